@@ -22,6 +22,14 @@
 //
 // Caveat: assumes the firmware flashing is always done from first to last
 // block, in increasing order. Random access flashing is not supported!
+//
+// With HAS_FAST_SYSEX_UPDATE, the SysEx pages are either nibblized (command
+// 0x7e 0x00), or packed in groups of 7 bytes preceded by a byte holding their
+// most significant bits (command 0x7e 0x01). A received page is copied to the
+// temporary page buffer of the chip, and the page is erased and written while
+// the next one is being received - the flash operations are polled from the
+// reception loop, so no byte is lost meanwhile. Otherwise, the pages are
+// nibblized, and written before the next one can be received.
 
 #include <avr/boot.h>
 #include <avr/pgmspace.h>
@@ -54,6 +62,9 @@ const uint8_t kMaxErrorCount = 5;
 
 
 uint16_t page = 0;
+#ifdef HAS_FAST_SYSEX_UPDATE
+uint16_t flash_page;
+#endif  // HAS_FAST_SYSEX_UPDATE
 uint8_t eeprom;
 uint8_t rx_buffer[257];
 uint8_t num_failures = 0;
@@ -120,6 +131,63 @@ inline void WriteBuffer(const uint8_t* buffer, uint8_t size) {
   }
 }
 
+#ifdef HAS_FAST_SYSEX_UPDATE
+enum FlashState {
+  FLASH_IDLE = 0,
+  FLASH_ERASING = 1,
+  FLASH_WRITING = 2,
+};
+
+uint8_t flash_state = FLASH_IDLE;
+
+// Moves to the next step of the page write once the previous one is complete.
+// Returns immediately while the flash is busy.
+void ContinueFlashWrite() {
+  if (boot_spm_busy()) {
+    return;
+  }
+  if (flash_state == FLASH_ERASING) {
+    boot_page_write(flash_page);
+    flash_state = FLASH_WRITING;
+  } else if (flash_state == FLASH_WRITING) {
+    // Also clears the temporary page buffer.
+    boot_rww_enable();
+    flash_state = FLASH_IDLE;
+  }
+}
+
+void FinishFlashWrite() {
+  while (flash_state != FLASH_IDLE) {
+    ContinueFlashWrite();
+  }
+}
+
+// Copies the received page to the temporary page buffer, and starts erasing
+// the page. The receive buffer can then be reused at once.
+void StartFlashWrite() {
+  FinishFlashWrite();
+  status_leds.Flash();
+
+  uint16_t i;
+  const uint8_t* p = rx_buffer;
+  eeprom_busy_wait();
+
+  for (i = 0; i < SPM_PAGESIZE; i += 2) {
+    uint16_t w = *p++;
+    w |= (*p++) << 8;
+    boot_page_fill(page + i, w);
+  }
+
+  flash_page = page;
+  boot_page_erase(page);
+  flash_state = FLASH_ERASING;
+}
+
+void WriteBufferToFlash() {
+  StartFlashWrite();
+  FinishFlashWrite();
+}
+#else
 void WriteBufferToFlash() {
   status_leds.Flash();
 
@@ -140,6 +208,7 @@ void WriteBufferToFlash() {
   boot_spm_busy_wait();
   boot_rww_enable();
 }
+#endif  // HAS_FAST_SYSEX_UPDATE
 
 void ReadRegionSpecs() {
   length.bytes[1] = ReadOrTimeout();
@@ -170,6 +239,9 @@ inline void MidiLoop() {
   uint8_t rx_buffer_index;
   uint8_t state = MATCHING_HEADER;
   uint8_t checksum;
+#ifdef HAS_FAST_SYSEX_UPDATE
+  uint8_t most_significant_bits;
+#endif  // HAS_FAST_SYSEX_UPDATE
   uint8_t sysex_commands[2];
 
   serial.Init<31250>();
@@ -177,7 +249,14 @@ inline void MidiLoop() {
   status_leds.WaitForData();
   page = 0;
   while (1) {
+#ifdef HAS_FAST_SYSEX_UPDATE
+    while (!serial.readable()) {
+      ContinueFlashWrite();
+    }
+    byte = serial.ImmediateRead();
+#else
     byte = serial.Read();
+#endif  // HAS_FAST_SYSEX_UPDATE
     // In case we see a realtime message in the stream, safely ignore it.
     if (byte > 0xf0 && byte != 0xf7) {
       continue;
@@ -216,6 +295,32 @@ inline void MidiLoop() {
 
       case READING_DATA:
         if (byte < 0x80) {
+#ifdef HAS_FAST_SYSEX_UPDATE
+          uint8_t complete;
+          if (sysex_commands[1]) {
+            uint8_t position = bytes_read & 7;
+            complete = position != 0;
+            if (complete) {
+              rx_buffer[rx_buffer_index] = byte |
+                  ((most_significant_bits << position) & 0x80);
+            } else {
+              most_significant_bits = byte;
+            }
+          } else {
+            complete = bytes_read & 1;
+            if (complete) {
+              rx_buffer[rx_buffer_index] |= byte & 0xf;
+            } else {
+              rx_buffer[rx_buffer_index] = (byte << 4);
+            }
+          }
+          if (complete) {
+            if (rx_buffer_index < SPM_PAGESIZE) {
+              checksum += rx_buffer[rx_buffer_index];
+            }
+            ++rx_buffer_index;
+          }
+#else
           if (bytes_read & 1) {
             rx_buffer[rx_buffer_index] |= byte & 0xf;
             if (rx_buffer_index < SPM_PAGESIZE) {
@@ -225,19 +330,32 @@ inline void MidiLoop() {
           } else {
             rx_buffer[rx_buffer_index] = (byte << 4);
           }
+#endif  // HAS_FAST_SYSEX_UPDATE
           ++bytes_read;
         } else if (byte == 0xf7) {
           if (sysex_commands[0] == 0x7f &&
               sysex_commands[1] == 0x00 &&
               bytes_read == 0) {
             // Reset.
+#ifdef HAS_FAST_SYSEX_UPDATE
+            // The last page might still be being written.
+            FinishFlashWrite();
+#endif  // HAS_FAST_SYSEX_UPDATE
             return;
           } else if (rx_buffer_index == SPM_PAGESIZE + 1 &&
                      sysex_commands[0] == 0x7e &&
+#ifdef HAS_FAST_SYSEX_UPDATE
+                     sysex_commands[1] <= 0x01 &&
+#else
                      sysex_commands[1] == 0x00 &&
+#endif  // HAS_FAST_SYSEX_UPDATE
                      rx_buffer[rx_buffer_index - 1] == checksum) {
             // Block write.
+#ifdef HAS_FAST_SYSEX_UPDATE
+            StartFlashWrite();
+#else
             WriteBufferToFlash();
+#endif  // HAS_FAST_SYSEX_UPDATE
             page += SPM_PAGESIZE;
             status_leds.SetProgress(1 + (page >> 12));
           } else {
@@ -408,7 +526,15 @@ int main(void) {
   if ((watchdog_status & _BV(WDRF)) || switch_input.Read() == LOW) {
     MidiLoop();
   } else {
+#ifdef HAS_FAST_BOOT
+    // After a power-up or a brown-out, the firmware is started at once. The
+    // serial programmers reset the chip through the reset pin.
+    if (watchdog_status & _BV(EXTRF)) {
+      StkLoop();
+    }
+#else
     StkLoop();
+#endif  // HAS_FAST_BOOT
   }
   main_entry_point();
   // Believe it or not, there is a weird situation in which the previous
@@ -19,9 +19,73 @@
 
 #include "hardware/hal/adc.h"
 
+#include <avr/interrupt.h>
+
 namespace hardware_hal {
 
 /* static */
 uint8_t Adc::reference_ = ADC_DEFAULT << 6;
 
+/* <static> */
+volatile int16_t AdcScanner::value_[max_channels];
+uint8_t AdcScanner::threshold_[max_channels];
+volatile uint8_t AdcScanner::changed_;
+volatile uint8_t AdcScanner::num_scans_;
+uint8_t AdcScanner::num_channels_;
+uint8_t AdcScanner::channel_;
+uint8_t AdcScanner::fast_channel_;
+uint8_t AdcScanner::converting_fast_channel_;
+volatile uint16_t AdcScanner::fast_sum_;
+volatile uint8_t AdcScanner::fast_count_;
+int16_t AdcScanner::fast_value_;
+/* </static> */
+
+/* static */
+void AdcScanner::Init(uint8_t num_channels, uint8_t fast_channel) {
+  num_channels_ = num_channels;
+  fast_channel_ = fast_channel;
+  converting_fast_channel_ = 0;
+  channel_ = fast_channel == 0 ? 1 : 0;
+  for (uint8_t i = 0; i < max_channels; ++i) {
+    // Out of range, so that the first conversion is always stored.
+    value_[i] = -1024;
+    threshold_[i] = 1;
+  }
+  changed_ = 0;
+  fast_sum_ = 0;
+  fast_count_ = 0;
+  fast_value_ = 0;
+  ADMUX = Adc::reference_ | channel_;
+  if (fast_channel == no_fast_channel) {
+    // Auto-trigger on timer 0 overflow.
+    ADCSRB = (ADCSRB & ~0x07) | 0x04;
+  } else {
+    // Auto-trigger on timer 1 overflow.
+    ADCSRB = (ADCSRB & ~0x07) | 0x06;
+    TIFR1 = _BV(TOV1);
+  }
+  ADCSRA |= _BV(ADATE) | _BV(ADIE);
+}
+
+/* static */
+int16_t AdcScanner::ReadFastChannel() {
+  uint8_t old_sreg = SREG;
+  cli();
+  uint16_t sum = fast_sum_;
+  uint8_t count = fast_count_;
+  fast_sum_ = 0;
+  fast_count_ = 0;
+  SREG = old_sreg;
+  // Keep the previous value if no conversion has completed since the last
+  // call.
+  if (count) {
+    fast_value_ = sum / count;
+  }
+  return fast_value_;
+}
+
 }  // namespace hardware_hal
+
+ISR(ADC_vect) {
+  hardware_hal::AdcScanner::Convert();
+}
@@ -20,6 +20,7 @@
 #ifndef HARDWARE_HAL_ADC_H_
 #define HARDWARE_HAL_ADC_H_
 
+#include <avr/interrupt.h>
 #include <avr/io.h>
 
 #include "hardware/hal/hal.h"
@@ -34,10 +35,13 @@ enum AdcReference {
 };
 
 IORegister(ADCSRA);
+IORegister(ADCSRB);
 
 typedef BitInRegister<ADCSRARegister, ADSC> AdcConvert;
 typedef BitInRegister<ADCSRARegister, ADEN> AdcEnabled;
 
+class AdcScanner;
+
 class Adc {
  public:
   static inline void set_prescaler(uint8_t factor) {
@@ -74,9 +78,122 @@ class Adc {
     uint8_t high = ADCH;
     return (high << 8) | low;
   }
+  friend class AdcScanner;
   DISALLOW_COPY_AND_ASSIGN(Adc);
 };
 
+// Free-running scan of the analog inputs 0 to num_channels - 1. Conversions
+// are triggered by the overflows of timer 0 (976Hz), and the ADC interrupt
+// stores the result and selects the next channel - so reading a value never
+// waits for the ADC. A new value is stored only when it differs from the
+// previous one by at least the threshold of the channel, in which case the
+// channel is flagged as changed. Adc::Read() must not be used once the scanner
+// is running.
+//
+// A fast channel can also be given. Every other conversion is then made on
+// this channel, and the results are summed until read by ReadFastChannel().
+// The conversions are triggered by the overflows of timer 1 instead - which
+// are never serviced by an interrupt, so the flag is cleared here. With the
+// ADC clocked at 125kHz, this gives about 8k conversions per second,
+// synchronous with the 31.25kHz PWM, for about 3% of the CPU.
+class AdcScanner {
+ public:
+  enum {
+    max_channels = 8,
+    no_fast_channel = 0xff
+  };
+  static void Init(uint8_t num_channels, uint8_t fast_channel);
+  static inline void Init(uint8_t num_channels) {
+    Init(num_channels, no_fast_channel);
+  }
+  static inline void set_threshold(uint8_t channel, uint8_t threshold) {
+    threshold_[channel] = threshold;
+  }
+  static inline int16_t Read(uint8_t channel) {
+    uint8_t old_sreg = SREG;
+    cli();
+    int16_t value = value_[channel];
+    SREG = old_sreg;
+    return value;
+  }
+  // Returns 1, and clears the flag, if the value of the channel has changed
+  // since the last call.
+  static inline uint8_t changed(uint8_t channel) {
+    uint8_t mask = 1 << channel;
+    uint8_t old_sreg = SREG;
+    cli();
+    uint8_t changed = changed_ & mask;
+    changed_ &= ~mask;
+    SREG = old_sreg;
+    return changed != 0;
+  }
+  // Number of complete scans of all the channels, modulo 256. When the signal
+  // fed to a channel is switched (by an external multiplexer), the value read
+  // is up to date only once this has been incremented twice - the first
+  // conversion might have started before the switch.
+  static inline uint8_t num_scans() { return num_scans_; }
+
+  // Returns the average of the conversions made on the fast channel since the
+  // last call - which filters out what the caller could not sample anyway.
+  static int16_t ReadFastChannel();
+
+  // Called by the ADC interrupt.
+  static inline void Convert() {
+    int16_t value = Adc::ReadOut();
+    uint8_t next;
+    if (converting_fast_channel_) {
+      fast_sum_ += value;
+      ++fast_count_;
+      converting_fast_channel_ = 0;
+      next = channel_;
+    } else {
+      uint8_t channel = channel_;
+      int16_t delta = value - value_[channel];
+      if (delta < 0) {
+        delta = -delta;
+      }
+      if (delta >= threshold_[channel]) {
+        value_[channel] = value;
+        changed_ |= 1 << channel;
+      }
+      do {
+        ++channel;
+        if (channel == num_channels_) {
+          channel = 0;
+          ++num_scans_;
+        }
+      } while (channel == fast_channel_);
+      channel_ = channel;
+      if (fast_channel_ != no_fast_channel) {
+        converting_fast_channel_ = 1;
+        next = fast_channel_;
+      } else {
+        next = channel;
+      }
+    }
+    // Takes effect at the next trigger.
+    ADMUX = Adc::reference_ | next;
+    if (fast_channel_ != no_fast_channel) {
+      TIFR1 = _BV(TOV1);
+    }
+  }
+
+ private:
+  static volatile int16_t value_[max_channels];
+  static uint8_t threshold_[max_channels];
+  static volatile uint8_t changed_;
+  static volatile uint8_t num_scans_;
+  static uint8_t num_channels_;
+  static uint8_t channel_;
+  static uint8_t fast_channel_;
+  static uint8_t converting_fast_channel_;
+  static volatile uint16_t fast_sum_;
+  static volatile uint8_t fast_count_;
+  static int16_t fast_value_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdcScanner);
+};
+
 template<int pin>
 struct AnalogInput {
   enum {
@@ -89,6 +206,19 @@ struct AnalogInput {
   }
 };
 
+// Same as AnalogInput, but reads the last value stored by the AdcScanner.
+template<int pin>
+struct ScannedAnalogInput {
+  enum {
+    buffer_size = 0,
+    data_size = 16,
+  };
+  static void Init() { }
+  static int16_t Read() {
+    return AdcScanner::Read(pin);
+  }
+};
+
 }  // namespace hardware_hal
 
 #endif  // HARDWARE_HAL_ADC_H_
@@ -32,10 +32,19 @@ enum UnderrunPolicy {
   HOLD_SAMPLE = 1
 };
 
+// Default, no-op, monitoring of the buffer. SampleEmitted() is called with the
+// number of samples found in the buffer, Underrun() when it was empty. Both
+// are called from the data emission interrupt.
+struct NoUnderrunMonitor {
+  static inline void SampleEmitted(uint8_t level) { }
+  static inline void Underrun() { }
+};
+
 template<typename OutputPort,
          uint8_t buffer_size_ = 32,
          uint8_t block_size = 16,
-         UnderrunPolicy underrun_policy = HOLD_SAMPLE>
+         UnderrunPolicy underrun_policy = HOLD_SAMPLE,
+         typename Monitor = NoUnderrunMonitor>
 class AudioOutput {
  public:
   AudioOutput() { }
@@ -43,7 +52,8 @@ class AudioOutput {
     buffer_size = buffer_size_,
     data_size = OutputPort::data_size,
   };
-  typedef AudioOutput<OutputPort, buffer_size_, block_size, underrun_policy> Me;
+  typedef AudioOutput<OutputPort, buffer_size_, block_size, underrun_policy,
+                      Monitor> Me;
   typedef typename DataTypeForSize<data_size>::Type Value;
   typedef Buffer<Me> OutputBuffer;
   
@@ -54,7 +64,14 @@ class AudioOutput {
   static inline void Write(Value v) { while (!writable()); Overwrite(v); }
   static inline void Overwrite(Value v) { OutputBuffer::Overwrite(v); }
   
+  // Zero-copy writes, see Buffer::WriteSpan().
+  static inline Value* WriteSpan(uint8_t max, uint8_t* span_size) {
+    return OutputBuffer::WriteSpan(max, span_size);
+  }
+  static inline void Commit(uint8_t n) { OutputBuffer::Commit(n); }
+
   static inline uint8_t writable() { return OutputBuffer::writable(); }
+  static inline uint8_t readable() { return OutputBuffer::readable(); }
   static inline uint8_t writable_block() {
     return OutputBuffer::writable() >= block_size;
   }
@@ -68,11 +85,13 @@ class AudioOutput {
   
   // Called from data emission interrupt.
   static inline void EmitSample() {
-    int16_t v = OutputBuffer::NonBlockingRead();
-    if (v >= 0) {
-      OutputPort::Write(Value(v));
+    uint8_t level = OutputBuffer::readable();
+    if (level) {
+      OutputPort::Write(OutputBuffer::ImmediateRead());
+      Monitor::SampleEmitted(level);
     } else {
       ++num_glitches_;
+      Monitor::Underrun();
       if (underrun_policy == EMIT_CLICK) {
         // Introduces clicks to allow underruns to be easily detected.
         OutputPort::Write(0);
@@ -89,9 +108,9 @@ class AudioOutput {
 
 /* static */
 template<typename OutputPort, uint8_t buffer_size_, uint8_t block_size,
-         UnderrunPolicy underrun_policy>
+         UnderrunPolicy underrun_policy, typename Monitor>
 uint16_t AudioOutput<OutputPort, buffer_size_, block_size,
-                     underrun_policy>::num_glitches_ = 0;
+                     underrun_policy, Monitor>::num_glitches_ = 0;
 
 }  // namespace hardware_hal
 
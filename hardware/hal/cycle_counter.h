@@ -0,0 +1,96 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Cycle counter for profiling, built on top of a timer running in 8-bit phase
+// correct PWM mode without prescaler - which is how timers 1 and 2 are
+// configured for the PWM and audio outputs. Such a timer counts up from 0 to
+// 255, then down to 0, so:
+// - the number of elapsed periods (510 cycles each) is counted by calling
+// Tick() in the overflow interrupt of the same timer.
+// - the position in the period is obtained by reading the timer twice to find
+// in which direction it is counting.
+//
+// The time spent in interrupts is included in the measurements.
+
+#ifndef HARDWARE_HAL_CYCLE_COUNTER_H_
+#define HARDWARE_HAL_CYCLE_COUNTER_H_
+
+#include "hardware/base/base.h"
+#include "hardware/hal/timer.h"
+
+namespace hardware_hal {
+
+struct CycleCounterTimestamp {
+  uint16_t ticks;
+  uint16_t phase;
+};
+
+template<int timer_index>
+class CycleCounter {
+ public:
+  typedef CycleCounterTimestamp Timestamp;
+  enum {
+    period = 510
+  };
+  CycleCounter() { }
+
+  static inline void Tick() { ++ticks_; }
+
+  static inline void Read(Timestamp* timestamp) {
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t ticks = ticks_;
+    uint8_t a = Timer<timer_index>::value();
+    uint8_t b = Timer<timer_index>::value();
+    uint8_t overflow = Timer<timer_index>::overflow();
+    SREG = oldSREG;
+    if (b >= a) {
+      // The overflow occurred before the timer was read, but the interrupt has
+      // not been serviced yet.
+      if (overflow) {
+        ++ticks;
+      }
+      timestamp->phase = b;
+    } else {
+      timestamp->phase = period - b;
+    }
+    timestamp->ticks = ticks;
+  }
+
+  // Number of cycles elapsed since a timestamp. Valid for up to 65536 periods
+  // (about 2s at 16MHz).
+  static inline uint32_t Elapsed(const Timestamp& start) {
+    Timestamp now;
+    Read(&now);
+    return static_cast<uint32_t>(
+        static_cast<uint16_t>(now.ticks - start.ticks)) * period +
+        now.phase - start.phase;
+  }
+
+ private:
+  static volatile uint16_t ticks_;
+
+  DISALLOW_COPY_AND_ASSIGN(CycleCounter);
+};
+
+/* static */
+template<int timer_index>
+volatile uint16_t CycleCounter<timer_index>::ticks_;
+
+}  // namespace hardware_hal
+
+#endif  // HARDWARE_HAL_CYCLE_COUNTER_H_
@@ -21,6 +21,12 @@
 // multiple chips. For example, if four 16k chips (AT24C128) are connected on the
 // bus, R/W to addresses 0x0000 - 0x4000 will be addressed to chip 1, 
 // R/W to addresses 0x4000 - 0x8000 will be addressed to chip 2, etc.
+//
+// Reads can also be done in the background: StartRead() sends the address,
+// and each call to PollRead() advances the transaction without waiting for
+// the bus, until the data has been received. Only one such read can be in
+// progress. The blocking operations first wait for its completion - a
+// blocking read then discards its result.
 
 #ifndef HARDWARE_HAL_DEVICES_EXTERNAL_EEPROM_H_
 #define HARDWARE_HAL_DEVICES_EXTERNAL_EEPROM_H_
@@ -29,6 +35,20 @@
 
 namespace hardware_hal {
 
+enum EepromReadStatus {
+  EEPROM_READ_PENDING,
+  EEPROM_READ_DONE,
+  EEPROM_READ_FAILED
+};
+
+enum EepromTransferState {
+  EEPROM_TRANSFER_IDLE,
+  EEPROM_TRANSFER_ADDRESSING,
+  EEPROM_TRANSFER_REQUESTING,
+  EEPROM_TRANSFER_DONE,
+  EEPROM_TRANSFER_FAILED
+};
+
 template<uint16_t eeprom_size = 8192 /* bytes */,
         typename Bus = I2cMaster<8, 64>,
         uint8_t base_address = 0,
@@ -67,6 +87,11 @@ class ExternalEeprom {
   }
   
   static uint8_t SetAddress(uint16_t address) {
+    Finish();
+    // The data of the background read is flushed below.
+    if (transfer_state_ == EEPROM_TRANSFER_DONE) {
+      transfer_state_ = EEPROM_TRANSFER_FAILED;
+    }
     uint8_t header[2];
     if (auto_banking) {
       bank_ = (address / eeprom_size);
@@ -124,16 +149,98 @@ class ExternalEeprom {
 
   static uint8_t Write(uint16_t address, uint8_t byte) {
     uint8_t data = byte;
-    return Write(&data, 1);
+    return Write(address, &data, 1);
+  }
+
+  // Returns 0 if the bus is busy, or if a background read is already in
+  // progress.
+  static uint8_t StartRead(uint16_t address, uint8_t size) {
+    if (transfer_state_ != EEPROM_TRANSFER_IDLE || Bus::busy() ||
+        Bus::writable() < 2 || size >= Bus::Input::capacity()) {
+      return 0;
+    }
+    uint8_t bank = bank_;
+    if (auto_banking) {
+      bank = (address / eeprom_size);
+      address %= eeprom_size;
+    }
+    transfer_device_ = (base_address + bank) | 0x50;
+    transfer_size_ = size;
+    Bus::Output::Overwrite(address >> 8);
+    Bus::Output::Overwrite(address & 0xff);
+    Bus::FlushInputBuffer();
+    if (!Bus::Send(transfer_device_)) {
+      Bus::Output::Flush();
+      return 0;
+    }
+    transfer_state_ = EEPROM_TRANSFER_ADDRESSING;
+    return 1;
+  }
+
+  // Returns an EepromReadStatus. The data is copied once the read is done.
+  static uint8_t PollRead(uint8_t* data) {
+    Step();
+    switch (transfer_state_) {
+      case EEPROM_TRANSFER_DONE:
+        for (uint8_t i = 0; i < transfer_size_; ++i) {
+          *data++ = Bus::ImmediateRead();
+        }
+        transfer_state_ = EEPROM_TRANSFER_IDLE;
+        return EEPROM_READ_DONE;
+
+      case EEPROM_TRANSFER_ADDRESSING:
+      case EEPROM_TRANSFER_REQUESTING:
+        return EEPROM_READ_PENDING;
+
+      default:
+        transfer_state_ = EEPROM_TRANSFER_IDLE;
+        return EEPROM_READ_FAILED;
+    }
+  }
+
+  static inline uint8_t reading() {
+    return transfer_state_ != EEPROM_TRANSFER_IDLE;
   }
-   
+
  private:
+  // Advances the background read if the bus is available.
+  static void Step() {
+    if (Bus::busy()) {
+      return;
+    }
+    if (transfer_state_ == EEPROM_TRANSFER_ADDRESSING) {
+      if (Bus::error() != I2C_ERROR_NONE) {
+        // The address bytes of a failed transaction are still in the buffer.
+        Bus::Output::Flush();
+        transfer_state_ = EEPROM_TRANSFER_FAILED;
+      } else if (Bus::Request(transfer_device_, transfer_size_) !=
+                 transfer_size_) {
+        transfer_state_ = EEPROM_TRANSFER_FAILED;
+      } else {
+        transfer_state_ = EEPROM_TRANSFER_REQUESTING;
+      }
+    } else if (transfer_state_ == EEPROM_TRANSFER_REQUESTING) {
+      transfer_state_ = Bus::readable() >= transfer_size_ ?
+          EEPROM_TRANSFER_DONE : EEPROM_TRANSFER_FAILED;
+    }
+  }
+
+  // Completes the background read, if any, before a blocking operation.
+  static void Finish() {
+    while (transfer_state_ == EEPROM_TRANSFER_ADDRESSING ||
+           transfer_state_ == EEPROM_TRANSFER_REQUESTING) {
+      Step();
+    }
+  }
+
   static uint8_t Write(const uint8_t* header, uint8_t header_size, 
                        const uint8_t* payload, uint8_t payload_size) {
     uint8_t size = header_size + payload_size;
     if (size >= Bus::Output::capacity()) {
       return 0;  // Hopeless, it won't fit in one write.
     }
+    // The address of the background read must be followed by its request.
+    Finish();
     // Wait until the buffer is flushed, and write to the buffer.
     while (Bus::writable() < size) { }
     for (uint8_t i = 0; i < header_size; ++i) {
@@ -158,6 +265,9 @@ class ExternalEeprom {
   }
   
   static uint8_t bank_;
+  static uint8_t transfer_state_;
+  static uint8_t transfer_device_;
+  static uint8_t transfer_size_;
   
   DISALLOW_COPY_AND_ASSIGN(ExternalEeprom);
 };
@@ -167,6 +277,24 @@ template<uint16_t eeprom_size, typename Bus, uint8_t base_address,
          bool auto_banking>
 uint8_t ExternalEeprom<eeprom_size, Bus, base_address, auto_banking>::bank_ = 0;
 
+/* static */
+template<uint16_t eeprom_size, typename Bus, uint8_t base_address,
+         bool auto_banking>
+uint8_t ExternalEeprom<eeprom_size, Bus, base_address,
+                       auto_banking>::transfer_state_ = EEPROM_TRANSFER_IDLE;
+
+/* static */
+template<uint16_t eeprom_size, typename Bus, uint8_t base_address,
+         bool auto_banking>
+uint8_t ExternalEeprom<eeprom_size, Bus, base_address,
+                       auto_banking>::transfer_device_;
+
+/* static */
+template<uint16_t eeprom_size, typename Bus, uint8_t base_address,
+         bool auto_banking>
+uint8_t ExternalEeprom<eeprom_size, Bus, base_address,
+                       auto_banking>::transfer_size_;
+
 }  // namespace hardware_hal
 
 #endif   // HARDWARE_HAL_DEVICES_EXTERNAL_EEPROM_H_
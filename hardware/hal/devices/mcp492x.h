@@ -16,10 +16,15 @@
 // -----------------------------------------------------------------------------
 //
 // Driver for a MCP492x DAC (SPI single/dual 12-bits DAC).
+//
+// With the default resolution of 8 bits, the values written are the 8 most
+// significant bits of the DAC code. With a resolution of 12 bits, the values
+// are 16-bit words, of which the 12 least significant bits are used.
 
 #ifndef HARDWARE_HAL_DEVICES_MCP492X_H_
 #define HARDWARE_HAL_DEVICES_MCP492X_H_
 
+#include "hardware/hal/size_to_type.h"
 #include "hardware/hal/spi.h"
 #include "hardware/utils/op.h"
 
@@ -36,37 +41,48 @@ enum DacVoltageReference {
 
 template<uint8_t slave_select_pin,
          DacVoltageReference voltage_reference = UNBUFFERED_REFERENCE,
-         uint8_t gain = 1>
+         uint8_t gain = 1,
+         uint8_t resolution = 8>
 class Dac {
  public:
   enum {
     buffer_size = 0,
-    data_size = 8,
+    data_size = resolution > 8 ? 16 : 8,
   };
+  typedef typename DataTypeForSize<data_size>::Type Value;
   Dac() { }
   
   static void Init() {
     DacInterface::Init();
   }
   
-  static void Write(uint8_t value) {
+  static inline void Write(Value value) {
     Write(value, 0);
   }
 
-  static void Write(uint8_t value, uint8_t channel) {
-    value = Swap4(value);
+  static inline void Write(Value value, uint8_t channel) {
     uint8_t command;
-    command = (value & 0x0f) | 0x10;
+    uint8_t data;
+    if (resolution > 8) {
+      command = (value >> 8) & 0x0f;
+      data = value & 0xff;
+    } else {
+      uint8_t swapped = Swap4(value);
+      command = swapped & 0x0f;
+      data = swapped & 0xf0;
+    }
+    // Output enabled.
+    command |= 0x10;
     if (channel) {
       command |= 0x80;
     }
-    if (voltage_reference == BUFFERED) {
+    if (voltage_reference == BUFFERED_REFERENCE) {
       command |= 0x40;
     }
     if (gain == 1) {
       command |= 0x20;
     }
-    DacInterface::Write(command, value & 0xf0);
+    DacInterface::WriteWord(command, data);
   }
 
  private:
@@ -61,8 +61,8 @@ class OutputArray {
     values_[output_index] = intensity;
   }
   static inline Value value(Index output_index) {
-    if (safe) {
-      ARGUMENT_CHECK_LT(output_index, size);
+    if (safe && output_index >= size) {
+      return 0;
     }
     return values_[output_index];
   }
@@ -131,8 +131,8 @@ class OutputArray<Latch, Clock, Data, size, 4, order, safe> {
     }
   }
   static inline Value value(Index output_index) {
-    if (safe) {
-      ARGUMENT_CHECK_LT(output_index, size);
+    if (safe && output_index >= size) {
+      return 0;
     }
     if (output_index & 1) {
       return values_[output_index >> 1] >> 4;
@@ -213,8 +213,8 @@ class OutputArray<Latch, Clock, Data, size, 1, order, safe> {
     }
   }
   static inline uint8_t value(uint8_t output_index) {
-    if (safe) {
-      ARGUMENT_CHECK_LT(output_index, size);
+    if (safe && output_index >= size) {
+      return 0;
     }
     T mask = T(1) << output_index;
     return T(bits_ & mask) ? 1 : 0;
@@ -243,6 +243,119 @@ template<typename Latch, typename Clock, typename Data,
 typename OutputArray<Latch, Clock, Data, size, 1, order, safe>::T
 OutputArray<Latch, Clock, Data, size, 1, order, safe>::last_bits_;
 
+
+// An array of outputs with 2^bit_depth brightness levels, displayed by binary
+// code modulation rather than by comparing each value to a PWM counter. The
+// values are stored as bit_depth "bit planes" - the i-th plane holds the i-th
+// bit of each value - and the i-th plane is held on the outputs for 2^i calls
+// to Refresh(). The values only have to be decomposed when they are set, and
+// the shift register is only written when the plane changes - bit_depth times
+// per cycle of 2^bit_depth - 1 calls - so that Refresh() can be called from a
+// timer interrupt.
+//
+// The values are set in a back buffer, published to Refresh() by Output().
+template<typename Latch, typename Clock, typename Data,
+         uint8_t size = 16, uint8_t bit_depth = 4,
+         DataOrder order = LSB_FIRST>
+class BitPlaneOutputArray {
+  typedef ShiftRegister<Latch, Clock, Data, size, order> Register;
+ public:
+  typedef typename DataTypeForSize<bit_depth>::Type Value;
+  typedef typename DataTypeForSize<size>::Type T;
+  BitPlaneOutputArray() { }
+  static inline void Init() {
+    Clear();
+    memset(planes_, 0, sizeof(planes_));
+    plane_ = 0;
+    countdown_ = 1;
+    last_bits_ = 0;
+    Register::Init();
+    Register::Write(0);
+  }
+  static inline void Clear() { memset(next_planes_, 0, sizeof(next_planes_)); }
+  static inline void set_value(uint8_t output_index, Value intensity) {
+    T mask = T(1) << output_index;
+    for (uint8_t i = 0; i < bit_depth; ++i) {
+      if (intensity & 1) {
+        next_planes_[i] |= mask;
+      } else {
+        next_planes_[i] &= ~mask;
+      }
+      intensity >>= 1;
+    }
+  }
+  static inline Value value(uint8_t output_index) {
+    T mask = T(1) << output_index;
+    Value intensity = 0;
+    for (uint8_t i = bit_depth; i > 0; --i) {
+      intensity <<= 1;
+      if (next_planes_[i - 1] & mask) {
+        intensity |= 1;
+      }
+    }
+    return intensity;
+  }
+  static inline void Output() {
+    if (!memcmp(planes_, next_planes_, sizeof(planes_))) {
+      return;
+    }
+    uint8_t old_sreg = SREG;
+    cli();
+    memcpy(planes_, next_planes_, sizeof(planes_));
+    SREG = old_sreg;
+  }
+  static inline void Refresh() {
+    if (--countdown_) {
+      return;
+    }
+    ++plane_;
+    if (plane_ == bit_depth) {
+      plane_ = 0;
+    }
+    countdown_ = 1 << plane_;
+    T bits = planes_[plane_];
+    if (bits != last_bits_) {
+      Register::Write(bits);
+      last_bits_ = bits;
+    }
+  }
+ private:
+  static T next_planes_[bit_depth];
+  static T planes_[bit_depth];
+  static T last_bits_;
+  static uint8_t plane_;
+  static uint8_t countdown_;
+  
+  DISALLOW_COPY_AND_ASSIGN(BitPlaneOutputArray);
+};
+
+template<typename Latch, typename Clock, typename Data,
+         uint8_t size, uint8_t bit_depth, DataOrder order>
+typename BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::T
+BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::next_planes_[
+    bit_depth];
+
+template<typename Latch, typename Clock, typename Data,
+         uint8_t size, uint8_t bit_depth, DataOrder order>
+typename BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::T
+BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::planes_[
+    bit_depth];
+
+template<typename Latch, typename Clock, typename Data,
+         uint8_t size, uint8_t bit_depth, DataOrder order>
+typename BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::T
+BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::last_bits_;
+
+template<typename Latch, typename Clock, typename Data,
+         uint8_t size, uint8_t bit_depth, DataOrder order>
+uint8_t
+BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::plane_;
+
+template<typename Latch, typename Clock, typename Data,
+         uint8_t size, uint8_t bit_depth, DataOrder order>
+uint8_t
+BitPlaneOutputArray<Latch, Clock, Data, size, bit_depth, order>::countdown_;
+
 }  // namespace hardware_hal
 
 #endif   // HARDWARE_HAL_DEVICES_OUTPUT_ARRAY_H_
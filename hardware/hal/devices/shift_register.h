@@ -16,12 +16,20 @@
 // -----------------------------------------------------------------------------
 //
 // Driver for a 8-bits shift register.
+//
+// When the clock and data lines are wired to the clock and data output pins of
+// the hardware SPI port, the bits are shifted by the SPI port, one byte at a
+// time, rather than by toggling the pins - only in MSB first order, since the
+// bit order is shared by all the devices on the bus.
 
 #ifndef HARDWARE_HAL_DEVICES_SHIFT_REGISTER_H_
 #define HARDWARE_HAL_DEVICES_SHIFT_REGISTER_H_
 
+#include <avr/interrupt.h>
+
 #include "hardware/hal/gpio.h"
 #include "hardware/hal/size_to_type.h"
+#include "hardware/hal/spi.h"
 
 namespace hardware_hal {
 
@@ -88,6 +96,33 @@ struct ShiftRegister<Latch, Clock, Data, size, MSB_FIRST>
   }
 };
 
+template<int latch_pin, uint8_t size>
+struct ShiftRegister<Gpio<latch_pin>, Gpio<kSpiClockPin>, Gpio<kSpiDataOutPin>,
+                     size, MSB_FIRST> {
+  ShiftRegister() { }
+  typedef typename DataTypeForSize<size>::Type T;
+  // The latch is driven as the slave select line of the SPI port.
+  typedef Spi<latch_pin, MSB_FIRST, 2> Interface;
+  static void Init() {
+    Interface::Init();
+  }
+  static void Write(T data) {
+    LOG(INFO) << "pin_" << kSpiDataOutPin << "\tshift\t" << int(data);
+    // A transfer started by an interrupt handler - for example the audio
+    // DAC - in the middle of this one would corrupt both. The sizes which are
+    // not a multiple of 8 are padded with leading zeros, which end up on the
+    // last, unused, outputs of the chain.
+    uint8_t old_sreg = SREG;
+    cli();
+    if (size > 8) {
+      Interface::WriteWord(data >> 8, data & 0xff);
+    } else {
+      Interface::Write(data);
+    }
+    SREG = old_sreg;
+  }
+};
+
 }  // namespace hardware_hal
 
 #endif  // HARDWARE_HAL_DEVICES_SHIFT_REGISTER_H_
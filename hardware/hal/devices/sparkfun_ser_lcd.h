@@ -52,6 +52,9 @@ namespace hardware_hal {
 static const uint8_t kLcdNoCursor = 0xff;
 static const uint8_t kLcdCursorBlinkRate = 0x7f;
 static const uint8_t kLcdCursor = 0xff;
+// Modified characters separated by less than this number of unmodified ones
+// are sent as a single run, rather than with a cursor move command.
+static const uint8_t kLcdMaxGap = 2;
 // Dear Serial LCD, why do I have to tell you all the time that I don't want
 // to use your stupid default 9600 bps baud rate? Are you listening to me?
 // Serial LCD? Serial LCD? Serial LCD?
@@ -79,7 +82,9 @@ class Display {
       9600> DisplayPanicSerialOutput;
 
   Display() { }
-  static void Init() {
+  // When wait is false, the baud rate message is sent only once, and the
+  // caller must leave the display 200ms to switch before writing to it.
+  static void Init(bool wait = true) {
     for (uint8_t i = 0; i < lcd_buffer_size; ++i) {
       local_[i] = ' ';
       remote_[i] = '?';
@@ -92,7 +97,8 @@ class Display {
     // At worst, if the baud rate is already set, this will display glitchy
     // characters for a short amount of time (if the display is configured at
     // 2400 bps, they look like the infinity symbol).
-    for (uint8_t i = 0; i < kSerialLcdIsMyProblemChild; ++i) {
+    uint8_t num_attempts = wait ? kSerialLcdIsMyProblemChild : 1;
+    for (uint8_t i = 0; i < num_attempts; ++i) {
       DisplayPanicSerialOutput::Write(124);
       if (baud_rate == 2400) {
         DisplayPanicSerialOutput::Write(11);
@@ -107,7 +113,9 @@ class Display {
       } else if (baud_rate == 19200) {
         DisplayPanicSerialOutput::Write(16);
       }
-      Delay(200);
+      if (wait) {
+        Delay(200);
+      }
     }
     DisplaySerialOutput::Init();
   }
@@ -141,6 +149,38 @@ class Display {
     DisplaySerialOutput::Write(128 + brightness);
   }
 
+  // Non-blocking version of SetCustomCharMap: writes the bytes of the upload
+  // which fit in the output buffer, from *position - initially 0. Returns 1
+  // once the whole map has been written.
+  static uint8_t UploadCustomCharMap(const uint8_t* characters,
+                                     uint8_t num_characters,
+                                     uint8_t* position) {
+    // A clear command, then for each character its address, its 8 rows and a
+    // clear command.
+    uint8_t size = 2 + num_characters * 12;
+    while (*position < size && DisplaySerialOutput::writable()) {
+      uint8_t p = *position;
+      uint8_t byte = 0xfe;
+      if (p < 2) {
+        byte = p == 0 ? 0xfe : 0x01;
+      } else {
+        uint8_t i = (p - 2) / 12;
+        uint8_t row = (p - 2) - i * 12;
+        if (row == 1) {
+          byte = 0x40 + i * 8;
+        } else if (row >= 2 && row < 10) {
+          byte = 0x20 | SimpleResourcesManager::Lookup<uint8_t, uint8_t>(
+              characters, i * 8 + row - 2);
+        } else if (row == 11) {
+          byte = 0x01;
+        }
+      }
+      DisplaySerialOutput::Overwrite(byte);
+      ++*position;
+    }
+    return *position == size;
+  }
+
   static void SetCustomCharMap(const uint8_t* characters,
                                uint8_t num_characters) {
     DisplaySerialOutput::Write(0xfe);
@@ -180,9 +220,9 @@ class Display {
   static inline void Tick() { DisplaySerialOutput::Tick(); }
   
   static void Update() {
-    // The following code is likely to write 3 bytes at most. If there are less
-    // than 3 bytes available for write in the output buffer, there's no reason
-    // to take the risk to continue.
+    // The following code writes 3 bytes at most for each character. If there
+    // are less than 3 bytes available for write in the output buffer, there's
+    // no reason to take the risk to continue.
     if (DisplaySerialOutput::writable() < 3) {
       return;
     }
@@ -196,33 +236,51 @@ class Display {
       status_ = 0;
     }
 
-    uint8_t character = 0;
-    // Determine which character to show at the current position.
+    // Unmodified characters are skipped one at a time, but a run of modified
+    // characters is transmitted at once, as long as there is room in the
+    // output buffer.
+    while (TransmitCharacter() && DisplaySerialOutput::writable() >= 3) { }
+  }
+
+ private:
+  // Determine which character to show at a given position.
+  static inline uint8_t DisplayedCharacter(uint8_t position) {
     // If the scan position is the cursor and it is shown (blinking), draw the
     // cursor.
-    if (scan_position_ == cursor_position_ && blink_) {
-      character = kLcdCursor;
-    } else {
-      // Otherwise, check if there's a status indicator to display. It is
-      // displayed either on the left or right of the first line, depending on
-      // the available space.
-      if (status_ && (scan_position_ == 0 || scan_position_ == (width - 1)) &&
-          local_[scan_position_] == ' ') {
-        character = status_ - 1;
-      } else {
-        character = local_[scan_position_];
-      }
+    if (position == cursor_position_ && blink_) {
+      return kLcdCursor;
+    }
+    // Otherwise, check if there's a status indicator to display. It is
+    // displayed either on the left or right of the first line, depending on
+    // the available space.
+    if (status_ && (position == 0 || position == (width - 1)) &&
+        local_[position] == ' ') {
+      return status_ - 1;
     }
+    return local_[position];
+  }
+
+  // Checks the character at the scan position, transmits it if it needs to,
+  // and moves to the next position. Returns 1 if a character was transmitted.
+  static uint8_t TransmitCharacter() {
+    uint8_t character = DisplayedCharacter(scan_position_);
+    uint8_t transmitted = 0;
     // Check whether the screen really has to be updated to show the character.
     if (character != remote_[scan_position_] ||
         scan_position_ == cursor_position_) {
       // There is a character to transmit!
-      // If the new character to transmit is just after the previous one, and on
-      // the same line, we're good, we don't need to reposition the cursor.
-      if ((scan_position_ == scan_position_last_write_ + 1) &&
-          (scan_position_ & (width - 1))) {
+      // If the new character to transmit is on the same line as the previous
+      // one, and there are less than kLcdMaxGap characters between them, the
+      // characters in between are transmitted again - this is shorter than
+      // the 2 bytes of a cursor move command.
+      uint8_t column = scan_position_ & (width - 1);
+      uint8_t gap = scan_position_ - scan_position_last_write_ - 1;
+      if (gap < column && gap < kLcdMaxGap) {
         // We use overwrite because we have checked before that there is
         // enough room in the buffer.
+        for (uint8_t i = scan_position_ - gap; i != scan_position_; ++i) {
+          DisplaySerialOutput::Overwrite(remote_[i]);
+        }
         DisplaySerialOutput::Overwrite(character);
       } else {
         // The character to transmit is at a different position, we need to move
@@ -230,7 +288,7 @@ class Display {
         uint8_t cursor_position = 0x80;
         cursor_position |= (scan_position_ & ~(width - 1)) <<
             Log2<64 / width>::value;
-        cursor_position |= (scan_position_ & (width - 1));
+        cursor_position |= column;
         DisplaySerialOutput::Overwrite(0xfe);
         DisplaySerialOutput::Overwrite(cursor_position);
         DisplaySerialOutput::Overwrite(character);
@@ -238,11 +296,12 @@ class Display {
       // We can now assume that remote display will be updated.
       remote_[scan_position_] = character;
       scan_position_last_write_ = scan_position_;
+      transmitted = 1;
     }
     scan_position_ = (scan_position_ + 1) & lcd_buffer_size_wrap;
+    return transmitted;
   }
 
- private:
   // Character pages storing what the display currently shows (remote), and
   // what it ought to show (local).
   static uint8_t local_[width * height];
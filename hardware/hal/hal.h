@@ -46,13 +46,19 @@ static const uint16_t kEepromSize = 1024;
 // pass it as a template argument.
 #define IORegister(reg) struct reg##Register { \
   static volatile uint8_t* ptr() { return &reg; } \
-  reg##Register& operator=(const uint8_t& value) { *ptr() = value; } \
+  reg##Register& operator=(const uint8_t& value) { \
+    *ptr() = value; \
+    return *this; \
+  } \
   uint8_t operator()(const uint8_t& value) { return *ptr(); } \
 };
 
 #define SpecialFunctionRegister(reg) struct reg##Register { \
   static volatile uint8_t* ptr() { return &_SFR_BYTE(reg); } \
-  reg##Register& operator=(const uint8_t& value) { *ptr() = value; } \
+  reg##Register& operator=(const uint8_t& value) { \
+    *ptr() = value; \
+    return *this; \
+  } \
   uint8_t operator()(const uint8_t& value) { return *ptr(); } \
 };
 
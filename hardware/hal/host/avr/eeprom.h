@@ -0,0 +1,38 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host (desktop) stand-in for <avr/eeprom.h>, backed by a RAM array.
+
+#ifndef HARDWARE_HAL_HOST_AVR_EEPROM_H_
+#define HARDWARE_HAL_HOST_AVR_EEPROM_H_
+
+#include <inttypes.h>
+
+extern uint8_t host_eeprom[1024];
+
+#define eeprom_busy_wait()
+#define eeprom_is_ready() 1
+
+inline uint8_t eeprom_read_byte(const uint8_t* address) {
+  return host_eeprom[(uintptr_t)(address) & 1023];
+}
+
+inline void eeprom_write_byte(uint8_t* address, uint8_t value) {
+  host_eeprom[(uintptr_t)(address) & 1023] = value;
+}
+
+#endif  // HARDWARE_HAL_HOST_AVR_EEPROM_H_
@@ -0,0 +1,31 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host (desktop) stand-in for <avr/interrupt.h>. ISR bodies become ordinary
+// functions, so that a desktop driver can call them to emulate the timers.
+
+#ifndef HARDWARE_HAL_HOST_AVR_INTERRUPT_H_
+#define HARDWARE_HAL_HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(vector) extern "C" void vector(void); extern "C" void vector(void)
+
+#define cli()
+#define sei()
+
+#endif  // HARDWARE_HAL_HOST_AVR_INTERRUPT_H_
@@ -0,0 +1,133 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host (desktop) stand-in for <avr/io.h>. The special function registers are
+// plain variables defined in hardware/hal/host/registers.cc, so that the HAL
+// templates compile and can be poked at, but nothing is wired to them.
+
+#ifndef HARDWARE_HAL_HOST_AVR_IO_H_
+#define HARDWARE_HAL_HOST_AVR_IO_H_
+
+#include <inttypes.h>
+
+#define _BV(bit) (1 << (bit))
+#define _SFR_BYTE(sfr) (sfr)
+
+#define HOST_REGISTER(reg) extern volatile uint8_t reg;
+
+HOST_REGISTER(SREG)
+
+HOST_REGISTER(DDRB)
+HOST_REGISTER(DDRC)
+HOST_REGISTER(DDRD)
+HOST_REGISTER(PINB)
+HOST_REGISTER(PINC)
+HOST_REGISTER(PIND)
+HOST_REGISTER(PORTB)
+HOST_REGISTER(PORTC)
+HOST_REGISTER(PORTD)
+
+HOST_REGISTER(TCCR0A)
+HOST_REGISTER(TCCR0B)
+HOST_REGISTER(TCCR1A)
+HOST_REGISTER(TCCR1B)
+HOST_REGISTER(TCCR2A)
+HOST_REGISTER(TCCR2B)
+HOST_REGISTER(TIMSK0)
+HOST_REGISTER(TIMSK1)
+HOST_REGISTER(TIMSK2)
+HOST_REGISTER(TIFR0)
+HOST_REGISTER(TIFR1)
+HOST_REGISTER(TIFR2)
+HOST_REGISTER(TCNT0)
+HOST_REGISTER(TCNT1)
+HOST_REGISTER(TCNT2)
+HOST_REGISTER(OCR0A)
+HOST_REGISTER(OCR0B)
+HOST_REGISTER(OCR1A)
+HOST_REGISTER(OCR1B)
+HOST_REGISTER(OCR2A)
+HOST_REGISTER(OCR2B)
+
+HOST_REGISTER(UBRR0H)
+HOST_REGISTER(UBRR0L)
+HOST_REGISTER(UCSR0A)
+HOST_REGISTER(UCSR0B)
+HOST_REGISTER(UDR0)
+
+HOST_REGISTER(ADCSRA)
+HOST_REGISTER(ADCSRB)
+HOST_REGISTER(ADMUX)
+HOST_REGISTER(ADCL)
+HOST_REGISTER(ADCH)
+
+HOST_REGISTER(SPCR)
+HOST_REGISTER(SPSR)
+HOST_REGISTER(SPDR)
+
+HOST_REGISTER(TWBR)
+HOST_REGISTER(TWCR)
+HOST_REGISTER(TWSR)
+HOST_REGISTER(TWDR)
+
+#undef HOST_REGISTER
+
+// Bit positions, as in <avr/iom328p.h>.
+#define TXEN0 3
+#define RXEN0 4
+#define RXCIE0 7
+#define UDRE0 5
+#define UDRIE0 5
+#define RXC0 7
+
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIE 3
+
+#define SPR0 0
+#define SPR1 1
+#define MSTR 4
+#define DORD 5
+#define SPE 6
+#define SPI2X 0
+#define SPIF 7
+
+#define TOV0 0
+#define TOV1 0
+#define TOV2 0
+
+#define OCF0A 1
+#define OCIE0A 1
+
+#define COM0B1 5
+#define COM0A1 7
+#define COM1B1 5
+#define COM1A1 7
+#define COM2B1 5
+#define COM2A1 7
+
+#define TWPS0 0
+#define TWPS1 1
+#define TWIE 0
+#define TWEN 2
+#define TWSTO 4
+#define TWSTA 5
+#define TWEA 6
+#define TWINT 7
+
+#endif  // HARDWARE_HAL_HOST_AVR_IO_H_
@@ -0,0 +1,51 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host (desktop) stand-in for <avr/pgmspace.h>. There is only one address
+// space on the host, so reading from "program memory" is a plain dereference.
+
+#ifndef HARDWARE_HAL_HOST_AVR_PGMSPACE_H_
+#define HARDWARE_HAL_HOST_AVR_PGMSPACE_H_
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <avr/io.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+typedef char prog_char;
+typedef int8_t prog_int8_t;
+typedef uint8_t prog_uint8_t;
+typedef int16_t prog_int16_t;
+typedef uint16_t prog_uint16_t;
+typedef uint32_t prog_uint32_t;
+
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_byte_near(address) pgm_read_byte(address)
+// Words are read through the type of the pointer rather than as a uint16_t,
+// because the resource manager also uses pgm_read_word to fetch pointers from
+// the resource tables - and those are wider than 16 bits on the host.
+#define pgm_read_word(address) (*(address))
+#define pgm_read_word_near(address) pgm_read_word(address)
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+
+#define memcpy_P memcpy
+#define strncpy_P strncpy
+
+#endif  // HARDWARE_HAL_HOST_AVR_PGMSPACE_H_
@@ -15,15 +15,16 @@
 //
 // -----------------------------------------------------------------------------
 //
-// Fast serial (for the onboard UART), using compile time optimizations.
+// Host (desktop) stand-in for <avr/wdt.h>. There is no watchdog to reset the
+// host.
 
-#include "hardware/hal/serial.h"
-#include "hardware/hal/gpio.h"
+#ifndef HARDWARE_HAL_HOST_AVR_WDT_H_
+#define HARDWARE_HAL_HOST_AVR_WDT_H_
 
-#include <avr/interrupt.h>
+#define WDTO_15MS 0
+#define WDTO_500MS 5
 
-using namespace hardware_hal;
+#define wdt_enable(interval)
+#define wdt_reset()
 
-ISR(USART_RX_vect) {
-  SerialInput<SerialPort0>::Received();
-}
+#endif  // HARDWARE_HAL_HOST_AVR_WDT_H_
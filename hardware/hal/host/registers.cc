@@ -0,0 +1,82 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Storage for the special function registers and EEPROM of the host build.
+
+#include <avr/eeprom.h>
+#include <avr/io.h>
+
+#define HOST_REGISTER(reg) volatile uint8_t reg;
+
+HOST_REGISTER(SREG)
+
+HOST_REGISTER(DDRB)
+HOST_REGISTER(DDRC)
+HOST_REGISTER(DDRD)
+HOST_REGISTER(PINB)
+HOST_REGISTER(PINC)
+HOST_REGISTER(PIND)
+HOST_REGISTER(PORTB)
+HOST_REGISTER(PORTC)
+HOST_REGISTER(PORTD)
+
+HOST_REGISTER(TCCR0A)
+HOST_REGISTER(TCCR0B)
+HOST_REGISTER(TCCR1A)
+HOST_REGISTER(TCCR1B)
+HOST_REGISTER(TCCR2A)
+HOST_REGISTER(TCCR2B)
+HOST_REGISTER(TIMSK0)
+HOST_REGISTER(TIMSK1)
+HOST_REGISTER(TIMSK2)
+HOST_REGISTER(TIFR0)
+HOST_REGISTER(TIFR1)
+HOST_REGISTER(TIFR2)
+HOST_REGISTER(TCNT0)
+HOST_REGISTER(TCNT1)
+HOST_REGISTER(TCNT2)
+HOST_REGISTER(OCR0A)
+HOST_REGISTER(OCR0B)
+HOST_REGISTER(OCR1A)
+HOST_REGISTER(OCR1B)
+HOST_REGISTER(OCR2A)
+HOST_REGISTER(OCR2B)
+
+// The transmitter is always ready on the host.
+volatile uint8_t UBRR0H;
+volatile uint8_t UBRR0L;
+volatile uint8_t UCSR0A = _BV(UDRE0);
+volatile uint8_t UCSR0B;
+volatile uint8_t UDR0;
+
+HOST_REGISTER(ADCSRA)
+HOST_REGISTER(ADCSRB)
+HOST_REGISTER(ADMUX)
+HOST_REGISTER(ADCL)
+HOST_REGISTER(ADCH)
+
+HOST_REGISTER(SPCR)
+HOST_REGISTER(SPSR)
+HOST_REGISTER(SPDR)
+
+HOST_REGISTER(TWBR)
+HOST_REGISTER(TWCR)
+HOST_REGISTER(TWSR)
+HOST_REGISTER(TWDR)
+
+/* extern */
+uint8_t host_eeprom[1024];
@@ -111,6 +111,11 @@ class I2cMaster {
     return error_;
   }
 
+  // Non-blocking alternative to Wait(): the result of a transaction is
+  // available from error() once busy() returns 0.
+  static inline uint8_t busy() { return state_ != I2C_STATE_READY; }
+  static inline uint8_t error() { return error_; }
+
   static uint8_t Send(uint8_t address) {
     // The output buffer is empty, no need to do anything.
     if (!Output::readable()) {
@@ -123,7 +128,7 @@ class I2cMaster {
     }
 
     error_ = I2C_ERROR_NONE;
-    state_ = I2C_STATE_RECEIVING;
+    state_ = I2C_STATE_TRANSMITTING;
     slarw_ = (address << 1) | TW_WRITE;
 
     uint8_t size = Output::readable();
@@ -0,0 +1,59 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// RAM usage monitoring.
+
+#include "hardware/hal/memory_monitor.h"
+
+// Defined by the linker script.
+extern "C" {
+extern uint8_t __data_start;
+extern uint8_t __bss_end;
+}
+
+namespace hardware_hal {
+
+static const uint8_t kStackPaint = 0xc5;
+
+// Room left for the frame of PaintStack() and for an interrupt firing while
+// the area is being painted.
+static const uint8_t kPaintMargin = 32;
+
+/* static */
+uint8_t* MemoryMonitor::painted_end_;
+
+/* static */
+void MemoryMonitor::PaintStack() {
+  uint8_t marker;
+  painted_end_ = &marker - kPaintMargin;
+  for (uint8_t* p = &__bss_end; p < painted_end_; ++p) {
+    *p = kStackPaint;
+  }
+}
+
+/* static */
+void MemoryMonitor::Measure(MemoryUsage* usage) {
+  uint8_t* p = &__bss_end;
+  while (p < painted_end_ && *p == kStackPaint) {
+    ++p;
+  }
+  usage->static_size = &__bss_end - &__data_start;
+  usage->free_size = p - &__bss_end;
+  usage->stack_size = painted_end_ - p;
+}
+
+}  // namespace hardware_hal
@@ -0,0 +1,59 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// RAM usage monitoring, by stack painting. At boot, the free RAM between the
+// end of the static variables and the stack pointer is filled with a pattern.
+// The bytes of the pattern which are still intact later on have never been
+// reached by the stack - nor by the interrupts, which push their registers on
+// the same stack.
+
+#ifndef HARDWARE_HAL_MEMORY_MONITOR_H_
+#define HARDWARE_HAL_MEMORY_MONITOR_H_
+
+#include "hardware/base/base.h"
+
+namespace hardware_hal {
+
+// Dumped as is (little endian) by the SysEx messages reporting RAM usage.
+typedef struct {
+  uint16_t static_size;  // .data and .bss.
+  // Deepest reach of the stack since boot, not counting the part used by the
+  // callers of PaintStack().
+  uint16_t stack_size;
+  uint16_t free_size;  // Bytes never reached by the stack.
+} MemoryUsage;
+
+class MemoryMonitor {
+ public:
+  MemoryMonitor() { }
+
+  // Must be called once, early, from a shallow call chain - the part of the
+  // stack used by the callers is not monitored.
+  static void PaintStack();
+
+  // Scans the painted area, at about 5 cycles per free byte.
+  static void Measure(MemoryUsage* usage);
+
+ private:
+  static uint8_t* painted_end_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryMonitor);
+};
+
+}  // namespace hardware_hal
+
+#endif  // HARDWARE_HAL_MEMORY_MONITOR_H_
@@ -57,6 +57,25 @@ class Buffer : public Input, Output {
     buffer_[write_ptr_] = v;
     write_ptr_ = (write_ptr_ + 1) & (size - 1);
   }
+  // Zero-copy writes. Returns a pointer to the next free element, and stores
+  // in span_size the number of elements which can be written from there
+  // without wrapping around the end of the buffer - at most max. The data
+  // written becomes visible to the reader only after it has been committed.
+  static inline Value* WriteSpan(uint8_t max, uint8_t* span_size) {
+    uint8_t write_ptr = write_ptr_;
+    uint8_t n = writable();
+    if (n > size - write_ptr) {
+      n = size - write_ptr;
+    }
+    if (n > max) {
+      n = max;
+    }
+    *span_size = n;
+    return &buffer_[write_ptr];
+  }
+  static inline void Commit(uint8_t n) {
+    write_ptr_ = (write_ptr_ + n) & (size - 1);
+  }
   static inline uint8_t Requested() { return 0; }
   static inline Value Read() {
     while (!readable());
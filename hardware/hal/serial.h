@@ -40,6 +40,10 @@
 // Flushing a buffer:
 // Serial::InputBuffer::Flush()
 //
+// Monitoring (for buffered input):
+// Serial::num_dropped_bytes()  // Number of bytes received while the input
+//   buffer was full.
+//
 // TODO(pichenettes): Buffered writes not supported for now (should look up
 // the right interrupt handler).
 
@@ -61,6 +65,7 @@ const uint8_t kSerialInputBufferSize = 32;
 template<typename TxEnableBit, typename TxReadyBit,
          typename RxEnableBit, typename RxReadyBit,
          typename RxInterruptBit,
+         typename TxInterruptBit,
          typename PrescalerRegisterH, typename PrescalerRegisterL,
          typename DataRegister,
          uint8_t input_buffer_size_,
@@ -69,6 +74,7 @@ struct SerialPort {
   typedef TxEnableBit Tx;
   typedef RxEnableBit Rx;
   typedef RxInterruptBit RxInterrupt;
+  typedef TxInterruptBit TxInterrupt;
   enum {
     input_buffer_size = input_buffer_size_,
     output_buffer_size = output_buffer_size_
@@ -103,13 +109,26 @@ struct SerialInput : public Input {
   // No check for ready state.
   static inline Value ImmediateRead() { return SerialPort::data(); }
   
-  // Called in data reception interrupt.
-  static inline void Received() {
+  // Called in data reception interrupt. Returns the byte received.
+  static inline Value Received() {
+    Value v = ImmediateRead();
     // This will discard data if the buffer is full.
-    Buffer<SerialInput<SerialPort> >::NonBlockingWrite(ImmediateRead());
+    if (!Buffer<SerialInput<SerialPort> >::NonBlockingWrite(v)) {
+      ++num_dropped_bytes_;
+    }
+    return v;
   }
+
+  static inline uint16_t num_dropped_bytes() { return num_dropped_bytes_; }
+
+ private:
+  static uint16_t num_dropped_bytes_;
 };
 
+/* static */
+template<typename SerialPort>
+uint16_t SerialInput<SerialPort>::num_dropped_bytes_ = 0;
+
 template<typename SerialPort>
 struct SerialOutput : public Output {
   enum {
@@ -142,6 +161,7 @@ struct SerialOutput : public Output {
     if (v >= 0) {
       Overwrite(v);
     }
+    return v;
   }
 };
 
@@ -237,6 +257,10 @@ struct Serial {
     return Impl::IO::NonBlockingRead();
   }
   static inline Value ImmediateRead() { return Impl::IO::ImmediateRead(); }
+  // Only meaningful in buffered input mode.
+  static inline uint16_t num_dropped_bytes() {
+    return SerialInput<SerialPort>::num_dropped_bytes();
+  }
 };
 
 // For other uC with several UARTs (eg Arduino mega), you can declare the other
@@ -253,12 +277,23 @@ typedef SerialPort<
     BitInRegister<UCSR0BRegister, RXEN0>,
     BitInRegister<UCSR0ARegister, RXC0>,
     BitInRegister<UCSR0BRegister, RXCIE0>,
+    BitInRegister<UCSR0BRegister, UDRIE0>,
     UBRR0HRegister,
     UBRR0LRegister,
     UDR0Register,
-    kSerialOutputBufferSize,
-    kSerialInputBufferSize> SerialPort0;
+    kSerialInputBufferSize,
+    kSerialOutputBufferSize> SerialPort0;
+
+// Interrupt raised when the UART is ready to accept the next byte, enabled by
+// SerialPort0::TxInterrupt. The handler is defined by the application, which
+// owns the output queue.
+#define SERIAL_0_TX_READY ISR(USART_UDRE_vect)
+
+// Interrupt raised when a byte has been received, enabled by
+// SerialPort0::RxInterrupt in the BUFFERED input mode. The handler is defined
+// by the application, and must call SerialInput<SerialPort0>::Received().
+#define SERIAL_0_RX_READY ISR(USART_RX_vect)
 
 }  // namespace hardware_hal
 
-#endif HARDWARE_HAL_SERIAL_H_
+#endif  // HARDWARE_HAL_SERIAL_H_
@@ -186,4 +186,4 @@ struct SoftwareSerialOutput {
 
 }  // namespace hardware_hal
 
-#endif HARDWARE_HAL_SOFTWARE_SERIAL_H_
+#endif  // HARDWARE_HAL_SOFTWARE_SERIAL_H_
@@ -113,4 +113,4 @@ class Spi {
 
 }  // namespace hardware_hal
 
-#endif HARDWARE_HAL_SPI_H_
+#endif  // HARDWARE_HAL_SPI_H_
@@ -39,6 +39,9 @@ SpecialFunctionRegister(TCCR2B);
 SpecialFunctionRegister(TIMSK0);
 SpecialFunctionRegister(TIMSK1);
 SpecialFunctionRegister(TIMSK2);
+SpecialFunctionRegister(TIFR0);
+SpecialFunctionRegister(TIFR1);
+SpecialFunctionRegister(TIFR2);
 SpecialFunctionRegister(TCNT0);
 SpecialFunctionRegister(TCNT1);
 SpecialFunctionRegister(TCNT2);
@@ -119,6 +122,7 @@ template<> struct NumberedTimer<0> {
       TIMSK0Register,
       TCNT0Register,
       false> Impl;
+  typedef BitInRegister<TIFR0Register, TOV0> OverflowFlag;
 };
 
 template<> struct NumberedTimer<1> {
@@ -128,6 +132,7 @@ template<> struct NumberedTimer<1> {
       TIMSK1Register,
       TCNT1Register,
       true> Impl;
+  typedef BitInRegister<TIFR1Register, TOV1> OverflowFlag;
 };
 
 template<> struct NumberedTimer<2> {
@@ -137,12 +142,18 @@ template<> struct NumberedTimer<2> {
       TIMSK2Register,
       TCNT2Register,
       true> Impl;
+  typedef BitInRegister<TIFR2Register, TOV2> OverflowFlag;
 };
 
 template<int n>
 struct Timer {
   typedef typename NumberedTimer<n>::Impl Impl;
   static inline uint8_t value() { return Impl::value(); }
+  // 1 if the overflow interrupt is pending (for example, when interrupts are
+  // disabled).
+  static inline uint8_t overflow() {
+    return NumberedTimer<n>::OverflowFlag::value();
+  }
   static inline void Start() { Impl::Start(); }
   static inline void Stop() { Impl::Stop(); }
   static inline void set_mode(TimerMode mode) { Impl::set_mode(mode); }
@@ -194,7 +205,27 @@ typedef TimerImpl<
     true> MutableTimer0;
 
 // Readable aliases for timer interrupts.
+// Output compare A interrupt of timer 0. Timer 0 is left free-running for the
+// real time clock, and OCR0A is moved forward by a fixed period at each match,
+// to derive a second clock from it. This requires the timer to be in normal
+// mode, since OCR0A is double-buffered in the PWM modes.
+struct Timer0CompareClock {
+  static inline void Start(uint8_t period) {
+    MutableTimer0::set_mode(TIMER_NORMAL);
+    *OCR0ARegister::ptr() = *TCNT0Register::ptr() + period;
+    *TIFR0Register::ptr() = _BV(OCF0A);
+    *TIMSK0Register::ptr() |= _BV(OCIE0A);
+  }
+  static inline void Stop() {
+    *TIMSK0Register::ptr() &= ~_BV(OCIE0A);
+  }
+  static inline void Advance(uint8_t period) {
+    *OCR0ARegister::ptr() += period;
+  }
+};
+
 #define TIMER_0_TICK ISR(TIMER0_OVF_vect)
+#define TIMER_0_COMPARE_A_TICK ISR(TIMER0_COMPA_vect)
 #define TIMER_1_TICK ISR(TIMER1_OVF_vect)
 #define TIMER_2_TICK ISR(TIMER2_OVF_vect)
 
@@ -22,6 +22,7 @@
 
 namespace hardware_midi {
   
+const uint8_t kBankSelectMsb = 0x00;
 const uint8_t kModulationWheelMsb = 0x01;
 const uint8_t kDataEntryMsb = 0x06;
 const uint8_t kDataEntryLsb = 0x26;
@@ -75,6 +76,8 @@ class MidiStreamParser {
  public:
   MidiStreamParser();
   uint8_t PushByte(uint8_t byte);
+  // Data bytes of the last message returned by PushByte.
+  inline const uint8_t* data() const { return data_; }
 
  private:
   void MessageReceived(uint8_t status);
@@ -0,0 +1,181 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Soft thru, merging the messages received with the messages generated by the
+// device.
+//
+// Instead of echoing each byte as it is received, the thru forwards the
+// messages once they have been fully decoded by a MidiStreamParser - so the
+// messages generated locally can be inserted between them. Only the SysEx
+// messages are forwarded byte by byte, and the local messages sent in the
+// middle of one are held until its end. The messages received can be filtered
+// by type.
+//
+// Usage:
+//
+// status = parser.PushByte(byte);
+// MidiMerge<Output>::Forward(status, parser.data());
+// ...
+// MidiMerge<Output>::Send(0x90, note, velocity);
+
+#ifndef HARDWARE_MIDI_MIDI_MERGE_H_
+#define HARDWARE_MIDI_MIDI_MERGE_H_
+
+#include "hardware/base/base.h"
+#include "hardware/hal/ring_buffer.h"
+
+namespace hardware_midi {
+
+enum MidiThruFilter {
+  THRU_NOTES = 1,
+  THRU_CONTROLLERS = 2,
+  THRU_PROGRAM_CHANGES = 4,
+  THRU_PRESSURE = 8,
+  THRU_PITCH_BEND = 16,
+  THRU_SYSTEM = 32,
+  THRU_REALTIME = 64,
+  THRU_ALL = 127
+};
+
+template<typename Output>
+class MidiMerge {
+ public:
+  typedef uint8_t Value;
+  // Local messages held during a SysEx.
+  enum {
+    buffer_size = 16,
+    data_size = 8
+  };
+  typedef hardware_hal::Buffer<MidiMerge<Output> > PendingMessages;
+
+  MidiMerge() { }
+
+  static void Init() {
+    filter_ = THRU_ALL;
+    in_sysex_ = 0;
+  }
+
+  static inline void set_filter(uint8_t filter) { filter_ = filter; }
+  static inline uint8_t filter() { return filter_; }
+
+  // Forwards the message completed by the last byte pushed into the parser -
+  // status is the value returned by PushByte.
+  static void Forward(uint8_t status, const uint8_t* data) {
+    if (!status || !(filter_ & Type(status))) {
+      return;
+    }
+    if (status >= 0xf8) {
+      Output::Write(status);
+      return;
+    }
+    if (status == 0xf0) {
+      if (!in_sysex_) {
+        Output::Write(0xf0);
+        in_sysex_ = 1;
+      }
+      Output::Write(data[0]);
+      return;
+    }
+    if (status == 0xf7) {
+      if (in_sysex_) {
+        Output::Write(0xf7);
+        EndSysEx();
+      }
+      return;
+    }
+    // Any other status byte interrupts a SysEx.
+    if (in_sysex_) {
+      EndSysEx();
+    }
+    Output::Write(status);
+    for (uint8_t i = 0; i < DataSize(status); ++i) {
+      Output::Write(data[i]);
+    }
+  }
+
+  // Sends a locally generated channel message.
+  static void Send(uint8_t status, uint8_t data_1, uint8_t data_2) {
+    if (in_sysex_) {
+      if (PendingMessages::writable() >= 3) {
+        PendingMessages::Overwrite(status);
+        PendingMessages::Overwrite(data_1);
+        PendingMessages::Overwrite(data_2);
+      }
+    } else {
+      Output::Send(status, data_1, data_2);
+    }
+  }
+
+ private:
+  static uint8_t Type(uint8_t status) {
+    switch (status & 0xf0) {
+      case 0x80:
+      case 0x90:
+        return THRU_NOTES;
+      case 0xb0:
+        return THRU_CONTROLLERS;
+      case 0xc0:
+        return THRU_PROGRAM_CHANGES;
+      case 0xa0:
+      case 0xd0:
+        return THRU_PRESSURE;
+      case 0xe0:
+        return THRU_PITCH_BEND;
+      default:
+        return status >= 0xf8 ? THRU_REALTIME : THRU_SYSTEM;
+    }
+  }
+
+  // Number of data bytes stored by the parser for each message.
+  static uint8_t DataSize(uint8_t status) {
+    uint8_t hi = status & 0xf0;
+    if (hi == 0xc0 || hi == 0xd0 || status == 0xf3) {
+      return 1;
+    } else if (hi < 0xf0 || status == 0xf1 || status == 0xf2) {
+      return 2;
+    } else {
+      return 0;
+    }
+  }
+
+  static void EndSysEx() {
+    in_sysex_ = 0;
+    while (PendingMessages::readable()) {
+      uint8_t status = PendingMessages::ImmediateRead();
+      uint8_t data_1 = PendingMessages::ImmediateRead();
+      uint8_t data_2 = PendingMessages::ImmediateRead();
+      Output::Send(status, data_1, data_2);
+    }
+  }
+
+  static uint8_t filter_;
+  static uint8_t in_sysex_;
+
+  DISALLOW_COPY_AND_ASSIGN(MidiMerge);
+};
+
+/* static */
+template<typename Output>
+uint8_t MidiMerge<Output>::filter_ = THRU_ALL;
+
+/* static */
+template<typename Output>
+uint8_t MidiMerge<Output>::in_sysex_ = 0;
+
+}  // namespace hardware_midi
+
+#endif  // HARDWARE_MIDI_MIDI_MERGE_H_
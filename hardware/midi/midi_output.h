@@ -0,0 +1,126 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// MIDI output queue, drained by the "data register empty" interrupt of a UART.
+//
+// The bytes written are queued, and sent in the background. Realtime messages
+// (clock, start, stop...) go to a separate queue, which is always emptied
+// first - they can legally be inserted anywhere in the stream, so they never
+// wait behind a long SysEx dump. Status bytes repeating the running status are
+// dropped, which saves a third of the bandwidth on a dense stream of notes or
+// controllers.
+//
+// Write() only blocks when the queue is full. The application must forward
+// the UART interrupt to Requested():
+//
+// SERIAL_0_TX_READY {
+//   MidiOutput<SerialPort0>::Requested();
+// }
+
+#ifndef HARDWARE_MIDI_MIDI_OUTPUT_H_
+#define HARDWARE_MIDI_MIDI_OUTPUT_H_
+
+#include "hardware/base/base.h"
+#include "hardware/hal/ring_buffer.h"
+
+namespace hardware_midi {
+
+template<typename SerialPort>
+class MidiOutput {
+ public:
+  typedef uint8_t Value;
+  enum {
+    buffer_size = 64,
+    data_size = 8
+  };
+
+  struct Realtime {
+    typedef uint8_t Value;
+    enum {
+      buffer_size = 8,
+      data_size = 8
+    };
+  };
+
+  typedef hardware_hal::Buffer<MidiOutput<SerialPort> > Queue;
+  typedef hardware_hal::Buffer<Realtime> RealtimeQueue;
+
+  MidiOutput() { }
+
+  static inline void Write(Value value) {
+    if (value >= 0xf8) {
+      // Realtime messages are dropped rather than blocking when their queue
+      // is full - they would be late anyway.
+      RealtimeQueue::NonBlockingWrite(value);
+    } else {
+      if (value >= 0xf0) {
+        // SysEx and system common messages cancel the running status.
+        running_status_ = 0;
+      } else if (value & 0x80) {
+        if (value == running_status_) {
+          return;
+        }
+        running_status_ = value;
+      }
+      while (!Queue::writable()) { }
+      Queue::Overwrite(value);
+    }
+    SerialPort::TxInterrupt::set();
+  }
+
+  static inline void Send(uint8_t status, uint8_t data_1, uint8_t data_2) {
+    Write(status);
+    Write(data_1);
+    Write(data_2);
+  }
+
+  static inline void Send(uint8_t status, uint8_t data) {
+    Write(status);
+    Write(data);
+  }
+
+  static inline uint8_t writable() { return Queue::writable(); }
+
+  // Number of bytes waiting to be sent.
+  static inline uint8_t readable() {
+    return Queue::readable() + RealtimeQueue::readable();
+  }
+
+  // Called in the data register empty interrupt.
+  static inline void Requested() {
+    if (RealtimeQueue::readable()) {
+      SerialPort::set_data(RealtimeQueue::ImmediateRead());
+    } else if (Queue::readable()) {
+      SerialPort::set_data(Queue::ImmediateRead());
+    } else {
+      SerialPort::TxInterrupt::clear();
+    }
+  }
+
+ private:
+  static uint8_t running_status_;
+
+  DISALLOW_COPY_AND_ASSIGN(MidiOutput);
+};
+
+/* static */
+template<typename SerialPort>
+uint8_t MidiOutput<SerialPort>::running_status_ = 0;
+
+}  // namespace hardware_midi
+
+#endif  // HARDWARE_MIDI_MIDI_OUTPUT_H_
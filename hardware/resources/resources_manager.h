@@ -19,6 +19,11 @@
 // one might not want this functionality and just use the plain program memory
 // read/write function, an alias for a stripped down version without string
 // table lookup is provided (SimpleResourcesManager).
+//
+// The strings can also be packed by the resources compiler as 6-bit character
+// codes (PackedResourcesTables), in which case the string table holds the
+// offset of each string in the packed stream, and LoadStringResource decodes
+// them on the fly.
 
 #ifndef HARDWARE_RESOURCES_RESOURCES_MANAGER_H_
 #define HARDWARE_RESOURCES_RESOURCES_MANAGER_H_
@@ -33,6 +38,23 @@ namespace hardware_resources {
 template<const prog_char** strings, const prog_uint16_t** lookup_tables>
 struct ResourcesTables {
   static inline const prog_char** string_table() { return strings; }
+  static inline const prog_uint16_t* string_offsets() { return NULL; }
+  static inline const prog_uint8_t* string_data() { return NULL; }
+  static inline const prog_uint8_t* string_alphabet() { return NULL; }
+  static inline const prog_uint16_t** lookup_table_table() {
+      return lookup_tables;
+  }
+};
+
+template<const prog_uint16_t* offsets,
+         const prog_uint8_t* data,
+         const prog_uint8_t* alphabet,
+         const prog_uint16_t** lookup_tables>
+struct PackedResourcesTables {
+  static inline const prog_char** string_table() { return NULL; }
+  static inline const prog_uint16_t* string_offsets() { return offsets; }
+  static inline const prog_uint8_t* string_data() { return data; }
+  static inline const prog_uint8_t* string_alphabet() { return alphabet; }
   static inline const prog_uint16_t** lookup_table_table() {
       return lookup_tables;
   }
@@ -40,6 +62,9 @@ struct ResourcesTables {
 
 struct NoResourcesTables {
   static inline const prog_char** string_table() { return NULL; }
+  static inline const prog_uint16_t* string_offsets() { return NULL; }
+  static inline const prog_uint8_t* string_data() { return NULL; }
+  static inline const prog_uint8_t* string_alphabet() { return NULL; }
   static inline const prog_uint16_t** lookup_table_table() { return NULL; }
 };
 
@@ -48,6 +73,13 @@ class ResourcesManager {
  public:
   static inline void LoadStringResource(ResourceId resource, char* buffer,
                                         uint8_t buffer_size) {
+    if (Tables::string_alphabet()) {
+      UnpackString(
+          pgm_read_word(&(Tables::string_offsets()[resource])),
+          buffer,
+          buffer_size);
+      return;
+    }
     if (!Tables::string_table()) {
       return;
     }
@@ -81,9 +113,27 @@ class ResourcesManager {
   }
 
   template<typename T>
-  static void Load(const prog_char* p, uint8_t i, T* destination) {
+  static void Load(const prog_uint8_t* p, uint8_t i, T* destination) {
     memcpy_P(destination, p + i * sizeof(T), sizeof(T));
   }
+
+ private:
+  // Like strncpy_P, pads the buffer with zeros after the end of the string.
+  // Code 0 stands for the terminator, and is also entry 0 of the alphabet.
+  static void UnpackString(uint16_t offset, char* buffer, uint8_t buffer_size) {
+    uint16_t bit = offset * 6;
+    uint8_t code = 0xff;
+    while (buffer_size--) {
+      if (code) {
+        // The 6 bits of a code can straddle two bytes.
+        const prog_uint8_t* p = Tables::string_data() + (bit >> 3);
+        uint16_t word = (pgm_read_byte(p) << 8) | pgm_read_byte(p + 1);
+        code = (word >> (10 - (bit & 7))) & 0x3f;
+        bit += 6;
+      }
+      *buffer++ = pgm_read_byte(Tables::string_alphabet() + code);
+    }
+  }
 };
 
 typedef ResourcesManager<> SimpleResourcesManager;
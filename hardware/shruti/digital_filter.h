@@ -0,0 +1,110 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+//
+// Digital low-pass filter, for the units with a DAC output whose analog filter
+// board is missing or out of order.
+//
+// This is a Chamberlin state variable filter, driven by the same cutoff and
+// resonance modulation destinations as the analog filter. The coefficients are
+// computed at control rate - the cutoff is interpolated between the entries of
+// lut_res_svf_cutoff - and the cutoff coefficient is ramped across the block.
+// The states are kept on 16 bits, for 12-bit samples.
+
+#ifndef HARDWARE_SHRUTI_DIGITAL_FILTER_H_
+#define HARDWARE_SHRUTI_DIGITAL_FILTER_H_
+
+#include "hardware/shruti/shruti.h"
+
+#ifdef HAS_DIGITAL_FILTER
+
+#include "hardware/shruti/resources.h"
+#include "hardware/utils/op.h"
+
+namespace hardware_shruti {
+
+// The damping goes from 2.0 - no resonance - down to about 0.07, in 2.14 fixed
+// point.
+static const uint16_t kFilterMaxDamping = 32768;
+static const uint8_t kFilterDampingStep = 124;
+
+class DigitalFilter {
+ public:
+  DigitalFilter() { }
+
+  void Init() {
+    lowpass_ = 0;
+    bandpass_ = 0;
+    frequency_ = 0;
+    target_frequency_ = 0;
+    damping_ = kFilterMaxDamping;
+  }
+
+  // Called at control rate.
+  void Update(uint8_t cutoff, uint8_t resonance) {
+    uint8_t index = cutoff >> 3;
+    int16_t a = ResourcesManager::Lookup<uint16_t, uint8_t>(
+        lut_res_svf_cutoff, index);
+    int16_t b = ResourcesManager::Lookup<uint16_t, uint8_t>(
+        lut_res_svf_cutoff, index + 1);
+    target_frequency_ = a + (((b - a) * (cutoff & 7)) >> 3);
+    damping_ = kFilterMaxDamping - resonance * kFilterDampingStep;
+  }
+
+  // Filters kAudioBlockSize 12-bit samples in place.
+  void Process(AudioSample* buffer) {
+    int16_t frequency = frequency_;
+    int16_t frequency_increment = (target_frequency_ - frequency) /
+        kAudioBlockSize;
+    int16_t lowpass = lowpass_;
+    int16_t bandpass = bandpass_;
+    for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+      frequency += frequency_increment;
+      int16_t input = static_cast<int16_t>(buffer[i]) - kAudioSilence;
+      lowpass = Saturate(
+          lowpass + (static_cast<int32_t>(bandpass) * frequency >> 14));
+      int32_t highpass = input - lowpass -
+          (static_cast<int32_t>(bandpass) * damping_ >> 14);
+      bandpass = Saturate(bandpass + (highpass * frequency >> 14));
+      buffer[i] = hardware_utils_op::Clip(lowpass, -2048, 2047) + kAudioSilence;
+    }
+    frequency_ = target_frequency_;
+    lowpass_ = lowpass;
+    bandpass_ = bandpass;
+  }
+
+ private:
+  static inline int16_t Saturate(int32_t value) {
+    return value < -32767 ? -32767 : (value > 32767 ? 32767 : value);
+  }
+
+  int16_t lowpass_;
+  int16_t bandpass_;
+  // Cutoff coefficient used for the last sample of the previous block, and
+  // value reached at the end of the next block.
+  int16_t frequency_;
+  int16_t target_frequency_;
+  uint16_t damping_;
+
+  DISALLOW_COPY_AND_ASSIGN(DigitalFilter);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_DIGITAL_FILTER
+
+#endif  // HARDWARE_SHRUTI_DIGITAL_FILTER_H_
@@ -32,7 +32,11 @@ namespace hardware_shruti {
 
 typedef Display<
     Gpio<kPinLcdTx>,
+#ifdef HAS_TIMER0_DISPLAY_CLOCK
+    kDisplayBaudRate,
+#else
     kMainTimerRate,
+#endif  // HAS_TIMER0_DISPLAY_CLOCK
     kDisplayBaudRate,
     kLcdWidth,
     kLcdHeight> SoftwareSerialDisplay;
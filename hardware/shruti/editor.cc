@@ -23,8 +23,11 @@
 #include "hardware/shruti/editor.h"
 #include "hardware/shruti/display.h"
 #include "hardware/shruti/patch_metadata.h"
+#include "hardware/shruti/render_cost.h"
 #include "hardware/shruti/synthesis_engine.h"
+#include "hardware/shruti/undo_journal.h"
 #include "hardware/utils/string.h"
+#include "hardware/hal/memory_monitor.h"
 #include "hardware/hal/watchdog_timer.h"
 
 using namespace hardware_hal;
@@ -45,7 +48,7 @@ static const prog_char arp_groove_template_prefix[5] PROGMEM = {
   's', 'f', 'p', 'l', 'h'  // swing, shuffle, push, lag, human
 };
 
-static const prog_char units_definitions[UNIT_MIDI_CHANNEL + 1]
+static const prog_uint8_t units_definitions[UNIT_MIDI_CHANNEL + 1]
     PROGMEM = {
   0,
   0,
@@ -65,6 +68,14 @@ static const prog_char units_definitions[UNIT_MIDI_CHANNEL + 1]
   0,
 };
 
+#ifdef HAS_RENDER_COST_CALIBRATION
+// Parameters edited by the knobs of the render cost page: shape of osc 1,
+// shape of osc 2, and the operator (on the last two knobs).
+static const prog_uint8_t render_cost_parameters[kNumEditingPots] PROGMEM = {
+  0, 4, 3, 3
+};
+#endif  // HAS_RENDER_COST_CALIBRATION
+
 /* static */
 const UiHandler Editor::ui_handler_[] = {
   { &Editor::DisplayEditSummaryPage, &Editor::DisplayEditDetailsPage,
@@ -73,8 +84,29 @@ const UiHandler Editor::ui_handler_[] = {
     &Editor::HandleStepSequencerInput, &Editor::HandleStepSequencerIncrement },
   { &Editor::DisplayLoadSavePage, &Editor::DisplayLoadSavePage,
     &Editor::HandleLoadSaveInput, &Editor::HandleLoadSaveIncrement },
+#ifdef HAS_RENDER_COST_CALIBRATION
+  { &Editor::DisplayRenderCostPage, &Editor::DisplayRenderCostPage,
+    &Editor::HandleEditInput, &Editor::HandleEditIncrement },
+#endif  // HAS_RENDER_COST_CALIBRATION
+#ifdef HAS_RAM_MONITORING
+  { &Editor::DisplayMemoryPage, &Editor::DisplayMemoryPage,
+    &Editor::HandleEditInput, &Editor::HandleEditIncrement },
+#endif  // HAS_RAM_MONITORING
 };
 
+// The extra pages of the performance group follow the performance page, the
+// last one leading back to it.
+#if defined(HAS_RAM_MONITORING)
+static const ParameterPage kLastPerformancePage = PAGE_MEMORY;
+#elif defined(HAS_RENDER_COST_CALIBRATION)
+static const ParameterPage kLastPerformancePage = PAGE_RENDER_COST;
+#else
+static const ParameterPage kLastPerformancePage = PAGE_PERFORMANCE;
+#endif  // HAS_RAM_MONITORING
+
+#define NEXT_PERFORMANCE_PAGE(page) \
+    ((page) == kLastPerformancePage ? PAGE_PERFORMANCE : (page) + 1)
+
 /* static */
 const PageDefinition Editor::page_definition_[] = {
   { PAGE_OSC_OSC_1, PAGE_OSC_OSC_2, GROUP_OSC,
@@ -101,8 +133,16 @@ const PageDefinition Editor::page_definition_[] = {
     STR_RES_KEYBOARD, PARAMETER_EDITOR, 36 },
   { PAGE_LOAD_SAVE, PAGE_LOAD_SAVE, GROUP_LOAD_SAVE,
     STR_RES_PATCH_BANK, LOAD_SAVE, 0 },
-  { PAGE_PERFORMANCE, PAGE_PERFORMANCE, GROUP_PERFORMANCE,
-    STR_RES_PERFORMANCE, PARAMETER_EDITOR, 0 },
+  { PAGE_PERFORMANCE, NEXT_PERFORMANCE_PAGE(PAGE_PERFORMANCE),
+    GROUP_PERFORMANCE, STR_RES_PERFORMANCE, PARAMETER_EDITOR, 0 },
+#ifdef HAS_RENDER_COST_CALIBRATION
+  { PAGE_RENDER_COST, NEXT_PERFORMANCE_PAGE(PAGE_RENDER_COST),
+    GROUP_PERFORMANCE, STR_RES_RENDER_COST, RENDER_COST, 0 },
+#endif  // HAS_RENDER_COST_CALIBRATION
+#ifdef HAS_RAM_MONITORING
+  { PAGE_MEMORY, NEXT_PERFORMANCE_PAGE(PAGE_MEMORY),
+    GROUP_PERFORMANCE, STR_RES_MEMORY, MEMORY_USAGE, 0 },
+#endif  // HAS_RAM_MONITORING
 };
 
 /* <static> */
@@ -121,6 +161,10 @@ uint8_t Editor::current_knob_;
 uint8_t Editor::last_visited_subpage_ = 0;
 
 char Editor::line_buffer_[kLcdWidth * kLcdHeight + 1];
+uint8_t Editor::cached_layout_ = kNoLayout;
+uint8_t Editor::cached_index_[kNumEditingPots];
+uint8_t Editor::cached_subpage_[kNumEditingPots];
+uint8_t Editor::cached_value_[kNumEditingPots];
 
 uint8_t Editor::cursor_;
 uint8_t Editor::subpage_;
@@ -173,6 +217,15 @@ void Editor::DoShiftFunction(ParameterGroup group, uint8_t hold_time) {
       break;
       
     case GROUP_MOD:
+#ifdef HAS_UNDO_JOURNAL
+      if (hold_time <= 8) {
+        // The redo is on the load/save page, where nothing is journaled.
+        if (current_page_ == PAGE_LOAD_SAVE ? UndoJournal::Redo() :
+            UndoJournal::Undo()) {
+          InvalidateCache();
+        }
+      }
+#endif  // HAS_UNDO_JOURNAL
       if (hold_time > 8 /* 1.5 SECONDS */) {
         if (current_page_ == PAGE_LOAD_SAVE) {
           display.set_status('O');
@@ -182,6 +235,7 @@ void Editor::DoShiftFunction(ParameterGroup group, uint8_t hold_time) {
           engine.AllSoundOff(0);
           test_note_playing_ = 0;
           display.Init();
+          InvalidateCache();
           current_display_type_ = PAGE_TYPE_DETAILS;
           DisplaySummary();
         }
@@ -242,7 +296,7 @@ void Editor::RandomizeParameter(uint8_t subpage, uint8_t parameter_index) {
     value -= range;
   }
   value += parameter.min_value;
-  engine.SetParameter(parameter.id + subpage * 3, value);
+  engine.EditParameter(parameter.id + subpage * 3, value);
 }
 
 /* static */
@@ -306,11 +360,10 @@ void Editor::HandleLoadSaveInput(uint8_t knob_index, uint16_t value) {
   switch (knob_index) {
     case 0:
       {
-        const uint8_t num_patches = kEepromSize / kSerializedPatchSize;
-        uint8_t new_patch = value * num_patches / 1024;
+        uint8_t new_patch = value * kNumPatchSlots / 1024;
         if (new_patch != current_patch_number_ && action_ == ACTION_LOAD) {
           engine.mutable_patch()->EepromLoad(new_patch);
-          engine.TouchPatch();
+          engine.TransitionPatch();
         }
         if (action_ != ACTION_EXIT) {
           current_patch_number_ = new_patch;
@@ -336,7 +389,7 @@ void Editor::HandleLoadSaveInput(uint8_t knob_index, uint16_t value) {
         if (action_ == ACTION_LOAD) {
           current_patch_number_ = previous_patch_number_;
           engine.mutable_patch()->Restore();
-          engine.TouchPatch();
+          engine.TransitionPatch();
         }
         action_ = value >= 960 ? ACTION_SAVE : ACTION_EXIT;
       }
@@ -357,6 +410,7 @@ void Editor::HandleLoadSaveIncrement(int8_t direction) {
 
 /* static */
 void Editor::DisplayLoadSavePage() {
+  InvalidateCache();
   // 0123456789abcdef
   // load/save patch
   // 32 barbpapa save 
@@ -386,6 +440,7 @@ void Editor::DisplayLoadSavePage() {
 
 /* static */
 void Editor::DisplayStepSequencerPage() {
+  InvalidateCache();
   // 0123456789abcdef
   // step sequencer
   // 0000ffff44449999
@@ -436,7 +491,7 @@ void Editor::HandleStepSequencerInput(
           if (cursor_ >= new_size) {
             cursor_ = new_size - 1;
           }
-          engine.SetParameter(PRM_ARP_PATTERN_SIZE, new_size);
+          engine.EditParameter(PRM_ARP_PATTERN_SIZE, new_size);
           current_knob_ = 1;
         }
         break;
@@ -450,30 +505,129 @@ void Editor::HandleStepSequencerIncrement(int8_t direction) {
       engine.patch().sequence_step(cursor_) + (direction << 4));
 }
 
+#ifdef HAS_RENDER_COST_CALIBRATION
+/* static */
+void Editor::DisplayRenderCostPage() {
+  InvalidateCache();
+  // 0123456789abcdef
+  // saw tri 1+2 cpu
+  //  98  61  75 46%
+  const Patch& patch = engine.patch();
+  uint16_t cost[3] = {
+    RenderCost::osc_1(patch.osc_shape[0]),
+    RenderCost::osc_2(patch.osc_shape[1]),
+    RenderCost::mix(patch.osc_option[0])
+  };
+  for (uint8_t i = 0; i < 3; ++i) {
+    PrettyPrintParameterValue(
+        PatchMetadata::parameter_definition(KnobIndexToParameterId(i)),
+        line_buffer_ + i * kColumnWidth,
+        kColumnWidth - 1);
+    line_buffer_[i * kColumnWidth + kColumnWidth - 1] = '\0';
+    AlignRight(line_buffer_ + i * kColumnWidth, kColumnWidth);
+    UnsafeItoa<int16_t>(
+        cost[i],
+        kColumnWidth - 1,
+        line_buffer_ + i * kColumnWidth + kLcdWidth + 1);
+    line_buffer_[i * kColumnWidth + kColumnWidth + kLcdWidth] = '\0';
+    AlignRight(line_buffer_ + i * kColumnWidth + kLcdWidth + 1, kColumnWidth);
+  }
+  ResourcesManager::LoadStringResource(
+      STR_RES_CPU,
+      line_buffer_ + 3 * kColumnWidth,
+      kColumnWidth - 1);
+  line_buffer_[4 * kColumnWidth - 1] = '\0';
+  AlignRight(line_buffer_ + 3 * kColumnWidth, kColumnWidth);
+  UnsafeItoa<int16_t>(
+      RenderCost::load(patch),
+      kColumnWidth - 1,
+      line_buffer_ + 3 * kColumnWidth + kLcdWidth + 1);
+  line_buffer_[4 * kColumnWidth + kLcdWidth] = '\0';
+  AlignRight(line_buffer_ + 3 * kColumnWidth + kLcdWidth + 1, kColumnWidth - 1);
+  line_buffer_[4 * kColumnWidth + kLcdWidth] = '%';
+  display.Print(0, line_buffer_);
+  display.Print(1, line_buffer_ + kLcdWidth + 1);
+}
+#endif  // HAS_RENDER_COST_CALIBRATION
+
+#ifdef HAS_RAM_MONITORING
+static const prog_uint8_t memory_usage_captions[3] PROGMEM = {
+  STR_RES_RAM, STR_RES_STK, STR_RES_MIN
+};
+
+/* static */
+void Editor::DisplayMemoryPage() {
+  InvalidateCache();
+  // 0123456789abcdef
+  //  ram stk min
+  // 1534 158 246
+  hardware_hal::MemoryUsage usage;
+  hardware_hal::MemoryMonitor::Measure(&usage);
+  uint16_t size[3] = {
+    usage.static_size,
+    usage.stack_size,
+    usage.free_size
+  };
+  memset(line_buffer_, ' ', sizeof(line_buffer_));
+  for (uint8_t i = 0; i < 3; ++i) {
+    ResourcesManager::LoadStringResource(
+        ResourcesManager::Lookup<uint8_t, uint8_t>(memory_usage_captions, i),
+        line_buffer_ + i * kColumnWidth,
+        kColumnWidth - 1);
+    line_buffer_[i * kColumnWidth + kColumnWidth - 1] = '\0';
+    AlignRight(line_buffer_ + i * kColumnWidth, kColumnWidth);
+    UnsafeItoa<int16_t>(
+        size[i],
+        kColumnWidth,
+        line_buffer_ + i * kColumnWidth + kLcdWidth + 1);
+    AlignRight(line_buffer_ + i * kColumnWidth + kLcdWidth + 1, kColumnWidth);
+  }
+  line_buffer_[kLcdWidth] = '\0';
+  display.Print(0, line_buffer_);
+  display.Print(1, line_buffer_ + kLcdWidth + 1);
+}
+#endif  // HAS_RAM_MONITORING
+
 /* static */
 void Editor::DisplayEditSummaryPage() {
   // 0123456789abcdef
   // foo bar baz bad
   //  63 127   0   0
+  if (cached_layout_ != current_page_) {
+    cached_layout_ = current_page_;
+    memset(cached_index_, kNoLayout, kNumEditingPots);
+  }
+  uint8_t dirty_lines = 0;
   for (uint8_t i = 0; i < kNumEditingPots; ++i) {
     uint8_t index = KnobIndexToParameterId(i);
+    uint8_t changes = UpdateCell(i, index);
+    if (!changes) {
+      continue;
+    }
     const ParameterDefinition& parameter = PatchMetadata::parameter_definition(
         index);
-    ResourcesManager::LoadStringResource(
-        parameter.short_name,
-        line_buffer_ + i * kColumnWidth,
-        kColumnWidth - 1);
-    line_buffer_[i * kColumnWidth + kColumnWidth - 1] = '\0';
-    AlignRight(line_buffer_ + i * kColumnWidth, kColumnWidth);
+    if (changes & CELL_CAPTION) {
+      ResourcesManager::LoadStringResource(
+          parameter.short_name,
+          line_buffer_ + i * kColumnWidth,
+          kColumnWidth - 1);
+      line_buffer_[i * kColumnWidth + kColumnWidth - 1] = '\0';
+      AlignRight(line_buffer_ + i * kColumnWidth, kColumnWidth);
+    }
     PrettyPrintParameterValue(
         parameter,
         line_buffer_ + i * kColumnWidth + kLcdWidth + 1,
         kColumnWidth - 1);
     line_buffer_[i * kColumnWidth + kColumnWidth + kLcdWidth] = '\0';
     AlignRight(line_buffer_ + i * kColumnWidth + kLcdWidth + 1, kColumnWidth);
+    dirty_lines |= changes;
+  }
+  if (dirty_lines & CELL_CAPTION) {
+    display.Print(0, line_buffer_);
+  }
+  if (dirty_lines) {
+    display.Print(1, line_buffer_ + kLcdWidth + 1);
   }
-  display.Print(0, line_buffer_);
-  display.Print(1, line_buffer_ + kLcdWidth + 1);
 }
 
 /* static */
@@ -486,49 +640,67 @@ void Editor::DisplayEditDetailsPage() {
   //
   // mod src>dst
   // amount        63
+  //
+  // Both lines are formatted in the first half of the line buffer, so the
+  // second one has to be formatted again whenever the first one is printed.
+  uint8_t header_changed = 0;
+  if (cached_layout_ != (current_page_ | kDetailsLayout)) {
+    cached_layout_ = current_page_ | kDetailsLayout;
+    memset(cached_index_, kNoLayout, kNumEditingPots);
+    header_changed = 1;
+  }
+  const PageDefinition& page = page_definition_[current_page_];
   if (current_page_ == PAGE_MOD_MATRIX) {
-    const ParameterDefinition& current_source = (
-        PatchMetadata::parameter_definition(
-            page_definition_[PAGE_MOD_MATRIX].first_parameter_index + 1));
-    PrettyPrintParameterValue(
-        current_source,
-        line_buffer_ + 4,
-        kColumnWidth - 1);
-    const ParameterDefinition& current_destination = (
-        PatchMetadata::parameter_definition(
-            page_definition_[PAGE_MOD_MATRIX].first_parameter_index + 2));
-    PrettyPrintParameterValue(
-        current_destination,
-        line_buffer_ + kColumnWidth + 4,
-        kColumnWidth);
-    line_buffer_[0] = 'm';
-    line_buffer_[1] = 'o';
-    line_buffer_[2] = 'd';
-    line_buffer_[3] = ' ';
-    line_buffer_[kColumnWidth + 3] = '>';
-    AlignLeft(line_buffer_ + kColumnWidth + 4, kLcdWidth - kColumnWidth - 4);
+    header_changed |= UpdateCell(1, page.first_parameter_index + 1);
+    header_changed |= UpdateCell(2, page.first_parameter_index + 2);
+  }
+  if (header_changed) {
+    if (current_page_ == PAGE_MOD_MATRIX) {
+      const ParameterDefinition& current_source = (
+          PatchMetadata::parameter_definition(
+              page.first_parameter_index + 1));
+      PrettyPrintParameterValue(
+          current_source,
+          line_buffer_ + 4,
+          kColumnWidth - 1);
+      const ParameterDefinition& current_destination = (
+          PatchMetadata::parameter_definition(
+              page.first_parameter_index + 2));
+      PrettyPrintParameterValue(
+          current_destination,
+          line_buffer_ + kColumnWidth + 4,
+          kColumnWidth);
+      line_buffer_[0] = 'm';
+      line_buffer_[1] = 'o';
+      line_buffer_[2] = 'd';
+      line_buffer_[3] = ' ';
+      line_buffer_[kColumnWidth + 3] = '>';
+      AlignLeft(line_buffer_ + kColumnWidth + 4, kLcdWidth - kColumnWidth - 4);
+    } else {
+      ResourcesManager::LoadStringResource(
+          page.name,
+          line_buffer_,
+          kLcdWidth);
+      AlignLeft(line_buffer_, kLcdWidth);
+    }
     display.Print(0, line_buffer_);
+    cached_index_[0] = kNoLayout;
   }
+  
   uint8_t index = KnobIndexToParameterId(current_knob_);
+  uint8_t changes = UpdateCell(0, index);
+  if (!changes) {
+    return;
+  }
   const ParameterDefinition& parameter = PatchMetadata::parameter_definition(
       index);
-  const PageDefinition& page = page_definition_[current_page_];
-
-  if (current_page_ != PAGE_MOD_MATRIX) {
+  if (changes & CELL_CAPTION) {
     ResourcesManager::LoadStringResource(
-        page.name,
+        parameter.long_name,
         line_buffer_,
-        kLcdWidth);
-    AlignLeft(line_buffer_, kLcdWidth);
-    display.Print(0, line_buffer_);
+        kCaptionWidth);
+    AlignLeft(line_buffer_, kCaptionWidth);
   }
-  
-  ResourcesManager::LoadStringResource(
-      parameter.long_name,
-      line_buffer_,
-      kCaptionWidth);
-  AlignLeft(line_buffer_, kCaptionWidth);
-  
   PrettyPrintParameterValue(
       parameter,
       line_buffer_ + kCaptionWidth,
@@ -537,11 +709,34 @@ void Editor::DisplayEditDetailsPage() {
   display.Print(1, line_buffer_);
 }
 
+/* static */
+uint8_t Editor::UpdateCell(uint8_t cell, uint8_t index) {
+  uint8_t changes = 0;
+  if (cached_index_[cell] != index || cached_subpage_[cell] != subpage_) {
+    cached_index_[cell] = index;
+    cached_subpage_[cell] = subpage_;
+    changes = CELL_CAPTION | CELL_VALUE;
+  }
+  uint8_t value = GetParameterValue(
+      PatchMetadata::parameter_definition(index).id);
+  if (value != cached_value_[cell]) {
+    cached_value_[cell] = value;
+    changes |= CELL_VALUE;
+  }
+  return changes;
+}
+
 /* static */
 uint8_t Editor::KnobIndexToParameterId(uint8_t knob_index) {
   if (current_page_ == PAGE_PERFORMANCE) {
     subpage_ = assigned_parameters_[knob_index].subpage;
     return assigned_parameters_[knob_index].id;
+#ifdef HAS_RENDER_COST_CALIBRATION
+  } else if (current_page_ == PAGE_RENDER_COST) {
+    return ResourcesManager::Lookup<uint8_t, uint8_t>(
+        render_cost_parameters,
+        knob_index);
+#endif  // HAS_RENDER_COST_CALIBRATION
   } else {
     return page_definition_[current_page_].first_parameter_index + \
         knob_index;
@@ -595,7 +790,10 @@ void Editor::SetParameterValue(uint8_t id, uint8_t value) {
     subpage_ = value;
     last_visited_subpage_ = value;
   } else {
-    engine.SetParameter(id + subpage_ * 3, value);
+    engine.EditParameter(id + subpage_ * 3, value);
+#ifdef HAS_MOTION_SEQUENCER
+    engine.RecordAutomation(id + subpage_ * 3, value);
+#endif  // HAS_MOTION_SEQUENCER
   }
 }
 
@@ -612,6 +810,7 @@ uint8_t Editor::GetParameterValue(uint8_t id) {
 
 /* static */
 void Editor::DisplaySplashScreen(ResourceId first_line) {
+  InvalidateCache();
   // 0123456789abcdef
   // mutable 
   // instruments sh-1
@@ -57,6 +57,12 @@ enum Page {
   PAGE_PLAY_KBD,
   PAGE_LOAD_SAVE,
   PAGE_PERFORMANCE,
+#ifdef HAS_RENDER_COST_CALIBRATION
+  PAGE_RENDER_COST,
+#endif  // HAS_RENDER_COST_CALIBRATION
+#ifdef HAS_RAM_MONITORING
+  PAGE_MEMORY,
+#endif  // HAS_RAM_MONITORING
 };
 
 enum Action {
@@ -77,10 +83,27 @@ static const uint8_t kCaptionWidth = 10;
 static const uint8_t kValueWidth = 6;
 static const uint8_t kColumnWidth = 4;
 
+// Value of cached_layout_ when the content of the line buffer does not belong
+// to an editor page, and has to be formatted again.
+static const uint8_t kNoLayout = 0xff;
+static const uint8_t kDetailsLayout = 0x80;
+
+// Parts of a cell which have changed since it was last formatted.
+enum CellChange {
+  CELL_VALUE = 1,
+  CELL_CAPTION = 2
+};
+
 enum PageUiType {
   PARAMETER_EDITOR = 0,
   STEP_SEQUENCER = 1,
   LOAD_SAVE = 2,
+#ifdef HAS_RENDER_COST_CALIBRATION
+  RENDER_COST = 3,
+#endif  // HAS_RENDER_COST_CALIBRATION
+#ifdef HAS_RAM_MONITORING
+  MEMORY_USAGE,
+#endif  // HAS_RAM_MONITORING
 };
 
 typedef uint8_t UiType;
@@ -159,6 +182,11 @@ class Editor {
   // Returns the parameter id of the parameter that should be edited when
   // touching knob #knob_index.
   static uint8_t KnobIndexToParameterId(uint8_t knob_index);
+  // Compares the parameter and value displayed in a cell of the editor pages
+  // with the cached ones, updates the cache, and returns a combination of
+  // CellChange flags.
+  static uint8_t UpdateCell(uint8_t cell, uint8_t index);
+  static inline void InvalidateCache() { cached_layout_ = kNoLayout; }
   
   static void DisplayLoadSavePage();
   static void HandleLoadSaveInput(uint8_t knob_index, uint16_t value);
@@ -170,6 +198,13 @@ class Editor {
   static void HandleStepSequencerInput(uint8_t knob_index, uint16_t value);
   static void HandleStepSequencerIncrement(int8_t direction);
   
+#ifdef HAS_RENDER_COST_CALIBRATION
+  static void DisplayRenderCostPage();
+#endif  // HAS_RENDER_COST_CALIBRATION
+#ifdef HAS_RAM_MONITORING
+  static void DisplayMemoryPage();
+#endif  // HAS_RAM_MONITORING
+
   static void RandomizeParameter(uint8_t subpage, uint8_t parameter_index);
   static void RandomizePatch();
 
@@ -188,6 +223,14 @@ class Editor {
   static uint8_t current_knob_;
 
   static char line_buffer_[kLcdWidth * kLcdHeight + 1];
+  // The text of the editor pages is kept in the line buffer from one call to
+  // the next, and only the cells whose parameter or value has changed are
+  // formatted and printed again. This records which page the line buffer
+  // holds, and the parameter index, subpage and value shown in each cell.
+  static uint8_t cached_layout_;
+  static uint8_t cached_index_[kNumEditingPots];
+  static uint8_t cached_subpage_[kNumEditingPots];
+  static uint8_t cached_value_[kNumEditingPots];
 
   // Load/Save related stuff. Cursor is also used for the step sequencer step.
   static uint8_t cursor_;
@@ -0,0 +1,93 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Background EEPROM writer.
+
+#include "hardware/shruti/eeprom_writer.h"
+
+#include <avr/eeprom.h>
+
+#include "hardware/hal/ring_buffer.h"
+
+using hardware_hal::Buffer;
+
+namespace hardware_shruti {
+
+typedef Buffer<EepromWriter> WriteQueue;
+
+/* static */
+uint16_t EepromWriter::address_;
+
+/* static */
+uint8_t EepromWriter::Seek(uint16_t address) {
+  if (!WriteQueue::readable()) {
+    address_ = address;
+    return 1;
+  }
+  return address == address_ + WriteQueue::readable();
+}
+
+/* static */
+void EepromWriter::Write(uint16_t address, const uint8_t* data, uint8_t size) {
+  if (address != address_ + WriteQueue::readable()) {
+    Flush();
+    address_ = address;
+  }
+  while (size--) {
+    // Nothing else drains the queue while we are waiting here.
+    while (!WriteQueue::writable()) {
+      eeprom_busy_wait();
+      Tick();
+    }
+    WriteQueue::Overwrite(*data++);
+  }
+}
+
+/* static */
+uint8_t* EepromWriter::WriteSpan(uint8_t max, uint8_t* span_size) {
+  return WriteQueue::WriteSpan(max, span_size);
+}
+
+/* static */
+void EepromWriter::Commit(uint8_t size) {
+  WriteQueue::Commit(size);
+}
+
+/* static */
+void EepromWriter::Tick() {
+  if (WriteQueue::readable() && eeprom_is_ready()) {
+    eeprom_write_byte(
+        (uint8_t*)(uintptr_t)(address_),
+        WriteQueue::ImmediateRead());
+    ++address_;
+  }
+}
+
+/* static */
+void EepromWriter::Flush() {
+  while (WriteQueue::readable()) {
+    eeprom_busy_wait();
+    Tick();
+  }
+}
+
+/* static */
+uint8_t EepromWriter::busy() {
+  return WriteQueue::readable() != 0;
+}
+
+}  // namespace hardware_shruti
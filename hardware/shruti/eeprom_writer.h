@@ -0,0 +1,80 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Background EEPROM writer.
+//
+// Writing a byte to the EEPROM takes 3.3ms, during which eeprom_write_byte
+// busy-waits. Instead, the data is queued in a ring buffer, and Tick() - called
+// from a low priority task - writes one byte only when the EEPROM is ready.
+// The queued bytes are written at consecutive addresses, starting from the
+// address given to Seek(). Saving a patch thus returns immediately, and busy()
+// tells when it has actually been written.
+//
+// Data can be written directly into the queue with WriteSpan(), and is written
+// to the EEPROM only once committed - this allows a patch received by SysEx to
+// be validated before it is written.
+
+#ifndef HARDWARE_SHRUTI_EEPROM_WRITER_H_
+#define HARDWARE_SHRUTI_EEPROM_WRITER_H_
+
+#include "hardware/base/base.h"
+
+namespace hardware_shruti {
+
+class EepromWriter {
+ public:
+  typedef uint8_t Value;
+  // Room for one patch, and all but one byte of the next one.
+  enum {
+    buffer_size = 128,
+    data_size = 8
+  };
+
+  EepromWriter() { }
+
+  // Sets the address at which the next queued byte will be written. Returns 0
+  // if the queue is busy with bytes which are not written just before it.
+  static uint8_t Seek(uint16_t address);
+
+  // Queues a block of data. Blocks only if the queue is still busy with
+  // a previous, non-contiguous, write, or full.
+  static void Write(uint16_t address, const uint8_t* data, uint8_t size);
+
+  // Returns a pointer to a contiguous block of free space in the queue, and
+  // its size - at most max.
+  static uint8_t* WriteSpan(uint8_t max, uint8_t* span_size);
+  static void Commit(uint8_t size);
+
+  // Writes the next byte in the queue, if the EEPROM is ready.
+  static void Tick();
+
+  // Waits until all the queued bytes have been written - to be called before
+  // reading back from the EEPROM.
+  static void Flush();
+
+  // Returns 1 while bytes are waiting to be written.
+  static uint8_t busy();
+
+ private:
+  static uint16_t address_;
+
+  DISALLOW_COPY_AND_ASSIGN(EepromWriter);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HARDWARE_SHRUTI_EEPROM_WRITER_H_
@@ -33,6 +33,13 @@ void Envelope::Trigger(uint8_t stage) {
     return;
   }
   stage_ = stage;
+#ifdef HAS_CURVED_ENVELOPES
+  // The duration of a stage does not depend on its starting point, so the
+  // release needs no special treatment.
+  phase_ = 0;
+  start_ = value_;
+  increment_ = stage_increment_[stage];
+#else
   // The note might be released at any moment, so we need to figure out
   // the right slope to make it reach 0 within the release time.
   if (stage == RELEASE) {
@@ -43,21 +50,58 @@ void Envelope::Trigger(uint8_t stage) {
   } else {
     increment_ = stage_increment_[stage];
   }
+#endif  // HAS_CURVED_ENVELOPES
   target_ = stage_target_[stage];
 }
 
 void Envelope::Update(
   uint8_t attack, uint8_t decay, uint8_t sustain, uint8_t release) {
   // Update the envelope increments and targets.
+  UpdateAttack(attack);
+  UpdateDecay(decay, sustain);
+  UpdateRelease(release);
+}
+
+#ifdef HAS_CURVED_ENVELOPES
+
+void Envelope::UpdateAttack(uint8_t attack) {
+  stage_increment_[ATTACK] = PhaseIncrement(attack);
+}
+
+void Envelope::UpdateDecay(uint8_t decay, uint8_t sustain) {
+  stage_increment_[DECAY] = PhaseIncrement(decay);
+  stage_target_[DECAY] = static_cast<int16_t>(sustain) << 7;
+}
+
+void Envelope::UpdateRelease(uint8_t release) {
+  release_ = release;
+  stage_increment_[RELEASE] = PhaseIncrement(release);
+}
+
+/* static */
+uint16_t Envelope::PhaseIncrement(uint8_t time) {
+  // The table gives the increment for a linear segment covering half of the
+  // phase range in the same time.
+  return ResourcesManager::Lookup<uint16_t, uint8_t>(
+      lut_res_env_portamento_increments, time) << 1;
+}
+
+#else
+
+void Envelope::UpdateAttack(uint8_t attack) {
   stage_increment_[ATTACK] = ScaleEnvelopeIncrement(
       attack, 127);
+}
+
+void Envelope::UpdateDecay(uint8_t decay, uint8_t sustain) {
   stage_increment_[DECAY] = -ScaleEnvelopeIncrement(
       decay,
       127 - sustain);
   stage_target_[DECAY] = static_cast<int16_t>(sustain) << 7;
-  release_ = release;
 }
 
+#endif  // HAS_CURVED_ENVELOPES
+
 /* static */
 uint16_t Envelope::ScaleEnvelopeIncrement(uint8_t time, uint8_t scale) {
   uint16_t increment = ResourcesManager::Lookup<uint16_t, uint8_t>(
@@ -24,6 +24,7 @@
 #include "hardware/shruti/shruti.h"
 
 #include "hardware/shruti/patch.h"
+#include "hardware/shruti/resources.h"
 #include "hardware/utils/op.h"
 
 using namespace hardware_utils_op;
@@ -55,6 +56,35 @@ class Envelope {
 
   void Update(uint8_t attack, uint8_t decay, uint8_t sustain, uint8_t release);
 
+  // Update the parameters of a single stage.
+  void UpdateAttack(uint8_t attack);
+  void UpdateDecay(uint8_t decay, uint8_t sustain);
+#ifdef HAS_CURVED_ENVELOPES
+  void UpdateRelease(uint8_t release);
+#else
+  void UpdateRelease(uint8_t release) { release_ = release; }
+#endif  // HAS_CURVED_ENVELOPES
+
+#ifdef HAS_CURVED_ENVELOPES
+  // The phase goes linearly from 0 to 65535 during a stage, and indexes a
+  // table with the fraction of the distance to the target covered at this
+  // point. The stage ends when the phase wraps.
+  void Render() {
+    uint16_t phase = phase_ + increment_;
+    if (phase < phase_) {
+      value_ = target_;
+      ++stage_;
+      Trigger(stage_);
+    } else {
+      phase_ = phase;
+      uint8_t covered = ResourcesManager::Lookup<uint8_t, uint8_t>(
+          stage_ == ATTACK ? wav_res_env_attack_curve : wav_res_env_decay_curve,
+          phase >> 8);
+      value_ = start_ + (
+          static_cast<int32_t>(target_ - start_) * covered >> 8);
+    }
+  }
+#else
   void Render() {
     value_ += increment_;
     // This code makes the assumption that only the ATTACK stage has a positive
@@ -64,26 +94,38 @@ class Envelope {
     // if ((increment_ > 0) ^ (value_ < target_)) {
     //
     // but the first test is more expensive on AVR...
-    // TODO(pichenettes): to get a more exponential feel, divide the increment
-    // by 2 mid-stage.
     if ((stage_ == ATTACK) ^ (value_ < target_)) {
       value_ = target_;
       ++stage_;
       Trigger(stage_);
     }
   }
+#endif  // HAS_CURVED_ENVELOPES
 
  private:
   uint8_t release_;  // release time.
   uint8_t stage_;  // current envelope stage.
-  int16_t increment_;  // envelope value increment.
   int16_t target_;  // target value (moves to next stage once reached).
   int16_t value_;  // envelope value, 0-16384.
+#ifdef HAS_CURVED_ENVELOPES
+  uint16_t increment_;  // phase increment.
+  uint16_t phase_;  // position in the current stage.
+  int16_t start_;  // envelope value at the beginning of the current stage.
+  // Phase increment and target for each stage of the envelope. The padding is
+  // not needed, and the size of the object is still 32 bytes.
+  uint16_t stage_increment_[DEAD + 1];
+  int16_t stage_target_[DEAD + 1];
+#else
+  int16_t increment_;  // envelope value increment.
   // Increment and target for each stage of the envelope.
   int16_t stage_increment_[UNKNOWN + 1];
   int16_t stage_target_[UNKNOWN + 1];
+#endif  // HAS_CURVED_ENVELOPES
    
   static uint16_t ScaleEnvelopeIncrement(uint8_t time, uint8_t scale);
+#ifdef HAS_CURVED_ENVELOPES
+  static uint16_t PhaseIncrement(uint8_t time);
+#endif  // HAS_CURVED_ENVELOPES
   
   DISALLOW_COPY_AND_ASSIGN(Envelope);
 };
@@ -0,0 +1,75 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Audio underrun log.
+
+#include "hardware/shruti/glitch_log.h"
+
+#ifdef HAS_GLITCH_LOG
+
+#include <string.h>
+
+#include "hardware/hal/time.h"
+#include "hardware/shruti/editor.h"
+#include "hardware/shruti/synthesis_engine.h"
+
+using hardware_hal::milliseconds;
+
+namespace hardware_shruti {
+
+/* <static> */
+GlitchReport GlitchLog::report_;
+volatile uint8_t GlitchLog::task_ = kNoCurrentTask;
+uint8_t GlitchLog::in_burst_;
+/* </static> */
+
+/* static */
+void GlitchLog::Init() {
+  memset(&report_, 0, sizeof(report_));
+  report_.low_water_mark = 0xff;
+  in_burst_ = 0;
+}
+
+/* static */
+void GlitchLog::Underrun() {
+  GlitchRecord* record;
+  if (in_burst_) {
+    record = &report_.records[(report_.num_bursts - 1) % kNumGlitchRecords];
+    if (record->num_missed_samples != 0xff) {
+      ++record->num_missed_samples;
+    }
+    return;
+  }
+  in_burst_ = 1;
+  report_.low_water_mark = 0;
+  uint8_t task = task_;
+  if (report_.histogram[task] != 0xffff) {
+    ++report_.histogram[task];
+  }
+  record = &report_.records[report_.num_bursts % kNumGlitchRecords];
+  ++report_.num_bursts;
+  record->time = milliseconds();
+  record->task = task;
+  record->page = Editor::current_page();
+  record->osc_shape[0] = engine.patch().osc_shape[0];
+  record->osc_shape[1] = engine.patch().osc_shape[1];
+  record->num_missed_samples = 1;
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_GLITCH_LOG
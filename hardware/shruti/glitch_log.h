@@ -0,0 +1,100 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Log of the audio buffer underruns, kept by the audio interrupt and sent as a
+// SysEx message on request.
+//
+// The underruns are grouped in bursts of consecutive missed samples. For each
+// burst, the log records when it started, which task of the scheduler was
+// running, which page of the editor was shown and the shapes of the two
+// oscillators - enough to trace a glitch to the patch or the UI action behind
+// it. Only the last kNumGlitchRecords bursts are kept, but a histogram counts
+// the bursts started during each task since boot. The log also keeps the
+// smallest number of samples ever found in the buffer by the interrupt.
+
+#ifndef HARDWARE_SHRUTI_GLITCH_LOG_H_
+#define HARDWARE_SHRUTI_GLITCH_LOG_H_
+
+#include "hardware/shruti/shruti.h"
+
+#ifdef HAS_GLITCH_LOG
+
+namespace hardware_shruti {
+
+static const uint8_t kNumGlitchRecords = 8;
+
+// Recorded in place of the task index when the underrun occurred while the
+// scheduler was choosing the next task.
+static const uint8_t kNoCurrentTask = kSchedulerMaxNumTasks;
+
+// Dumped as is (little endian) by the glitch log SysEx message.
+typedef struct {
+  uint32_t time;  // In milliseconds since boot.
+  uint8_t task;
+  uint8_t page;
+  uint8_t osc_shape[2];
+  uint8_t num_missed_samples;  // Saturates at 255.
+} GlitchRecord;
+
+typedef struct {
+  uint8_t low_water_mark;
+  // Total number of bursts. The last one is in records[(num_bursts - 1) %
+  // kNumGlitchRecords].
+  uint16_t num_bursts;
+  uint16_t histogram[kSchedulerMaxNumTasks + 1];
+  GlitchRecord records[kNumGlitchRecords];
+} GlitchReport;
+
+class GlitchLog {
+ public:
+  GlitchLog() { }
+
+  // Clears the log - for example once the calibration of the render costs,
+  // which starves the audio buffer, is done.
+  static void Init();
+
+  // Called by the scheduler, through its Profiler policy, around each task.
+  static inline void TaskStarted(uint8_t task) { task_ = task; }
+  static inline void TaskEnded(uint8_t task) { task_ = kNoCurrentTask; }
+
+  // Called by the audio interrupt, through the Monitor policy of AudioOutput.
+  static inline void SampleEmitted(uint8_t level) {
+    if (level < report_.low_water_mark) {
+      report_.low_water_mark = level;
+    }
+    in_burst_ = 0;
+  }
+  static void Underrun();
+
+  // The report is read while the audio interrupt is running, so an underrun
+  // during the transfer may leave it torn. A second request is then needed.
+  static inline const GlitchReport* report() { return &report_; }
+  static inline uint8_t size() { return sizeof(report_); }
+
+ private:
+  static GlitchReport report_;
+  static volatile uint8_t task_;
+  static uint8_t in_burst_;
+
+  DISALLOW_COPY_AND_ASSIGN(GlitchLog);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_GLITCH_LOG
+
+#endif  // HARDWARE_SHRUTI_GLITCH_LOG_H_
@@ -0,0 +1,145 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Microbenchmark of the fixed point routines of hardware/utils/op.h, for the
+// desktop build. Each routine is called in a chain - the result of a call is
+// mixed into the arguments of the next - so that the calls cannot be
+// vectorized or combined, and the latency of a call is measured, as it would
+// be on a sample of the audio rendering. The cost of the loop itself is
+// measured with an empty routine and subtracted.
+//
+// The desktop build uses the portable C++ versions of the routines. The
+// numbers are host numbers - they are only meaningful when compared with each
+// other, or with those of a previous revision built on the same machine.
+//
+// usage:
+//   op_benchmark [number of rounds]
+
+// System headers must be included before base.h, which defines abs().
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hardware/utils/op.h"
+
+using namespace hardware_utils_op;
+
+static const uint16_t kNumInputs = 256;
+
+#if defined(__i386__) || defined(__x86_64__)
+
+static inline uint64_t ReadCycleCounter() {
+  return __builtin_ia32_rdtsc();
+}
+
+#else
+
+static inline uint64_t ReadCycleCounter() {
+  return 0;
+}
+
+#endif  // __i386__ || __x86_64__
+
+static uint8_t input_a[kNumInputs];
+static uint8_t input_b[kNumInputs];
+static uint8_t input_c[kNumInputs];
+
+// Each routine is wrapped in a struct, so that the call can be inlined in the
+// measurement loop.
+#define OP(name, expression) \
+  struct name##Op { \
+    static inline uint8_t Apply(uint8_t a, uint8_t b, uint8_t c) { \
+      return expression; \
+    } \
+  };
+
+OP(Empty, a)
+OP(Clip8, Clip8((int16_t(a) - 128) * 2 + c))
+OP(SignedClip8, SignedClip8((int16_t(a) - 128) * 2 + c))
+OP(Mix, Mix(a, b, c))
+OP(UnscaledMix, UnscaledMix(a, b, c) >> 8)
+OP(Mix4, Mix4(a, b, c & 0x0f))
+OP(UnscaledMix4, UnscaledMix4(a, b, c & 0x0f) >> 4)
+OP(ShiftLeft4, ShiftLeft4(a))
+OP(ShiftRight4, ShiftRight4(a))
+OP(Swap4, Swap4(a))
+OP(MulScale8, MulScale8(a, b))
+OP(SignedMulScale8, SignedMulScale8(a, b))
+OP(SignedUnsignedMul, SignedUnsignedMul(a, b) >> 4)
+OP(UnsignedUnsignedMul, UnsignedUnsignedMul(a, b) >> 4)
+OP(SignedSignedMulScale8, SignedSignedMulScale8(a, b))
+OP(Mul16Scale8, Mul16Scale8((a << 8) | c, b << 8) >> 8)
+OP(ShiftRight6, ShiftRight6((a << 8) | c))
+
+#undef OP
+
+static double empty_cost = 0.0;
+
+template<typename Op>
+static double Measure(uint32_t num_rounds, uint8_t* checksum) {
+  uint8_t x = *checksum;
+  uint64_t start = ReadCycleCounter();
+  for (uint32_t round = 0; round < num_rounds; ++round) {
+    for (uint16_t i = 0; i < kNumInputs; ++i) {
+      x = Op::Apply(x ^ input_a[i], input_b[i], input_c[i]);
+      // Prevents the compiler from combining the calls of the chain.
+      asm volatile("" : "+r" (x));
+    }
+  }
+  uint64_t cycles = ReadCycleCounter() - start;
+  *checksum = x;
+  return double(cycles) / (double(num_rounds) * kNumInputs);
+}
+
+template<typename Op>
+static void Report(const char* name, uint32_t num_rounds) {
+  uint8_t checksum = 0;
+  double cost = Measure<Op>(num_rounds, &checksum) - empty_cost;
+  printf("%s\t%.2f\t%02x\n", name, cost > 0.0 ? cost : 0.0, checksum);
+}
+
+int main(int argc, char** argv) {
+  uint32_t num_rounds = argc >= 2 ? atoi(argv[1]) : 100000;
+  uint32_t state = 0x21;
+  for (uint16_t i = 0; i < kNumInputs; ++i) {
+    state = state * 1664525 + 1013904223;
+    input_a[i] = state >> 24;
+    input_b[i] = state >> 16;
+    input_c[i] = state >> 8;
+  }
+
+  uint8_t checksum = 0;
+  empty_cost = Measure<EmptyOp>(num_rounds, &checksum);
+  printf("op\tcycles/call\tchecksum\n");
+  printf("(loop)\t%.2f\t%02x\n", empty_cost, checksum);
+  Report<Clip8Op>("Clip8", num_rounds);
+  Report<SignedClip8Op>("SignedClip8", num_rounds);
+  Report<MixOp>("Mix", num_rounds);
+  Report<UnscaledMixOp>("UnscaledMix", num_rounds);
+  Report<Mix4Op>("Mix4", num_rounds);
+  Report<UnscaledMix4Op>("UnscaledMix4", num_rounds);
+  Report<ShiftLeft4Op>("ShiftLeft4", num_rounds);
+  Report<ShiftRight4Op>("ShiftRight4", num_rounds);
+  Report<Swap4Op>("Swap4", num_rounds);
+  Report<MulScale8Op>("MulScale8", num_rounds);
+  Report<SignedMulScale8Op>("SignedMulScale8", num_rounds);
+  Report<SignedUnsignedMulOp>("SignedUnsignedMul", num_rounds);
+  Report<UnsignedUnsignedMulOp>("UnsignedUnsignedMul", num_rounds);
+  Report<SignedSignedMulScale8Op>("SignedSignedMulScale8", num_rounds);
+  Report<Mul16Scale8Op>("Mul16Scale8", num_rounds);
+  Report<ShiftRight6Op>("ShiftRight6", num_rounds);
+  return 0;
+}
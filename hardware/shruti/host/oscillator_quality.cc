@@ -0,0 +1,304 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Quality report of the oscillator algorithms, for the desktop build. Each
+// algorithm of the two main oscillators is rendered on its own, at one note
+// per octave, and the following figures are reported:
+// - the DC offset, in LSB.
+// - the RMS level of the rest of the signal, in LSB.
+// - the aliasing, as the ratio (in dB) of the energy found between the
+// harmonics of the note to the energy of the harmonics.
+// - the rendering time per sample, with the same caveats as render_benchmark.
+//
+// The phase increments are integers and the phase accumulators are 16 bits,
+// so the output of the deterministic algorithms repeats itself exactly after
+// 65536 samples. Over this window, the harmonics of the note fall exactly on
+// the bins of the FFT and there is no spectral leakage - the noise-based
+// algorithms excepted.
+//
+// When a report saved from a previous revision is given, the figures which
+// got worse by more than the tolerances below are listed, and the exit code
+// is 1 if there were any - the slower timings are listed, but not counted.
+//
+// usage:
+//   oscillator_quality [reference report]
+
+// System headers must be included before base.h, which defines abs().
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hardware/shruti/resources.h"
+#include "hardware/shruti/synthesis_engine.h"
+#include "hardware/shruti/oscillator.h"
+
+using namespace hardware_shruti;
+
+static const uint8_t kLog2NumSamples = 16;
+static const uint32_t kNumSamples = 1L << kLog2NumSamples;
+static const uint32_t kNumWarmUpSamples = 4096;
+static const uint8_t kNumTimedRuns = 3;
+
+static const uint8_t kFirstNote = 24;
+static const uint8_t kLastNote = 108;
+static const uint8_t kParameter = 64;
+
+// Tolerances of the comparison with a reference report.
+static const double kDcTolerance = 1.0;
+static const double kLevelTolerance = 1.0;  // In dB.
+static const double kAliasingTolerance = 1.0;  // In dB.
+static const double kTimeTolerance = 1.5;  // Ratio.
+
+struct Measurement {
+  double dc;
+  double level;
+  double aliasing;
+  double ns_per_sample;
+};
+
+static inline uint64_t ReadNanoseconds() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return uint64_t(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+// In-place radix-2 FFT, on kNumSamples points.
+static void Fft(double* re, double* im) {
+  for (uint32_t i = 1, j = 0; i < kNumSamples; ++i) {
+    uint32_t bit = kNumSamples >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      double t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+  for (uint32_t size = 2; size <= kNumSamples; size <<= 1) {
+    double angle = -2.0 * M_PI / size;
+    for (uint32_t start = 0; start < kNumSamples; start += size) {
+      for (uint32_t k = 0; k < size / 2; ++k) {
+        double w_re = cos(angle * k);
+        double w_im = sin(angle * k);
+        uint32_t a = start + k;
+        uint32_t b = a + size / 2;
+        double t_re = re[b] * w_re - im[b] * w_im;
+        double t_im = re[b] * w_im + im[b] * w_re;
+        re[b] = re[a] - t_re;
+        im[b] = im[a] - t_im;
+        re[a] += t_re;
+        im[a] += t_im;
+      }
+    }
+  }
+}
+
+static double* re;
+static double* im;
+
+static void Analyze(
+    const uint8_t* samples,
+    uint16_t increment,
+    Measurement* m) {
+  double sum = 0.0;
+  for (uint32_t i = 0; i < kNumSamples; ++i) {
+    sum += samples[i];
+  }
+  double mean = sum / kNumSamples;
+  m->dc = mean - 128.0;
+  double energy = 0.0;
+  for (uint32_t i = 0; i < kNumSamples; ++i) {
+    re[i] = samples[i] - mean;
+    im[i] = 0.0;
+    energy += re[i] * re[i];
+  }
+  m->level = sqrt(energy / kNumSamples);
+
+  // Only the positive frequencies are summed, the spectrum being symmetric.
+  Fft(re, im);
+  double harmonics = 0.0;
+  double others = 0.0;
+  for (uint32_t bin = 1; bin < kNumSamples / 2; ++bin) {
+    double power = re[bin] * re[bin] + im[bin] * im[bin];
+    if (bin % increment == 0) {
+      harmonics += power;
+    } else {
+      others += power;
+    }
+  }
+  m->aliasing = others > 0.0 && harmonics > 0.0 ?
+      10.0 * log10(others / harmonics) : -200.0;
+}
+
+template<typename OscillatorType, typename Storage>
+static void Measure(
+    uint8_t shape,
+    uint8_t note,
+    uint8_t* samples,
+    Measurement* m) {
+  // Each measurement starts from a blank state, rather than from the one left
+  // by the previous algorithm.
+  memset(&Storage::state(), 0, sizeof(OscillatorState));
+  uint16_t increment = static_cast<uint16_t>(
+      440.0 * pow(2.0, (note - 69) / 12.0) * 65536.0 / kSampleRate + 0.5);
+  OscillatorType::SetupAlgorithm(shape);
+  // As in the engine, the parameters are updated once per block during the
+  // warm-up - some algorithms, like the vowel one, only read them every few
+  // updates.
+  uint8_t block[kAudioBlockSize];
+  for (uint32_t i = 0; i < kNumWarmUpSamples; i += kAudioBlockSize) {
+    OscillatorType::Update(kParameter, note, increment);
+    OscillatorType::RenderBlock(block);
+  }
+  // The window is rendered several times, and the fastest run is kept. The
+  // deterministic algorithms render the same samples each time.
+  uint64_t best_time = 0;
+  for (uint8_t run = 0; run < kNumTimedRuns; ++run) {
+    uint64_t start = ReadNanoseconds();
+    for (uint32_t i = 0; i < kNumSamples; i += kAudioBlockSize) {
+      OscillatorType::RenderBlock(samples + i);
+    }
+    uint64_t time = ReadNanoseconds() - start;
+    if (run == 0 || time < best_time) {
+      best_time = time;
+    }
+  }
+  m->ns_per_sample = double(best_time) / kNumSamples;
+  Analyze(samples, increment, m);
+}
+
+struct Reference {
+  char key[32];
+  Measurement m;
+};
+
+static Reference* references;
+static uint32_t num_references;
+
+static void LoadReferences(const char* file_name) {
+  FILE* f = fopen(file_name, "r");
+  if (!f) {
+    fprintf(stderr, "Cannot read %s\n", file_name);
+    exit(2);
+  }
+  uint32_t capacity = 256;
+  references = static_cast<Reference*>(malloc(capacity * sizeof(Reference)));
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    char osc[8];
+    char name[16];
+    int note;
+    Measurement m;
+    if (sscanf(line, "%7s %15s %d %lf %lf %lf %lf", osc, name, &note, &m.dc,
+               &m.level, &m.aliasing, &m.ns_per_sample) != 7) {
+      continue;
+    }
+    if (num_references == capacity) {
+      capacity *= 2;
+      references = static_cast<Reference*>(
+          realloc(references, capacity * sizeof(Reference)));
+    }
+    Reference* r = &references[num_references++];
+    snprintf(r->key, sizeof(r->key), "%s %s %d", osc, name, note);
+    r->m = m;
+  }
+  fclose(f);
+}
+
+static uint32_t Compare(const char* key, const Measurement& m) {
+  for (uint32_t i = 0; i < num_references; ++i) {
+    if (strcmp(references[i].key, key)) {
+      continue;
+    }
+    const Measurement& r = references[i].m;
+    uint32_t num_regressions = 0;
+    if (fabs(m.dc) > fabs(r.dc) + kDcTolerance) {
+      fprintf(stderr, "%s: DC offset %.2f -> %.2f\n", key, r.dc, m.dc);
+      ++num_regressions;
+    }
+    if (r.level > 0.0 && m.level > 0.0 &&
+        fabs(20.0 * log10(m.level / r.level)) > kLevelTolerance) {
+      fprintf(stderr, "%s: level %.2f -> %.2f\n", key, r.level, m.level);
+      ++num_regressions;
+    }
+    if (m.aliasing > r.aliasing + kAliasingTolerance) {
+      fprintf(stderr, "%s: aliasing %.1fdB -> %.1fdB\n", key, r.aliasing,
+              m.aliasing);
+      ++num_regressions;
+    }
+    // The timings depend too much on the load of the machine to fail the
+    // comparison.
+    if (m.ns_per_sample > r.ns_per_sample * kTimeTolerance) {
+      fprintf(stderr, "%s: %.2f -> %.2f ns/sample (not counted)\n", key,
+              r.ns_per_sample, m.ns_per_sample);
+    }
+    return num_regressions;
+  }
+  fprintf(stderr, "%s: not in the reference report\n", key);
+  return 0;
+}
+
+template<int id, OscillatorMode mode>
+static uint32_t Report(
+    const char* osc,
+    uint8_t last_shape,
+    uint8_t* samples) {
+  uint32_t num_regressions = 0;
+  // WAVEFORM_NONE renders nothing and is skipped.
+  for (uint8_t shape = WAVEFORM_NONE + 1; shape <= last_shape; ++shape) {
+    char name[16];
+    ResourcesManager::LoadStringResource(STR_RES_NONE + shape, name, 16);
+    for (uint8_t note = kFirstNote; note <= kLastNote; note += 12) {
+      Measurement m;
+      Measure<Oscillator<id, mode>, StaticOscillatorStorage<id> >(
+          shape, note, samples, &m);
+      printf("%s\t%s\t%d\t%.2f\t%.2f\t%.1f\t%.2f\n", osc, name, note, m.dc,
+             m.level, m.aliasing, m.ns_per_sample);
+      if (references) {
+        char key[32];
+        snprintf(key, sizeof(key), "%s %s %d", osc, name, note);
+        num_regressions += Compare(key, m);
+      }
+    }
+  }
+  return num_regressions;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2) {
+    LoadReferences(argv[1]);
+  }
+  uint8_t* samples = static_cast<uint8_t*>(malloc(kNumSamples));
+  re = static_cast<double*>(malloc(kNumSamples * sizeof(double)));
+  im = static_cast<double*>(malloc(kNumSamples * sizeof(double)));
+  engine.Init();
+
+  printf("osc\tshape\tnote\tdc\tlevel\taliasing (dB)\tns/sample\n");
+  uint32_t num_regressions = 0;
+  num_regressions += Report<7, FULL>("osc1", WAVEFORM_QUAD_SAW_PAD, samples);
+  num_regressions += Report<8, LOW_COMPLEXITY>("osc2", WAVEFORM_TRIANGLE,
+                                               samples);
+
+  free(samples);
+  free(re);
+  free(im);
+  free(references);
+  return num_regressions ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Offline rendering benchmark for the desktop build. For each oscillator
+// algorithm, a note is played on the default patch for a few seconds and the
+// output of the synthesis engine is written to a 8-bit WAV file. The time
+// spent in SynthesisEngine::Control() and SynthesisEngine::AudioBlock() is
+// reported, per sample.
+//
+// The numbers are host numbers - they are only meaningful when compared with
+// each other, or with those of a previous revision of the code built on the
+// same machine.
+//
+// usage:
+//   render_benchmark [duration in seconds] [output directory]
+
+// System headers must be included before base.h, which defines abs().
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hardware/shruti/patch.h"
+#include "hardware/shruti/resources.h"
+#include "hardware/shruti/synthesis_engine.h"
+
+using namespace hardware_shruti;
+
+static const uint8_t kNote = 48;
+static const uint8_t kVelocity = 100;
+
+#if defined(__i386__) || defined(__x86_64__)
+
+static inline uint64_t ReadCycleCounter() {
+  return __builtin_ia32_rdtsc();
+}
+
+#else
+
+static inline uint64_t ReadCycleCounter() {
+  return 0;
+}
+
+#endif  // __i386__ || __x86_64__
+
+static inline uint64_t ReadNanoseconds() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return uint64_t(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+static void WriteLittleEndian(FILE* f, uint32_t value, uint8_t size) {
+  for (uint8_t i = 0; i < size; ++i) {
+    fputc(value & 0xff, f);
+    value >>= 8;
+  }
+}
+
+// 8-bit unsigned mono PCM, which is exactly what the engine produces - or
+// 16-bit signed PCM for the 12-bit samples sent to the DAC.
+static void WriteWavHeader(FILE* f, uint32_t num_samples) {
+  uint8_t sample_size = sizeof(AudioSample);
+  fwrite("RIFF", 1, 4, f);
+  WriteLittleEndian(f, 36 + num_samples * sample_size, 4);
+  fwrite("WAVEfmt ", 1, 8, f);
+  WriteLittleEndian(f, 16, 4);
+  WriteLittleEndian(f, 1, 2);  // PCM.
+  WriteLittleEndian(f, 1, 2);  // Mono.
+  WriteLittleEndian(f, kSampleRate, 4);
+  WriteLittleEndian(f, kSampleRate * sample_size, 4);  // Bytes per second.
+  WriteLittleEndian(f, sample_size, 2);  // Block align.
+  WriteLittleEndian(f, sample_size * 8, 2);  // Bits per sample.
+  fwrite("data", 1, 4, f);
+  WriteLittleEndian(f, num_samples * sample_size, 4);
+}
+
+static void WriteSamples(
+    FILE* f,
+    const AudioSample* samples,
+    uint32_t num_samples) {
+#ifdef HAS_DAC_OUTPUT
+  for (uint32_t i = 0; i < num_samples; ++i) {
+    WriteLittleEndian(f, (samples[i] - kAudioSilence) << 4, 2);
+  }
+#else
+  fwrite(samples, 1, num_samples, f);
+#endif  // HAS_DAC_OUTPUT
+}
+
+int main(int argc, char** argv) {
+  uint32_t duration = argc >= 2 ? atoi(argv[1]) : 4;
+  const char* output_directory = argc >= 3 ? argv[2] : ".";
+  uint32_t num_blocks = duration * kSampleRate / kAudioBlockSize;
+  uint32_t num_samples = num_blocks * kAudioBlockSize;
+  AudioSample* samples = static_cast<AudioSample*>(
+      malloc(num_samples * sizeof(AudioSample)));
+
+  printf("shape\tns/sample\tcycles/sample\tcontrol ns/block\n");
+  for (uint8_t shape = WAVEFORM_NONE; shape <= WAVEFORM_QUAD_SAW_PAD; ++shape) {
+    char name[16];
+    ResourcesManager::LoadStringResource(STR_RES_NONE + shape, name, 16);
+
+    engine.Init();
+    engine.SetParameter(PRM_OSC_SHAPE_1, shape);
+    engine.NoteOn(0, kNote, kVelocity);
+
+    uint64_t control_time = 0;
+    uint64_t total_time = 0;
+    uint64_t total_cycles = 0;
+    AudioSample* out = samples;
+    for (uint32_t block = 0; block < num_blocks; ++block) {
+      // Release the note for the last quarter of the rendering, so that the
+      // release segment of the envelopes is measured too.
+      if (block == num_blocks * 3 / 4) {
+        engine.NoteOff(0, kNote, 0);
+      }
+      uint64_t start_cycles = ReadCycleCounter();
+      uint64_t start = ReadNanoseconds();
+      engine.Control();
+      uint64_t control_end = ReadNanoseconds();
+      if (engine.dead()) {
+        for (uint8_t i = kAudioBlockSize; i > 0 ; --i) {
+          *out++ = kAudioSilence;
+        }
+      } else {
+        engine.AudioBlock(out);
+        out += kAudioBlockSize;
+      }
+      total_cycles += ReadCycleCounter() - start_cycles;
+      total_time += ReadNanoseconds() - start;
+      control_time += control_end - start;
+    }
+
+    printf("%s\t%.2f\t%.1f\t%.1f\n",
+           name,
+           double(total_time) / num_samples,
+           double(total_cycles) / num_samples,
+           double(control_time) / num_blocks);
+
+    char file_name[256];
+    snprintf(file_name, sizeof(file_name), "%s/%02d_%s.wav",
+             output_directory, shape, name);
+    FILE* f = fopen(file_name, "wb");
+    if (!f) {
+      fprintf(stderr, "Cannot write %s\n", file_name);
+      return 1;
+    }
+    WriteWavHeader(f, num_samples);
+    WriteSamples(f, samples, num_samples);
+    fclose(f);
+  }
+  free(samples);
+  return 0;
+}
@@ -0,0 +1,124 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Note-on latency measurement.
+
+#include "hardware/shruti/latency_probe.h"
+
+#ifdef HAS_LATENCY_PROBE
+
+#include "hardware/hal/cycle_counter.h"
+
+using hardware_hal::CycleCounter;
+
+namespace hardware_shruti {
+
+// Timer 2 runs the audio interrupt, which ticks this counter. Each of its
+// periods is a sample.
+typedef CycleCounter<2> Clock;
+
+// A note-on which has not triggered anything after 0.5s - for example because
+// it was sent on another channel - is forgotten.
+static const uint16_t kLatencyTimeout = kSampleRate / 2;
+
+/* <static> */
+LatencyStatistics LatencyProbe::statistics_;
+volatile uint8_t LatencyProbe::pending_;
+uint16_t LatencyProbe::start_;
+uint8_t LatencyProbe::running_status_;
+uint8_t LatencyProbe::data_byte_;
+uint8_t LatencyProbe::num_triggers_;
+/* </static> */
+
+/* static */
+void LatencyProbe::Init() {
+  statistics_.min = 0xffff;
+  statistics_.max = 0;
+  statistics_.total = 0;
+  statistics_.count = 0;
+  pending_ = 0;
+}
+
+/* static */
+void LatencyProbe::ByteReceived(uint8_t byte) {
+  if (byte >= 0xf8) {
+    // Realtime messages do not interrupt the running status.
+    return;
+  }
+  if (byte & 0x80) {
+    running_status_ = byte;
+    data_byte_ = 0;
+    return;
+  }
+  if ((running_status_ & 0xf0) != 0x90) {
+    return;
+  }
+  if (++data_byte_ != 2) {
+    return;
+  }
+  data_byte_ = 0;
+  // A velocity of 0 is a note-off.
+  if (!byte) {
+    return;
+  }
+  Clock::Timestamp now;
+  Clock::Read(&now);
+  if (!pending_ || static_cast<uint16_t>(now.ticks - start_) >=
+                   kLatencyTimeout) {
+    start_ = now.ticks;
+    pending_ = 1;
+  }
+}
+
+/* static */
+void LatencyProbe::BlockRendered(
+    uint8_t num_triggers,
+    uint8_t num_queued_samples) {
+  if (num_triggers == num_triggers_) {
+    return;
+  }
+  num_triggers_ = num_triggers;
+  if (!pending_) {
+    return;
+  }
+  Clock::Timestamp now;
+  Clock::Read(&now);
+  // The UART interrupt may replace a timed out note-on at any time.
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t start = start_;
+  pending_ = 0;
+  SREG = oldSREG;
+  uint16_t latency = now.ticks - start + num_queued_samples;
+  LatencyStatistics* s = &statistics_;
+  if (latency < s->min) {
+    s->min = latency;
+  }
+  if (latency > s->max) {
+    s->max = latency;
+  }
+  if (s->count == 0xffff) {
+    s->count >>= 1;
+    s->total >>= 1;
+  }
+  ++s->count;
+  s->total += latency;
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_LATENCY_PROBE
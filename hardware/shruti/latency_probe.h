@@ -0,0 +1,87 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Measurement of the latency between the reception of a MIDI note-on and the
+// playback of the first sample of the note it triggers.
+//
+// The end of each note-on message is timestamped by the UART interrupt. The
+// next voice trigger is then matched to it: the block rendered just after the
+// trigger holds the start of the attack, and its first sample is played once
+// the samples already queued in the audio buffer have been emitted. The
+// latency is thus the time elapsed until the block is committed, plus the
+// number of samples queued ahead of it. Only one note-on is tracked at a time,
+// and the notes triggered by the arpeggiator or the sequencer are matched as
+// well, so the measurements should be made with both of them stopped.
+
+#ifndef HARDWARE_SHRUTI_LATENCY_PROBE_H_
+#define HARDWARE_SHRUTI_LATENCY_PROBE_H_
+
+#include "hardware/shruti/shruti.h"
+
+#ifdef HAS_LATENCY_PROBE
+
+namespace hardware_shruti {
+
+// Dumped as is (little endian) by the latency SysEx message. In periods of the
+// audio timer (32us). The total and count are halved when the count
+// saturates, so that the average can still be computed.
+typedef struct {
+  uint16_t min;
+  uint16_t max;
+  uint32_t total;
+  uint16_t count;
+} LatencyStatistics;
+
+class LatencyProbe {
+ public:
+  LatencyProbe() { }
+
+  static void Init();
+
+  // Called by the UART interrupt with each byte received.
+  static void ByteReceived(uint8_t byte);
+
+  // Called once a block has been rendered, before it is committed to the
+  // audio buffer, with the number of voice triggers so far and the number of
+  // samples still in the buffer.
+  static void BlockRendered(uint8_t num_triggers, uint8_t num_queued_samples);
+
+  static inline const LatencyStatistics* statistics() { return &statistics_; }
+  static inline uint8_t size() { return sizeof(statistics_); }
+
+ private:
+  static LatencyStatistics statistics_;
+
+  // Set by the UART interrupt when a note-on has been received, cleared once
+  // it has been measured.
+  static volatile uint8_t pending_;
+  static uint16_t start_;
+
+  // Running status and position in the message, for the UART interrupt.
+  static uint8_t running_status_;
+  static uint8_t data_byte_;
+
+  static uint8_t num_triggers_;
+
+  DISALLOW_COPY_AND_ASSIGN(LatencyProbe);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_LATENCY_PROBE
+
+#endif  // HARDWARE_SHRUTI_LATENCY_PROBE_H_
@@ -70,6 +70,11 @@ class Lfo {
   void Reset() {
     phase_ = 0;
   }
+  // Moves the phase a quarter of the way back to 0, to keep the LFO in phase
+  // with the clock without a discontinuity.
+  void Pull() {
+    phase_ -= static_cast<int16_t>(phase_) >> 2;
+  }
   void Increment() {
     phase_ += phase_increment_;
   }
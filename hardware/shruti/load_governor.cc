@@ -0,0 +1,76 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Governor trading some rendering quality for CPU time.
+
+#include "hardware/shruti/load_governor.h"
+
+#ifdef HAS_LOAD_GOVERNOR
+
+namespace hardware_shruti {
+
+// After a step down, the average needs a few blocks to settle to the new cost,
+// so it is not checked again before this number of blocks.
+static const uint8_t kGovernorSettlingTime = 32;
+static const uint8_t kGovernorRestoreTime = 255;
+
+/* <static> */
+uint8_t LoadGovernor::level_;
+uint16_t LoadGovernor::average_cost_;
+uint16_t LoadGovernor::num_glitches_;
+uint8_t LoadGovernor::num_blocks_;
+/* </static> */
+
+/* static */
+void LoadGovernor::Init() {
+  level_ = GOVERNOR_FULL_QUALITY;
+  average_cost_ = 0;
+  num_blocks_ = 0;
+}
+
+/* static */
+void LoadGovernor::BlockRendered(uint8_t cost, uint16_t num_glitches) {
+  // One-pole low-pass filter, with a time constant of 8 blocks.
+  average_cost_ += ((static_cast<int16_t>(cost) << 4) -
+      static_cast<int16_t>(average_cost_)) >> 3;
+  if (num_blocks_ < 255) {
+    ++num_blocks_;
+  }
+  uint8_t glitch = num_glitches != num_glitches_;
+  num_glitches_ = num_glitches;
+  if (glitch || (num_blocks_ >= kGovernorSettlingTime &&
+                 average_cost_ > (kGovernorHighCost << 4))) {
+    if (level_ < kNumGovernorLevels - 1) {
+      ++level_;
+    }
+    num_blocks_ = 0;
+  } else if (average_cost_ >= (kGovernorLowCost << 4)) {
+    // Not low enough to restore anything yet.
+    if (num_blocks_ > kGovernorSettlingTime) {
+      num_blocks_ = kGovernorSettlingTime;
+    }
+  } else if (num_blocks_ == kGovernorRestoreTime) {
+    if (level_ > GOVERNOR_FULL_QUALITY) {
+      --level_;
+    }
+    num_blocks_ = 0;
+  }
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_LOAD_GOVERNOR
@@ -0,0 +1,82 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Governor trading some rendering quality for CPU time when the audio
+// rendering falls behind.
+//
+// The cost of each block is measured, without any timer, by the number of
+// samples played by the audio interrupt while the block was rendered - 32
+// samples for a block of 32 samples mean that the rendering takes all the CPU
+// time. Each underrun, and a running average of the cost above
+// kGovernorHighCost, steps the quality down by one level. The quality is
+// stepped up again after 255 blocks without underrun in which the average
+// stayed below kGovernorLowCost.
+
+#ifndef HARDWARE_SHRUTI_LOAD_GOVERNOR_H_
+#define HARDWARE_SHRUTI_LOAD_GOVERNOR_H_
+
+#include "hardware/shruti/shruti.h"
+
+#ifdef HAS_LOAD_GOVERNOR
+
+namespace hardware_shruti {
+
+// Each level includes the savings of the previous ones.
+enum GovernorLevel {
+  GOVERNOR_FULL_QUALITY = 0,
+  // The sub oscillator is rendered at 1/8th of the sample rate instead of
+  // 1/4th.
+  GOVERNOR_HALF_RATE_SUB_OSC,
+  // The noise is no longer mixed.
+  GOVERNOR_NO_NOISE,
+  // The LEDs and the display are refreshed half as often.
+  GOVERNOR_SLOW_UI,
+  kNumGovernorLevels
+};
+
+// In samples played during the rendering of a block.
+static const uint8_t kGovernorHighCost = kAudioBlockSize * 7 / 8;
+static const uint8_t kGovernorLowCost = kAudioBlockSize * 5 / 8;
+
+class LoadGovernor {
+ public:
+  LoadGovernor() { }
+
+  static void Init();
+
+  // Called once a block has been rendered, with the number of samples played
+  // during its rendering and the total number of underruns.
+  static void BlockRendered(uint8_t cost, uint16_t num_glitches);
+
+  static inline uint8_t level() { return level_; }
+
+ private:
+  static uint8_t level_;
+  // Average cost, in 1/16th of sample.
+  static uint16_t average_cost_;
+  static uint16_t num_glitches_;
+  // Number of blocks rendered since the last change of level.
+  static uint8_t num_blocks_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadGovernor);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_LOAD_GOVERNOR
+
+#endif  // HARDWARE_SHRUTI_LOAD_GOVERNOR_H_
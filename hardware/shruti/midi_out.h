@@ -0,0 +1,61 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// MIDI output, shared by the thru, the SysEx transfers and the arpeggiator.
+
+#ifndef HARDWARE_SHRUTI_MIDI_OUT_H_
+#define HARDWARE_SHRUTI_MIDI_OUT_H_
+
+#include "hardware/shruti/shruti.h"
+
+#include "hardware/hal/serial.h"
+#include "hardware/midi/midi_merge.h"
+#include "hardware/midi/midi_output.h"
+
+namespace hardware_shruti {
+
+#ifdef HAS_MIDI_OUTPUT_QUEUE
+typedef hardware_midi::MidiOutput<hardware_hal::SerialPort0> MidiOut;
+#else
+typedef hardware_hal::Serial<hardware_hal::SerialPort0, 31250,
+    hardware_hal::DISABLED, hardware_hal::POLLED> MidiOut;
+#endif  // HAS_MIDI_OUTPUT_QUEUE
+
+#ifdef HAS_MIDI_MERGE
+typedef hardware_midi::MidiMerge<MidiOut> MidiThru;
+
+// Controller setting the types of messages forwarded by the thru - a
+// combination of MidiThruFilter flags.
+const uint8_t kThruFilter = 0x5a;
+
+#ifdef HAS_POLY_CHAIN
+// Controller enabling (>= 64) or disabling the poly chain.
+const uint8_t kPolyChain = 0x5d;
+
+// Stored as the note played by the unit when it is free.
+const uint8_t kNoChainNote = 0xff;
+#endif  // HAS_POLY_CHAIN
+
+#ifdef HAS_PARAMETER_ECHO
+// Controller enabling (>= 64) or disabling the parameter echo.
+const uint8_t kParameterEcho = 0x5e;
+#endif  // HAS_PARAMETER_ECHO
+#endif  // HAS_MIDI_MERGE
+
+}  // namespace hardware_shruti
+
+#endif  // HARDWARE_SHRUTI_MIDI_OUT_H_
@@ -37,6 +37,33 @@ uint8_t NoteStack::root_ptr_;
 /* static */
 uint8_t NoteStack::sorted_ptr_[kNoteStackSize + 1];
 
+/* static */
+uint8_t NoteStack::prev_ptr_[kNoteStackSize + 1];
+
+/* static */
+uint8_t NoteStack::tail_ptr_;
+
+/* static */
+uint8_t NoteStack::free_ptr_;
+
+/* static */
+uint8_t NoteStack::note_bitmap_[128 / 8];
+
+/* static */
+uint8_t NoteStack::SortedPosition(uint8_t note) {
+  uint8_t low = 0;
+  uint8_t high = size_;
+  while (low < high) {
+    uint8_t middle = (low + high) >> 1;
+    if (pool_[sorted_ptr_[middle]].note < note) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
 /* static */
 void NoteStack::NoteOn(uint8_t note, uint8_t velocity) {
   // Remove the note from the list first (in case it is already here).
@@ -44,72 +71,62 @@ void NoteStack::NoteOn(uint8_t note, uint8_t velocity) {
   // In case of saturation, remove the least recently played note from the
   // stack.
   if (size_ == kNoteStackSize) {
-    uint8_t least_recent_note;
-    for (uint8_t i = 1; i <= kNoteStackSize; ++i) {
-      if (pool_[i].next_ptr == 0) {
-        least_recent_note = pool_[i].note;
-      }
-    }
-    NoteOff(least_recent_note);
+    NoteOff(pool_[tail_ptr_].note);
   }
-  // Now we are ready to insert the new note. Find a free slot to insert it.
-  uint8_t free_slot;
-  for (uint8_t i = 1; i <= kNoteStackSize; ++i) {
-    if (pool_[i].note == kFreeSlot) {
-      free_slot = i;
-    }
+  // Now we are ready to insert the new note, in a slot taken from the free
+  // list.
+  uint8_t slot = free_ptr_;
+  free_ptr_ = pool_[slot].next_ptr;
+  pool_[slot].next_ptr = root_ptr_;
+  pool_[slot].note = note;
+  pool_[slot].velocity = velocity;
+  prev_ptr_[slot] = 0;
+  if (root_ptr_) {
+    prev_ptr_[root_ptr_] = slot;
+  } else {
+    tail_ptr_ = slot;
   }
-  pool_[free_slot].next_ptr = root_ptr_;
-  pool_[free_slot].note = note;
-  pool_[free_slot].velocity = velocity;
-  root_ptr_ = free_slot;
+  root_ptr_ = slot;
   // The last step consists in inserting the note in the sorted list.
-  for (uint8_t i = 0; i < size_; ++i) {
-    if (pool_[sorted_ptr_[i]].note > note) {
-      for (uint8_t j = size_; j > i; --j) {
-        sorted_ptr_[j] = sorted_ptr_[j - 1];
-      }
-      sorted_ptr_[i] = free_slot;
-      free_slot = 0;
-      break;
-    }
-  }
-  if (free_slot) {
-    sorted_ptr_[size_] = free_slot;
-  }
+  uint8_t position = SortedPosition(note);
+  memmove(
+      sorted_ptr_ + position + 1,
+      sorted_ptr_ + position,
+      size_ - position);
+  sorted_ptr_[position] = slot;
+  note_bitmap_[note >> 3] |= 1 << (note & 7);
   ++size_;
 }
 
 /* static */
 void NoteStack::NoteOff(uint8_t note) {
-  uint8_t current = root_ptr_;
-  uint8_t previous = 0;
-  while (current) {
-    if (pool_[current].note == note) {
-      break;
-    }
-    previous = current;
-    current = pool_[current].next_ptr;
+  if (!contains(note)) {
+    return;
   }
-  if (current) {
-    if (previous) {
-      pool_[previous].next_ptr = pool_[current].next_ptr;
-    } else {
-      root_ptr_ = pool_[current].next_ptr;
-    }
-    for (uint8_t i = 0; i < size_; ++i) {
-      if (sorted_ptr_[i] == current) {
-        for (uint8_t j = i; j < size_ - 1; ++j) {
-          sorted_ptr_[j] = sorted_ptr_[j + 1];
-        }
-        break;
-      }
-    }
-    pool_[current].next_ptr = 0;
-    pool_[current].note = kFreeSlot;
-    pool_[current].velocity = 0;
-    --size_;
+  uint8_t position = SortedPosition(note);
+  uint8_t current = sorted_ptr_[position];
+  uint8_t previous = prev_ptr_[current];
+  uint8_t next = pool_[current].next_ptr;
+  if (previous) {
+    pool_[previous].next_ptr = next;
+  } else {
+    root_ptr_ = next;
+  }
+  if (next) {
+    prev_ptr_[next] = previous;
+  } else {
+    tail_ptr_ = previous;
   }
+  memmove(
+      sorted_ptr_ + position,
+      sorted_ptr_ + position + 1,
+      size_ - position - 1);
+  pool_[current].next_ptr = free_ptr_;
+  pool_[current].note = kFreeSlot;
+  pool_[current].velocity = 0;
+  free_ptr_ = current;
+  note_bitmap_[note >> 3] &= ~(1 << (note & 7));
+  --size_;
 }
 
 /* static */
@@ -117,10 +134,17 @@ void NoteStack::Clear() {
   size_ = 0;
   memset(pool_ + 1, 0, sizeof(NoteEntry) * kNoteStackSize);
   memset(sorted_ptr_ + 1, 0, kNoteStackSize);
+  memset(note_bitmap_, 0, sizeof(note_bitmap_));
   root_ptr_ = 0;
+  tail_ptr_ = 0;
   for (uint8_t i = 0; i <= kNoteStackSize; ++i) {
     pool_[i].note = kFreeSlot;
   }
+  // All the nodes are free.
+  for (uint8_t i = 1; i < kNoteStackSize; ++i) {
+    pool_[i].next_ptr = i + 1;
+  }
+  free_ptr_ = 1;
 }
 
 }  // namespace hardware_shruti
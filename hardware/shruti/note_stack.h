@@ -33,6 +33,13 @@
 // Additionally, an array of pointers is stored to allow random access to the
 // n-th note, sorted by ascending order of pitch (for arpeggiation).
 //
+// The list is doubly linked, the free nodes are chained in a free list, and a
+// 128-bit bitmap records which notes are in the stack, so that:
+// - a note off for a note which is not in the stack (for example a note
+// previously evicted by saturation) returns at once ;
+// - a note is located by a binary search in the sorted array, unlinked and
+// allocated in constant time, without scanning the pool.
+//
 // TODO(pichenettes): having this class implemented as a "static singleton"
 // saves almost 300 bytes of code. w00t! But we'd rather move this back to a
 // simple class when adding multitimbrality. When will we add multitimbrality?
@@ -75,6 +82,16 @@ class NoteStack {
   static NoteEntry pool_[kNoteStackSize + 1];  // First element is a dummy node!
   static uint8_t root_ptr_;  // Base 1.
   static uint8_t sorted_ptr_[kNoteStackSize + 1];  // Base 1.
+  static uint8_t prev_ptr_[kNoteStackSize + 1];  // Base 1.
+  static uint8_t tail_ptr_;  // Base 1, least recently played note.
+  static uint8_t free_ptr_;  // Base 1, chained through next_ptr.
+  static uint8_t note_bitmap_[128 / 8];
+
+  static inline uint8_t contains(uint8_t note) {
+    return note_bitmap_[note >> 3] & (1 << (note & 7));
+  }
+  // Index of the first note, in the sorted array, not lower than note.
+  static uint8_t SortedPosition(uint8_t note);
 
   DISALLOW_COPY_AND_ASSIGN(NoteStack);
 };
@@ -17,6 +17,10 @@
 //
 // Oscillators. Note that the code of each oscillator is duplicated/specialized,
 // for a noticeable performance boost.
+// The state of an oscillator is stored in an OscillatorState struct, whose
+// location is chosen by the Storage template parameter: a static variable (the
+// default, and the fastest), or a struct owned by someone else and bound
+// before use - so that several voices can share the same code.
 // Another performance optimization consists in rendering the oscillator at
 // a sample rate which is the half of the base sample rate - this is
 // particularly useful for oscillators which do not have a rich frequency
@@ -36,7 +40,7 @@
 // 8-bits   sr        n/a              n/a
 // Vowel    sr/2      n/a              n/a
 // Table    sr/2      n/a              n/a
-// Sweep    ?         n/a              n/a
+// Sweep    sr        n/a              n/a
 
 #ifndef HARDWARE_SHRUTI_OSCILLATOR_H_
 #define HARDWARE_SHRUTI_OSCILLATOR_H_
@@ -46,11 +50,15 @@
 
 #include "hardware/shruti/patch.h"
 #include "hardware/shruti/resources.h"
+#include "hardware/shruti/wavetable_cache.h"
 #include "hardware/utils/random.h"
 #include "hardware/utils/op.h"
 
 using namespace hardware_utils_op;
 using hardware_utils::Random;
+#ifdef HAS_AUDIO_RATE_NOISE
+using hardware_utils::AudioRandom;
+#endif  // HAS_AUDIO_RATE_NOISE
 
 namespace hardware_shruti {
 
@@ -82,6 +90,14 @@ struct SawTriangleOscillatorData {
   uint8_t balance;
 };
 
+#ifdef HAS_COMPRESSED_WAVETABLE
+// Interpolates between two cycles of the wavetable, decoded in RAM.
+struct CachedWavetableData {
+  const uint8_t* wave[2];
+  uint8_t balance;
+};
+#endif  // HAS_COMPRESSED_WAVETABLE
+
 struct CzOscillatorData {
   uint16_t formant_phase;
   uint16_t formant_phase_increment;
@@ -90,13 +106,15 @@ struct CzOscillatorData {
 struct FmOscillatorData {
   uint16_t modulator_phase;
   uint16_t modulator_phase_increment;
+  uint8_t ratio;
 };
 
 struct VowelSynthesizerData {
   uint16_t formant_increment[3];
   uint16_t formant_phase[3];
-  uint8_t formant_amplitude[3];
-  uint8_t noise_modulation;
+  // Amplitudes of the 3 formants, followed by the amount of noise applied to
+  // the phase - all 4 are unpacked from the nibbles of the vowel data.
+  uint8_t formant_amplitude[4];
   uint8_t update;  // Update only every kVowelControlRateDecimation-th call.
 };
 
@@ -104,19 +122,49 @@ struct FilteredNoiseData {
   uint8_t lp_noise_sample;
 };
 
+#ifdef HAS_UNISON_PAD
+// Number of saws of the pad, including the one running at the note frequency.
+// 5 saws take as much RAM as the vowel synthesizer, the largest algorithm.
+static const uint8_t kNumUnisonVoices = 5;
+
+// Set to 0 to render the extra saws at the full sample rate.
+static const uint8_t kUnisonHalfSampleRate = 1;
+
+// The gain reduction applied to the sum of the saws, so that it fits in 8 bits.
+static const uint8_t kUnisonGain = 256 / kNumUnisonVoices;
+
+// Phase and increment are packed together, so that each extra saw is stepped
+// with a single pointer walking through the array.
+struct UnisonVoice {
+  uint16_t phase;
+  uint16_t phase_increment;
+};
+
+struct UnisonPadData {
+  UnisonVoice voice[kNumUnisonVoices - 1];
+};
+#else
 struct QuadSawPadData {
   uint16_t phase_increment[3];
   uint16_t phase[3];
 };
+#endif  // HAS_UNISON_PAD
 
 union OscillatorData {
   BandlimitedPwmOscillatorData pw;
   SawTriangleOscillatorData st;
+#ifdef HAS_COMPRESSED_WAVETABLE
+  CachedWavetableData wt;
+#endif  // HAS_COMPRESSED_WAVETABLE
   CzOscillatorData cz;
   FmOscillatorData fm;
   VowelSynthesizerData vw;
   FilteredNoiseData no;
+#ifdef HAS_UNISON_PAD
+  UnisonPadData un;
+#else
   QuadSawPadData qs;
+#endif  // HAS_UNISON_PAD
 };
 
 struct AlgorithmFn {
@@ -124,7 +172,69 @@ struct AlgorithmFn {
   void (*render)();
 };
 
-template<int id, OscillatorMode mode>
+// Everything an oscillator needs to remember between two calls.
+struct OscillatorState {
+  // Current phase of the oscillator.
+  uint16_t phase;
+  
+  // Phase increment (and phase increment x 2, for low-sr oscillators).
+  uint16_t phase_increment;
+  uint16_t phase_increment_2;
+  
+  // Copy of the shape used by this oscillator. When changing this, you
+  // should also update the Update/Render pointers.
+  uint8_t shape;
+  uint8_t shape_corrected;
+  
+  // Current value of the oscillator parameter.
+  uint8_t parameter;
+  
+  // Sample generated in the previous full call.
+  uint8_t held_sample;
+  
+  // Current MIDI note (used for wavetable selection).
+  uint8_t note;
+  
+  // Parameter and increment passed to the last call to Update() - which is
+  // skipped when they are unchanged, along with the note. A null increment
+  // forces the next update.
+  uint8_t update_parameter;
+  uint16_t update_increment;
+  
+  // Union of state data used by each algorithm.
+  OscillatorData data;
+  
+  // A pair of pointers to the update/render functions. update function might be
+  // NULL.
+  AlgorithmFn fn;
+};
+
+// The state of an oscillator is stored in a static variable, and accessed with
+// direct addressing. This is the fastest option, but each oscillator needs its
+// own id - and its own copy of the code.
+template<int id>
+struct StaticOscillatorStorage {
+  static inline OscillatorState& state() { return state_; }
+  static OscillatorState state_;
+};
+
+template<int id> OscillatorState StaticOscillatorStorage<id>::state_;
+
+// The state of the oscillator is owned by someone else (for example, a voice),
+// and is accessed through a pointer set by Bind(). A single oscillator class -
+// and a single copy of the code - can then be used to render any number of
+// oscillators, one after the other.
+template<int id>
+struct BoundOscillatorStorage {
+  static inline OscillatorState& state() { return *state_; }
+  static inline void Bind(OscillatorState* state) { state_ = state; }
+  static OscillatorState* state_;
+};
+
+template<int id> OscillatorState* BoundOscillatorStorage<id>::state_;
+
+template<int id, OscillatorMode mode,
+         typename Storage = StaticOscillatorStorage<id> >
 class Oscillator {
  public:
    Oscillator() { }
@@ -136,11 +246,11 @@ class Oscillator {
          (mode == LOW_COMPLEXITY && shape > WAVEFORM_TRIANGLE)) {
        return;  // Protection against NULL function pointers.
      }
-     if (shape != shape_ || (sweeping_ && shape != WAVEFORM_ANALOG_WAVETABLE)) {
-       shape_ = shape;
+     if (shape != state().shape) {
+       state().shape = shape;
+       state().update_increment = 0;
        if (mode == FULL) {
-         fn_ = fn_table_[shape];
-         sweeping_ = shape_ == WAVEFORM_ANALOG_WAVETABLE;
+         state().fn = fn_table_[shape];
        }
      }
   }
@@ -152,95 +262,148 @@ class Oscillator {
     if (mode == SUB_OSCILLATOR) {
       RenderSub();
     } else if (mode == LOW_COMPLEXITY) {
-      if (shape_corrected_ & 1) {
+      if (state().shape_corrected & 1) {
         RenderPulseSquare();
       } else {
         RenderSimpleWavetable();
       }
     } else {
-      (*fn_.render)();
+      (*state().fn.render)();
+    }
+    return state().held_sample;
+  }
+  // Renders kAudioBlockSize samples at once. The tests on the mode and shape
+  // are done once per block instead of once per sample. The decimation counter
+  // of the engine is stepped at each sample, and is back to 0 at the end of
+  // the block.
+  static inline void RenderBlock(uint8_t* buffer) {
+    if (mode == SUB_OSCILLATOR) {
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        engine.set_oscillator_decimation((i + 1) & 3);
+        RenderSub();
+        buffer[i] = state().held_sample;
+      }
+    } else if (mode == LOW_COMPLEXITY) {
+      if (state().shape_corrected & 1) {
+        for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+          engine.set_oscillator_decimation((i + 1) & 3);
+          RenderPulseSquare();
+          buffer[i] = state().held_sample;
+        }
+      } else {
+        for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+          engine.set_oscillator_decimation((i + 1) & 3);
+          RenderSimpleWavetable();
+          buffer[i] = state().held_sample;
+        }
+      }
+    } else {
+      void (*render)() = state().fn.render;
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        engine.set_oscillator_decimation((i + 1) & 3);
+        (*render)();
+        buffer[i] = state().held_sample;
+      }
+    }
+  }
+#ifdef HAS_LOAD_GOVERNOR
+  // Renders kAudioBlockSize samples of the sub oscillator at half its rate -
+  // each sample is held for 8 samples instead of 4.
+  static inline void RenderHalfRateSubBlock(uint8_t* buffer) {
+    uint16_t increment = state().phase_increment << 1;
+    uint8_t sample = state().held_sample;
+    for (uint8_t i = 0; i < kAudioBlockSize; i += 8) {
+      state().phase += increment;
+      sample = InterpolateTwoTables(
+          state().data.st.wave[0], state().data.st.wave[1],
+          state().phase, state().data.st.balance);
+      for (uint8_t j = 0; j < 8; ++j) {
+        buffer[i + j] = sample;
+      }
+    }
+    state().held_sample = sample;
+  }
+#endif  // HAS_LOAD_GOVERNOR
+  // Renders kAudioBlockSize samples of this oscillator and of the Slave
+  // oscillator, sample by sample, resetting the phase of the slave whenever
+  // the phase of this oscillator wraps (hard sync).
+  template<typename Slave>
+  static inline void RenderSyncedBlock(
+      uint8_t* buffer,
+      uint8_t* slave_buffer) {
+    void (*render)() = state().fn.render;
+    for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+      engine.set_oscillator_decimation((i + 1) & 3);
+      slave_buffer[i] = Slave::Render();
+      uint16_t previous_phase = state().phase;
+      if (mode == FULL) {
+        (*render)();
+      } else {
+        Render();
+      }
+      buffer[i] = state().held_sample;
+      if (state().phase < previous_phase) {
+        Slave::ResetPhase();
+      }
     }
-    return held_sample_;
   }
   static inline void Update(
       uint8_t parameter,
       uint8_t note,
       uint16_t increment) {
-    note_ = note;
+    // The zone selection and all the precomputations below only depend on
+    // these inputs, so there is nothing to do for a sustained note.
+    if (note == state().note &&
+        parameter == state().update_parameter &&
+        increment == state().update_increment) {
+      return;
+    }
+    state().note = note;
+    state().update_parameter = parameter;
+    state().update_increment = increment;
 
     if (mode == SUB_OSCILLATOR) {
-      phase_increment_ = increment << 2;
+      state().phase_increment = increment << 2;
       UpdateSub();
     } else {
-      parameter_ = parameter;
-      phase_increment_ = increment;
-      phase_increment_2_ = increment << 1;
+      state().parameter = parameter;
+      state().phase_increment = increment;
+      state().phase_increment_2 = increment << 1;
       if (mode == LOW_COMPLEXITY) {
-        if (shape_ == WAVEFORM_SQUARE && parameter_ == 0) {
-          shape_corrected_ = shape_ + 1;
+        if (state().shape == WAVEFORM_SQUARE && state().parameter == 0) {
+          state().shape_corrected = state().shape + 1;
         } else {
-          shape_corrected_ = shape_;
+          state().shape_corrected = state().shape;
         }
-        if (shape_corrected_ & 1) {
+        if (state().shape_corrected & 1) {
           UpdatePulseSquare();
         } else {
           UpdateSimpleWavetable();
         }
       } else {
-        if (sweeping_) {
-          shape_ = (parameter >> 5) + 1;
-          fn_ = fn_table_[shape_];
-          parameter_ = (parameter & 0x1f) << 2;
-        }
         // A hack: when pulse width is set to 0, use a simple wavetable.
-        if (shape_ == WAVEFORM_SQUARE) {
-          fn_ = fn_table_[shape_ + (parameter_ == 0 ? 1 : 0)];
+        if (state().shape == WAVEFORM_SQUARE) {
+          state().fn = fn_table_[
+              state().shape + (state().parameter == 0 ? 1 : 0)];
         }
-        if (fn_.update) {
-          (*fn_.update)();
+        if (state().fn.update) {
+          (*state().fn.update)();
         }
       }
     }
   }
   static inline void UpdateSecondaryParameter(uint8_t secondary_parameter) {
-    if (mode == FULL) {
-      data_.fm.modulator_phase_increment = secondary_parameter;
+    if (mode == FULL && secondary_parameter != state().data.fm.ratio) {
+      state().data.fm.ratio = secondary_parameter;
+      state().update_increment = 0;
     }
   }
-  static inline uint16_t phase() { return phase_; }
-  static inline void ResetPhase() { phase_ = 0;  }
+  static inline uint16_t phase() { return state().phase; }
+  static inline void ResetPhase() { state().phase = 0;  }
 
  private:
-  // Current phase of the oscillator.
-  static uint16_t phase_;
-  
-  // Phase increment (and phase increment x 2, for low-sr oscillators).
-  static uint16_t phase_increment_;
-  static uint16_t phase_increment_2_;
-  
-  // Copy of the shape used by this oscillator. When changing this, you
-  // should also update the Update/Render pointers.
-  static uint8_t shape_;
-  static uint8_t shape_corrected_;
-  // Whether we are sweeping through the algorithms.
-  static uint8_t sweeping_;
-  
-  // Current value of the oscillator parameter.
-  static uint8_t parameter_;
-  
-  // Sample generated in the previous full call.
-  static uint8_t held_sample_;
-  
-  // Current MIDI note (used for wavetable selection).
-  static uint8_t note_;
-  
-  // Union of state data used by each algorithm.
-  static OscillatorData data_;
-  
-  // A pair of pointers to the update/render functions. update function might be
-  // NULL.
-  static AlgorithmFn fn_;
-  
+  static inline OscillatorState& state() { return Storage::state(); }
+
   static AlgorithmFn fn_table_[];
   
   static inline uint8_t ReadSample(const prog_uint8_t* table, uint16_t phase) {
@@ -282,6 +445,13 @@ class Oscillator {
   }
 #endif  // USE_OPTIMIZED_OP
 
+#ifdef HAS_COMPRESSED_WAVETABLE
+  static inline uint8_t InterpolateCachedSample(const uint8_t* cycle,
+                                                uint16_t phase) {
+    return Mix(cycle[phase >> 8], cycle[1 + (phase >> 8)], phase & 0xff);
+  }
+#endif  // HAS_COMPRESSED_WAVETABLE
+
   static inline uint8_t InterpolateTwoTables(
       const prog_uint8_t* table_a, const prog_uint8_t* table_b,
       uint16_t phase, uint8_t balance) {
@@ -293,218 +463,323 @@ class Oscillator {
   
   // ------- Silence (useful when processing external signals) -----------------
   static void RenderSilence() {
-    held_sample_ = 128;
+    state().held_sample = 128;
   }
   
   // ------- Band-limited waveforms with variable pulse width ------------------
   static void UpdatePulseSquare() {
-    uint8_t balance_index = Swap4(note_ - 12);
-    data_.pw.balance = balance_index & 0xf0;
+    uint8_t balance_index = Swap4(state().note >= 12 ? state().note - 12 : 0);
+    state().data.pw.balance = balance_index & 0xf0;
 
     uint8_t wave_index = balance_index & 0xf;
-    data_.pw.wave[0] = waveform_table[WAV_RES_BANDLIMITED_SAW_1 + wave_index];
+    state().data.pw.wave[0] = waveform_table[
+        WAV_RES_BANDLIMITED_SAW_1 + wave_index];
     wave_index = AddClip(wave_index, 1, kNumZonesHalfSampleRate);
-    data_.pw.wave[1] = waveform_table[WAV_RES_BANDLIMITED_SAW_1 + wave_index];    
-    data_.pw.shift = static_cast<uint16_t>(parameter_ + 128) << 8;
+    state().data.pw.wave[1] = waveform_table[
+        WAV_RES_BANDLIMITED_SAW_1 + wave_index];
+    state().data.pw.shift = static_cast<uint16_t>(state().parameter + 128) << 8;
     // For higher pitched notes, simply use 128
-    data_.pw.scale = 192 - (parameter_ >> 1);
-    if (note_ > 64) {
-      data_.pw.scale = Mix(data_.pw.scale, 96, (note_ - 64) << 2);
-      data_.pw.scale = Mix(data_.pw.scale, 96, (note_ - 64) << 2);
+    state().data.pw.scale = 192 - (state().parameter >> 1);
+    if (state().note > 64) {
+      state().data.pw.scale = Mix(
+          state().data.pw.scale, 96, (state().note - 64) << 2);
+      state().data.pw.scale = Mix(
+          state().data.pw.scale, 96, (state().note - 64) << 2);
     }
   }
   static void RenderPulseSquare() {
-    phase_ += phase_increment_;
+    state().phase += state().phase_increment;
     HALF_SAMPLE_RATE;
     
     uint8_t a = InterpolateTwoTables(
-        data_.pw.wave[0],
-        data_.pw.wave[1],
-        phase_,
-        data_.pw.balance);
-    a = MulScale8(a, data_.pw.scale);
+        state().data.pw.wave[0],
+        state().data.pw.wave[1],
+        state().phase,
+        state().data.pw.balance);
+    a = MulScale8(a, state().data.pw.scale);
     uint8_t b = InterpolateSample(
-        data_.pw.wave[0],
-        phase_ + data_.pw.shift);
-    b = MulScale8(b, data_.pw.scale);
-    if (shape_ == WAVEFORM_IMPULSE_TRAIN) {
+        state().data.pw.wave[0],
+        state().phase + state().data.pw.shift);
+    b = MulScale8(b, state().data.pw.scale);
+    if (state().shape == WAVEFORM_IMPULSE_TRAIN) {
       int8_t new_sample = a - b;
-      held_sample_ = ((new_sample - data_.pw.previous)) + 128;
-      data_.pw.previous = new_sample;
+      state().held_sample = ((new_sample - state().data.pw.previous)) + 128;
+      state().data.pw.previous = new_sample;
     } else {
-      held_sample_ = a - b + 128;
+      state().held_sample = a - b + 128;
     }
   }
   
   // ------- Minimal version of the square and triangle oscillators ------------
   static void UpdateSub() {
-    uint8_t balance_index = Swap4(note_);
-    data_.st.balance = balance_index & 0xf0;
+    uint8_t balance_index = Swap4(state().note);
+    state().data.st.balance = balance_index & 0xf0;
     
     uint8_t wave_index = balance_index & 0x0f;
-    uint8_t base_resource_id = shape_ == WAVEFORM_SQUARE ?
+    uint8_t base_resource_id = state().shape == WAVEFORM_SQUARE ?
         WAV_RES_BANDLIMITED_SQUARE_1 :
         WAV_RES_BANDLIMITED_TRIANGLE_1;
 
     wave_index = AddClip(wave_index, 1, kNumZonesHalfSampleRate);
-    data_.st.wave[0] = waveform_table[base_resource_id + wave_index];
+    state().data.st.wave[0] = waveform_table[base_resource_id + wave_index];
     wave_index = AddClip(wave_index, 1, kNumZonesHalfSampleRate);
-    data_.st.wave[1] = waveform_table[base_resource_id + wave_index];
+    state().data.st.wave[1] = waveform_table[base_resource_id + wave_index];
   }
   static void RenderSub() {
     FOURTH_SAMPLE_RATE;
-    phase_ += phase_increment_;
-    held_sample_ = InterpolateTwoTables(
-        data_.st.wave[0], data_.st.wave[1],
-        phase_, data_.st.balance);
+    state().phase += state().phase_increment;
+    state().held_sample = InterpolateTwoTables(
+        state().data.st.wave[0], state().data.st.wave[1],
+        state().phase, state().data.st.balance);
   }
 
   // ------- Interpolation between two waveforms from two wavetables -----------
   static void UpdateSimpleWavetable() {
-    uint8_t balance_index = Swap4(note_ - 12);
-    data_.st.balance = balance_index & 0xf0;
+    uint8_t balance_index = Swap4(state().note >= 12 ? state().note - 12 : 0);
+    state().data.st.balance = balance_index & 0xf0;
 
     uint8_t wave_index = balance_index & 0xf;
-    uint8_t base_resource_id = shape_ == WAVEFORM_SAW ?
+    uint8_t base_resource_id = state().shape == WAVEFORM_SAW ?
         WAV_RES_BANDLIMITED_SAW_0 :
-        (shape_ == WAVEFORM_SQUARE ? WAV_RES_BANDLIMITED_SQUARE_0  : 
+        (state().shape == WAVEFORM_SQUARE ? WAV_RES_BANDLIMITED_SQUARE_0  : 
         WAV_RES_BANDLIMITED_TRIANGLE_0);
       
-    data_.st.wave[0] = waveform_table[base_resource_id + wave_index];
+    state().data.st.wave[0] = waveform_table[base_resource_id + wave_index];
     wave_index = AddClip(wave_index, 1, kNumZonesFullSampleRate);
-    data_.st.wave[1] = waveform_table[base_resource_id + wave_index];
+    state().data.st.wave[1] = waveform_table[base_resource_id + wave_index];
   }
   static void RenderSimpleWavetable() {
-    phase_ += phase_increment_;
+    state().phase += state().phase_increment;
     uint8_t sample = InterpolateTwoTables(
-        data_.st.wave[0], data_.st.wave[1],
-        phase_, data_.st.balance);
+        state().data.st.wave[0], state().data.st.wave[1],
+        state().phase, state().data.st.balance);
 
     // To produce pulse width-modulated variants, we shift (saw) or set to
     // a constant (triangle) a portion of the waveform within an increasingly
     // large fraction of the period. Note that this is pure waveshapping - the
     // phase information is not used to determine when/where to shift.
-    //
-    //     /|            /|          /\             /\
-    //    / |           / |         /  \           /  \
-    //   /  |    =>  /|/  |        /    \  =>  ___/    \
-    //  /   |       /     |/      /      \
-    // /    |/                   /        \
-    //
-    if (sample < parameter_) {
-      if (shape_ == WAVEFORM_SAW) {
+    /*
+         /|            /|          /\             /\
+        / |           / |         /  \           /  \
+       /  |    =>  /|/  |        /    \  =>  ___/    \
+      /   |       /     |/      /      \
+     /    |/                   /        \
+    */
+    if (sample < state().parameter) {
+      if (state().shape == WAVEFORM_SAW) {
         // Add a discontinuity.
-        sample += parameter_ >> 1;
+        sample += state().parameter >> 1;
       } else {
         // Clip.
-        sample = parameter_;
+        sample = state().parameter;
       }
     }
-    held_sample_ = sample;
+    state().held_sample = sample;
+  }
+
+  // ------- Crossfade between band-limited waveforms --------------------------
+  // The parameter sweeps through saw, square, triangle and sine. The tables
+  // of the two waveforms are taken from the zone closest to the note, and
+  // crossfaded at each sample - so the render function stays the same during
+  // the whole sweep.
+  static void UpdateSweep() {
+    uint8_t balance_index = Swap4(state().note >= 12 ? state().note - 12 : 0);
+    uint8_t zone = balance_index & 0xf;
+    if (balance_index & 0x80) {
+      zone = AddClip(zone, 1, kNumZonesFullSampleRate);
+    }
+    uint16_t position = state().parameter * 3;
+    uint8_t waveform = position >> 7;
+    state().data.st.balance = (position & 0x7f) << 1;
+    state().data.st.wave[0] = SweepTable(waveform, zone);
+    state().data.st.wave[1] = SweepTable(waveform + 1, zone);
+  }
+  static inline const prog_uint8_t* SweepTable(uint8_t waveform, uint8_t zone) {
+    if (waveform == 0) {
+      return waveform_table[WAV_RES_BANDLIMITED_SAW_0 + zone];
+    } else if (waveform == 1) {
+      return waveform_table[WAV_RES_BANDLIMITED_SQUARE_0 + zone];
+    } else if (waveform == 2) {
+      return waveform_table[WAV_RES_BANDLIMITED_TRIANGLE_0 + zone];
+    } else {
+      return waveform_table[WAV_RES_SINE];
+    }
+  }
+  static void RenderSweep() {
+    state().phase += state().phase_increment;
+    state().held_sample = InterpolateTwoTables(
+        state().data.st.wave[0], state().data.st.wave[1],
+        state().phase, state().data.st.balance);
   }
 
   // ------- Interpolation between two offsets of a wavetable ------------------
   // 64 samples per cycle.
   static void UpdateWavetable128() {
-    uint8_t balance_index = Swap4(parameter_ << 1);
-    data_.st.balance = balance_index & 0xf0;
+    uint8_t balance_index = Swap4(state().parameter << 1);
+#ifdef HAS_COMPRESSED_WAVETABLE
+    state().data.wt.balance = balance_index & 0xf0;
+
+    // As below, the last cycle is crossfaded with the one before it.
+    uint8_t wave_index = balance_index & 0xf;
+    uint8_t other_index = wave_index < kWavetableNumCycles - 1 ?
+        wave_index + 1 : wave_index - 1;
+    WavetableCache::Load(wave_index, other_index);
+    state().data.wt.wave[0] = WavetableCache::cycle(wave_index);
+    state().data.wt.wave[1] = WavetableCache::cycle(other_index);
+#else
+    state().data.st.balance = balance_index & 0xf0;
 
     uint8_t wave_index = balance_index & 0xf;
     uint16_t offset = wave_index * 129;
-    data_.st.wave[0] = waveform_table[WAV_RES_WAVETABLE] + offset;
+    state().data.st.wave[0] = waveform_table[WAV_RES_WAVETABLE] + offset;
     if (offset < 2048 - 129) {
-      data_.st.wave[1] = waveform_table[WAV_RES_WAVETABLE] + offset + 129;
+      state().data.st.wave[1] = waveform_table[WAV_RES_WAVETABLE] + offset +
+          129;
     } else {
-      data_.st.wave[1] = data_.st.wave[0] - 129;
+      state().data.st.wave[1] = state().data.st.wave[0] - 129;
     }
+#endif  // HAS_COMPRESSED_WAVETABLE
   }
   static void RenderWavetable128() {
-    phase_ += phase_increment_;
-    held_sample_ = InterpolateTwoTables(
-        data_.st.wave[0], data_.st.wave[1],
-        phase_ >> 1, data_.st.balance);
+    state().phase += state().phase_increment;
+#ifdef HAS_COMPRESSED_WAVETABLE
+    state().held_sample = Mix(
+        InterpolateCachedSample(state().data.wt.wave[0], state().phase >> 1),
+        InterpolateCachedSample(state().data.wt.wave[1], state().phase >> 1),
+        state().data.wt.balance);
+#else
+    state().held_sample = InterpolateTwoTables(
+        state().data.st.wave[0], state().data.st.wave[1],
+        state().phase >> 1, state().data.st.balance);
+#endif  // HAS_COMPRESSED_WAVETABLE
   }
   
   // ------- Casio CZ-like synthesis -------------------------------------------
   static void UpdateCz() {
-    data_.cz.formant_phase_increment = phase_increment_ + (
-        (phase_increment_ * uint32_t(parameter_)) >> 3);
+    state().data.cz.formant_phase_increment = state().phase_increment + (
+        (state().phase_increment * uint32_t(state().parameter)) >> 3);
   }
   static void RenderCzSawReso() {
-    uint8_t old_phase_msb = phase_ >> 8;
-    phase_ += phase_increment_;
-    uint8_t phase_msb = phase_ >> 8;
+    uint8_t old_phase_msb = state().phase >> 8;
+    state().phase += state().phase_increment;
+    uint8_t phase_msb = state().phase >> 8;
     if (phase_msb < old_phase_msb) {
-      data_.cz.formant_phase = 0;
+      state().data.cz.formant_phase = 0;
     }
     // TODO(pichenettes): limit increment to avoid aliasing (this will be
     // equivalent to clipping a VCF control signal).
-    data_.cz.formant_phase += data_.cz.formant_phase_increment;
+    state().data.cz.formant_phase += state().data.cz.formant_phase_increment;
     uint8_t result = InterpolateSample(
         waveform_table[WAV_RES_SINE],
-        data_.cz.formant_phase);
-    held_sample_ = MulScale8(result, ~phase_msb);
+        state().data.cz.formant_phase);
+    state().held_sample = MulScale8(result, ~phase_msb);
   }
   static void RenderCzSyncReso() {
-    uint8_t old_phase_msb = phase_ >> 8;
-    phase_ += phase_increment_;
-    uint8_t phase_msb = phase_ >> 8;
+    uint8_t old_phase_msb = state().phase >> 8;
+    state().phase += state().phase_increment;
+    uint8_t phase_msb = state().phase >> 8;
     if (phase_msb < old_phase_msb) {
-      data_.cz.formant_phase = 0;
+      state().data.cz.formant_phase = 0;
     }
-    data_.cz.formant_phase += data_.cz.formant_phase_increment;
+    state().data.cz.formant_phase += state().data.cz.formant_phase_increment;
     uint8_t result = InterpolateSample(
         waveform_table[WAV_RES_SINE],
-        data_.cz.formant_phase);
-    held_sample_ = phase_ < 0x8000 ? result : 128;
+        state().data.cz.formant_phase);
+    state().held_sample = state().phase < 0x8000 ? result : 128;
   }
   
   // ------- Quad saw (mit aliasing) -------------------------------------------
+#ifdef HAS_UNISON_PAD
+  // The extra saws are alternately tuned above and below the note, by a
+  // multiple of the spread.
+  static void UpdateQuadSawPad() {
+    uint16_t phase_spread = (
+        static_cast<uint32_t>(state().phase_increment) *
+        state().parameter) >> 13;
+    ++phase_spread;
+    uint16_t above = state().phase_increment;
+    uint16_t below = state().phase_increment;
+    UnisonVoice* voice = state().data.un.voice;
+    for (uint8_t i = 0; i < kNumUnisonVoices - 1; ++i) {
+      uint16_t phase_increment;
+      if (i & 1) {
+        below -= phase_spread;
+        phase_increment = below;
+      } else {
+        above += phase_spread;
+        phase_increment = above;
+      }
+      voice->phase_increment = phase_increment << kUnisonHalfSampleRate;
+      ++voice;
+    }
+  }
+
+  // The saw is read straight from the phase, so the sum of the phase MSBs is
+  // scaled once per sample. The phase of the main saw is stepped at each
+  // sample, so that hard sync still works.
+  static void RenderQuadSawPad() {
+    state().phase += state().phase_increment;
+    if (kUnisonHalfSampleRate) {
+      HALF_SAMPLE_RATE;
+    }
+    uint16_t sum = state().phase >> 8;
+    UnisonVoice* voice = state().data.un.voice;
+    for (uint8_t i = 0; i < kNumUnisonVoices - 1; ++i) {
+      voice->phase += voice->phase_increment;
+      sum += voice->phase >> 8;
+      ++voice;
+    }
+    state().held_sample = (sum * kUnisonGain) >> 8;
+  }
+#else
   static void UpdateQuadSawPad() {
     uint16_t phase_spread = (
-        static_cast<uint32_t>(phase_increment_) * parameter_) >> 13;
+        static_cast<uint32_t>(state().phase_increment) *
+        state().parameter) >> 13;
     ++phase_spread;
-    uint16_t phase_increment = phase_increment_;
+    uint16_t phase_increment = state().phase_increment;
     for (uint8_t i = 0; i < 3; ++i) {
       phase_increment += phase_spread;
-      data_.qs.phase_increment[i] = phase_increment;
+      state().data.qs.phase_increment[i] = phase_increment;
     }
   }
 
   static void RenderQuadSawPad() {
-    phase_ += phase_increment_;
-    data_.qs.phase[0] += data_.qs.phase_increment[0];
-    data_.qs.phase[1] += data_.qs.phase_increment[1];
-    data_.qs.phase[2] += data_.qs.phase_increment[2];
-    held_sample_ = (phase_ >> 10);
-    held_sample_ += (data_.qs.phase[0] >> 10);
-    held_sample_ += (data_.qs.phase[1] >> 10);
-    held_sample_ += (data_.qs.phase[2] >> 10);
+    state().phase += state().phase_increment;
+    state().data.qs.phase[0] += state().data.qs.phase_increment[0];
+    state().data.qs.phase[1] += state().data.qs.phase_increment[1];
+    state().data.qs.phase[2] += state().data.qs.phase_increment[2];
+    state().held_sample = (state().phase >> 10);
+    state().held_sample += (state().data.qs.phase[0] >> 10);
+    state().held_sample += (state().data.qs.phase[1] >> 10);
+    state().held_sample += (state().data.qs.phase[2] >> 10);
   }
+#endif  // HAS_UNISON_PAD
   
   // ------- FM ----------------------------------------------------------------
   static void UpdateFm() {
     uint16_t multiplier = ResourcesManager::Lookup<uint16_t, uint8_t>(
-        lut_res_fm_frequency_ratios, data_.fm.modulator_phase_increment);
-    data_.fm.modulator_phase_increment = (
-        static_cast<int32_t>(phase_increment_) * multiplier) >> 8;
-    parameter_ <<= 1;
+        lut_res_fm_frequency_ratios, state().data.fm.ratio);
+    state().data.fm.modulator_phase_increment = (
+        static_cast<int32_t>(state().phase_increment) * multiplier) >> 8;
+    state().parameter <<= 1;
   }
   static void RenderFm() {
-    phase_ += phase_increment_;
-    data_.fm.modulator_phase += data_.fm.modulator_phase_increment;
+    state().phase += state().phase_increment;
+    state().data.fm.modulator_phase +=
+        state().data.fm.modulator_phase_increment;
     uint8_t modulator = ReadSample(waveform_table[WAV_RES_SINE],
-                                   data_.fm.modulator_phase);
-    uint16_t modulation = modulator * parameter_;
-    held_sample_ = InterpolateSample(waveform_table[WAV_RES_SINE],
-        phase_ + modulation);
+                                   state().data.fm.modulator_phase);
+    uint16_t modulation = modulator * state().parameter;
+    state().held_sample = InterpolateSample(waveform_table[WAV_RES_SINE],
+        state().phase + modulation);
   }
   
   // ------- 8-bit land --------------------------------------------------------
   static void Render8BitLand() {
-    phase_ += phase_increment_;
-    uint8_t x = parameter_;
-    held_sample_ = (((phase_ >> 8) ^ (x << 1)) & (~x)) + (x >> 1);
+    state().phase += state().phase_increment;
+    uint8_t x = state().parameter;
+    state().held_sample = (((state().phase >> 8) ^ (x << 1)) & (~x)) + (x >> 1);
   }
   
   // ------- Vowel ------------------------------------------------------------
@@ -514,25 +789,28 @@ class Oscillator {
   // http://code.google.com/p/tinkerit/wiki/Cantarino
   //
   static void UpdateVowel() {
-    ++data_.vw.update;
-    if (data_.vw.update == kVowelControlRateDecimation) {
-      data_.vw.update = 0;
+    ++state().data.vw.update;
+    if (state().data.vw.update == kVowelControlRateDecimation) {
+      state().data.vw.update = 0;
     } else {
+      // The formants do not reflect the new parameter yet - make sure that the
+      // next call is not skipped.
+      state().update_increment = 0;
       return;
     }
     
-    uint8_t offset_1 = ShiftRight4(parameter_);
+    uint8_t offset_1 = ShiftRight4(state().parameter);
     offset_1 = (offset_1 << 2) + offset_1;  // offset_1 * 5
     uint8_t offset_2 = offset_1 + 5;
-    uint8_t balance = parameter_ & 15;
+    uint8_t balance = state().parameter & 15;
     for (uint8_t i = 0; i < 3; ++i) {
-      data_.vw.formant_increment[i] = UnscaledMix4(
+      state().data.vw.formant_increment[i] = UnscaledMix4(
           ResourcesManager::Lookup<uint8_t, uint8_t>(
               waveform_table[WAV_RES_VOWEL_DATA], offset_1 + i),
           ResourcesManager::Lookup<uint8_t, uint8_t>(
               waveform_table[WAV_RES_VOWEL_DATA], offset_2 + i),
           balance);
-      data_.vw.formant_increment[i] <<= 3;
+      state().data.vw.formant_increment[i] <<= 3;
     }
     for (uint8_t i = 0; i < 2; ++i) {
       uint8_t amplitude_a = ResourcesManager::Lookup<uint8_t, uint8_t>(
@@ -542,91 +820,88 @@ class Oscillator {
           waveform_table[WAV_RES_VOWEL_DATA],
           offset_2 + 3 + i);
 
-      data_.vw.formant_amplitude[2 * i + 1] = Mix4(
+      state().data.vw.formant_amplitude[2 * i + 1] = Mix4(
           amplitude_a & 0x0f,
           amplitude_b & 0x0f, balance);
       amplitude_a = ShiftRight4(amplitude_a);
       amplitude_b = ShiftRight4(amplitude_b);
-      data_.vw.formant_amplitude[2 * i] = Mix4(
+      state().data.vw.formant_amplitude[2 * i] = Mix4(
           amplitude_a,
           amplitude_b, balance);
     }
   }
+  // The formant tables store 16 cycles of 16 samples, one for each amplitude.
+  static inline uint8_t RenderFormant(
+      uint8_t formant,
+      const prog_uint8_t* table) {
+    uint16_t phase = state().data.vw.formant_phase[formant] +
+        state().data.vw.formant_increment[formant];
+    state().data.vw.formant_phase[formant] = phase;
+    return ResourcesManager::Lookup<uint8_t, uint8_t>(
+        table,
+        ((phase >> 8) & 0xf0) | state().data.vw.formant_amplitude[formant]);
+  }
   static void RenderVowel() {
     HALF_SAMPLE_RATE;
     
-    int8_t result = 0;
-    for (uint8_t i = 0; i < 3; ++i) {
-      data_.vw.formant_phase[i] += data_.vw.formant_increment[i];
-      result += ResourcesManager::Lookup<uint8_t, uint8_t>(
-          i == 2 ? waveform_table[WAV_RES_FORMANT_SQUARE] :
-                   waveform_table[WAV_RES_FORMANT_SINE],
-          ((data_.vw.formant_phase[i] >> 8) & 0xf0) |
-            data_.vw.formant_amplitude[i]);
-    }
-    result = SignedMulScale8(result, ~(phase_ >> 8));
-
-    phase_ += phase_increment_;
+    // The loop on the formants is unrolled, so that the table of each formant
+    // is known at compile time.
+    int8_t result = RenderFormant(0, waveform_table[WAV_RES_FORMANT_SINE]);
+    result += RenderFormant(1, waveform_table[WAV_RES_FORMANT_SINE]);
+    result += RenderFormant(2, waveform_table[WAV_RES_FORMANT_SQUARE]);
+    result = SignedMulScale8(result, ~(state().phase >> 8));
+
+    state().phase += state().phase_increment;
+#ifdef HAS_AUDIO_RATE_NOISE
+    int16_t phase_noise = int8_t(AudioRandom::state_msb()) *
+        int8_t(state().data.vw.formant_amplitude[3]);
+#else
     int16_t phase_noise = int8_t(Random::state_msb()) *
-        int8_t(data_.vw.noise_modulation);
-    if ((phase_ + phase_noise) < phase_increment_) {
-      data_.vw.formant_phase[0] = 0;
-      data_.vw.formant_phase[1] = 0;
-      data_.vw.formant_phase[2] = 0;
+        int8_t(state().data.vw.formant_amplitude[3]);
+#endif  // HAS_AUDIO_RATE_NOISE
+    if ((state().phase + phase_noise) < state().phase_increment) {
+      state().data.vw.formant_phase[0] = 0;
+      state().data.vw.formant_phase[1] = 0;
+      state().data.vw.formant_phase[2] = 0;
     }
-    held_sample_ = SignedClip8(4 * result) + 128;
+    state().held_sample = SignedClip8(4 * result) + 128;
   }
   
   // ------- Dirty PWM (kills kittens) -----------------------------------------
   static void RenderDirtyPwm() {
-    phase_ += phase_increment_;
-    held_sample_ = (phase_ >> 8) < 127 + parameter_ ? 0 : 255;
+    state().phase += state().phase_increment;
+    state().held_sample = (state().phase >> 8) < 127 + state().parameter ?
+        0 : 255;
   }
   
   // ------- Low-passed, then high-passed white noise --------------------------
   static void RenderFilteredNoise() {
+#ifdef HAS_AUDIO_RATE_NOISE
+    uint8_t innovation = AudioRandom::GetByte();
+#else
     uint8_t innovation = Random::GetByte();
+#endif  // HAS_AUDIO_RATE_NOISE
     // This trick is used to avoid having a DC component (no innovation) when
     // the parameter is set to its minimal or maximal value.
-    uint8_t offset = parameter_ == 127 ? 0 : 2;
-    data_.no.lp_noise_sample = Mix(
-        data_.no.lp_noise_sample,
+    uint8_t offset = state().parameter == 127 ? 0 : 2;
+    state().data.no.lp_noise_sample = Mix(
+        state().data.no.lp_noise_sample,
         innovation,
-        offset + (parameter_ << 2));
-    if (parameter_ >= 64) {
-      held_sample_ = innovation - data_.no.lp_noise_sample;
+        offset + (state().parameter << 2));
+    if (state().parameter >= 64) {
+      state().held_sample = innovation - state().data.no.lp_noise_sample;
     } else {
-      held_sample_ = data_.no.lp_noise_sample;
+      state().held_sample = state().data.no.lp_noise_sample;
     }
   }
   
   DISALLOW_COPY_AND_ASSIGN(Oscillator);
 };
 
-#define Osc Oscillator<id, mode>
-
-template<int id, OscillatorMode mode>
-uint16_t Oscillator<id, mode>::phase_increment_;
-template<int id, OscillatorMode mode>
-uint16_t Oscillator<id, mode>::phase_increment_2_;
-
-template<int id, OscillatorMode mode> uint16_t Oscillator<id, mode>::phase_;
-template<int id, OscillatorMode mode> uint8_t Oscillator<id, mode>::shape_;
-template<int id, OscillatorMode mode>
-uint8_t Oscillator<id, mode>::shape_corrected_;
-template<int id, OscillatorMode mode> uint8_t Oscillator<id, mode>::parameter_;
-template<int id, OscillatorMode mode> uint8_t Oscillator<id, mode>::note_;
-template<int id, OscillatorMode mode> uint8_t Oscillator<id, mode>::sweeping_;
+#define Osc Oscillator<id, mode, Storage>
 
-template<int id, OscillatorMode mode>
-uint8_t Oscillator<id, mode>::held_sample_;
-
-template<int id, OscillatorMode mode>
-OscillatorData Oscillator<id, mode>::data_;
-
-template<int id, OscillatorMode mode> AlgorithmFn Oscillator<id, mode>::fn_;
-template<int id, OscillatorMode mode>
-AlgorithmFn Oscillator<id, mode>::fn_table_[] = {
+template<int id, OscillatorMode mode, typename Storage>
+AlgorithmFn Oscillator<id, mode, Storage>::fn_table_[] = {
   { NULL, &Osc::RenderSilence },
   { &Osc::UpdatePulseSquare, &Osc::RenderPulseSquare },
   { &Osc::UpdateSimpleWavetable, &Osc::RenderSimpleWavetable },
@@ -639,7 +914,7 @@ AlgorithmFn Oscillator<id, mode>::fn_table_[] = {
   { NULL, &Osc::RenderFilteredNoise },
   { &Osc::UpdateVowel, &Osc::RenderVowel },
   { &Osc::UpdateWavetable128, &Osc::RenderWavetable128 },
-  { &Osc::UpdateSimpleWavetable, &Osc::RenderSimpleWavetable },
+  { &Osc::UpdateSweep, &Osc::RenderSweep },
   { &Osc::UpdateCz, &Osc::RenderCzSyncReso },
   { &Osc::UpdateQuadSawPad, &Osc::RenderQuadSawPad },
 };
@@ -22,8 +22,10 @@
 #include <avr/eeprom.h>
 #include <avr/pgmspace.h>
 
-#include "hardware/hal/serial.h"
 #include "hardware/shruti/display.h"
+#include "hardware/shruti/eeprom_writer.h"
+#include "hardware/shruti/midi_out.h"
+#include "hardware/shruti/patch_library.h"
 #include "hardware/utils/op.h"
 
 using namespace hardware_hal;
@@ -32,8 +34,10 @@ using namespace hardware_utils_op;
 namespace hardware_shruti {
 
 void Patch::Pack(uint8_t* patch_buffer) const {
+  // The first 28 parameters are stored contiguously after keep_me_at_the_top.
+  const uint8_t* parameters = reinterpret_cast<const uint8_t*>(this) + 1;
   for (uint8_t i = 0; i < 28; ++i) {
-    patch_buffer[i] = osc_shape[i];
+    patch_buffer[i] = parameters[i];
   }
   for (uint8_t i = 0; i < kSavedModulationMatrixSize; ++i) {
     patch_buffer[2 * i + 28] = modulation_matrix.modulation[i].source |
@@ -48,15 +52,15 @@ void Patch::Pack(uint8_t* patch_buffer) const {
   }
 }
 
-uint8_t Patch::CheckBuffer() {
+uint8_t Patch::CheckBuffer(const uint8_t* patch_buffer) {
   for (uint8_t i = 6; i < 26; ++i) {
-    if (load_save_buffer_[i] > 128) {
+    if (patch_buffer[i] > 128) {
       return 0;
     }
   }
   const uint8_t name_offset = 2 * kSavedModulationMatrixSize + 28 + 8;
   for (uint8_t i = name_offset; i < name_offset + kPatchNameSize; ++i) {
-    if (load_save_buffer_[i] > 128) {
+    if (patch_buffer[i] > 128) {
       return 0;
     }
   }
@@ -64,8 +68,9 @@ uint8_t Patch::CheckBuffer() {
 }
 
 void Patch::Unpack(const uint8_t* patch_buffer) {
+  uint8_t* parameters = reinterpret_cast<uint8_t*>(this) + 1;
   for (uint8_t i = 0; i < 28; ++i) {
-    osc_shape[i] = patch_buffer[i];
+    parameters[i] = patch_buffer[i];
   }
   for (uint8_t i = 0; i < kSavedModulationMatrixSize; ++i) {
     modulation_matrix.modulation[i].source = patch_buffer[2 * i + 28] & 0xf;
@@ -83,54 +88,182 @@ void Patch::Unpack(const uint8_t* patch_buffer) {
 
 void Patch::EepromSave(uint8_t slot) const {
   Pack(load_save_buffer_);
+  EepromWriter::Write(
+      slot * kSerializedPatchSize,
+      load_save_buffer_,
+      kSerializedPatchSize);
+  UpdateSlotIndex(slot, load_save_buffer_);
+}
+
+void Patch::EepromLoad(uint8_t slot) {
+  EepromWriter::Flush();
   int16_t offset = slot * kSerializedPatchSize;
   for (int16_t i = 0; i < kSerializedPatchSize; ++i) {
-    eeprom_write_byte((uint8_t*)(i + offset), load_save_buffer_[i]);
+    load_save_buffer_[i] = eeprom_read_byte((uint8_t*)(uintptr_t)(i + offset));
+  }
+  if (CheckBuffer(load_save_buffer_)) {
+    Unpack(load_save_buffer_);
+  } else {
+    name[0] = '?';
   }
 }
 
-void Patch::EepromLoad(uint8_t slot) {
+uint8_t Patch::EepromRecall(uint8_t slot) {
+  if (!slot_valid(slot)) {
+    return 0;
+  }
+  EepromWriter::Flush();
   int16_t offset = slot * kSerializedPatchSize;
   for (int16_t i = 0; i < kSerializedPatchSize; ++i) {
-    load_save_buffer_[i] = eeprom_read_byte((uint8_t*)(i + offset));
+    load_save_buffer_[i] = eeprom_read_byte((uint8_t*)(uintptr_t)(i + offset));
   }
-  if (CheckBuffer()) {
+  Unpack(load_save_buffer_);
+  return 1;
+}
+
+#ifdef HAS_EXTERNAL_EEPROM
+uint8_t Patch::LibraryLoad(uint16_t slot) {
+  return PatchLibrary::StartRead(slot);
+}
+
+uint8_t Patch::LibraryLoadPoll() {
+  uint8_t status = PatchLibrary::PollRead(load_save_buffer_);
+  if (status == LIBRARY_READ_DONE) {
+    if (!CheckBuffer(load_save_buffer_)) {
+      return LIBRARY_READ_FAILED;
+    }
     Unpack(load_save_buffer_);
+  }
+  return status;
+}
+
+uint8_t Patch::LibrarySave(uint16_t slot) const {
+  Pack(load_save_buffer_);
+  return PatchLibrary::Write(slot, load_save_buffer_);
+}
+#endif  // HAS_EXTERNAL_EEPROM
+
+/* static */
+void Patch::UpdateSlotIndex(uint8_t slot, const uint8_t* patch_buffer) {
+  uint16_t mask = static_cast<uint16_t>(1) << slot;
+  if (CheckBuffer(patch_buffer)) {
+    valid_slots_ |= mask;
   } else {
-    name[0] = '?';
+    valid_slots_ &= ~mask;
   }
 }
 
-static const prog_char sysex_header[] PROGMEM = {
+/* static */
+void Patch::IndexEepromSlots() {
+  const uint8_t* address = 0;
+  for (uint8_t slot = 0; slot < kNumPatchSlots; ++slot) {
+    for (uint8_t i = 0; i < kSerializedPatchSize; ++i) {
+      load_save_buffer_[i] = eeprom_read_byte(address++);
+    }
+    UpdateSlotIndex(slot, load_save_buffer_);
+  }
+}
+
+// The header is followed by a command byte and an argument byte.
+static const prog_uint8_t sysex_header[] PROGMEM = {
   0xf0,  // <SysEx>
   0x00, 0x20, 0x77,  // TODO(pichenettes): register manufacturer ID.
   0x00, 0x01,  // Product ID for Shruti-1.
-  0x01,  // Command: patch transfer.
-  0x00,  // Argument: none.
 };
 
-void Patch::SysExSend() const {
-  Serial<SerialPort0, 31250, DISABLED, POLLED> midi_output;
-  
-  Pack(load_save_buffer_);
-  
-  // Outputs the SysEx header.
+static const uint8_t kSysExCommandOffset = sizeof(sysex_header);
+static const uint8_t kSysExArgumentOffset = kSysExCommandOffset + 1;
+static const uint8_t kSysExDataOffset = kSysExArgumentOffset + 1;
+
+// Number of nibbles in a patch followed by its checksum.
+static const uint8_t kSysExPatchSize = (kSerializedPatchSize + 1) * 2;
+
+typedef MidiOut SysExOutput;
+
+static void SysExWriteHeader(uint8_t command, uint8_t argument) {
   for (uint8_t i = 0; i < sizeof(sysex_header); ++i) {
-    midi_output.Write(pgm_read_byte(sysex_header + i));
+    SysExOutput::Write(pgm_read_byte(sysex_header + i));
   }
-  
-  // Outputs the patch data, in high-low nibblized form.
-  uint8_t checksum = 0;  // Sum of all patch data bytes.
-  for (uint8_t i = 0; i < kSerializedPatchSize; ++i) {
-    checksum += load_save_buffer_[i];
-    midi_output.Write(ShiftRight4(load_save_buffer_[i]));
-    midi_output.Write(load_save_buffer_[i] & 0x0f);
+  SysExOutput::Write(command);
+  SysExOutput::Write(argument);
+}
+
+// Outputs a byte, in high-low nibblized form.
+static void SysExWriteByte(uint8_t value) {
+  SysExOutput::Write(ShiftRight4(value));
+  SysExOutput::Write(value & 0x0f);
+}
+
+/* static */
+void Patch::SysExSendMessage(
+    uint8_t command,
+    uint8_t argument,
+    const uint8_t* data,
+    uint8_t size) {
+  SysExWriteHeader(command, argument);
+  uint8_t checksum = 0;  // Sum of all data bytes.
+  for (uint8_t i = 0; i < size; ++i) {
+    checksum += data[i];
+    SysExWriteByte(data[i]);
   }
-  
-  midi_output.Write(ShiftRight4(checksum));
-  midi_output.Write(checksum & 0x0f);
-  
-  midi_output.Write(0xf7);  // </SysEx>
+  SysExWriteByte(checksum);
+  SysExOutput::Write(0xf7);  // </SysEx>
+}
+
+/* static */
+void Patch::SysExSendBank() {
+  bank_dump_slot_ = 0;
+  bank_dump_position_ = 0;
+}
+
+/* static */
+void Patch::SysExSendBankTick() {
+  // The slots are read once the pending writes are done.
+  if (bank_dump_slot_ >= kNumPatchSlots || EepromWriter::busy()) {
+    return;
+  }
+  while (SysExOutput::writable()) {
+    uint8_t position = bank_dump_position_++;
+    uint8_t value;
+    if (position < kSysExCommandOffset) {
+      value = pgm_read_byte(sysex_header + position);
+    } else if (position == kSysExCommandOffset) {
+      value = SYSEX_COMMAND_BANK_TRANSFER;
+    } else if (position == kSysExArgumentOffset) {
+      value = bank_dump_slot_;
+      bank_dump_checksum_ = 0;
+    } else if (position < kSysExDataOffset + kSysExPatchSize) {
+      uint8_t nibble = position - kSysExDataOffset;
+      uint8_t i = nibble >> 1;
+      if (i < kSerializedPatchSize) {
+        value = eeprom_read_byte((uint8_t*)(uintptr_t)(
+            bank_dump_slot_ * kSerializedPatchSize + i));
+        if (!(nibble & 1)) {
+          bank_dump_checksum_ += value;
+        }
+      } else {
+        value = bank_dump_checksum_;
+      }
+      value = (nibble & 1) ? value & 0x0f : ShiftRight4(value);
+    } else {
+      value = 0xf7;  // </SysEx>
+      bank_dump_position_ = 0;
+      ++bank_dump_slot_;
+    }
+    SysExOutput::Write(value);
+    if (!bank_dump_position_) {
+      break;
+    }
+  }
+}
+
+void Patch::SysExSend() const {
+  Pack(load_save_buffer_);
+  SysExSendMessage(
+      SYSEX_COMMAND_PATCH_TRANSFER,
+      0,
+      load_save_buffer_,
+      kSerializedPatchSize);
 }
 
 uint8_t Patch::sequence_step(uint8_t step) const {
@@ -152,22 +285,41 @@ void Patch::SysExReceive(uint8_t sysex_byte) {
     sysex_reception_checksum_ = 0;
     sysex_bytes_received_ = 0;
     sysex_reception_state_ = RECEIVING_HEADER;
+    sysex_command_ = 0;
   }
   switch (sysex_reception_state_) {
     case RECEIVING_HEADER:
-      if (pgm_read_byte(sysex_header + sysex_bytes_received_) == sysex_byte) {
+      if (sysex_bytes_received_ == kSysExCommandOffset) {
+        sysex_command_ = sysex_byte;
         ++sysex_bytes_received_;
-        if (sysex_bytes_received_ >= sizeof(sysex_header)) {
-          sysex_reception_state_ = RECEIVING_DATA;
-          sysex_bytes_received_ = 0;
+      } else if (sysex_bytes_received_ == kSysExArgumentOffset) {
+        // Only patch and bank transfers carry data.
+        sysex_reception_state_ = sysex_command_ == SYSEX_COMMAND_PATCH_TRANSFER
+            ? RECEIVING_DATA
+            : RECEIVING_FOOTER;
+        if (sysex_command_ == SYSEX_COMMAND_BANK_TRANSFER) {
+          // The slot can only be queued if the previous writes are done, or
+          // if it directly follows them.
+          sysex_slot_ = sysex_byte;
+          sysex_reception_state_ = sysex_byte < kNumPatchSlots &&
+              EepromWriter::Seek(sysex_byte * kSerializedPatchSize)
+              ? RECEIVING_DATA
+              : RECEPTION_ERROR;
         }
+        sysex_bytes_received_ = 0;
+      } else if (pgm_read_byte(sysex_header + sysex_bytes_received_) ==
+                 sysex_byte) {
+        ++sysex_bytes_received_;
       } else {
+        sysex_command_ = 0;
         sysex_reception_state_ = RECEIVING_FOOTER;
       }
       break;
       
     case RECEIVING_DATA:
-      {
+      if (sysex_command_ == SYSEX_COMMAND_BANK_TRANSFER) {
+        SysExReceiveBankData(sysex_byte);
+      } else {
         uint8_t i = sysex_bytes_received_ >> 1;
         if (sysex_bytes_received_ & 1) {
           load_save_buffer_[i] |= sysex_byte & 0xf;
@@ -178,16 +330,22 @@ void Patch::SysExReceive(uint8_t sysex_byte) {
           load_save_buffer_[i] = ShiftLeft4(sysex_byte);
         }
         ++sysex_bytes_received_;
-        if (sysex_bytes_received_ >= (kSerializedPatchSize + 1) * 2) {
+        if (sysex_bytes_received_ >= kSysExPatchSize) {
           sysex_reception_state_ = RECEIVING_FOOTER;
         }
       }
     break;
     
   case RECEIVING_FOOTER:
-    if (sysex_byte == 0xf7 &&
+    if (sysex_command_ != SYSEX_COMMAND_PATCH_TRANSFER) {
+      // Requests, or slots which have already been checked: there is nothing
+      // to check except that they are well formed.
+      sysex_reception_state_ = sysex_byte == 0xf7 && sysex_command_
+          ? RECEPTION_OK
+          : RECEPTION_ERROR;
+    } else if (sysex_byte == 0xf7 &&
         sysex_reception_checksum_ == load_save_buffer_[kSerializedPatchSize] &&
-        CheckBuffer()) {
+        CheckBuffer(load_save_buffer_)) {
       Unpack(load_save_buffer_);
       sysex_reception_state_ = RECEPTION_OK;
     } else {
@@ -197,6 +355,51 @@ void Patch::SysExReceive(uint8_t sysex_byte) {
   }
 }
 
+/* static */
+void Patch::SysExReceiveBankData(uint8_t sysex_byte) {
+  // A truncated message.
+  if (sysex_byte > 0x0f) {
+    sysex_reception_state_ = RECEPTION_ERROR;
+    return;
+  }
+  if (sysex_bytes_received_ == 0) {
+    // The EEPROM is written much more slowly than the data is received. If the
+    // queue is still busy with the previous slots, the sender is too fast.
+    uint8_t span_size;
+    sysex_slot_buffer_ = EepromWriter::WriteSpan(
+        kSerializedPatchSize,
+        &span_size);
+    if (span_size < kSerializedPatchSize) {
+      sysex_reception_state_ = RECEPTION_ERROR;
+      return;
+    }
+    sysex_reception_checksum_ = 0;
+  }
+  uint8_t i = sysex_bytes_received_ >> 1;
+  uint8_t* destination = i < kSerializedPatchSize
+      ? sysex_slot_buffer_ + i
+      : &sysex_slot_checksum_;
+  if (sysex_bytes_received_ & 1) {
+    *destination |= sysex_byte & 0xf;
+    if (i < kSerializedPatchSize) {
+      sysex_reception_checksum_ += *destination;
+    }
+  } else {
+    *destination = ShiftLeft4(sysex_byte);
+  }
+  ++sysex_bytes_received_;
+  if (sysex_bytes_received_ >= kSysExPatchSize) {
+    if (sysex_reception_checksum_ != sysex_slot_checksum_ ||
+        !CheckBuffer(sysex_slot_buffer_)) {
+      sysex_reception_state_ = RECEPTION_ERROR;
+      return;
+    }
+    EepromWriter::Commit(kSerializedPatchSize);
+    UpdateSlotIndex(sysex_slot_, sysex_slot_buffer_);
+    sysex_reception_state_ = RECEIVING_FOOTER;
+  }
+}
+
 void Patch::Backup() const {
   Pack(undo_buffer_);
 }
@@ -214,10 +417,34 @@ uint8_t Patch::undo_buffer_[kSerializedPatchSize];
 /* static */
 uint8_t Patch::sysex_bytes_received_;
 
+/* static */
+uint8_t Patch::sysex_command_;
+
 /* static */
 uint8_t Patch::sysex_reception_checksum_;
 
 /* static */
 uint8_t Patch::sysex_reception_state_;
 
+/* static */
+uint8_t Patch::sysex_slot_checksum_;
+
+/* static */
+uint8_t* Patch::sysex_slot_buffer_;
+
+/* static */
+uint8_t Patch::sysex_slot_;
+
+/* static */
+uint8_t Patch::bank_dump_slot_ = kNumPatchSlots;
+
+/* static */
+uint8_t Patch::bank_dump_position_;
+
+/* static */
+uint8_t Patch::bank_dump_checksum_;
+
+/* static */
+uint16_t Patch::valid_slots_;
+
 }  // hardware_shruti
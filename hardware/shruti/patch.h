@@ -27,6 +27,8 @@
 #define HARDWARE_SHRUTI_PATCH_H_
 
 #include "hardware/base/base.h"
+#include "hardware/hal/hal.h"
+#include "hardware/shruti/shruti.h"
 
 namespace hardware_shruti {
 
@@ -34,6 +36,8 @@ const uint8_t kPatchNameSize = 8;
 const uint8_t kSerializedPatchSize = 64;
 const uint8_t kModulationMatrixSize = 14;
 const uint8_t kSavedModulationMatrixSize = 10;
+const uint8_t kNumPatchSlots = hardware_hal::kEepromSize /
+    kSerializedPatchSize;
 
 struct Modulation {
   uint8_t source;
@@ -55,6 +59,28 @@ enum SysExReceptionState {
   RECEPTION_ERROR = 4,
 };
 
+enum SysExCommand {
+  SYSEX_COMMAND_PATCH_TRANSFER = 0x01,
+  SYSEX_COMMAND_TASK_PROFILE = 0x02,
+  // One EEPROM slot, followed by its checksum. The argument is the index of
+  // the slot. A bank is sent as one message per slot.
+  SYSEX_COMMAND_BANK_TRANSFER = 0x03,
+  // The argument is the number of records in the log.
+  SYSEX_COMMAND_GLITCH_LOG = 0x04,
+  SYSEX_COMMAND_LATENCY = 0x05,
+  SYSEX_COMMAND_MEMORY_USAGE = 0x06,
+  // The argument is the index of the oldest record.
+  SYSEX_COMMAND_TRACE = 0x07,
+  
+  // Requests, sent to the unit without data.
+  SYSEX_COMMAND_TASK_PROFILE_REQUEST = 0x12,
+  SYSEX_COMMAND_BANK_REQUEST = 0x13,
+  SYSEX_COMMAND_GLITCH_LOG_REQUEST = 0x14,
+  SYSEX_COMMAND_LATENCY_REQUEST = 0x15,
+  SYSEX_COMMAND_MEMORY_USAGE_REQUEST = 0x16,
+  SYSEX_COMMAND_TRACE_REQUEST = 0x17,
+};
+
 class Patch {
  public:
   uint8_t keep_me_at_the_top;
@@ -123,19 +149,65 @@ class Patch {
   // Set the value of a step in the sequence.
   void set_sequence_step(uint8_t step, uint8_t value);
 
+  // The patch is written in the background, and is fully saved once
+  // EepromWriter::busy() returns 0.
   void EepromSave(uint8_t slot) const;
   void EepromLoad(uint8_t slot);
+  // Loads a slot known to hold a valid patch, without any check. Returns 0,
+  // leaving the patch untouched, if the slot is not in the directory.
+  uint8_t EepromRecall(uint8_t slot);
+#ifdef HAS_EXTERNAL_EEPROM
+  // Same as EepromLoad/EepromSave, for the slots of the external library.
+  // The load is done in the background: LibraryLoad returns 0 if the library
+  // is busy, then LibraryLoadPoll returns a LibraryReadStatus, and leaves the
+  // patch untouched if the read failed. LibrarySave returns 0 on failure.
+  uint8_t LibraryLoad(uint16_t slot);
+  uint8_t LibraryLoadPoll();
+  uint8_t LibrarySave(uint16_t slot) const;
+#endif  // HAS_EXTERNAL_EEPROM
   void SysExSend() const;
   void SysExReceive(uint8_t sysex_byte);
+  // Starts a dump of the content of all the EEPROM slots. The messages are
+  // written by SysExSendBankTick() - called from a low priority task - only
+  // as long as there is room in the MIDI output, so that the dump of about
+  // 2k bytes does not block the audio rendering.
+  static void SysExSendBank();
+  static void SysExSendBankTick();
+
+  // Validates each EEPROM slot. Called once at boot, the directory is then
+  // kept up to date when slots are written.
+  static void IndexEepromSlots();
+  static inline uint8_t slot_valid(uint8_t slot) {
+    return (valid_slots_ >> slot) & 1;
+  }
   void Backup() const;
   void Restore();
   
   inline uint8_t sysex_reception_state() const {
     return sysex_reception_state_;
   }
+  // Command of the last received SysEx message, 0 if it was not for us.
+  inline uint8_t sysex_command() const {
+    return sysex_command_;
+  }
+  
+  // Sends a message with the Shruti-1 header, and the data in nibblized form
+  // followed by a checksum.
+  static void SysExSendMessage(
+      uint8_t command,
+      uint8_t argument,
+      const uint8_t* data,
+      uint8_t size);
 
  private:
-  static uint8_t CheckBuffer() __attribute__((noinline));
+  static uint8_t CheckBuffer(const uint8_t* patch_buffer)
+      __attribute__((noinline));
+  // Bank transfers: the slots are received directly in the EEPROM write queue,
+  // and committed once their checksum has been verified. Writing a slot takes
+  // about 210ms, and the queue cannot hold a second one, so the sender has to
+  // wait for about 250ms after each message.
+  static void SysExReceiveBankData(uint8_t sysex_byte);
+  static void UpdateSlotIndex(uint8_t slot, const uint8_t* patch_buffer);
   void Pack(uint8_t* patch_buffer) const;
   void Unpack(const uint8_t* patch_buffer);
   
@@ -147,8 +219,20 @@ class Patch {
   static uint8_t undo_buffer_[kSerializedPatchSize];
   
   static uint8_t sysex_bytes_received_;
+  static uint8_t sysex_command_;
   static uint8_t sysex_reception_state_;
   static uint8_t sysex_reception_checksum_;
+  static uint8_t sysex_slot_checksum_;
+  static uint8_t* sysex_slot_buffer_;
+  static uint8_t sysex_slot_;
+
+  // Slot being dumped (kNumPatchSlots when idle), and position in its message.
+  static uint8_t bank_dump_slot_;
+  static uint8_t bank_dump_position_;
+  static uint8_t bank_dump_checksum_;
+
+  // Directory of the EEPROM slots: one bit per slot holding a valid patch.
+  static uint16_t valid_slots_;
 };
 
 static const uint8_t kNumModulationSources = 16;
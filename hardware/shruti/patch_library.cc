@@ -0,0 +1,131 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Patch library stored on external I2C EEPROMs.
+
+#include "hardware/shruti/patch_library.h"
+
+#ifdef HAS_EXTERNAL_EEPROM
+
+#include "hardware/hal/devices/external_eeprom.h"
+
+using namespace hardware_hal;
+
+namespace hardware_shruti {
+
+// The input buffer can hold a whole patch, so that it is read in a single
+// transaction. The output buffer holds a page write of 32 bytes, and the
+// 2 address bytes.
+typedef I2cMaster<128, 64> LibraryBus;
+typedef ExternalEeprom<kLibraryChipSize, LibraryBus> LibraryEeprom;
+
+static const uint8_t kPageWriteSize = 32;
+
+// While a page is being written - for about 5ms - the chip does not
+// acknowledge its address, so writes are retried.
+static const uint8_t kMaxWriteAttempts = 255;
+
+/* static */
+void PatchLibrary::Init() {
+  LibraryEeprom::Init();
+}
+
+/* static */
+uint8_t PatchLibrary::StartRead(uint16_t slot) {
+  if (slot >= kNumLibrarySlots) {
+    return 0;
+  }
+  return LibraryEeprom::StartRead(
+      slot * kSerializedPatchSize,
+      kSerializedPatchSize);
+}
+
+/* static */
+uint8_t PatchLibrary::PollRead(uint8_t* buffer) {
+  switch (LibraryEeprom::PollRead(buffer)) {
+    case EEPROM_READ_PENDING:
+      return LIBRARY_READ_PENDING;
+    case EEPROM_READ_DONE:
+      return LIBRARY_READ_DONE;
+    default:
+      return LIBRARY_READ_FAILED;
+  }
+}
+
+/* static */
+uint8_t PatchLibrary::reading() {
+  return LibraryEeprom::reading();
+}
+
+/* static */
+uint8_t PatchLibrary::Write(uint16_t slot, const uint8_t* patch_buffer) {
+  if (slot >= kNumLibrarySlots) {
+    return 0;
+  }
+  uint16_t address = slot * kSerializedPatchSize;
+  for (uint8_t i = 0; i < kSerializedPatchSize; i += kPageWriteSize) {
+    uint8_t attempts = kMaxWriteAttempts;
+    while (!LibraryEeprom::Write(address + i, patch_buffer + i,
+                                 kPageWriteSize)) {
+      LibraryBus::Output::Flush();
+      if (--attempts == 0) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+#ifdef HAS_PATTERN_BANK
+
+static const uint16_t kPatternBankAddress = kNumLibrarySlots *
+    kSerializedPatchSize;
+
+/* static */
+uint8_t PatchLibrary::StartReadPattern(uint8_t pattern) {
+  if (pattern >= kNumPatterns) {
+    return 0;
+  }
+  return LibraryEeprom::StartRead(
+      kPatternBankAddress + pattern * kSerializedPatternSize,
+      kSerializedPatternSize);
+}
+
+/* static */
+uint8_t PatchLibrary::WritePattern(
+    uint8_t pattern,
+    const uint8_t* pattern_buffer) {
+  if (pattern >= kNumPatterns) {
+    return 0;
+  }
+  uint16_t address = kPatternBankAddress + pattern * kSerializedPatternSize;
+  uint8_t attempts = kMaxWriteAttempts;
+  while (!LibraryEeprom::Write(address, pattern_buffer,
+                               kSerializedPatternSize)) {
+    LibraryBus::Output::Flush();
+    if (--attempts == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+#endif  // HAS_PATTERN_BANK
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_EXTERNAL_EEPROM
@@ -0,0 +1,93 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Patch library stored on external I2C EEPROMs.
+//
+// Each slot holds a serialized patch - including its step sequence - and
+// starts on a 64-byte boundary. A slot is read in a single I2C transaction,
+// and written as two 32-byte page writes, so the same layout works with chips
+// with 32 or 64-byte pages.
+//
+// Reads are done in the background, so that the audio rendering goes on while
+// the data is transferred: a read is started, then polled - from a task - until
+// it is complete. Writes block, but the read in progress, if any, is not lost.
+
+#ifndef HARDWARE_SHRUTI_PATCH_LIBRARY_H_
+#define HARDWARE_SHRUTI_PATCH_LIBRARY_H_
+
+#include "hardware/shruti/shruti.h"
+
+#include "hardware/shruti/patch.h"
+
+#ifdef HAS_EXTERNAL_EEPROM
+
+namespace hardware_shruti {
+
+static const uint16_t kLibraryChipSize = 16384;
+static const uint8_t kNumLibraryChips = 2;
+#ifdef HAS_PATTERN_BANK
+// The last slots of the library hold the pattern bank.
+static const uint8_t kSerializedPatternSize = 16;
+static const uint8_t kNumPatterns = 32;
+static const uint16_t kNumLibrarySlots = kLibraryChipSize /
+    kSerializedPatchSize * kNumLibraryChips -
+    kNumPatterns * kSerializedPatternSize / kSerializedPatchSize;
+#else
+static const uint16_t kNumLibrarySlots = kLibraryChipSize /
+    kSerializedPatchSize * kNumLibraryChips;
+#endif  // HAS_PATTERN_BANK
+
+enum LibraryReadStatus {
+  LIBRARY_READ_PENDING,
+  LIBRARY_READ_DONE,
+  LIBRARY_READ_FAILED
+};
+
+class PatchLibrary {
+ public:
+  PatchLibrary() { }
+
+  static void Init();
+
+  // Both return 0 if the slot is out of range, or if the bus is busy - in
+  // which case the read can be started again later.
+  static uint8_t StartRead(uint16_t slot);
+#ifdef HAS_PATTERN_BANK
+  static uint8_t StartReadPattern(uint8_t pattern);
+#endif  // HAS_PATTERN_BANK
+  // Returns a LibraryReadStatus. The buffer, large enough for a patch or a
+  // pattern, is filled once the read is done.
+  static uint8_t PollRead(uint8_t* buffer);
+  static uint8_t reading();
+
+  // Returns 0 if the chip did not answer, or if the slot is out of range.
+  static uint8_t Write(uint16_t slot, const uint8_t* patch_buffer);
+#ifdef HAS_PATTERN_BANK
+  // Patterns never cross a page boundary, so each is written in a single page
+  // write.
+  static uint8_t WritePattern(uint8_t pattern, const uint8_t* pattern_buffer);
+#endif  // HAS_PATTERN_BANK
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(PatchLibrary);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_EXTERNAL_EEPROM
+
+#endif  // HARDWARE_SHRUTI_PATCH_LIBRARY_H_
@@ -25,7 +25,7 @@
 
 namespace hardware_shruti {
 
-static const prog_char raw_parameter_definition[
+static const prog_uint8_t raw_parameter_definition[
     kNumEditableParameters * sizeof(ParameterDefinition)] PROGMEM = {
   // Osc 1.
   PRM_OSC_SHAPE_1,
@@ -39,7 +39,7 @@ static const prog_char raw_parameter_definition[
   STR_RES_PRM, STR_RES_PARAMETER,
 
   PRM_OSC_RANGE_1,
-  -12, 12,
+  uint8_t(-12), 12,
   UNIT_INT8,
   STR_RES_RNG, STR_RES_RANGE,
 
@@ -60,7 +60,7 @@ static const prog_char raw_parameter_definition[
   STR_RES_PRM, STR_RES_PARAMETER,
 
   PRM_OSC_RANGE_2,
-  -24, 24, 
+  uint8_t(-24), 24,
   UNIT_INT8,
   STR_RES_RNG, STR_RES_RANGE,
 
@@ -191,7 +191,7 @@ static const prog_char raw_parameter_definition[
   STR_RES_DST, STR_RES_DEST_,
 
   PRM_MOD_AMOUNT,
-  -63, 63,
+  uint8_t(-63), 63,
   UNIT_INT8,
   STR_RES_AMT, STR_RES_AMOUNT,
 
@@ -218,7 +218,7 @@ static const prog_char raw_parameter_definition[
 
   // Keyboard settings.
   PRM_KBD_OCTAVE,
-  -2, +2,
+  uint8_t(-2), +2,
   UNIT_INT8,
   STR_RES_OCTAVE, STR_RES_OCTAVE,
 
@@ -228,7 +228,7 @@ static const prog_char raw_parameter_definition[
   STR_RES_RAGA, STR_RES_RAGA,
 
   PRM_KBD_PORTAMENTO,
-  -63, 63,
+  uint8_t(-63), 63,
   UNIT_INT8,
   STR_RES_PRT, STR_RES_PORTA,
 
@@ -248,6 +248,61 @@ static const prog_char raw_parameter_definition[
   STR_RES_LENGTH, STR_RES_LENGTH
 };
 
+// For each parameter assigned to a controller: its id, minimum value and range
+// (max - min + 1, or 0 for the UNIT_RAW_UINT8 parameters, which are not
+// scaled). Must be kept in sync with the first kNumControlledParameters
+// definitions above.
+static const uint8_t kControlledParameterRecordSize = 3;
+
+static const prog_uint8_t controlled_parameter_scaling[
+    kNumControlledParameters * kControlledParameterRecordSize] PROGMEM = {
+  PRM_OSC_SHAPE_1,
+  WAVEFORM_NONE, WAVEFORM_QUAD_SAW_PAD - WAVEFORM_NONE + 1,
+  PRM_OSC_PARAMETER_1, 0, 0,
+  PRM_OSC_RANGE_1, uint8_t(-12), 12 - (-12) + 1,
+  PRM_OSC_OPTION_1, SUM, XOR - SUM + 1,
+
+  PRM_OSC_SHAPE_2,
+  WAVEFORM_IMPULSE_TRAIN, WAVEFORM_TRIANGLE - WAVEFORM_IMPULSE_TRAIN + 1,
+  PRM_OSC_PARAMETER_2, 0, 0,
+  PRM_OSC_RANGE_2, uint8_t(-24), 24 - (-24) + 1,
+  PRM_OSC_OPTION_2, 0, 0,
+
+  PRM_MIX_BALANCE, 0, 64,
+  PRM_MIX_SUB_OSC, 0, 64,
+  PRM_MIX_NOISE, 0, 64,
+  PRM_MIX_SUB_OSC_SHAPE,
+  WAVEFORM_SQUARE, WAVEFORM_TRIANGLE - WAVEFORM_SQUARE + 1,
+
+  PRM_FILTER_CUTOFF, 0, 0,
+  PRM_FILTER_RESONANCE, 0, 64,
+  PRM_FILTER_ENV, 0, 64,
+  PRM_FILTER_LFO, 0, 64,
+
+  PRM_ENV_ATTACK_1, 0, 0,
+  PRM_ENV_DECAY_1, 0, 0,
+  PRM_ENV_SUSTAIN_1, 0, 0,
+  PRM_ENV_RELEASE_1, 0, 0,
+
+  PRM_ENV_ATTACK_2, 0, 0,
+  PRM_ENV_DECAY_2, 0, 0,
+  PRM_ENV_SUSTAIN_2, 0, 0,
+  PRM_ENV_RELEASE_2, 0, 0,
+
+  PRM_LFO_WAVE_1,
+  LFO_WAVEFORM_TRIANGLE,
+  LFO_WAVEFORM_STEP_SEQUENCER - LFO_WAVEFORM_TRIANGLE + 1,
+  PRM_LFO_RATE_1, 0, 127 + 16 + 1,
+  PRM_LFO_WAVE_2,
+  LFO_WAVEFORM_TRIANGLE,
+  LFO_WAVEFORM_STEP_SEQUENCER - LFO_WAVEFORM_TRIANGLE + 1,
+  PRM_LFO_RATE_2, 0, 127 + 16 + 1,
+
+  PRM_MOD_ROW, 0, kModulationMatrixSize,
+  PRM_MOD_SOURCE, 0, kNumModulationSources,
+  PRM_MOD_DESTINATION, 0, kNumModulationDestinations
+};
+
 /* static */
 ParameterDefinition PatchMetadata::parameter_definition_;
 
@@ -281,4 +336,24 @@ uint8_t PatchMetadata::Scale(
   return scaled_value;
 }
 
+/* static */
+uint8_t PatchMetadata::controlled_parameter(uint8_t controller) {
+  return pgm_read_byte(
+      controlled_parameter_scaling +
+      controller * kControlledParameterRecordSize);
+}
+
+/* static */
+uint8_t PatchMetadata::ScaleControllerValue(
+    uint8_t controller,
+    uint8_t value_7bits) {
+  const prog_uint8_t* record = controlled_parameter_scaling +
+      controller * kControlledParameterRecordSize;
+  uint8_t range = pgm_read_byte(record + 2);
+  if (!range) {
+    return value_7bits;
+  }
+  return ((value_7bits * range) >> 7) + pgm_read_byte(record + 1);
+}
+
 }  // hardware_shruti
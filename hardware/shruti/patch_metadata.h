@@ -56,12 +56,22 @@ struct ParameterDefinition {
   ResourceId long_name;
 };
 
+// The first parameters are assigned to CC 16 to 31, then CC 102 to 116.
+static const uint8_t kNumControlledParameters = 31;
+
 class PatchMetadata {
  public:
   PatchMetadata() { }
   static const ParameterDefinition& parameter_definition(uint8_t index);
   static uint8_t Scale(const ParameterDefinition& parameter, uint8_t value);
   
+  // Same as parameter_definition(controller).id, and as Scale() applied to
+  // this definition, from a table holding only the id and scaling of the
+  // parameters assigned to a controller - so that a controller change does not
+  // copy a whole definition out of flash.
+  static uint8_t controlled_parameter(uint8_t controller);
+  static uint8_t ScaleControllerValue(uint8_t controller, uint8_t value_7bits);
+  
  private:
   static ParameterDefinition parameter_definition_;
   static uint8_t parameter_definition_index_;
@@ -0,0 +1,152 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Bank of step sequencer patterns stored on the external EEPROM.
+
+#include "hardware/shruti/pattern_bank.h"
+
+#ifdef HAS_PATTERN_BANK
+
+#include <string.h>
+
+namespace hardware_shruti {
+
+/* <static> */
+Pattern PatternBank::buffer_;
+uint8_t PatternBank::buffered_;
+uint8_t PatternBank::buffer_valid_;
+uint8_t PatternBank::reading_;
+uint8_t PatternBank::current_;
+uint8_t PatternBank::repeats_left_;
+uint8_t PatternBank::switch_requested_;
+uint8_t PatternBank::song_mode_;
+uint8_t PatternBank::next_;
+uint8_t PatternBank::repeats_;
+/* </static> */
+
+/* static */
+void PatternBank::Init() {
+  buffered_ = kNoPattern;
+  buffer_valid_ = 0;
+  reading_ = kNoPattern;
+  current_ = kNoPattern;
+  repeats_left_ = 0;
+  switch_requested_ = 0;
+  song_mode_ = 0;
+  next_ = kNoPattern;
+  repeats_ = 0;
+}
+
+/* static */
+void PatternBank::Select(uint8_t pattern) {
+  if (pattern >= kNumPatterns) {
+    return;
+  }
+  if (pattern != buffered_) {
+    buffered_ = pattern;
+    buffer_valid_ = 0;
+  }
+  switch_requested_ = 1;
+}
+
+/* static */
+uint8_t PatternBank::Store(uint8_t pattern, const Patch& patch) {
+  Pattern record;
+  memcpy(record.sequence, patch.sequence, sizeof(record.sequence));
+  record.arp_pattern = patch.arp_pattern;
+  record.pattern_size = patch.pattern_size;
+  record.next = next_;
+  record.repeats = repeats_;
+  memset(record.padding, 0, sizeof(record.padding));
+  if (!PatchLibrary::WritePattern(
+          pattern,
+          reinterpret_cast<const uint8_t*>(&record))) {
+    return 0;
+  }
+  // Do not play a stale copy of the pattern.
+  if (pattern == buffered_) {
+    buffer_valid_ = 0;
+  }
+  if (pattern == reading_) {
+    reading_ |= kStaleRead;
+  }
+  return 1;
+}
+
+/* static */
+void PatternBank::Tick() {
+  if (reading_ != kNoPattern) {
+    uint8_t status = PatchLibrary::PollRead(
+        reinterpret_cast<uint8_t*>(&buffer_));
+    if (status == LIBRARY_READ_PENDING) {
+      return;
+    }
+    uint8_t pattern = reading_;
+    reading_ = kNoPattern;
+    // Another pattern has been selected, or this one overwritten, in the
+    // meantime: it is read again on the next call.
+    if (pattern != buffered_) {
+      return;
+    }
+    if (status == LIBRARY_READ_DONE &&
+        buffer_.pattern_size >= 1 && buffer_.pattern_size <= 16) {
+      buffer_valid_ = 1;
+    } else {
+      // Unreadable or blank pattern.
+      buffered_ = kNoPattern;
+      switch_requested_ = 0;
+    }
+    return;
+  }
+  if (buffered_ == kNoPattern || buffer_valid_) {
+    return;
+  }
+  // Retried on the next call if the library is busy.
+  if (PatchLibrary::StartReadPattern(buffered_)) {
+    reading_ = buffered_;
+  }
+}
+
+/* static */
+const Pattern* PatternBank::Downbeat() {
+  if (!switch_requested_) {
+    if (!song_mode_ || current_ == kNoPattern) {
+      return NULL;
+    }
+    if (repeats_left_) {
+      --repeats_left_;
+      return NULL;
+    }
+  }
+  if (buffered_ == kNoPattern || !buffer_valid_) {
+    return NULL;
+  }
+  current_ = buffered_;
+  repeats_left_ = buffer_.repeats;
+  switch_requested_ = 0;
+  // The buffer holds the new pattern until the next call to Tick(), which
+  // reads the pattern it is chained to.
+  if (buffer_.next != current_) {
+    buffered_ = buffer_.next < kNumPatterns ? buffer_.next : kNoPattern;
+    buffer_valid_ = 0;
+  }
+  return &buffer_;
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_PATTERN_BANK
@@ -0,0 +1,115 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Bank of step sequencer patterns stored on the external EEPROM.
+//
+// A pattern holds the 16 steps of the sequence, the rhythm and length of the
+// arpeggiator pattern, and the pattern to chain to once it has been played
+// 1 + repeats times. The pattern to play next is read into RAM by Tick(),
+// called from a low priority task, so that the switch - which only takes
+// place on the first step - copies it from memory. If it has not been read by
+// then, the current pattern is played once more.
+//
+// In song mode, the patterns follow their chain. Otherwise, the current
+// pattern loops until another one is selected.
+
+#ifndef HARDWARE_SHRUTI_PATTERN_BANK_H_
+#define HARDWARE_SHRUTI_PATTERN_BANK_H_
+
+#include "hardware/shruti/shruti.h"
+
+#include "hardware/shruti/patch_library.h"
+
+#ifdef HAS_PATTERN_BANK
+
+namespace hardware_shruti {
+
+// Controllers in the undefined range.
+const uint8_t kPatternSelect = 0x55;
+const uint8_t kPatternStore = 0x56;
+const uint8_t kPatternChainNext = 0x57;
+const uint8_t kPatternChainRepeats = 0x58;
+const uint8_t kPatternSongMode = 0x59;
+
+// Value of next marking the end of a chain: the pattern loops.
+const uint8_t kNoPattern = 0xff;
+
+// Set in the index of the pattern being read when it is overwritten before the
+// end of the read.
+const uint8_t kStaleRead = 0x80;
+
+struct Pattern {
+  uint8_t sequence[8];
+  uint8_t arp_pattern;
+  uint8_t pattern_size;
+  uint8_t next;
+  uint8_t repeats;
+  uint8_t padding[4];
+};
+
+class PatternBank {
+ public:
+  PatternBank() { }
+
+  static void Init();
+
+  // Queues a pattern change for the next first step.
+  static void Select(uint8_t pattern);
+
+  // Writes the sequence and arpeggiator pattern of a patch to the bank, with
+  // the chaining settings set by set_next/set_repeats. Blocks for the duration
+  // of the I2C transaction. Returns 0 on failure.
+  static uint8_t Store(uint8_t pattern, const Patch& patch);
+
+  static void set_next(uint8_t next) { next_ = next; }
+  static void set_repeats(uint8_t repeats) { repeats_ = repeats; }
+  static void set_song_mode(uint8_t song_mode) { song_mode_ = song_mode; }
+
+  // Reads the pattern to play next, if it is not in RAM yet. The read takes
+  // several calls.
+  static void Tick();
+
+  // To be called on the first step of the sequence. Returns the pattern to
+  // switch to, or NULL if the current pattern keeps playing.
+  static const Pattern* Downbeat();
+
+  static inline uint8_t current() { return current_; }
+
+ private:
+  static Pattern buffer_;
+  // Index of the pattern held, or to be read, in buffer_.
+  static uint8_t buffered_;
+  static uint8_t buffer_valid_;
+  // Index of the pattern being read from the library, or kNoPattern.
+  static uint8_t reading_;
+  static uint8_t current_;
+  static uint8_t repeats_left_;
+  static uint8_t switch_requested_;
+  static uint8_t song_mode_;
+
+  // Chaining settings of the next stored pattern.
+  static uint8_t next_;
+  static uint8_t repeats_;
+
+  DISALLOW_COPY_AND_ASSIGN(PatternBank);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_PATTERN_BANK
+
+#endif  // HARDWARE_SHRUTI_PATTERN_BANK_H_
@@ -0,0 +1,49 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Table of oscillator phase increments, computed at compile time.
+
+#include "hardware/shruti/pitch_table.h"
+
+namespace hardware_shruti {
+
+#define INCREMENT(i) OscillatorIncrement<(i)>::value
+#define INCREMENTS_4(i) \
+    INCREMENT(i), INCREMENT(i + 1), INCREMENT(i + 2), INCREMENT(i + 3)
+#define INCREMENTS_16(i) \
+    INCREMENTS_4(i), INCREMENTS_4(i + 4), INCREMENTS_4(i + 8), \
+    INCREMENTS_4(i + 12)
+#define INCREMENTS_64(i) \
+    INCREMENTS_16(i), INCREMENTS_16(i + 16), INCREMENTS_16(i + 32), \
+    INCREMENTS_16(i + 48)
+#define INCREMENTS_256(i) \
+    INCREMENTS_64(i), INCREMENTS_64(i + 64), INCREMENTS_64(i + 128), \
+    INCREMENTS_64(i + 192)
+
+const prog_uint16_t oscillator_increments[] PROGMEM = {
+  INCREMENTS_256(0),
+  INCREMENTS_256(256),
+  INCREMENTS_256(512)
+};
+
+#undef INCREMENTS_256
+#undef INCREMENTS_64
+#undef INCREMENTS_16
+#undef INCREMENTS_4
+#undef INCREMENT
+
+}  // namespace hardware_shruti
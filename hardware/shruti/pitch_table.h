@@ -0,0 +1,80 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Table of oscillator phase increments, computed at compile time.
+//
+// The table covers the highest octave, from C7, with one entry every 2/128th
+// of semitone. It depends on kSampleRate and kA4Pitch only, so it follows the
+// build settings without running "make resources". Without constexpr, the
+// values are computed by templates, in 2.30 fixed point: 2^(x / 1536) is the
+// product of the powers 2^(2^b / 1536) of the bits b set in x.
+
+#ifndef HARDWARE_SHRUTI_PITCH_TABLE_H_
+#define HARDWARE_SHRUTI_PITCH_TABLE_H_
+
+#include "hardware/shruti/shruti.h"
+
+#include <avr/pgmspace.h>
+
+namespace hardware_shruti {
+
+static const uint16_t kA4Pitch = 440;  // Hz
+static const uint16_t kPitchTableSize = 12 * 64;
+
+extern const prog_uint16_t oscillator_increments[] PROGMEM;
+
+// 2^(2^bit / 1536).
+template<uint8_t bit> struct Exp2Step { };
+template<> struct Exp2Step<0> { static const uint32_t value = 1074226478UL; };
+template<> struct Exp2Step<1> { static const uint32_t value = 1074711351UL; };
+template<> struct Exp2Step<2> { static const uint32_t value = 1075681754UL; };
+template<> struct Exp2Step<3> { static const uint32_t value = 1077625190UL; };
+template<> struct Exp2Step<4> { static const uint32_t value = 1081522600UL; };
+template<> struct Exp2Step<5> { static const uint32_t value = 1089359758UL; };
+template<> struct Exp2Step<6> { static const uint32_t value = 1105204861UL; };
+template<> struct Exp2Step<7> { static const uint32_t value = 1137589835UL; };
+template<> struct Exp2Step<8> { static const uint32_t value = 1205234447UL; };
+template<> struct Exp2Step<9> { static const uint32_t value = 1352829926UL; };
+template<> struct Exp2Step<10> { static const uint32_t value = 1704458901UL; };
+
+// 2^(x / 1536), for x < 2048.
+template<uint16_t x, uint8_t bit = 0>
+struct Exp2 {
+  static const uint64_t next = Exp2<x, bit + 1>::value;
+  static const uint32_t value = (x >> bit) & 1 ?
+      static_cast<uint32_t>(
+          (next * Exp2Step<bit>::value + (1UL << 29)) >> 30) :
+      static_cast<uint32_t>(next);
+};
+
+template<uint16_t x>
+struct Exp2<x, 11> {
+  static const uint32_t value = 1UL << 30;
+};
+
+// Entry i is the pitch 96 * 128 + 2 * i, in 1/128th of semitones - 2 octaves
+// and (384 + 2 * i) / 1536 octave above A4.
+template<uint16_t i>
+struct OscillatorIncrement {
+  static const uint16_t value = static_cast<uint16_t>(
+      65536ULL * kA4Pitch * 4 * Exp2<384 + 2 * i>::value /
+      (static_cast<uint64_t>(kSampleRate) << 30));
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HARDWARE_SHRUTI_PITCH_TABLE_H_
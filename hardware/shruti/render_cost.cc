@@ -0,0 +1,142 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Render cost calibration.
+
+#include "hardware/shruti/render_cost.h"
+
+#ifdef HAS_RENDER_COST_CALIBRATION
+
+#include "hardware/hal/cycle_counter.h"
+#include "hardware/shruti/synthesis_engine.h"
+#include "hardware/shruti/oscillator.h"
+
+using hardware_hal::CycleCounter;
+
+namespace hardware_shruti {
+
+// Timer 2 runs the audio interrupt, which ticks this counter.
+typedef CycleCounter<2> Clock;
+
+// A multiple of 4 - so that all the phases of the oscillator decimation counter
+// are equally represented - and of kAudioBlockSize.
+static const uint8_t kNumCalibrationSamples = 64;
+static const uint8_t kNumCalibrationBlocks = 8;
+
+// Middle C, and a "parameter" value which does not select any special case
+// in the oscillator code (like the pulse width of 0 for the square).
+static const uint8_t kCalibrationNote = 60;
+static const uint8_t kCalibrationParameter = 64;
+static const uint16_t kCalibrationIncrement = 549;
+
+/* <static> */
+uint16_t RenderCost::osc_1_cost_[WAVEFORM_QUAD_SAW_PAD + 1];
+uint16_t RenderCost::osc_2_cost_[WAVEFORM_TRIANGLE + 1];
+uint16_t RenderCost::sub_osc_cost_;
+uint16_t RenderCost::mix_cost_[XOR + 1];
+uint16_t RenderCost::control_cost_;
+/* </static> */
+
+// Renders the oscillator in its current state. The few cycles of loop overhead
+// are included in the result.
+/* static */
+template<typename OscillatorType>
+uint16_t RenderCost::TimeRender() {
+  Clock::Timestamp start;
+  Clock::Read(&start);
+  for (uint8_t i = 0; i < kNumCalibrationSamples; ++i) {
+    SynthesisEngine::oscillator_decimation_ = i & 3;
+    OscillatorType::Render();
+  }
+  return Clock::Elapsed(start) / kNumCalibrationSamples;
+}
+
+/* static */
+template<typename OscillatorType>
+uint16_t RenderCost::MeasureRender(uint8_t shape) {
+  OscillatorType::SetupAlgorithm(shape);
+  OscillatorType::Update(
+      kCalibrationParameter,
+      kCalibrationNote,
+      kCalibrationIncrement);
+  return TimeRender<OscillatorType>();
+}
+
+/* static */
+uint16_t RenderCost::MeasureAudio(uint8_t op) {
+  engine.SetParameter(PRM_OSC_OPTION_1, op);
+  AudioSample block[kAudioBlockSize];
+  Clock::Timestamp start;
+  Clock::Read(&start);
+  for (uint8_t i = 0; i < kNumCalibrationSamples; i += kAudioBlockSize) {
+    engine.AudioBlock(block);
+  }
+  uint16_t cost = Clock::Elapsed(start) / kNumCalibrationSamples;
+  // Remove the share of the two main oscillators, rendered in the same state.
+  uint16_t oscillators_cost = TimeRender<Oscillator<1, FULL> >() +
+      TimeRender<Oscillator<2, LOW_COMPLEXITY> >();
+  return cost > oscillators_cost ? cost - oscillators_cost : 0;
+}
+
+/* static */
+void RenderCost::Calibrate() {
+  for (uint8_t shape = 0; shape <= WAVEFORM_QUAD_SAW_PAD; ++shape) {
+    osc_1_cost_[shape] = MeasureRender<Oscillator<1, FULL> >(shape);
+  }
+  for (uint8_t shape = 0; shape <= WAVEFORM_TRIANGLE; ++shape) {
+    osc_2_cost_[shape] = MeasureRender<Oscillator<2, LOW_COMPLEXITY> >(shape);
+  }
+  sub_osc_cost_ = MeasureRender<Oscillator<3, SUB_OSCILLATOR> >(
+      WAVEFORM_SQUARE);
+
+  // Put the oscillators back in the state of the default patch.
+  engine.ResetPatch();
+  Clock::Timestamp start;
+  Clock::Read(&start);
+  for (uint8_t i = 0; i < kNumCalibrationBlocks; ++i) {
+    engine.Control();
+  }
+  control_cost_ = Clock::Elapsed(start) / (
+      kNumCalibrationBlocks * kControlRate);
+
+  for (uint8_t op = SUM; op <= XOR; ++op) {
+    mix_cost_[op] = MeasureAudio(op);
+  }
+  engine.ResetPatch();
+}
+
+/* static */
+uint16_t RenderCost::patch_cost(const Patch& patch) {
+  return osc_1_cost_[patch.osc_shape[0]] +
+      osc_2_cost_[patch.osc_shape[1]] +
+      mix_cost_[patch.osc_option[0]] +
+      control_cost_;
+}
+
+/* static */
+uint8_t RenderCost::load(const Patch& patch) {
+  uint16_t cost = patch_cost(patch);
+  // Capped so that it fits on 3 digits.
+  if (cost >= kSampleCycleBudget * 2) {
+    return 199;
+  }
+  return static_cast<uint32_t>(cost) * 100 / kSampleCycleBudget;
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_RENDER_COST_CALIBRATION
@@ -0,0 +1,87 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Table of the number of cycles spent in each oscillator algorithm, measured
+// at boot time. Used to estimate, for a given patch, the fraction of the CPU
+// taken by audio rendering - and whether the audio buffer is likely to
+// underrun.
+//
+// The costs are measured with the audio interrupt running, so they include the
+// share of time it steals. This overestimates the raw cost of the algorithms,
+// but a load of 100% really corresponds to the point where rendering can no
+// longer keep up with the audio interrupt.
+
+#ifndef HARDWARE_SHRUTI_RENDER_COST_H_
+#define HARDWARE_SHRUTI_RENDER_COST_H_
+
+#include "hardware/shruti/shruti.h"
+
+#include "hardware/shruti/patch.h"
+
+namespace hardware_shruti {
+
+// Number of cycles available for rendering a sample.
+static const uint16_t kSampleCycleBudget = F_CPU / kSampleRate;
+
+class RenderCost {
+ public:
+  RenderCost() { }
+
+  // Renders each algorithm of each oscillator for a few samples, measuring the
+  // time spent. Must be called once the audio interrupt is running, and before
+  // any note is played. Resets the patch.
+  static void Calibrate();
+
+  // Average number of cycles per Render() call.
+  static inline uint16_t osc_1(uint8_t shape) { return osc_1_cost_[shape]; }
+  static inline uint16_t osc_2(uint8_t shape) { return osc_2_cost_[shape]; }
+  static inline uint16_t sub_osc() { return sub_osc_cost_; }
+
+  // Average number of cycles per sample rendered by
+  // SynthesisEngine::AudioBlock(), not counted in the two main oscillators:
+  // operator, mixer, sub oscillator and noise.
+  static inline uint16_t mix(uint8_t op) { return mix_cost_[op]; }
+
+  // Number of cycles per sample spent in SynthesisEngine::Control() with the
+  // default patch, amortized over a block.
+  static inline uint16_t control() { return control_cost_; }
+
+  // Estimated number of cycles needed to render one sample of a patch, and
+  // corresponding percentage of kSampleCycleBudget.
+  static uint16_t patch_cost(const Patch& patch);
+  static uint8_t load(const Patch& patch);
+
+ private:
+  template<typename OscillatorType>
+  static uint16_t TimeRender();
+  template<typename OscillatorType>
+  static uint16_t MeasureRender(uint8_t shape);
+
+  static uint16_t MeasureAudio(uint8_t op);
+
+  static uint16_t osc_1_cost_[WAVEFORM_QUAD_SAW_PAD + 1];
+  static uint16_t osc_2_cost_[WAVEFORM_TRIANGLE + 1];
+  static uint16_t sub_osc_cost_;
+  static uint16_t mix_cost_[XOR + 1];
+  static uint16_t control_cost_;
+
+  DISALLOW_COPY_AND_ASSIGN(RenderCost);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HARDWARE_SHRUTI_RENDER_COST_H_
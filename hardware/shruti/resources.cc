@@ -25,397 +25,329 @@
 
 namespace hardware_shruti {
 
-static const prog_char str_res_prm[] PROGMEM = "prm";
-static const prog_char str_res_rng[] PROGMEM = "rng";
-static const prog_char str_res_op[] PROGMEM = "op";
-static const prog_char str_res_tun[] PROGMEM = "tun";
-static const prog_char str_res_prt[] PROGMEM = "prt";
-static const prog_char str_res_porta[] PROGMEM = "porta";
-static const prog_char str_res_parameter[] PROGMEM = "parameter";
-static const prog_char str_res_range[] PROGMEM = "range";
-static const prog_char str_res_operator[] PROGMEM = "operator";
-static const prog_char str_res_detune[] PROGMEM = "detune";
-static const prog_char str_res_osc_bal[] PROGMEM = "osc bal";
-static const prog_char str_res_sub_osc_[] PROGMEM = "sub osc.";
-static const prog_char str_res_pattern[] PROGMEM = "pattern";
-static const prog_char str_res_groove[] PROGMEM = "groove";
-static const prog_char str_res_oscillator_1[] PROGMEM = "oscillator 1";
-static const prog_char str_res_oscillator_2[] PROGMEM = "oscillator 2";
-static const prog_char str_res_arpeggio[] PROGMEM = "arpeggio";
-static const prog_char str_res_performance[] PROGMEM = "performance";
-static const prog_char str_res_none[] PROGMEM = "none";
-static const prog_char str_res_blit[] PROGMEM = "blit";
-static const prog_char str_res_saw[] PROGMEM = "saw";
-static const prog_char str_res_square[] PROGMEM = "square";
-static const prog_char str_res_triang[] PROGMEM = "triang";
-static const prog_char str_res_cz[] PROGMEM = "cz";
-static const prog_char str_res_fm[] PROGMEM = "fm";
-static const prog_char str_res_8bits[] PROGMEM = "8bits";
-static const prog_char str_res_pwm[] PROGMEM = "pwm";
-static const prog_char str_res_noise[] PROGMEM = "noise";
-static const prog_char str_res_vowel[] PROGMEM = "vowel";
-static const prog_char str_res_wavtbl[] PROGMEM = "wavtbl";
-static const prog_char str_res_sweep[] PROGMEM = "sweep";
-static const prog_char str_res_zsync[] PROGMEM = "zsync";
-static const prog_char str_res_pad[] PROGMEM = "pad";
-static const prog_char str_res_1S2[] PROGMEM = "1+2";
-static const prog_char str_res_1_2[] PROGMEM = "1>2";
-static const prog_char str_res_1P2[] PROGMEM = "1*2";
-static const prog_char str_res_1x2[] PROGMEM = "1^2";
-static const prog_char str_res_cut[] PROGMEM = "cut";
-static const prog_char str_res_vca[] PROGMEM = "vca";
-static const prog_char str_res_pw1[] PROGMEM = "pw1";
-static const prog_char str_res_pw2[] PROGMEM = "pw2";
-static const prog_char str_res_51[] PROGMEM = "1";
-static const prog_char str_res_52[] PROGMEM = "2";
-static const prog_char str_res_5[] PROGMEM = "";
-static const prog_char str_res_mix[] PROGMEM = "mix";
-static const prog_char str_res_noi[] PROGMEM = "noi";
-static const prog_char str_res_sub[] PROGMEM = "sub";
-static const prog_char str_res_res[] PROGMEM = "res";
-static const prog_char str_res_cutoff[] PROGMEM = "cutoff";
-static const prog_char str_res__vca[] PROGMEM = "vca";
-static const prog_char str_res_pwm1[] PROGMEM = "pwm1";
-static const prog_char str_res_pwm2[] PROGMEM = "pwm2";
-static const prog_char str_res_osc1[] PROGMEM = "osc1";
-static const prog_char str_res_osc2[] PROGMEM = "osc2";
-static const prog_char str_res_osc1S2[] PROGMEM = "osc1+2";
-static const prog_char str_res__mix[] PROGMEM = "mix";
-static const prog_char str_res__noise[] PROGMEM = "noise";
-static const prog_char str_res_subosc[] PROGMEM = "subosc";
-static const prog_char str_res_reso[] PROGMEM = "reso";
-static const prog_char str_res_atk[] PROGMEM = "atk";
-static const prog_char str_res_wv1[] PROGMEM = "wv1";
-static const prog_char str_res_rt1[] PROGMEM = "rt1";
-static const prog_char str_res_wv2[] PROGMEM = "wv2";
-static const prog_char str_res_rt2[] PROGMEM = "rt2";
-static const prog_char str_res_src[] PROGMEM = "src";
-static const prog_char str_res_dst[] PROGMEM = "dst";
-static const prog_char str_res_amt[] PROGMEM = "amt";
-static const prog_char str_res_chn[] PROGMEM = "chn";
-static const prog_char str_res_bpm[] PROGMEM = "bpm";
-static const prog_char str_res_swg[] PROGMEM = "swg";
-static const prog_char str_res_shape[] PROGMEM = "shape";
-static const prog_char str_res_env1Tvcf[] PROGMEM = "env1~vcf";
-static const prog_char str_res_lfo2Tvcf[] PROGMEM = "lfo2~vcf";
-static const prog_char str_res_resonance[] PROGMEM = "resonance";
-static const prog_char str_res_envelope_1[] PROGMEM = "envelope 1";
-static const prog_char str_res_envelope_2[] PROGMEM = "envelope 2";
-static const prog_char str_res_sequencer[] PROGMEM = "sequencer";
-static const prog_char str_res_attack[] PROGMEM = "attack";
-static const prog_char str_res_decay[] PROGMEM = "decay";
-static const prog_char str_res_sustain[] PROGMEM = "sustain";
-static const prog_char str_res_release[] PROGMEM = "release";
-static const prog_char str_res_lfo1_wave[] PROGMEM = "lfo1 wave";
-static const prog_char str_res_lfo1_rate[] PROGMEM = "lfo1 rate";
-static const prog_char str_res_lfo2_wave[] PROGMEM = "lfo2 wave";
-static const prog_char str_res_lfo2_rate[] PROGMEM = "lfo2 rate";
-static const prog_char str_res_mod_[] PROGMEM = "mod.";
-static const prog_char str_res_source[] PROGMEM = "source";
-static const prog_char str_res_dest_[] PROGMEM = "dest.";
-static const prog_char str_res_amount[] PROGMEM = "amount";
-static const prog_char str_res_octave[] PROGMEM = "octave";
-static const prog_char str_res_raga[] PROGMEM = "raga";
-static const prog_char str_res_midi_chan[] PROGMEM = "midi chan";
-static const prog_char str_res_tempo[] PROGMEM = "tempo";
-static const prog_char str_res_mixer[] PROGMEM = "mixer";
-static const prog_char str_res_filter[] PROGMEM = "filter";
-static const prog_char str_res_lfos[] PROGMEM = "lfos";
-static const prog_char str_res_modulation[] PROGMEM = "modulation";
-static const prog_char str_res_keyboard[] PROGMEM = "keyboard";
-static const prog_char str_res_off[] PROGMEM = "off";
-static const prog_char str_res_on[] PROGMEM = "on";
-static const prog_char str_res_tri[] PROGMEM = "tri";
-static const prog_char str_res_sqr[] PROGMEM = "sqr";
-static const prog_char str_res_s_h[] PROGMEM = "s&h";
-static const prog_char str_res_3[] PROGMEM = "";
-static const prog_char str_res__seq[] PROGMEM = "seq";
-static const prog_char str_res_lf1[] PROGMEM = "lf1";
-static const prog_char str_res_lf2[] PROGMEM = "lf2";
-static const prog_char str_res_seq[] PROGMEM = "seq";
-static const prog_char str_res_arp[] PROGMEM = "arp";
-static const prog_char str_res_whl[] PROGMEM = "whl";
-static const prog_char str_res_bnd[] PROGMEM = "bnd";
-static const prog_char str_res_ofs[] PROGMEM = "ofs";
-static const prog_char str_res_cv1[] PROGMEM = "cv1";
-static const prog_char str_res_cv2[] PROGMEM = "cv2";
-static const prog_char str_res_cv3[] PROGMEM = "cv3";
-static const prog_char str_res_rnd[] PROGMEM = "rnd";
-static const prog_char str_res_en1[] PROGMEM = "en1";
-static const prog_char str_res_en2[] PROGMEM = "en2";
-static const prog_char str_res_vel[] PROGMEM = "vel";
-static const prog_char str_res_not[] PROGMEM = "not";
-static const prog_char str_res_gat[] PROGMEM = "gat";
-static const prog_char str_res_lfo1[] PROGMEM = "lfo1";
-static const prog_char str_res_lfo2[] PROGMEM = "lfo2";
-static const prog_char str_res_stpseq[] PROGMEM = "stpseq";
-static const prog_char str_res__arp[] PROGMEM = "arp";
-static const prog_char str_res_mwheel[] PROGMEM = "mwheel";
-static const prog_char str_res_bender[] PROGMEM = "bender";
-static const prog_char str_res_offset[] PROGMEM = "offset";
-static const prog_char str_res__cv1[] PROGMEM = "cv1";
-static const prog_char str_res__cv2[] PROGMEM = "cv2";
-static const prog_char str_res__cv3[] PROGMEM = "cv3";
-static const prog_char str_res_random[] PROGMEM = "random";
-static const prog_char str_res_env1[] PROGMEM = "env1";
-static const prog_char str_res_env2[] PROGMEM = "env2";
-static const prog_char str_res_velo[] PROGMEM = "velo";
-static const prog_char str_res_note[] PROGMEM = "note";
-static const prog_char str_res_gate[] PROGMEM = "gate";
-static const prog_char str_res_270[] PROGMEM = "270";
-static const prog_char str_res_300[] PROGMEM = "300";
-static const prog_char str_res_360[] PROGMEM = "360";
-static const prog_char str_res_480[] PROGMEM = "480";
-static const prog_char str_res_720[] PROGMEM = "720";
-static const prog_char str_res_960[] PROGMEM = "960";
-static const prog_char str_res_start[] PROGMEM = "start";
-static const prog_char str_res_length[] PROGMEM = "length";
-static const prog_char str_res_touch_a_knob_to[] PROGMEM = "touch a knob to";
-static const prog_char str_res_assign_parameter[] PROGMEM = "assign parameter";
-static const prog_char str_res_ready[] PROGMEM = "ready";
-static const prog_char str_res_for_os_update[] PROGMEM = "for os update";
-static const prog_char str_res_patch_bank[] PROGMEM = "patch bank";
-static const prog_char str_res_step_sequencer[] PROGMEM = "step sequencer";
-static const prog_char str_res_load[] PROGMEM = "load";
-static const prog_char str_res_[] PROGMEM = "----";
-static const prog_char str_res_save[] PROGMEM = "save";
-static const prog_char str_res_extern[] PROGMEM = "extern";
-static const prog_char str_res_x2_ext[] PROGMEM = "x2 ext";
-static const prog_char str_res__2_ext[] PROGMEM = "/2 ext";
-static const prog_char str_res__4_ext[] PROGMEM = "/4 ext";
-static const prog_char str_res__8_ext[] PROGMEM = "/8 ext";
-static const prog_char str_res_mutable____v0_59[] PROGMEM = "mutable    v0.59";
-static const prog_char str_res_instruments_671[] PROGMEM = "instruments -1";
-static const prog_char str_res_equal[] PROGMEM = "equal";
-static const prog_char str_res_just[] PROGMEM = "just";
-static const prog_char str_res_pythag[] PROGMEM = "pythag";
-static const prog_char str_res_1_4_eb[] PROGMEM = "1/4 eb";
-static const prog_char str_res_1_4_e[] PROGMEM = "1/4 e";
-static const prog_char str_res_1_4_ea[] PROGMEM = "1/4 ea";
-static const prog_char str_res_bhaira[] PROGMEM = "bhaira";
-static const prog_char str_res_gunakr[] PROGMEM = "gunakr";
-static const prog_char str_res_marwa[] PROGMEM = "marwa";
-static const prog_char str_res_shree[] PROGMEM = "shree";
-static const prog_char str_res_purvi[] PROGMEM = "purvi";
-static const prog_char str_res_bilawa[] PROGMEM = "bilawa";
-static const prog_char str_res_yaman[] PROGMEM = "yaman";
-static const prog_char str_res_kafi[] PROGMEM = "kafi";
-static const prog_char str_res_bhimpa[] PROGMEM = "bhimpa";
-static const prog_char str_res_darbar[] PROGMEM = "darbar";
-static const prog_char str_res_bagesh[] PROGMEM = "bagesh";
-static const prog_char str_res_ragesh[] PROGMEM = "ragesh";
-static const prog_char str_res_khamaj[] PROGMEM = "khamaj";
-static const prog_char str_res_mimal[] PROGMEM = "mi'mal";
-static const prog_char str_res_parame[] PROGMEM = "parame";
-static const prog_char str_res_ranges[] PROGMEM = "ranges";
-static const prog_char str_res_ganges[] PROGMEM = "ganges";
-static const prog_char str_res_kamesh[] PROGMEM = "kamesh";
-static const prog_char str_res_palas_[] PROGMEM = "palas";
-static const prog_char str_res_natbha[] PROGMEM = "natbha";
-static const prog_char str_res_m_kaun[] PROGMEM = "m.kaun";
-static const prog_char str_res_bairag[] PROGMEM = "bairag";
-static const prog_char str_res_b_todi[] PROGMEM = "b.todi";
-static const prog_char str_res_chandr[] PROGMEM = "chandr";
-static const prog_char str_res_kaushi[] PROGMEM = "kaushi";
-static const prog_char str_res_jogesh[] PROGMEM = "jogesh";
-static const prog_char str_res_rasia[] PROGMEM = "rasia";
+const prog_uint8_t string_alphabet[] PROGMEM = {
+       0,      3,      5,      6,      7,     32,     38,     39, 
+      42,     43,     45,     46,     47,     48,     49,     50, 
+      51,     52,     53,     54,     55,     56,     57,     62, 
+      94,     97,     98,     99,    100,    101,    102,    103, 
+     104,    105,    106,    107,    108,    109,    110,    111, 
+     112,    113,    114,    115,    116,    117,    118,    119, 
+     120,    121,    122,    126, 
+};
 
+const prog_uint8_t string_data[] PROGMEM = {
+     102,    186,    225,    126,     97,    104,    102,    166, 
+     101,    118,    199,    106,      2,     91,    108,    101, 
+     169,     29,     20,     81,     69,    184,    210,    210, 
+      88,      8,    102,    174,    202,    173,    149,    217, 
+     172,    172,     80,    196,     40,    224,     44,    158, 
+     214,    224,     21,    145,     99,    154,    118,    133, 
+     178,    112,     43,    177,    218,      5,    173,    218, 
+     109,    118,    102,    221,    168,      7,    167,    168, 
+      89,    235,     22,    218,     28,    102,    199,     64, 
+     158,    182,    225,    146,     70,    108,    158,    161, 
+      78,      2,    122,    219,    134,     73,     25,    178, 
+     122,    133,     60,     10,     29,    169,    233,    234, 
+     149,    153,    155,    116,     10,    157,    153,    199, 
+     106,     21,    185,    235,    176,      7,    102,    185, 
+     217,     39,    161,    209,     78,      1,    217,    174, 
+     118,     73,    232,    116,     83,    192,    150,    119, 
+      45,    145,    155,     33,    158,     96,     40,    102, 
+     198,    224,     21,    166,    102,    140,     10,    157, 
+     174,    121,    153,    153,    183,     64,    145,    233, 
+     206,     22,    246,    110,    116,      9,     30,    156, 
+     225,    106,    102,    199,     64,    145,    233,    207, 
+      22,    246,    110,    116,      9,     30,    156,    241, 
+     106,    102,    199,     64,    150,     23,     33,     21, 
+     184,     25,    152,      9,    232,    118,    166,    108, 
+     158,    160,     43,    181,    161,    103,    173,    178, 
+     192,    102,    170,     29,    125,    248,    103,      1, 
+     217,    174,     59,     59,    155,    120,      9,     30, 
+     156,    252,    238,    109,    224,     35,    119,     22, 
+     167,    102,    167,      0,    158,    182,    197,    105, 
+     153,      0,    161,    155,     44,    118,    169,    128, 
+     174,    218,    236,    102,     25,    128,    169,    217, 
+      29,    102,    183,     64,    113,    219,     45,    153, 
+     208,     31,    170,    121,    238,    116,     10,    233, 
+     181,    154,    157,      2,    202,    161,    102,    103, 
+     192,    189,    155,    172,    106,     64,     27,    182, 
+     201,    222,    120,      9,    235,    108,    226,     79, 
+       2,    187,     90,    158,    182,    192,    102,    203, 
+      25,    110,     48,     43,    158,    218,    155,    116, 
+       6,    101,    158,    217,    172,      2,    118,    236, 
+     102,    231,     64,    122,     25,     44,    118,    160, 
+      43,    178,    138,    221,    164,      9,    111,    129, 
+     215,    100,      1,    167,    102,    113,    218,    128, 
+     157,    231,    171,    118,    192,     42,    102,    103, 
+      39,    148,      9,     29,    153,    251,     32,      1, 
+     220,     44,    118,    169,    128,    192,    241,     93, 
+     194,    192,     12,     60,     87,    112,    176,      3, 
+      17,     21,    220,     44,      0,    197,     69,    119, 
+      11,      0,    149,    217,    103,    171,     16,     40, 
+     198,    200,     25,    124,      3,    140,     68,     87, 
+      90,      0,    227,     17,     21,    214,     64,    106, 
+       6,     97,    169,    144,     31,    182,    102,     99, 
+     168,      6,    161,    145,    155,    217,      1,    168, 
+      33,    150,    134,     64,    113,    154,    154,    102, 
+     160,     26,    101,    247,    107,    128,     10,    153, 
+     125,    218,    224,      2,     56,     25,    149,    152, 
+     128,    150,     17,    229,    102,     64,     40,    102, 
+     166,    101,    116,     10,    153,    153,    247,    107, 
+       1,    246,    102,    125,    218,    192,    141,    153, 
+      93,    174,      0,     38,    102,    198,    160,    100, 
+       9,     75,    141,    155,    102,      1,    166,     97, 
+     169,    151,    192,    104,    187,     39,    114,     16, 
+      27,    129,    153,    156,    168,      8,    217,    182, 
+     184,     33,      2,     41,    223,    118,    184,      0, 
+     162,    122,    172,    100,     10,    153,    153,    247, 
+      64,     85,    168,    108,    172,      9,    167,    134, 
+     183,     64,    186,    123,    221,    144,     10,    239, 
+     117,    218,      0,    202,    188,    102,    108,     10, 
+     224,    102,    135,     64,    113,    214,    217,    196, 
+       7,     29,    174,    194,    192,    177,    217,    104, 
+     156,      9,     97,    193,    218,    128,    174,    198, 
+     106,    176,     10,    157,    101,    204,     64,    118, 
+     155,     89,    144,      3,    140,     68,     87,     64, 
+     149,    154,    175,    100,     10,    224,    169,    215, 
+      64,    162,    218,    174,    132,     12,     89,    149, 
+     153,    128,    161,    153,     25,    172,     10,    153, 
+     174,     22,     64,    154,    121,    157,      1,    169, 
+      33,    176,     10,     47,    148,    224,     40,    190, 
+      83,    192,    158,    182,    206,      2,    122,    219, 
+      60,     10,    157,    174,    112,     37,    157,    194, 
+     192,    169,    151,    217,      2,     71,    167,    172, 
+       9,     30,    156,    224,     36,    122,    115,    192, 
+     118,    107,    142,      1,    217,    174,     60,     11, 
+     157,    146,    112,     38,    158,    199,     64,    125, 
+     155,     29,      2,     73,    217,    112,      2,    138, 
+      40,    160,     43,    102,    231,     64,    138,    218, 
+     236,      2,     54,     94,    132,     10,     42,    148, 
+      10,    166,    124,     11,     45,    152,     10,     42, 
+     176,     10,    217,    188,     10,     47,    148,     10, 
+      25,    112,      3,    151,     60,      3,    136,     60, 
+       3,    152,     60,      6,    237,    176,     11,    155, 
+     100,     10,     47,     56,     10,     47,     60,      9, 
+      97,    192,      9,    167,    132,     10,    237,    104, 
+      10,    157,    172,      6,    108,    140,     11,    238, 
+      56,     10,    172,     56,     11,    238,     60,     10, 
+     172,     60,     10,    234,    108,      7,     43,    176, 
+       6,    101,    176,      6,    224,    152,      6,    168, 
+     148,     10,    239,    124,     11,     42,    132,     10, 
+     233,    168,     10,    198,    128,      9,     30,     56, 
+       9,     30,     60,      6,    106,    160,     11,    224, 
+     144,      6,    166,    112,      9,    222,    172,      6, 
+     238,     56,      6,    238,     60,      6,    238,     64, 
+      10,    166,    112,      7,    102,     56,      7,    102, 
+      60,     11,    157,    144,      9,    167,    176,      7, 
+     217,    176,      3,    212,     52,      4,     13,     52, 
+       4,     19,     52,      4,     85,     52,      5,     15, 
+      52,      5,    147,     52,      6,    232,    180,     10, 
+     153,    148,     10,    236,    140,      9,     97,    152, 
+       9,    232,      1,    188,    128,    122,     80,      2, 
+      56,      0,    143,      0,     32,      1,      0,      0, 
+};
 
-PROGMEM const prog_char* string_table[] = {
-  str_res_prm,
-  str_res_rng,
-  str_res_op,
-  str_res_tun,
-  str_res_prt,
-  str_res_porta,
-  str_res_parameter,
-  str_res_range,
-  str_res_operator,
-  str_res_detune,
-  str_res_osc_bal,
-  str_res_sub_osc_,
-  str_res_pattern,
-  str_res_groove,
-  str_res_oscillator_1,
-  str_res_oscillator_2,
-  str_res_arpeggio,
-  str_res_performance,
-  str_res_none,
-  str_res_blit,
-  str_res_saw,
-  str_res_square,
-  str_res_triang,
-  str_res_cz,
-  str_res_fm,
-  str_res_8bits,
-  str_res_pwm,
-  str_res_noise,
-  str_res_vowel,
-  str_res_wavtbl,
-  str_res_sweep,
-  str_res_zsync,
-  str_res_pad,
-  str_res_1S2,
-  str_res_1_2,
-  str_res_1P2,
-  str_res_1x2,
-  str_res_cut,
-  str_res_vca,
-  str_res_pw1,
-  str_res_pw2,
-  str_res_51,
-  str_res_52,
-  str_res_5,
-  str_res_mix,
-  str_res_noi,
-  str_res_sub,
-  str_res_res,
-  str_res_cutoff,
-  str_res__vca,
-  str_res_pwm1,
-  str_res_pwm2,
-  str_res_osc1,
-  str_res_osc2,
-  str_res_osc1S2,
-  str_res__mix,
-  str_res__noise,
-  str_res_subosc,
-  str_res_reso,
-  str_res_atk,
-  str_res_wv1,
-  str_res_rt1,
-  str_res_wv2,
-  str_res_rt2,
-  str_res_src,
-  str_res_dst,
-  str_res_amt,
-  str_res_chn,
-  str_res_bpm,
-  str_res_swg,
-  str_res_shape,
-  str_res_env1Tvcf,
-  str_res_lfo2Tvcf,
-  str_res_resonance,
-  str_res_envelope_1,
-  str_res_envelope_2,
-  str_res_sequencer,
-  str_res_attack,
-  str_res_decay,
-  str_res_sustain,
-  str_res_release,
-  str_res_lfo1_wave,
-  str_res_lfo1_rate,
-  str_res_lfo2_wave,
-  str_res_lfo2_rate,
-  str_res_mod_,
-  str_res_source,
-  str_res_dest_,
-  str_res_amount,
-  str_res_octave,
-  str_res_raga,
-  str_res_midi_chan,
-  str_res_tempo,
-  str_res_mixer,
-  str_res_filter,
-  str_res_lfos,
-  str_res_modulation,
-  str_res_keyboard,
-  str_res_off,
-  str_res_on,
-  str_res_tri,
-  str_res_sqr,
-  str_res_s_h,
-  str_res_3,
-  str_res__seq,
-  str_res_lf1,
-  str_res_lf2,
-  str_res_seq,
-  str_res_arp,
-  str_res_whl,
-  str_res_bnd,
-  str_res_ofs,
-  str_res_cv1,
-  str_res_cv2,
-  str_res_cv3,
-  str_res_rnd,
-  str_res_en1,
-  str_res_en2,
-  str_res_vel,
-  str_res_not,
-  str_res_gat,
-  str_res_lfo1,
-  str_res_lfo2,
-  str_res_stpseq,
-  str_res__arp,
-  str_res_mwheel,
-  str_res_bender,
-  str_res_offset,
-  str_res__cv1,
-  str_res__cv2,
-  str_res__cv3,
-  str_res_random,
-  str_res_env1,
-  str_res_env2,
-  str_res_velo,
-  str_res_note,
-  str_res_gate,
-  str_res_270,
-  str_res_300,
-  str_res_360,
-  str_res_480,
-  str_res_720,
-  str_res_960,
-  str_res_start,
-  str_res_length,
-  str_res_touch_a_knob_to,
-  str_res_assign_parameter,
-  str_res_ready,
-  str_res_for_os_update,
-  str_res_patch_bank,
-  str_res_step_sequencer,
-  str_res_load,
-  str_res_,
-  str_res_save,
-  str_res_extern,
-  str_res_x2_ext,
-  str_res__2_ext,
-  str_res__4_ext,
-  str_res__8_ext,
-  str_res_mutable____v0_59,
-  str_res_instruments_671,
-  str_res_equal,
-  str_res_just,
-  str_res_pythag,
-  str_res_1_4_eb,
-  str_res_1_4_e,
-  str_res_1_4_ea,
-  str_res_bhaira,
-  str_res_gunakr,
-  str_res_marwa,
-  str_res_shree,
-  str_res_purvi,
-  str_res_bilawa,
-  str_res_yaman,
-  str_res_kafi,
-  str_res_bhimpa,
-  str_res_darbar,
-  str_res_bagesh,
-  str_res_ragesh,
-  str_res_khamaj,
-  str_res_mimal,
-  str_res_parame,
-  str_res_ranges,
-  str_res_ganges,
-  str_res_kamesh,
-  str_res_palas_,
-  str_res_natbha,
-  str_res_m_kaun,
-  str_res_bairag,
-  str_res_b_todi,
-  str_res_chandr,
-  str_res_kaushi,
-  str_res_jogesh,
-  str_res_rasia,
+const prog_uint16_t string_table[] PROGMEM = {
+   914,  // prm
+   918,  // rng
+  1142,  // op
+   922,  // tun
+   926,  // prt
+   672,  // porta
+     7,  // parameter
+   678,  // range
+   250,  // operator
+   336,  // detune
+   304,  // osc_bal
+   259,  // sub_osc_
+   312,  // pattern
+   343,  // groove
+    96,  // oscillator_1
+   109,  // oscillator_2
+   268,  // arpeggio
+   122,  // performance
+   804,  // none
+   809,  // blit
+   930,  // saw
+   350,  // square
+   357,  // triang
+  1145,  // cz
+  1148,  // fm
+   684,  // 8bits
+   934,  // pwm
+   690,  // noise
+   696,  // vowel
+   364,  // wavtbl
+   702,  // sweep
+   708,  // zsync
+   938,  // pad
+   381,  // 1S2
+   942,  // 1_2
+   946,  // 1P2
+   950,  // 1x2
+   954,  // cut
+   958,  // vca
+   962,  // pw1
+   966,  // pw2
+  1151,  // 51
+  1154,  // 52
+  1157,  // 5
+   970,  // mix
+   974,  // noi
+   978,  // sub
+   982,  // res
+   371,  // cutoff
+   958,  // _vca
+   814,  // pwm1
+   819,  // pwm2
+   824,  // osc1
+   829,  // osc2
+   378,  // osc1S2
+   970,  // _mix
+   690,  // _noise
+   385,  // subosc
+   834,  // reso
+   986,  // atk
+   990,  // wv1
+   994,  // rt1
+   998,  // wv2
+  1002,  // rt2
+  1006,  // src
+  1010,  // dst
+  1014,  // amt
+  1018,  // chn
+  1022,  // bpm
+  1026,  // swg
+   714,  // shape
+   277,  // env1Tvcf
+   286,  // lfo2Tvcf
+   190,  // resonance
+   146,  // envelope_1
+   157,  // envelope_2
+    72,  // sequencer
+   392,  // attack
+   720,  // decay
+   320,  // sustain
+   328,  // release
+   200,  // lfo1_wave
+   210,  // lfo1_rate
+   220,  // lfo2_wave
+   230,  // lfo2_rate
+   839,  // mod_
+   399,  // source
+   726,  // dest_
+   406,  // amount
+   413,  // octave
+   844,  // raga
+   240,  // midi_chan
+   732,  // tempo
+   738,  // mixer
+   420,  // filter
+   849,  // lfos
+   168,  // modulation
+   295,  // keyboard
+   374,  // off
+   176,  // on
+  1030,  // tri
+  1034,  // sqr
+  1038,  // s_h
+  1159,  // 3
+   430,  // _seq
+  1042,  // lf1
+  1046,  // lf2
+   430,  // seq
+  1050,  // arp
+  1054,  // whl
+  1058,  // bnd
+  1062,  // ofs
+  1066,  // cv1
+  1070,  // cv2
+  1074,  // cv3
+  1078,  // rnd
+  1082,  // en1
+  1086,  // en2
+  1090,  // vel
+  1094,  // not
+  1098,  // gat
+   854,  // lfo1
+   859,  // lfo2
+   427,  // stpseq
+  1050,  // _arp
+   434,  // mwheel
+   441,  // bender
+   448,  // offset
+  1066,  // _cv1
+  1070,  // _cv2
+  1074,  // _cv3
+   455,  // random
+   864,  // env1
+   869,  // env2
+   874,  // velo
+   879,  // note
+   884,  // gate
+  1102,  // 270
+  1106,  // 300
+  1110,  // 360
+  1114,  // 480
+  1118,  // 720
+  1122,  // 960
+   744,  // start
+   462,  // length
+    51,  // touch_a_knob_to
+     0,  // assign_parameter
+   750,  // ready
+    82,  // for_os_update
+   179,  // patch_bank
+    67,  // step_sequencer
+   889,  // load
+   894,  // 
+   899,  // save
+   469,  // extern
+   476,  // x2_ext
+   483,  // _2_ext
+   490,  // _4_ext
+   497,  // _8_ext
+   134,  // render_cost
+  1126,  // cpu
+   504,  // memory
+  1130,  // ram
+  1134,  // stk
+  1138,  // min
+    17,  // mutable____v0_59
+    34,  // instruments_671
+   756,  // equal
+   904,  // just
+   511,  // pythag
+   518,  // 1_4_eb
+   762,  // 1_4_e
+   525,  // 1_4_ea
+   532,  // bhaira
+   539,  // gunakr
+   768,  // marwa
+   774,  // shree
+   780,  // purvi
+   546,  // bilawa
+   786,  // yaman
+   909,  // kafi
+   553,  // bhimpa
+   560,  // darbar
+   567,  // bagesh
+   574,  // ragesh
+   581,  // khamaj
+   588,  // mimal
+   595,  // parame
+   602,  // ranges
+   609,  // ganges
+   616,  // kamesh
+   792,  // palas_
+   623,  // natbha
+   630,  // m_kaun
+   637,  // bairag
+   644,  // b_todi
+   651,  // chandr
+   658,  // kaushi
+   665,  // jogesh
+   798,  // rasia
 };
 
 const prog_uint16_t lut_res_lfo_increments[] PROGMEM = {
@@ -454,104 +386,6 @@ const prog_uint16_t lut_res_env_portamento_increments[] PROGMEM = {
       12,     12,     12,     11,     11,     11,     10,     10, 
       10,      9,      9,      9,      9,      8,      8,      8, 
 };
-const prog_uint16_t lut_res_oscillator_increments[] PROGMEM = {
-    4389,   4393,   4397,   4401,   4405,   4409,   4413,   4417, 
-    4421,   4425,   4429,   4433,   4437,   4441,   4445,   4449, 
-    4453,   4457,   4461,   4465,   4469,   4473,   4477,   4481, 
-    4485,   4489,   4493,   4497,   4501,   4505,   4509,   4513, 
-    4517,   4522,   4526,   4530,   4534,   4538,   4542,   4546, 
-    4550,   4554,   4558,   4563,   4567,   4571,   4575,   4579, 
-    4583,   4587,   4591,   4596,   4600,   4604,   4608,   4612, 
-    4616,   4621,   4625,   4629,   4633,   4637,   4641,   4646, 
-    4650,   4654,   4658,   4662,   4667,   4671,   4675,   4679, 
-    4684,   4688,   4692,   4696,   4700,   4705,   4709,   4713, 
-    4717,   4722,   4726,   4730,   4735,   4739,   4743,   4747, 
-    4752,   4756,   4760,   4765,   4769,   4773,   4777,   4782, 
-    4786,   4790,   4795,   4799,   4803,   4808,   4812,   4816, 
-    4821,   4825,   4830,   4834,   4838,   4843,   4847,   4851, 
-    4856,   4860,   4865,   4869,   4873,   4878,   4882,   4887, 
-    4891,   4895,   4900,   4904,   4909,   4913,   4917,   4922, 
-    4926,   4931,   4935,   4940,   4944,   4949,   4953,   4958, 
-    4962,   4967,   4971,   4976,   4980,   4985,   4989,   4994, 
-    4998,   5003,   5007,   5012,   5016,   5021,   5025,   5030, 
-    5034,   5039,   5043,   5048,   5052,   5057,   5062,   5066, 
-    5071,   5075,   5080,   5084,   5089,   5094,   5098,   5103, 
-    5107,   5112,   5117,   5121,   5126,   5131,   5135,   5140, 
-    5145,   5149,   5154,   5158,   5163,   5168,   5172,   5177, 
-    5182,   5186,   5191,   5196,   5201,   5205,   5210,   5215, 
-    5219,   5224,   5229,   5233,   5238,   5243,   5248,   5252, 
-    5257,   5262,   5267,   5271,   5276,   5281,   5286,   5290, 
-    5295,   5300,   5305,   5310,   5314,   5319,   5324,   5329, 
-    5334,   5338,   5343,   5348,   5353,   5358,   5363,   5367, 
-    5372,   5377,   5382,   5387,   5392,   5397,   5401,   5406, 
-    5411,   5416,   5421,   5426,   5431,   5436,   5441,   5446, 
-    5450,   5455,   5460,   5465,   5470,   5475,   5480,   5485, 
-    5490,   5495,   5500,   5505,   5510,   5515,   5520,   5525, 
-    5530,   5535,   5540,   5545,   5550,   5555,   5560,   5565, 
-    5570,   5575,   5580,   5585,   5590,   5595,   5600,   5605, 
-    5610,   5615,   5620,   5625,   5630,   5636,   5641,   5646, 
-    5651,   5656,   5661,   5666,   5671,   5676,   5682,   5687, 
-    5692,   5697,   5702,   5707,   5712,   5718,   5723,   5728, 
-    5733,   5738,   5743,   5749,   5754,   5759,   5764,   5769, 
-    5775,   5780,   5785,   5790,   5795,   5801,   5806,   5811, 
-    5816,   5822,   5827,   5832,   5837,   5843,   5848,   5853, 
-    5859,   5864,   5869,   5874,   5880,   5885,   5890,   5896, 
-    5901,   5906,   5912,   5917,   5922,   5928,   5933,   5938, 
-    5944,   5949,   5955,   5960,   5965,   5971,   5976,   5981, 
-    5987,   5992,   5998,   6003,   6009,   6014,   6019,   6025, 
-    6030,   6036,   6041,   6047,   6052,   6058,   6063,   6068, 
-    6074,   6079,   6085,   6090,   6096,   6101,   6107,   6112, 
-    6118,   6124,   6129,   6135,   6140,   6146,   6151,   6157, 
-    6162,   6168,   6173,   6179,   6185,   6190,   6196,   6201, 
-    6207,   6213,   6218,   6224,   6229,   6235,   6241,   6246, 
-    6252,   6258,   6263,   6269,   6275,   6280,   6286,   6292, 
-    6297,   6303,   6309,   6314,   6320,   6326,   6331,   6337, 
-    6343,   6349,   6354,   6360,   6366,   6372,   6377,   6383, 
-    6389,   6395,   6400,   6406,   6412,   6418,   6424,   6429, 
-    6435,   6441,   6447,   6453,   6458,   6464,   6470,   6476, 
-    6482,   6488,   6494,   6499,   6505,   6511,   6517,   6523, 
-    6529,   6535,   6541,   6546,   6552,   6558,   6564,   6570, 
-    6576,   6582,   6588,   6594,   6600,   6606,   6612,   6618, 
-    6624,   6630,   6636,   6642,   6648,   6654,   6660,   6666, 
-    6672,   6678,   6684,   6690,   6696,   6702,   6708,   6714, 
-    6720,   6726,   6732,   6738,   6744,   6750,   6757,   6763, 
-    6769,   6775,   6781,   6787,   6793,   6799,   6806,   6812, 
-    6818,   6824,   6830,   6836,   6843,   6849,   6855,   6861, 
-    6867,   6873,   6880,   6886,   6892,   6898,   6905,   6911, 
-    6917,   6923,   6930,   6936,   6942,   6948,   6955,   6961, 
-    6967,   6973,   6980,   6986,   6992,   6999,   7005,   7011, 
-    7018,   7024,   7030,   7037,   7043,   7049,   7056,   7062, 
-    7069,   7075,   7081,   7088,   7094,   7100,   7107,   7113, 
-    7120,   7126,   7133,   7139,   7145,   7152,   7158,   7165, 
-    7171,   7178,   7184,   7191,   7197,   7204,   7210,   7217, 
-    7223,   7230,   7236,   7243,   7249,   7256,   7263,   7269, 
-    7276,   7282,   7289,   7295,   7302,   7309,   7315,   7322, 
-    7328,   7335,   7342,   7348,   7355,   7362,   7368,   7375, 
-    7381,   7388,   7395,   7401,   7408,   7415,   7422,   7428, 
-    7435,   7442,   7448,   7455,   7462,   7469,   7475,   7482, 
-    7489,   7496,   7502,   7509,   7516,   7523,   7530,   7536, 
-    7543,   7550,   7557,   7564,   7570,   7577,   7584,   7591, 
-    7598,   7605,   7612,   7618,   7625,   7632,   7639,   7646, 
-    7653,   7660,   7667,   7674,   7681,   7687,   7694,   7701, 
-    7708,   7715,   7722,   7729,   7736,   7743,   7750,   7757, 
-    7764,   7771,   7778,   7785,   7792,   7799,   7806,   7813, 
-    7820,   7827,   7835,   7842,   7849,   7856,   7863,   7870, 
-    7877,   7884,   7891,   7898,   7906,   7913,   7920,   7927, 
-    7934,   7941,   7949,   7956,   7963,   7970,   7977,   7984, 
-    7992,   7999,   8006,   8013,   8021,   8028,   8035,   8042, 
-    8050,   8057,   8064,   8071,   8079,   8086,   8093,   8101, 
-    8108,   8115,   8123,   8130,   8137,   8145,   8152,   8159, 
-    8167,   8174,   8181,   8189,   8196,   8204,   8211,   8218, 
-    8226,   8233,   8241,   8248,   8256,   8263,   8271,   8278, 
-    8285,   8293,   8300,   8308,   8315,   8323,   8330,   8338, 
-    8346,   8353,   8361,   8368,   8376,   8383,   8391,   8398, 
-    8406,   8414,   8421,   8429,   8436,   8444,   8452,   8459, 
-    8467,   8475,   8482,   8490,   8498,   8505,   8513,   8521, 
-    8528,   8536,   8544,   8551,   8559,   8567,   8575,   8582, 
-    8590,   8598,   8606,   8613,   8621,   8629,   8637,   8645, 
-    8652,   8660,   8668,   8676,   8684,   8691,   8699,   8707, 
-    8715,   8723,   8731,   8739,   8747,   8754,   8762,   8770, 
-};
 const prog_uint16_t lut_res_fm_frequency_ratios[] PROGMEM = {
       32,     64,    128,    129,    181,    201,    256,    257, 
      362,    402,    448,    512,    514,    576,    704,    724, 
@@ -559,124 +393,124 @@ const prog_uint16_t lut_res_fm_frequency_ratios[] PROGMEM = {
     2048, 
 };
 const prog_uint16_t lut_res_scale_just[] PROGMEM = {
-       0,     15,      5,     20,    -17,     -2,    -12,      2, 
-      17,    -20,     -5,    -15, 
+       0,     15,      5,     20,  65519,  65534,  65524,      2, 
+      17,  65516,  65531,  65521, 
 };
 const prog_uint16_t lut_res_scale_pythagorean[] PROGMEM = {
-       0,     15,      5,     -7,     10,     -2,    -12,      2, 
-      17,    -20,     -5,     12, 
+       0,     15,      5,  65529,     10,  65534,  65524,      2, 
+      17,  65516,  65531,     12, 
 };
 const prog_uint16_t lut_res_scale_1_4_eb[] PROGMEM = {
-       0,      0,      0,      0,    -64,      0,      0,      0, 
-       0,      0,      0,    -64, 
+       0,      0,      0,      0,  65472,      0,      0,      0, 
+       0,      0,      0,  65472, 
 };
 const prog_uint16_t lut_res_scale_1_4_e[] PROGMEM = {
-       0,      0,      0,      0,    -64,      0,      0,      0, 
+       0,      0,      0,      0,  65472,      0,      0,      0, 
        0,      0,      0,      0, 
 };
 const prog_uint16_t lut_res_scale_1_4_ea[] PROGMEM = {
-       0,      0,      0,      0,    -64,      0,      0,      0, 
-       0,    -64,      0,      0, 
+       0,      0,      0,      0,  65472,      0,      0,      0, 
+       0,  65472,      0,      0, 
 };
 const prog_uint16_t lut_res_scale_bhairav[] PROGMEM = {
-       0,    -12,  32767,  32767,    -17,     -2,  32767,      2, 
-     -10,  32767,  32767,    -15, 
+       0,  65524,  32767,  32767,  65519,  65534,  32767,      2, 
+   65526,  32767,  32767,  65521, 
 };
 const prog_uint16_t lut_res_scale_gunakri[] PROGMEM = {
-       0,     15,  32767,  32767,  32767,     -2,  32767,      2, 
+       0,     15,  32767,  32767,  32767,  65534,  32767,      2, 
       17,  32767,  32767,  32767, 
 };
 const prog_uint16_t lut_res_scale_marwa[] PROGMEM = {
-       0,     15,  32767,  32767,    -17,  32767,    -12,  32767, 
-   32767,    -20,  32767,    -15, 
+       0,     15,  32767,  32767,  65519,  32767,  65524,  32767, 
+   32767,  65516,  32767,  65521, 
 };
 const prog_uint16_t lut_res_scale_shree[] PROGMEM = {
-       0,    -12,  32767,  32767,    -17,  32767,    -12,      2, 
-     -10,  32767,  32767,    -15, 
+       0,  65524,  32767,  32767,  65519,  32767,  65524,      2, 
+   65526,  32767,  32767,  65521, 
 };
 const prog_uint16_t lut_res_scale_purvi[] PROGMEM = {
-       0,     15,  32767,  32767,    -17,  32767,    -12,      2, 
-      17,  32767,  32767,    -15, 
+       0,     15,  32767,  32767,  65519,  32767,  65524,      2, 
+      17,  32767,  32767,  65521, 
 };
 const prog_uint16_t lut_res_scale_bilawal[] PROGMEM = {
-       0,  32767,      5,  32767,    -17,     -2,  32767,      2, 
-   32767,      7,  32767,    -15, 
+       0,  32767,      5,  32767,  65519,  65534,  32767,      2, 
+   32767,      7,  32767,  65521, 
 };
 const prog_uint16_t lut_res_scale_yaman[] PROGMEM = {
        0,  32767,      5,  32767,     10,  32767,     15,      2, 
    32767,      7,  32767,     12, 
 };
 const prog_uint16_t lut_res_scale_kafi[] PROGMEM = {
-       0,  32767,    -22,     -7,  32767,     -2,  32767,      2, 
-   32767,    -20,     -5,  32767, 
+       0,  32767,  65514,  65529,  32767,  65534,  32767,      2, 
+   32767,  65516,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_bhimpalasree[] PROGMEM = {
-       0,  32767,      5,     20,  32767,     -2,  32767,      2, 
+       0,  32767,      5,     20,  32767,  65534,  32767,      2, 
    32767,      7,     22,  32767, 
 };
 const prog_uint16_t lut_res_scale_darbari[] PROGMEM = {
-       0,  32767,      5,     -7,  32767,     -2,  32767,      2, 
-     -10,  32767,     -5,  32767, 
+       0,  32767,      5,  65529,  32767,  65534,  32767,      2, 
+   65526,  32767,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_rageshree[] PROGMEM = {
-       0,  32767,      5,  32767,    -17,     -2,  32767,      2, 
-   32767,    -20,     -5,  32767, 
+       0,  32767,      5,  32767,  65519,  65534,  32767,      2, 
+   32767,  65516,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_khamaj[] PROGMEM = {
-       0,  32767,      5,  32767,    -17,     -2,  32767,      2, 
-   32767,      7,     -5,     12, 
+       0,  32767,      5,  32767,  65519,  65534,  32767,      2, 
+   32767,      7,  65531,     12, 
 };
 const prog_uint16_t lut_res_scale_mimal[] PROGMEM = {
-       0,  32767,      5,     -7,  32767,     -2,  32767,      2, 
-   32767,    -20,     -5,    -15, 
+       0,  32767,      5,  65529,  32767,  65534,  32767,      2, 
+   32767,  65516,  65531,  65521, 
 };
 const prog_uint16_t lut_res_scale_parameshwari[] PROGMEM = {
-       0,    -12,  32767,     -7,  32767,     -2,  32767,  32767, 
-   32767,    -20,     -5,  32767, 
+       0,  65524,  32767,  65529,  32767,  65534,  32767,  32767, 
+   32767,  65516,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_rangeshwari[] PROGMEM = {
-       0,  32767,      5,     -7,  32767,     -2,  32767,      2, 
-   32767,  32767,  32767,    -15, 
+       0,  32767,      5,  65529,  32767,  65534,  32767,      2, 
+   32767,  32767,  32767,  65521, 
 };
 const prog_uint16_t lut_res_scale_gangeshwari[] PROGMEM = {
-       0,  32767,  32767,  32767,    -17,     -2,  32767,      2, 
-     -10,  32767,     -5,  32767, 
+       0,  32767,  32767,  32767,  65519,  65534,  32767,      2, 
+   65526,  32767,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_kameshwari[] PROGMEM = {
-       0,  32767,      5,  32767,  32767,  32767,    -12,      2, 
-   32767,    -20,     -5,  32767, 
+       0,  32767,      5,  32767,  32767,  32767,  65524,      2, 
+   32767,  65516,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_palas_kafi[] PROGMEM = {
-       0,  32767,      5,     -7,  32767,     -2,  32767,      2, 
-   32767,      7,     -5,  32767, 
+       0,  32767,      5,  65529,  32767,  65534,  32767,      2, 
+   32767,      7,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_natbhairav[] PROGMEM = {
-       0,  32767,      5,  32767,    -17,     -2,  32767,      2, 
-     -10,  32767,  32767,    -15, 
+       0,  32767,      5,  32767,  65519,  65534,  32767,      2, 
+   65526,  32767,  32767,  65521, 
 };
 const prog_uint16_t lut_res_scale_m_kauns[] PROGMEM = {
-       0,  32767,      5,  32767,     10,     -2,  32767,  32767, 
-     -10,  32767,     -5,  32767, 
+       0,  32767,      5,  32767,     10,  65534,  32767,  32767, 
+   65526,  32767,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_bairagi[] PROGMEM = {
-       0,    -12,  32767,  32767,  32767,     -2,  32767,      2, 
-   32767,  32767,     -5,  32767, 
+       0,  65524,  32767,  32767,  32767,  65534,  32767,      2, 
+   32767,  32767,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_b_todi[] PROGMEM = {
-       0,    -12,  32767,     -7,  32767,  32767,  32767,      2, 
-   32767,  32767,     -5,  32767, 
+       0,  65524,  32767,  65529,  32767,  32767,  32767,      2, 
+   32767,  32767,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_chandradeep[] PROGMEM = {
-       0,  32767,  32767,     -7,  32767,     -2,  32767,      2, 
-   32767,  32767,     -5,  32767, 
+       0,  32767,  32767,  65529,  32767,  65534,  32767,      2, 
+   32767,  32767,  65531,  32767, 
 };
 const prog_uint16_t lut_res_scale_kaushik_todi[] PROGMEM = {
-       0,  32767,  32767,     -7,  32767,     -2,    -12,  32767, 
-     -10,  32767,  32767,  32767, 
+       0,  32767,  32767,  65529,  32767,  65534,  65524,  32767, 
+   65526,  32767,  32767,  32767, 
 };
 const prog_uint16_t lut_res_scale_jogeshwari[] PROGMEM = {
-       0,  32767,  32767,     -7,    -17,     -2,  32767,  32767, 
-   32767,    -20,     -5,  32767, 
+       0,  32767,  32767,  65529,  65519,  65534,  32767,  32767, 
+   32767,  65516,  65531,  32767, 
 };
 const prog_uint16_t lut_res_arpeggiator_patterns[] PROGMEM = {
    21845,  30583,  62965,  46517,  28527,   2313,  18761,  21065, 
@@ -686,31 +520,37 @@ const prog_uint16_t lut_res_turbo_tempi[] PROGMEM = {
      270,    300,    360,    480,    720,    960, 
 };
 const prog_uint16_t lut_res_groove_swing[] PROGMEM = {
-     127,    127,   -127,   -127,    127,    127,   -127,   -127, 
-     127,    127,   -127,   -127,    127,    127,   -127,   -127, 
+     127,    127,  65409,  65409,    127,    127,  65409,  65409, 
+     127,    127,  65409,  65409,    127,    127,  65409,  65409, 
 };
 const prog_uint16_t lut_res_groove_shuffle[] PROGMEM = {
-     127,   -127,    127,   -127,    127,   -127,    127,   -127, 
-     127,   -127,    127,   -127,    127,   -127,    127,   -127, 
+     127,  65409,    127,  65409,    127,  65409,    127,  65409, 
+     127,  65409,    127,  65409,    127,  65409,    127,  65409, 
 };
 const prog_uint16_t lut_res_groove_push[] PROGMEM = {
-     -63,    -63,    127,      0,   -127,      0,      0,     88, 
-       0,      0,     88,    -50,    -88,      0,     88,      0, 
+   65473,  65473,    127,      0,  65409,      0,      0,     88, 
+       0,      0,     88,  65486,  65448,      0,     88,      0, 
 };
 const prog_uint16_t lut_res_groove_lag[] PROGMEM = {
-      19,     44,     93,     -4,     32,    -53,    -90,   -127, 
-     117,     32,   -102,    -53,    105,    -53,     93,    -53, 
+      19,     44,     93,  65532,     32,  65483,  65446,  65409, 
+     117,     32,  65434,  65483,    105,  65483,     93,  65483, 
 };
 const prog_uint16_t lut_res_groove_human[] PROGMEM = {
-      88,   -101,    107,    -95,     88,    -88,     50,    -38, 
-      65,    -88,    101,    -95,    101,   -127,     63,    -31, 
+      88,  65435,    107,  65441,     88,  65448,     50,  65498, 
+      65,  65448,    101,  65441,    101,  65409,     63,  65505, 
+};
+const prog_uint16_t lut_res_svf_cutoff[] PROGMEM = {
+     131,    153,    178,    207,    241,    281,    327,    380, 
+     443,    515,    600,    698,    812,    945,   1100,   1280, 
+    1490,   1734,   2017,   2347,   2730,   3176,   3694,   4296, 
+    4994,   5804,   6742,   7826,   9076,  10512,  12156,  14025, 
+   16131, 
 };
 
 
 PROGMEM const prog_uint16_t* lookup_table_table[] = {
   lut_res_lfo_increments,
   lut_res_env_portamento_increments,
-  lut_res_oscillator_increments,
   lut_res_fm_frequency_ratios,
   lut_res_scale_just,
   lut_res_scale_pythagorean,
@@ -751,6 +591,7 @@ PROGMEM const prog_uint16_t* lookup_table_table[] = {
   lut_res_groove_push,
   lut_res_groove_lag,
   lut_res_groove_human,
+  lut_res_svf_cutoff,
 };
 
 const prog_uint8_t wav_res_formant_sine[] PROGMEM = {
@@ -772,20 +613,20 @@ const prog_uint8_t wav_res_formant_sine[] PROGMEM = {
        7,      8,     10,     12,     14,     17,     20,     24, 
        0,      0,      0,      0,      0,      0,      0,      0, 
        0,      0,      0,      0,      0,      0,      0,      0, 
-       0,     -2,     -2,     -3,     -3,     -4,     -5,     -6, 
-      -7,     -8,    -10,    -12,    -14,    -17,    -20,    -24, 
-       0,     -3,     -4,     -5,     -6,     -7,     -9,    -10, 
-     -12,    -15,    -18,    -21,    -26,    -31,    -37,    -45, 
-       0,     -4,     -5,     -6,     -8,     -9,    -11,    -13, 
-     -16,    -19,    -23,    -28,    -34,    -40,    -49,    -58, 
-       0,     -5,     -6,     -7,     -8,    -10,    -12,    -15, 
-     -17,    -21,    -25,    -30,    -36,    -44,    -53,    -63, 
-       0,     -4,     -5,     -6,     -8,     -9,    -11,    -13, 
-     -16,    -19,    -23,    -28,    -34,    -40,    -49,    -58, 
-       0,     -3,     -4,     -5,     -6,     -7,     -9,    -10, 
-     -12,    -15,    -18,    -21,    -26,    -31,    -37,    -45, 
-       0,     -2,     -2,     -3,     -3,     -4,     -5,     -6, 
-      -7,     -8,    -10,    -12,    -14,    -17,    -20,    -24, 
+       0,    254,    254,    253,    253,    252,    251,    250, 
+     249,    248,    246,    244,    242,    239,    236,    232, 
+       0,    253,    252,    251,    250,    249,    247,    246, 
+     244,    241,    238,    235,    230,    225,    219,    211, 
+       0,    252,    251,    250,    248,    247,    245,    243, 
+     240,    237,    233,    228,    222,    216,    207,    198, 
+       0,    251,    250,    249,    248,    246,    244,    241, 
+     239,    235,    231,    226,    220,    212,    203,    193, 
+       0,    252,    251,    250,    248,    247,    245,    243, 
+     240,    237,    233,    228,    222,    216,    207,    198, 
+       0,    253,    252,    251,    250,    249,    247,    246, 
+     244,    241,    238,    235,    230,    225,    219,    211, 
+       0,    254,    254,    253,    253,    252,    251,    250, 
+     249,    248,    246,    244,    242,    239,    236,    232, 
 };
 const prog_uint8_t wav_res_formant_square[] PROGMEM = {
        0,      1,      1,      2,      2,      3,      3,      4, 
@@ -804,22 +645,22 @@ const prog_uint8_t wav_res_formant_square[] PROGMEM = {
        4,      5,      6,      8,      9,     11,     13,     16, 
        0,      1,      1,      2,      2,      3,      3,      4, 
        4,      5,      6,      8,      9,     11,     13,     16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
-       0,     -1,     -1,     -2,     -2,     -3,     -3,     -4, 
-      -4,     -5,     -6,     -8,     -9,    -11,    -13,    -16, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
+       0,    255,    255,    254,    254,    253,    253,    252, 
+     252,    251,    250,    248,    247,    245,    243,    240, 
 };
 const prog_uint8_t wav_res_bandlimited_square_0[] PROGMEM = {
       43,     43,     43,     43,     44,     44,     45,     46, 
@@ -1754,6 +1595,74 @@ const prog_uint8_t wav_res_vowel_data[] PROGMEM = {
       81,    195,      0,      9,     51,     95,    243,      3, 
        6,     73,     99,    122,    233, 
 };
+const prog_uint8_t wav_res_env_attack_curve[] PROGMEM = {
+       0,      2,      5,      7,      9,     11,     14,     16, 
+      18,     20,     22,     24,     26,     28,     31,     33, 
+      35,     37,     39,     41,     43,     45,     47,     49, 
+      50,     52,     54,     56,     58,     60,     62,     63, 
+      65,     67,     69,     71,     72,     74,     76,     77, 
+      79,     81,     82,     84,     86,     87,     89,     91, 
+      92,     94,     95,     97,     98,    100,    102,    103, 
+     105,    106,    107,    109,    110,    112,    113,    115, 
+     116,    117,    119,    120,    122,    123,    124,    126, 
+     127,    128,    129,    131,    132,    133,    135,    136, 
+     137,    138,    140,    141,    142,    143,    144,    145, 
+     147,    148,    149,    150,    151,    152,    153,    155, 
+     156,    157,    158,    159,    160,    161,    162,    163, 
+     164,    165,    166,    167,    168,    169,    170,    171, 
+     172,    173,    174,    175,    176,    177,    178,    179, 
+     179,    180,    181,    182,    183,    184,    185,    186, 
+     186,    187,    188,    189,    190,    191,    191,    192, 
+     193,    194,    195,    195,    196,    197,    198,    198, 
+     199,    200,    201,    201,    202,    203,    204,    204, 
+     205,    206,    206,    207,    208,    208,    209,    210, 
+     210,    211,    212,    212,    213,    214,    214,    215, 
+     216,    216,    217,    217,    218,    219,    219,    220, 
+     220,    221,    222,    222,    223,    223,    224,    224, 
+     225,    225,    226,    226,    227,    228,    228,    229, 
+     229,    230,    230,    231,    231,    232,    232,    233, 
+     233,    234,    234,    235,    235,    235,    236,    236, 
+     237,    237,    238,    238,    239,    239,    239,    240, 
+     240,    241,    241,    242,    242,    242,    243,    243, 
+     244,    244,    244,    245,    245,    246,    246,    246, 
+     247,    247,    248,    248,    248,    249,    249,    249, 
+     250,    250,    250,    251,    251,    251,    252,    252, 
+     252,    253,    253,    253,    254,    254,    254,    255, 
+};
+const prog_uint8_t wav_res_env_decay_curve[] PROGMEM = {
+       0,      5,     10,     15,     19,     24,     28,     33, 
+      37,     41,     46,     50,     54,     58,     61,     65, 
+      69,     73,     76,     80,     83,     86,     90,     93, 
+      96,     99,    102,    105,    108,    111,    114,    117, 
+     119,    122,    125,    127,    130,    132,    135,    137, 
+     139,    141,    144,    146,    148,    150,    152,    154, 
+     156,    158,    160,    162,    164,    166,    167,    169, 
+     171,    172,    174,    176,    177,    179,    180,    182, 
+     183,    185,    186,    187,    189,    190,    191,    193, 
+     194,    195,    196,    197,    199,    200,    201,    202, 
+     203,    204,    205,    206,    207,    208,    209,    210, 
+     211,    212,    212,    213,    214,    215,    216,    217, 
+     217,    218,    219,    220,    220,    221,    222,    222, 
+     223,    224,    224,    225,    226,    226,    227,    227, 
+     228,    228,    229,    230,    230,    231,    231,    232, 
+     232,    233,    233,    233,    234,    234,    235,    235, 
+     236,    236,    236,    237,    237,    238,    238,    238, 
+     239,    239,    239,    240,    240,    240,    241,    241, 
+     241,    242,    242,    242,    242,    243,    243,    243, 
+     244,    244,    244,    244,    245,    245,    245,    245, 
+     245,    246,    246,    246,    246,    246,    247,    247, 
+     247,    247,    247,    248,    248,    248,    248,    248, 
+     248,    249,    249,    249,    249,    249,    249,    250, 
+     250,    250,    250,    250,    250,    250,    250,    251, 
+     251,    251,    251,    251,    251,    251,    251,    251, 
+     252,    252,    252,    252,    252,    252,    252,    252, 
+     252,    252,    252,    253,    253,    253,    253,    253, 
+     253,    253,    253,    253,    253,    253,    253,    253, 
+     253,    254,    254,    254,    254,    254,    254,    254, 
+     254,    254,    254,    254,    254,    254,    254,    254, 
+     254,    254,    254,    254,    255,    255,    255,    255, 
+     255,    255,    255,    255,    255,    255,    255,    255, 
+};
 
 
 const prog_uint8_t* waveform_table[] = {
@@ -1782,6 +1691,8 @@ const prog_uint8_t* waveform_table[] = {
   wav_res_bandlimited_square_6,
   wav_res_wavetable,
   wav_res_vowel_data,
+  wav_res_env_attack_curve,
+  wav_res_env_decay_curve,
 };
 
 const prog_uint8_t chr_res_special_characters[] PROGMEM = {
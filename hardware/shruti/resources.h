@@ -35,7 +35,9 @@ namespace hardware_shruti {
 
 typedef uint8_t ResourceId;
 
-extern const prog_char* string_table[];
+extern const prog_uint16_t string_table[] PROGMEM;
+extern const prog_uint8_t string_data[] PROGMEM;
+extern const prog_uint8_t string_alphabet[] PROGMEM;
 
 extern const prog_uint16_t* lookup_table_table[];
 
@@ -45,7 +47,6 @@ extern const prog_uint8_t* character_table[];
 
 extern const prog_uint16_t lut_res_lfo_increments[] PROGMEM;
 extern const prog_uint16_t lut_res_env_portamento_increments[] PROGMEM;
-extern const prog_uint16_t lut_res_oscillator_increments[] PROGMEM;
 extern const prog_uint16_t lut_res_fm_frequency_ratios[] PROGMEM;
 extern const prog_uint16_t lut_res_scale_just[] PROGMEM;
 extern const prog_uint16_t lut_res_scale_pythagorean[] PROGMEM;
@@ -84,6 +85,7 @@ extern const prog_uint16_t lut_res_groove_shuffle[] PROGMEM;
 extern const prog_uint16_t lut_res_groove_push[] PROGMEM;
 extern const prog_uint16_t lut_res_groove_lag[] PROGMEM;
 extern const prog_uint16_t lut_res_groove_human[] PROGMEM;
+extern const prog_uint16_t lut_res_svf_cutoff[] PROGMEM;
 extern const prog_uint8_t wav_res_formant_sine[] PROGMEM;
 extern const prog_uint8_t wav_res_formant_square[] PROGMEM;
 extern const prog_uint8_t wav_res_bandlimited_square_0[] PROGMEM;
@@ -107,6 +109,8 @@ extern const prog_uint8_t wav_res_bandlimited_triangle_4[] PROGMEM;
 extern const prog_uint8_t wav_res_bandlimited_triangle_5[] PROGMEM;
 extern const prog_uint8_t wav_res_wavetable[] PROGMEM;
 extern const prog_uint8_t wav_res_vowel_data[] PROGMEM;
+extern const prog_uint8_t wav_res_env_attack_curve[] PROGMEM;
+extern const prog_uint8_t wav_res_env_decay_curve[] PROGMEM;
 extern const prog_uint8_t chr_res_special_characters[] PROGMEM;
 #define STR_RES_PRM 0  // prm
 #define STR_RES_RNG 1  // rng
@@ -267,127 +271,133 @@ extern const prog_uint8_t chr_res_special_characters[] PROGMEM;
 #define STR_RES__2_EXT 156  // /2 ext
 #define STR_RES__4_EXT 157  // /4 ext
 #define STR_RES__8_EXT 158  // /8 ext
-#define STR_RES_MUTABLE____V0_59 159  // mutable    v0.59
-#define STR_RES_INSTRUMENTS_671 160  // instruments -1
-#define STR_RES_EQUAL 161  // equal
-#define STR_RES_JUST 162  // just
-#define STR_RES_PYTHAG 163  // pythag
-#define STR_RES_1_4_EB 164  // 1/4 eb
-#define STR_RES_1_4_E 165  // 1/4 e
-#define STR_RES_1_4_EA 166  // 1/4 ea
-#define STR_RES_BHAIRA 167  // bhaira
-#define STR_RES_GUNAKR 168  // gunakr
-#define STR_RES_MARWA 169  // marwa
-#define STR_RES_SHREE 170  // shree
-#define STR_RES_PURVI 171  // purvi
-#define STR_RES_BILAWA 172  // bilawa
-#define STR_RES_YAMAN 173  // yaman
-#define STR_RES_KAFI 174  // kafi
-#define STR_RES_BHIMPA 175  // bhimpa
-#define STR_RES_DARBAR 176  // darbar
-#define STR_RES_BAGESH 177  // bagesh
-#define STR_RES_RAGESH 178  // ragesh
-#define STR_RES_KHAMAJ 179  // khamaj
-#define STR_RES_MIMAL 180  // mi'mal
-#define STR_RES_PARAME 181  // parame
-#define STR_RES_RANGES 182  // ranges
-#define STR_RES_GANGES 183  // ganges
-#define STR_RES_KAMESH 184  // kamesh
-#define STR_RES_PALAS_ 185  // palas 
-#define STR_RES_NATBHA 186  // natbha
-#define STR_RES_M_KAUN 187  // m.kaun
-#define STR_RES_BAIRAG 188  // bairag
-#define STR_RES_B_TODI 189  // b.todi
-#define STR_RES_CHANDR 190  // chandr
-#define STR_RES_KAUSHI 191  // kaushi
-#define STR_RES_JOGESH 192  // jogesh
-#define STR_RES_RASIA 193  // rasia
+#define STR_RES_RENDER_COST 159  // render cost
+#define STR_RES_CPU 160  // cpu
+#define STR_RES_MEMORY 161  // memory
+#define STR_RES_RAM 162  // ram
+#define STR_RES_STK 163  // stk
+#define STR_RES_MIN 164  // min
+#define STR_RES_MUTABLE____V0_59 165  // mutable    v0.59
+#define STR_RES_INSTRUMENTS_671 166  // instruments -1
+#define STR_RES_EQUAL 167  // equal
+#define STR_RES_JUST 168  // just
+#define STR_RES_PYTHAG 169  // pythag
+#define STR_RES_1_4_EB 170  // 1/4 eb
+#define STR_RES_1_4_E 171  // 1/4 e
+#define STR_RES_1_4_EA 172  // 1/4 ea
+#define STR_RES_BHAIRA 173  // bhaira
+#define STR_RES_GUNAKR 174  // gunakr
+#define STR_RES_MARWA 175  // marwa
+#define STR_RES_SHREE 176  // shree
+#define STR_RES_PURVI 177  // purvi
+#define STR_RES_BILAWA 178  // bilawa
+#define STR_RES_YAMAN 179  // yaman
+#define STR_RES_KAFI 180  // kafi
+#define STR_RES_BHIMPA 181  // bhimpa
+#define STR_RES_DARBAR 182  // darbar
+#define STR_RES_BAGESH 183  // bagesh
+#define STR_RES_RAGESH 184  // ragesh
+#define STR_RES_KHAMAJ 185  // khamaj
+#define STR_RES_MIMAL 186  // mi'mal
+#define STR_RES_PARAME 187  // parame
+#define STR_RES_RANGES 188  // ranges
+#define STR_RES_GANGES 189  // ganges
+#define STR_RES_KAMESH 190  // kamesh
+#define STR_RES_PALAS_ 191  // palas 
+#define STR_RES_NATBHA 192  // natbha
+#define STR_RES_M_KAUN 193  // m.kaun
+#define STR_RES_BAIRAG 194  // bairag
+#define STR_RES_B_TODI 195  // b.todi
+#define STR_RES_CHANDR 196  // chandr
+#define STR_RES_KAUSHI 197  // kaushi
+#define STR_RES_JOGESH 198  // jogesh
+#define STR_RES_RASIA 199  // rasia
 #define LUT_RES_LFO_INCREMENTS 0
 #define LUT_RES_LFO_INCREMENTS_SIZE 128
 #define LUT_RES_ENV_PORTAMENTO_INCREMENTS 1
 #define LUT_RES_ENV_PORTAMENTO_INCREMENTS_SIZE 128
-#define LUT_RES_OSCILLATOR_INCREMENTS 2
-#define LUT_RES_OSCILLATOR_INCREMENTS_SIZE 768
-#define LUT_RES_FM_FREQUENCY_RATIOS 3
+#define LUT_RES_FM_FREQUENCY_RATIOS 2
 #define LUT_RES_FM_FREQUENCY_RATIOS_SIZE 25
-#define LUT_RES_SCALE_JUST 4
+#define LUT_RES_SCALE_JUST 3
 #define LUT_RES_SCALE_JUST_SIZE 12
-#define LUT_RES_SCALE_PYTHAGOREAN 5
+#define LUT_RES_SCALE_PYTHAGOREAN 4
 #define LUT_RES_SCALE_PYTHAGOREAN_SIZE 12
-#define LUT_RES_SCALE_1_4_EB 6
+#define LUT_RES_SCALE_1_4_EB 5
 #define LUT_RES_SCALE_1_4_EB_SIZE 12
-#define LUT_RES_SCALE_1_4_E 7
+#define LUT_RES_SCALE_1_4_E 6
 #define LUT_RES_SCALE_1_4_E_SIZE 12
-#define LUT_RES_SCALE_1_4_EA 8
+#define LUT_RES_SCALE_1_4_EA 7
 #define LUT_RES_SCALE_1_4_EA_SIZE 12
-#define LUT_RES_SCALE_BHAIRAV 9
+#define LUT_RES_SCALE_BHAIRAV 8
 #define LUT_RES_SCALE_BHAIRAV_SIZE 12
-#define LUT_RES_SCALE_GUNAKRI 10
+#define LUT_RES_SCALE_GUNAKRI 9
 #define LUT_RES_SCALE_GUNAKRI_SIZE 12
-#define LUT_RES_SCALE_MARWA 11
+#define LUT_RES_SCALE_MARWA 10
 #define LUT_RES_SCALE_MARWA_SIZE 12
-#define LUT_RES_SCALE_SHREE 12
+#define LUT_RES_SCALE_SHREE 11
 #define LUT_RES_SCALE_SHREE_SIZE 12
-#define LUT_RES_SCALE_PURVI 13
+#define LUT_RES_SCALE_PURVI 12
 #define LUT_RES_SCALE_PURVI_SIZE 12
-#define LUT_RES_SCALE_BILAWAL 14
+#define LUT_RES_SCALE_BILAWAL 13
 #define LUT_RES_SCALE_BILAWAL_SIZE 12
-#define LUT_RES_SCALE_YAMAN 15
+#define LUT_RES_SCALE_YAMAN 14
 #define LUT_RES_SCALE_YAMAN_SIZE 12
-#define LUT_RES_SCALE_KAFI 16
+#define LUT_RES_SCALE_KAFI 15
 #define LUT_RES_SCALE_KAFI_SIZE 12
-#define LUT_RES_SCALE_BHIMPALASREE 17
+#define LUT_RES_SCALE_BHIMPALASREE 16
 #define LUT_RES_SCALE_BHIMPALASREE_SIZE 12
-#define LUT_RES_SCALE_DARBARI 18
+#define LUT_RES_SCALE_DARBARI 17
 #define LUT_RES_SCALE_DARBARI_SIZE 12
-#define LUT_RES_SCALE_BAGESHREE 19
+#define LUT_RES_SCALE_BAGESHREE 18
 #define LUT_RES_SCALE_BAGESHREE_SIZE 12
-#define LUT_RES_SCALE_RAGESHREE 20
+#define LUT_RES_SCALE_RAGESHREE 19
 #define LUT_RES_SCALE_RAGESHREE_SIZE 12
-#define LUT_RES_SCALE_KHAMAJ 21
+#define LUT_RES_SCALE_KHAMAJ 20
 #define LUT_RES_SCALE_KHAMAJ_SIZE 12
-#define LUT_RES_SCALE_MIMAL 22
+#define LUT_RES_SCALE_MIMAL 21
 #define LUT_RES_SCALE_MIMAL_SIZE 12
-#define LUT_RES_SCALE_PARAMESHWARI 23
+#define LUT_RES_SCALE_PARAMESHWARI 22
 #define LUT_RES_SCALE_PARAMESHWARI_SIZE 12
-#define LUT_RES_SCALE_RANGESHWARI 24
+#define LUT_RES_SCALE_RANGESHWARI 23
 #define LUT_RES_SCALE_RANGESHWARI_SIZE 12
-#define LUT_RES_SCALE_GANGESHWARI 25
+#define LUT_RES_SCALE_GANGESHWARI 24
 #define LUT_RES_SCALE_GANGESHWARI_SIZE 12
-#define LUT_RES_SCALE_KAMESHWARI 26
+#define LUT_RES_SCALE_KAMESHWARI 25
 #define LUT_RES_SCALE_KAMESHWARI_SIZE 12
-#define LUT_RES_SCALE_PALAS_KAFI 27
+#define LUT_RES_SCALE_PALAS_KAFI 26
 #define LUT_RES_SCALE_PALAS_KAFI_SIZE 12
-#define LUT_RES_SCALE_NATBHAIRAV 28
+#define LUT_RES_SCALE_NATBHAIRAV 27
 #define LUT_RES_SCALE_NATBHAIRAV_SIZE 12
-#define LUT_RES_SCALE_M_KAUNS 29
+#define LUT_RES_SCALE_M_KAUNS 28
 #define LUT_RES_SCALE_M_KAUNS_SIZE 12
-#define LUT_RES_SCALE_BAIRAGI 30
+#define LUT_RES_SCALE_BAIRAGI 29
 #define LUT_RES_SCALE_BAIRAGI_SIZE 12
-#define LUT_RES_SCALE_B_TODI 31
+#define LUT_RES_SCALE_B_TODI 30
 #define LUT_RES_SCALE_B_TODI_SIZE 12
-#define LUT_RES_SCALE_CHANDRADEEP 32
+#define LUT_RES_SCALE_CHANDRADEEP 31
 #define LUT_RES_SCALE_CHANDRADEEP_SIZE 12
-#define LUT_RES_SCALE_KAUSHIK_TODI 33
+#define LUT_RES_SCALE_KAUSHIK_TODI 32
 #define LUT_RES_SCALE_KAUSHIK_TODI_SIZE 12
-#define LUT_RES_SCALE_JOGESHWARI 34
+#define LUT_RES_SCALE_JOGESHWARI 33
 #define LUT_RES_SCALE_JOGESHWARI_SIZE 12
-#define LUT_RES_SCALE_RASIA 35
+#define LUT_RES_SCALE_RASIA 34
 #define LUT_RES_SCALE_RASIA_SIZE 12
-#define LUT_RES_ARPEGGIATOR_PATTERNS 36
+#define LUT_RES_ARPEGGIATOR_PATTERNS 35
 #define LUT_RES_ARPEGGIATOR_PATTERNS_SIZE 15
-#define LUT_RES_TURBO_TEMPI 37
+#define LUT_RES_TURBO_TEMPI 36
 #define LUT_RES_TURBO_TEMPI_SIZE 6
-#define LUT_RES_GROOVE_SWING 38
+#define LUT_RES_GROOVE_SWING 37
 #define LUT_RES_GROOVE_SWING_SIZE 16
-#define LUT_RES_GROOVE_SHUFFLE 39
+#define LUT_RES_GROOVE_SHUFFLE 38
 #define LUT_RES_GROOVE_SHUFFLE_SIZE 16
-#define LUT_RES_GROOVE_PUSH 40
+#define LUT_RES_GROOVE_PUSH 39
 #define LUT_RES_GROOVE_PUSH_SIZE 16
-#define LUT_RES_GROOVE_LAG 41
+#define LUT_RES_GROOVE_LAG 40
 #define LUT_RES_GROOVE_LAG_SIZE 16
-#define LUT_RES_GROOVE_HUMAN 42
+#define LUT_RES_GROOVE_HUMAN 41
 #define LUT_RES_GROOVE_HUMAN_SIZE 16
+#define LUT_RES_SVF_CUTOFF 42
+#define LUT_RES_SVF_CUTOFF_SIZE 33
 #define WAV_RES_FORMANT_SINE 0
 #define WAV_RES_FORMANT_SINE_SIZE 256
 #define WAV_RES_FORMANT_SQUARE 1
@@ -438,12 +448,18 @@ extern const prog_uint8_t chr_res_special_characters[] PROGMEM;
 #define WAV_RES_WAVETABLE_SIZE 2064
 #define WAV_RES_VOWEL_DATA 24
 #define WAV_RES_VOWEL_DATA_SIZE 45
+#define WAV_RES_ENV_ATTACK_CURVE 25
+#define WAV_RES_ENV_ATTACK_CURVE_SIZE 256
+#define WAV_RES_ENV_DECAY_CURVE 26
+#define WAV_RES_ENV_DECAY_CURVE_SIZE 256
 #define CHR_RES_SPECIAL_CHARACTERS 0
 #define CHR_RES_SPECIAL_CHARACTERS_SIZE 64
 typedef hardware_resources::ResourcesManager<
     ResourceId,
-    hardware_resources::ResourcesTables<
+    hardware_resources::PackedResourcesTables<
         string_table,
+        string_data,
+        string_alphabet,
         lookup_table_table> > ResourcesManager; 
 
 }  // namespace hardware_shruti
@@ -20,6 +20,8 @@
 # Lookup table definitions.
 
 import numpy
+import os
+import re
 
 """----------------------------------------------------------------------------
 LFO and envelope increments.
@@ -27,8 +29,19 @@ LFO and envelope increments.
 
 lookup_tables = []
 
-sample_rate = 31250.0
-control_rate = sample_rate / 32
+def ReadConstant(name):
+  """Reads the value of an integer constant defined in shruti.h."""
+  header = os.path.join(os.path.dirname(__file__), '..', 'shruti.h')
+  definition = re.compile(r'static const \w+ %s = (\d+);' % name)
+  for line in file(header):
+    match = definition.match(line)
+    if match:
+      return int(match.group(1))
+  raise ValueError('%s is not defined in shruti.h' % name)
+
+
+sample_rate = float(ReadConstant('kSampleRate'))
+control_rate = sample_rate / ReadConstant('kControlRate')
 min_frequency = 1.0 / 16.0  # Hertz
 max_frequency = 100.0  # Hertz
 
@@ -60,17 +73,8 @@ lookup_tables.append(
     ('env_portamento_increments', numpy.power(rates, -1/gamma).astype(int))
 )
 
-# Create table for pitch.
-a4_midi = 69
-a4_pitch = 440.0
-excursion = 65536.0
-notes = numpy.arange(96 * 128.0, (96 + 12) * 128.0, 2)
-pitches = a4_pitch * 2 ** ((notes - a4_midi * 128) / (128 * 12))
-increments = excursion / sample_rate * pitches
-
-lookup_tables.append(
-    ('oscillator_increments', increments.astype(int))
-)
+# The table of oscillator increments is computed at compile time, see
+# pitch_table.h.
 
 
 """----------------------------------------------------------------------------
@@ -407,3 +411,20 @@ lookup_tables.extend([
     ('groove_human', ConvertGrooveTemplate(
       [0.7, -0.8, 0.85, -0.75, 0.7, -0.7,  0.4, -0.3,
        0.5, -0.7, 0.8, -0.75, 0.8, -1, 0.5, -0.25]))])
+
+
+"""----------------------------------------------------------------------------
+Cutoff frequency coefficients of the digital state variable filter
+----------------------------------------------------------------------------"""
+
+# 33 entries, so that the 8-bit cutoff can be interpolated between two entries
+# from 40 Hz to 5120 Hz - above which the filter becomes unstable at high
+# resonance. The coefficient is 2 sin(pi f / sr), in 2.14 fixed point.
+min_frequency = 40.0  # Hertz
+num_octaves = 7
+
+frequencies = min_frequency * 2 ** (numpy.arange(33) * num_octaves / 32.0)
+lookup_tables.append(
+    ('svf_cutoff',
+     (2 * numpy.sin(numpy.pi * frequencies / sample_rate) * 16384).astype(int))
+)
@@ -52,6 +52,7 @@ includes = """
 #include <avr/pgmspace.h>
 """
 create_specialized_manager = True
+packed_strings = True
 
 
 import characters
@@ -193,6 +193,13 @@ x2 ext
 /4 ext
 /8 ext
 
+render cost
+cpu
+memory
+ram
+stk
+min
+
 mutable    v0.59
 instruments \x06\x07-1
 equal
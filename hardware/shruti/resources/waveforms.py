@@ -20,6 +20,7 @@
 # Waveform definitions.
 
 import numpy
+import os
 
 """----------------------------------------------------------------------------
 Waveforms for vowel synthesis
@@ -165,9 +166,55 @@ def LoadWavetable(x):
   return wavetable.ravel()
 
 
-waveforms.append((
-    'wavetable',
-    LoadWavetable('hardware/shruti/data/wavetable.bin')))
+def IsDefined(flag):
+  """Returns True if a flag is defined - and not commented out - in shruti.h."""
+  header = os.path.join(os.path.dirname(__file__), '..', 'shruti.h')
+  return any(line.strip() == '#define %s' % flag for line in file(header))
+
+
+def CompressWavetable(x):
+  """Codes each cycle of 128 samples as 4-bit deltas.
+
+  A cycle is stored as its first sample, a shift, and 127 signed deltas scaled
+  by 2 ** shift, packed two per byte with the high nibble first. The deltas are
+  taken from the decoded signal rather than from the source, so that the
+  errors do not accumulate, and the shift with the smallest error is chosen
+  for each cycle. The decoder in wavetable_cache.cc mirrors this.
+  """
+  array = map(ord, list(file(x).read()))
+  cycle = 128
+  assert len(array) == 16 * cycle
+  data = []
+  for i in xrange(16):
+    source = array[i * cycle:(i + 1) * cycle]
+    best = None
+    for shift in xrange(8):
+      sample = source[0]
+      deltas = []
+      error = 0
+      for target in source[1:]:
+        delta = int(round((target - sample) / float(1 << shift)))
+        delta = max(-8, min(7, delta))
+        sample = max(0, min(255, sample + (delta << shift)))
+        deltas.append(delta & 0xf)
+        error += (target - sample) ** 2
+      if best is None or error < best[0]:
+        best = (error, shift, deltas)
+    error, shift, deltas = best
+    deltas.append(0)
+    data.extend([source[0], shift])
+    data.extend([(deltas[j] << 4) | deltas[j + 1] for j in xrange(0, cycle, 2)])
+  return data
+
+
+if IsDefined('HAS_COMPRESSED_WAVETABLE'):
+  waveforms.append((
+      'wavetable',
+      CompressWavetable('hardware/shruti/data/wavetable.bin')))
+else:
+  waveforms.append((
+      'wavetable',
+      LoadWavetable('hardware/shruti/data/wavetable.bin')))
 
 
 """----------------------------------------------------------------------------
@@ -186,3 +233,18 @@ vowel_data = [
  6, 73,  99, 122, 233]
 
 waveforms.append(('vowel_data', vowel_data))
+
+
+"""----------------------------------------------------------------------------
+Envelope curves (fraction of the stage covered, as a function of the phase)
+-----------------------------------------------------------------------------"""
+
+def EnvelopeCurve(k):
+  x = numpy.arange(0, 256) / 256.0
+  return numpy.round(255 * (1 - numpy.exp(-k * x)) / (1 - numpy.exp(-k)))
+
+
+# The attack is the charge of a capacitor towards a voltage above the maximum
+# level, the decay and release are exponential.
+waveforms.append(('env_attack_curve', EnvelopeCurve(2.0).astype(int)))
+waveforms.append(('env_decay_curve', EnvelopeCurve(5.0).astype(int)))
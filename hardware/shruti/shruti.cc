@@ -13,35 +13,54 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <string.h>
+
 #include "hardware/hal/adc.h"
 #include "hardware/hal/audio_output.h"
+#include "hardware/hal/cycle_counter.h"
+#include "hardware/hal/devices/mcp492x.h"
 #include "hardware/hal/devices/output_array.h"
 #include "hardware/hal/devices/shift_register.h"
 #include "hardware/hal/gpio.h"
 #include "hardware/hal/init_atmega.h"
 #include "hardware/hal/input_array.h"
+#include "hardware/hal/memory_monitor.h"
 #include "hardware/hal/serial.h"
 #include "hardware/hal/time.h"
 #include "hardware/hal/timer.h"
 #include "hardware/midi/midi.h"
 #include "hardware/shruti/display.h"
 #include "hardware/shruti/editor.h"
+#include "hardware/shruti/eeprom_writer.h"
+#include "hardware/shruti/glitch_log.h"
+#include "hardware/shruti/latency_probe.h"
+#include "hardware/shruti/load_governor.h"
+#include "hardware/shruti/midi_out.h"
+#include "hardware/shruti/patch_library.h"
+#include "hardware/shruti/pattern_bank.h"
+#include "hardware/shruti/render_cost.h"
 #include "hardware/shruti/synthesis_engine.h"
+#include "hardware/shruti/trace.h"
 #include "hardware/utils/task.h"
 
 using namespace hardware_hal;
 using namespace hardware_midi;
 using namespace hardware_shruti;
 
+using hardware_utils::DeadlineScheduler;
+using hardware_utils::kNoUrgentTask;
 using hardware_utils::NaiveScheduler;
+using hardware_utils::NoTaskProfiler;
 using hardware_utils::Task;
+using hardware_utils::TaskProfiler;
 
-// Midi input.
+// Midi input, buffered by the RX interrupt. Midi output (thru), polled - or
+// queued and sent by the TX interrupt.
 Serial<SerialPort0, 31250, BUFFERED, POLLED> midi_io;
 
 // Input event handlers.
 typedef InputArray<
-    AnalogInput<kPinAnalogInput>,
+    ScannedAnalogInput<kPinAnalogInput>,
     kNumEditingPots,
     8> Pots;
 
@@ -62,34 +81,281 @@ ShiftRegister<
     Gpio<kPinClk>,
     Gpio<kPinData>, 8, MSB_FIRST> input_mux;
 
+#ifdef HAS_LED_BIT_PLANES
+// LED array, refreshed from the audio interrupt every kLedRefreshPeriod
+// samples.
+BitPlaneOutputArray<
+    Gpio<kPinOutputLatch>,
+    Gpio<kPinClk>,
+    Gpio<kPinData>, kNumPages, 4, MSB_FIRST> leds;
+
+static const uint8_t kLedRefreshPeriod = 16;
+static const uint8_t kUpdateLedsTaskPriority = 1;
+uint8_t led_refresh_countdown = kLedRefreshPeriod;
+#else
 // LED array.
 OutputArray<
     Gpio<kPinOutputLatch>, 
     Gpio<kPinClk>,
     Gpio<kPinData>, kNumPages, 4, MSB_FIRST, false> leds;
 
+static const uint8_t kUpdateLedsTaskPriority = 4;
+#endif  // HAS_LED_BIT_PLANES
+
+#ifdef HAS_GLITCH_LOG
+typedef GlitchLog UnderrunLog;
+#else
+typedef NoUnderrunMonitor UnderrunLog;
+#endif  // HAS_GLITCH_LOG
+
+#ifdef HAS_TRACE
+uint8_t trace_in_underrun;
+
+// Traces the first missed sample of each burst of underruns, before handing
+// over to the glitch log.
+struct AudioMonitor {
+  static inline void SampleEmitted(uint8_t level) {
+    trace_in_underrun = 0;
+    UnderrunLog::SampleEmitted(level);
+  }
+  static inline void Underrun() {
+    if (!trace_in_underrun) {
+      trace_in_underrun = 1;
+      Trace::Write(TRACE_UNDERRUN, 0);
+    }
+    UnderrunLog::Underrun();
+  }
+};
+#else
+typedef UnderrunLog AudioMonitor;
+#endif  // HAS_TRACE
+
+#ifdef HAS_DAC_OUTPUT
+// Audio output on the DAC, written from the timer 2 interrupt.
+typedef Dac<kPinDacSlaveSelect, UNBUFFERED_REFERENCE, 1, 12> AudioDac;
+AudioOutput<AudioDac, kAudioBufferSize, kAudioBlockSize, HOLD_SAMPLE,
+            AudioMonitor> audio_out;
+#else
 // Audio output on pin 3.
-AudioOutput<PwmOutput<kPinVcoOut>, kAudioBufferSize, kAudioBlockSize> audio_out;
+AudioOutput<PwmOutput<kPinVcoOut>, kAudioBufferSize, kAudioBlockSize,
+            HOLD_SAMPLE, AudioMonitor> audio_out;
+#endif  // HAS_DAC_OUTPUT
 
 MidiStreamParser<SynthesisEngine> midi_parser;
 
+#if defined(HAS_TASK_PROFILING) || defined(HAS_RENDER_COST_CALIBRATION) || \
+    defined(HAS_LATENCY_PROBE)
+#define HAS_PROFILER_CLOCK
+#endif
+
+#ifdef HAS_PROFILER_CLOCK
+// Timer 2 runs the audio interrupt, so its overflows are already counted there.
+typedef CycleCounter<2> ProfilerClock;
+#endif  // HAS_PROFILER_CLOCK
+
+#ifdef HAS_TASK_PROFILING
+typedef TaskProfiler<ProfilerClock, kSchedulerMaxNumTasks> Profiler;
+
+void SysExSendTaskProfile() {
+  Patch::SysExSendMessage(
+      SYSEX_COMMAND_TASK_PROFILE,
+      kSchedulerMaxNumTasks,
+      reinterpret_cast<const uint8_t*>(Profiler::statistics()),
+      Profiler::size());
+}
+#else
+typedef NoTaskProfiler Profiler;
+#endif  // HAS_TASK_PROFILING
+
+#ifdef HAS_GLITCH_LOG
+// Tells the glitch log which task is running, before handing over to the
+// task profiler.
+struct SchedulerProfiler {
+  static inline void TaskStarted(uint8_t task) {
+    GlitchLog::TaskStarted(task);
+    Profiler::TaskStarted(task);
+  }
+  static inline void TaskEnded(uint8_t task) {
+    Profiler::TaskEnded(task);
+    GlitchLog::TaskEnded(task);
+  }
+};
+
+void SysExSendGlitchLog() {
+  Patch::SysExSendMessage(
+      SYSEX_COMMAND_GLITCH_LOG,
+      kNumGlitchRecords,
+      reinterpret_cast<const uint8_t*>(GlitchLog::report()),
+      GlitchLog::size());
+}
+#else
+typedef Profiler SchedulerProfiler;
+#endif  // HAS_GLITCH_LOG
+
+#ifdef HAS_LATENCY_PROBE
+void SysExSendLatency() {
+  Patch::SysExSendMessage(
+      SYSEX_COMMAND_LATENCY,
+      0,
+      reinterpret_cast<const uint8_t*>(LatencyProbe::statistics()),
+      LatencyProbe::size());
+}
+#endif  // HAS_LATENCY_PROBE
+
+#ifdef HAS_TRACE
+void SysExSendTrace() {
+  Trace::Freeze();
+  Patch::SysExSendMessage(
+      SYSEX_COMMAND_TRACE,
+      Trace::write_ptr(),
+      reinterpret_cast<const uint8_t*>(Trace::records()),
+      Trace::size());
+  Trace::Unfreeze();
+}
+#endif  // HAS_TRACE
+
+#ifdef HAS_RAM_MONITORING
+void SysExSendMemoryUsage() {
+  MemoryUsage usage;
+  MemoryMonitor::Measure(&usage);
+  Patch::SysExSendMessage(
+      SYSEX_COMMAND_MEMORY_USAGE,
+      0,
+      reinterpret_cast<const uint8_t*>(&usage),
+      sizeof(usage));
+}
+#endif  // HAS_RAM_MONITORING
+
+#ifdef HAS_ADAPTIVE_BUFFER_DEPTH
+// A block is rendered when fewer than audio_buffer_target samples are queued.
+// The target starts at its maximum - the whole buffer, minus the room for the
+// block. It is lowered by one block when, for a whole observation period,
+// more than kAudioBufferShrinkSlack samples were still queued each time a
+// block was ready; and raised by one block after each underrun.
+static const uint8_t kMinAudioBufferTarget = kAudioBlockSize;
+static const uint8_t kMaxAudioBufferTarget = kAudioBufferSize -
+    kAudioBlockSize;
+static const uint8_t kAudioBufferShrinkSlack = kAudioBlockSize +
+    kAudioBlockSize / 2;
+// In blocks, about 0.25s.
+static const uint8_t kAudioBufferObservationPeriod = 255;
+
+uint8_t audio_buffer_target = kMaxAudioBufferTarget;
+uint8_t audio_buffer_min_slack;
+uint8_t audio_buffer_num_observed_blocks;
+uint16_t audio_buffer_num_glitches;
+
+// Called once a block has been rendered, with the number of samples still
+// queued.
+void AdaptAudioBufferTarget(uint8_t slack) {
+  uint16_t num_glitches = audio_out.num_glitches();
+  if (num_glitches != audio_buffer_num_glitches || slack == 0) {
+    audio_buffer_num_glitches = num_glitches;
+    if (audio_buffer_target < kMaxAudioBufferTarget) {
+      audio_buffer_target += kAudioBlockSize;
+    }
+    audio_buffer_num_observed_blocks = 0;
+    return;
+  }
+  if (audio_buffer_num_observed_blocks == 0 ||
+      slack < audio_buffer_min_slack) {
+    audio_buffer_min_slack = slack;
+  }
+  if (++audio_buffer_num_observed_blocks == kAudioBufferObservationPeriod) {
+    if (audio_buffer_min_slack > kAudioBufferShrinkSlack &&
+        audio_buffer_target > kMinAudioBufferTarget) {
+      audio_buffer_target -= kAudioBlockSize;
+    }
+    audio_buffer_num_observed_blocks = 0;
+  }
+}
+
+static inline uint8_t AudioBlockRequested() {
+  return audio_out.readable() < audio_buffer_target;
+}
+#else
+static inline uint8_t AudioBlockRequested() {
+  return audio_out.writable_block();
+}
+#endif  // HAS_ADAPTIVE_BUFFER_DEPTH
+
+// Position of the tasks with a deadline in the task table.
+enum TaskIndex {
+  TASK_AUDIO_RENDERING = 0,
+  TASK_MIDI = 1,
+};
+
+#ifdef HAS_DEADLINE_SCHEDULER
+// Rendering a block as soon as there is room for one in the audio buffer - or
+// as soon as the buffer falls below its target level - always wins. Then, the
+// MIDI input buffer is drained as soon as it is half full - at 31.25kbps, this
+// leaves about 5ms before bytes get dropped. The other tasks get the remaining
+// time.
+static const uint8_t kMidiBacklogThreshold = kSerialInputBufferSize / 2;
+
+struct TaskDeadlines {
+  static inline uint8_t UrgentTask() {
+    if (AudioBlockRequested()) {
+      return TASK_AUDIO_RENDERING;
+    }
+    if (midi_io.readable() >= kMidiBacklogThreshold) {
+      return TASK_MIDI;
+    }
+    return kNoUrgentTask;
+  }
+};
+
+typedef DeadlineScheduler<
+    kSchedulerNumSlots,
+    TaskDeadlines,
+    SchedulerProfiler> Scheduler;
+
+// The audio rendering task is run on demand only.
+static const uint8_t kAudioRenderingTaskPriority = 0;
+#else
+typedef NaiveScheduler<kSchedulerNumSlots, SchedulerProfiler> Scheduler;
+
+static const uint8_t kAudioRenderingTaskPriority = 16;
+#endif  // HAS_DEADLINE_SCHEDULER
+
 static const uint16_t kDetailsPageDelay = 900;
 
 // What follows is a list of "tasks" - short functions handling a particular
 // aspect of the synth (rendering audio, updating the LCD display, etc). they
 // are called in sequence, with some tasks being more frequently called than
 // others, by the Scheduler.
+#ifdef HAS_LOAD_GOVERNOR
+uint8_t led_update_counter;
+uint8_t display_update_counter;
+#endif  // HAS_LOAD_GOVERNOR
+
 void UpdateLedsTask() {
+#ifdef HAS_LOAD_GOVERNOR
+  if (LoadGovernor::level() >= GOVERNOR_SLOW_UI &&
+      (++led_update_counter & 1)) {
+    return;
+  }
+#endif  // HAS_LOAD_GOVERNOR
   leds.Clear();
   if (editor.current_page() == PAGE_MOD_MATRIX) {
-    uint8_t current_modulation_source_value = engine.modulation_source(0,
+    uint8_t current_modulation_source_value = engine.modulation_source(
         engine.patch().modulation_matrix.modulation[
             editor.subpage()].source);
     leds.set_value(PAGE_MOD_MATRIX, current_modulation_source_value >> 4);
   } else if (editor.current_page() == PAGE_PERFORMANCE) {
     for (uint8_t i = 0; i < kNumModulationDestinations; ++i) {
-      leds.set_value(i, engine.voice(0).modulation_destination(i) >> 4);
+      leds.set_value(i, engine.modulation_destination(i) >> 4);
+    }
+#ifdef HAS_RENDER_COST_CALIBRATION
+  } else if (editor.current_page() == PAGE_RENDER_COST) {
+    // Bargraph of the estimated CPU load, full scale at 100%.
+    uint16_t load = RenderCost::load(engine.patch());
+    for (uint8_t i = 0; i < kNumPages; ++i) {
+      if (load * kNumPages > i * 100) {
+        leds.set_value(i, 15);
+      }
     }
+#endif  // HAS_RENDER_COST_CALIBRATION
   } else {
     leds.set_value(editor.current_page(), 15);
   }
@@ -103,7 +369,35 @@ void UpdateLedsTask() {
   leds.Output();
 }
 
+#ifdef HAS_FAST_BOOT
+// The LCD needs some time to switch to the new baud rate, then its settings
+// and custom characters are written a few bytes at a time, before the first
+// refresh.
+static const uint8_t kDisplayBootDelay = 200;  // ms
+uint8_t display_boot_position;
+uint8_t display_ready;
+#endif  // HAS_FAST_BOOT
+
 void UpdateDisplayTask() {
+#ifdef HAS_FAST_BOOT
+  if (!display_ready) {
+    if (milliseconds() < kDisplayBootDelay) {
+      return;
+    }
+    if (display_boot_position == 0) {
+      display.SetBrightness(29);
+    }
+    display_ready = display.UploadCustomCharMap(
+        character_table[0], 8, &display_boot_position);
+    return;
+  }
+#endif  // HAS_FAST_BOOT
+#ifdef HAS_LOAD_GOVERNOR
+  if (LoadGovernor::level() >= GOVERNOR_SLOW_UI &&
+      (++display_update_counter & 1)) {
+    return;
+  }
+#endif  // HAS_LOAD_GOVERNOR
   display.Update();
 }
 
@@ -112,7 +406,9 @@ void InputTask() {
   Pots::Event pot_event;
   static uint8_t idle;
   static uint8_t target_page_type;
-TASK_BEGIN_NEAR
+  static uint8_t pot_scan;
+  static uint8_t pot_read;
+TASK_BEGIN
   while (1) {
     idle = 0;
     target_page_type = PAGE_TYPE_ANY;
@@ -144,10 +440,33 @@ TASK_BEGIN_NEAR
       }
     }
     
-    // Select which analog/digital inputs we want to read by a write to the
-    // multiplexer register.
-    input_mux.Write((pots.active_input() << 3) | switches.active_input());    
-    pot_event = pots.Read();
+    // Read the pot selected by the previous write to the multiplexer, once
+    // the scanner has converted it.
+    pot_read = static_cast<uint8_t>(AdcScanner::num_scans() - pot_scan) >= 2;
+    if (pot_read) {
+      pot_event = pots.Read();
+    } else {
+      pot_event.event = EVENT_NONE;
+      pot_event.time = 0;
+    }
+    
+    // Select which analog/digital inputs we want to read next by a write to
+    // the multiplexer register.
+#ifdef HAS_LED_BIT_PLANES
+    {
+      // The LEDs are refreshed by the audio interrupt, on the same clock and
+      // data lines.
+      uint8_t old_sreg = SREG;
+      cli();
+      input_mux.Write((pots.active_input() << 3) | switches.active_input());
+      SREG = old_sreg;
+    }
+#else
+    input_mux.Write((pots.active_input() << 3) | switches.active_input());
+#endif  // HAS_LED_BIT_PLANES
+    if (pot_read) {
+      pot_scan = AdcScanner::num_scans();
+    }
     
     // Update the editor if something happened.
     // Revert back to the main page when nothing happened for 1.5s.
@@ -171,31 +490,52 @@ TASK_BEGIN_NEAR
 TASK_END
 }
 
-uint8_t current_cv;
-
-void CvTask() {
-  ++current_cv;
-  if (current_cv >= kNumCvInputs) {
-    current_cv = 0;
-  }
-  engine.set_cv(current_cv, Adc::Read(kPinCvInput + current_cv) >> 2);
-}
-
 void MidiTask() {
   // Always flush the MIDI buffer before continuing. This makes unlikely the
   // situation where MIDI bytes are dropped... at the cost of a more glitchy
   // audio output in case of MIDI overloading.
   uint8_t status = 0;
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+  // The next rendered block is played after the samples still buffered. The
+  // clock ticks are delayed by the free space in the buffer, so that they
+  // are played one full buffer after their reception.
+  engine.mutable_voice_controller()->set_sync_delay(audio_out.writable());
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
   while (midi_io.readable()) {
     uint8_t value = midi_io.ImmediateRead();
     
+#ifdef HAS_MIDI_MERGE
+    // Parse the message, and forward it to the output once complete.
+    status = midi_parser.PushByte(value);
+#ifdef HAS_POLY_CHAIN
+    // The notes not played by this unit have already been sent to the next
+    // one by the engine.
+    if (!engine.chained(status)) {
+      MidiThru::Forward(status, midi_parser.data());
+    }
+#else
+    MidiThru::Forward(status, midi_parser.data());
+#endif  // HAS_POLY_CHAIN
+#else
+#ifdef HAS_MIDI_OUTPUT_QUEUE
+    // Copy the byte to the MIDI output (thru). The output rate is the same as
+    // the input rate, so this only blocks if we are also sending a SysEx.
+    MidiOut::Write(value);
+#else
     // Copy the byte to the MIDI output (thru). We could use Overwrite here
     // since the output rate is the same as the input rate, which ensures that
     // 0.32ms have elapsed between the writes.
     midi_io.Write(value);
+#endif  // HAS_MIDI_OUTPUT_QUEUE
     
     // Also, parse the message.
     status = midi_parser.PushByte(value);
+#endif  // HAS_MIDI_MERGE
+#ifdef HAS_TRACE
+    if (status) {
+      Trace::Write(TRACE_MIDI_MESSAGE, status);
+    }
+#endif  // HAS_TRACE
     if (engine.patch().kbd_midi_channel >= 17) {
       break;
     }
@@ -226,7 +566,44 @@ void MidiTask() {
             break;
           case RECEPTION_OK:
             display.set_status('+');
-            engine.TouchPatch();
+            if (engine.patch().sysex_command() ==
+                SYSEX_COMMAND_PATCH_TRANSFER) {
+              engine.TransitionPatch();
+            }
+            if (engine.patch().sysex_command() ==
+                SYSEX_COMMAND_BANK_REQUEST) {
+              Patch::SysExSendBank();
+            }
+#ifdef HAS_TASK_PROFILING
+            if (engine.patch().sysex_command() ==
+                SYSEX_COMMAND_TASK_PROFILE_REQUEST) {
+              SysExSendTaskProfile();
+            }
+#endif  // HAS_TASK_PROFILING
+#ifdef HAS_GLITCH_LOG
+            if (engine.patch().sysex_command() ==
+                SYSEX_COMMAND_GLITCH_LOG_REQUEST) {
+              SysExSendGlitchLog();
+            }
+#endif  // HAS_GLITCH_LOG
+#ifdef HAS_LATENCY_PROBE
+            if (engine.patch().sysex_command() ==
+                SYSEX_COMMAND_LATENCY_REQUEST) {
+              SysExSendLatency();
+            }
+#endif  // HAS_LATENCY_PROBE
+#ifdef HAS_RAM_MONITORING
+            if (engine.patch().sysex_command() ==
+                SYSEX_COMMAND_MEMORY_USAGE_REQUEST) {
+              SysExSendMemoryUsage();
+            }
+#endif  // HAS_RAM_MONITORING
+#ifdef HAS_TRACE
+            if (engine.patch().sysex_command() ==
+                SYSEX_COMMAND_TRACE_REQUEST) {
+              SysExSendTrace();
+            }
+#endif  // HAS_TRACE
             break;
           case RECEPTION_ERROR:
             display.set_status('#');
@@ -237,68 +614,212 @@ void MidiTask() {
   }
 }
 
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+uint16_t clock_num_glitches;
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
+
 void AudioRenderingTask() {
-  if (audio_out.writable_block()) {
+  if (AudioBlockRequested()) {
+#ifdef HAS_LOAD_GOVERNOR
+    uint8_t num_queued_samples = audio_out.readable();
+#endif  // HAS_LOAD_GOVERNOR
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+    // The samples missed during an underrun have been played by the timer
+    // all the same.
+    uint16_t num_glitches = audio_out.num_glitches();
+    uint16_t num_skipped_samples = num_glitches - clock_num_glitches;
+    clock_num_glitches = num_glitches;
+    engine.mutable_voice_controller()->Skip(
+        num_skipped_samples > 255 ? 255 : num_skipped_samples);
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
+#ifdef HAS_FAST_CV
+    engine.set_cv(kFastCvInput, AdcScanner::ReadFastChannel() >> 2);
+#endif  // HAS_FAST_CV
     engine.Control();
-    if (engine.voice(0).dead()) {
-      for (uint8_t i = kAudioBlockSize; i > 0 ; --i) {
-        audio_out.Overwrite(128);
+    // The size of the audio buffer is a multiple of the block size, and
+    // samples are written one block at a time, so the span always covers the
+    // whole block.
+    uint8_t span_size;
+    AudioSample* block = audio_out.WriteSpan(kAudioBlockSize, &span_size);
+    if (engine.dead()) {
+#ifdef HAS_DAC_OUTPUT
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        block[i] = kAudioSilence;
       }
+#else
+      memset(block, kAudioSilence, kAudioBlockSize);
+#endif  // HAS_DAC_OUTPUT
     } else {
-      for (uint8_t i = kAudioBlockSize; i > 0 ; --i) {
-        engine.Audio();
-        audio_out.Overwrite(engine.voice(0).signal());
-      }
+      engine.AudioBlock(block);
+    }
+#ifdef HAS_LATENCY_PROBE
+    LatencyProbe::BlockRendered(engine.num_triggers(), audio_out.readable());
+#endif  // HAS_LATENCY_PROBE
+#ifdef HAS_ADAPTIVE_BUFFER_DEPTH
+    AdaptAudioBufferTarget(audio_out.readable());
+#endif  // HAS_ADAPTIVE_BUFFER_DEPTH
+#ifdef HAS_LOAD_GOVERNOR
+    // The samples played in the meantime measure the cost of the block.
+    LoadGovernor::BlockRendered(
+        num_queued_samples - audio_out.readable(),
+        audio_out.num_glitches());
+#endif  // HAS_LOAD_GOVERNOR
+    audio_out.Commit(kAudioBlockSize);
+#ifdef HAS_TRACE
+    Trace::Write(TRACE_BLOCK_RENDERED, audio_out.readable());
+#endif  // HAS_TRACE
+    vcf_cutoff_out.Write(engine.cutoff());
+    vcf_resonance_out.Write(engine.resonance());
+    vca_out.Write(engine.vca());
+  }
+}
+
+// Saved patches and bank transfers received by SysEx are written in the
+// background. A '_' is displayed in the status area until they are complete.
+// The bank dumps, the patches of the external library and the next pattern of
+// the bank are read by the same task.
+void EepromWriterTask() {
+  if (EepromWriter::busy()) {
+    EepromWriter::Tick();
+    display.set_status('_');
+  }
+  Patch::SysExSendBankTick();
+#ifdef HAS_EXTERNAL_EEPROM
+  engine.LibraryTick();
+#endif  // HAS_EXTERNAL_EEPROM
+#ifdef HAS_PATTERN_BANK
+  PatternBank::Tick();
+#endif  // HAS_PATTERN_BANK
+}
+
+// The background EEPROM accesses share the slot of the CV inputs scanning:
+// with the audio rendering task in the slots, the scheduler has no room left
+// for another task.
+void CvTask() {
+  for (uint8_t i = 0; i < kNumCvInputs; ++i) {
+    if (AdcScanner::changed(kPinCvInput + i)) {
+      engine.set_cv(i, AdcScanner::Read(kPinCvInput + i) >> 2);
     }
-    vcf_cutoff_out.Write(engine.voice(0).cutoff());
-    vcf_resonance_out.Write(engine.voice(0).resonance());
-    vca_out.Write(engine.voice(0).vca());
   }
+  EepromWriterTask();
 }
 
 uint16_t previous_num_glitches;
+uint16_t previous_num_dropped_midi_bytes;
 
 // This task displays a '!' in the status area of the LCD displays whenever
 // a discontinuity occurred in the audio rendering. Even if the code is
 // optimized in such a way that it never occurs, I'd rather keep it here in
 // case new features are implemented and need performance monitoring.
-// This code uses 42 bytes.
+// Similarly, a '*' is displayed whenever a MIDI byte has been lost because
+// the MIDI input buffer was full.
 void AudioGlitchMonitoringTask() {
   uint16_t num_glitches = audio_out.num_glitches();
   if (num_glitches != previous_num_glitches) {
     previous_num_glitches = num_glitches;
     display.set_status('!');
   }
+  uint16_t num_dropped_midi_bytes = midi_io.num_dropped_bytes();
+  if (num_dropped_midi_bytes != previous_num_dropped_midi_bytes) {
+    previous_num_dropped_midi_bytes = num_dropped_midi_bytes;
+    display.set_status('*');
+  }
 }
 
-typedef NaiveScheduler<kSchedulerNumSlots> Scheduler;
+static const uint8_t kMidiTaskPriority = 6;
+static const uint8_t kUpdateDisplayTaskPriority = 2;
+#ifdef HAS_GLITCH_MONITORING
+static const uint8_t kAudioGlitchMonitoringTaskPriority = 1;
+#else
+static const uint8_t kAudioGlitchMonitoringTaskPriority = 0;
+#endif  // HAS_GLITCH_MONITORING
+static const uint8_t kInputTaskPriority = 2;
+static const uint8_t kCvTaskPriority = 1;
+
+// Each unit of priority takes one slot of the scheduler. This fails to compile
+// when the tasks below ask for more slots than there are.
+typedef char TaskPrioritiesFitInSchedulerSlots[
+    kAudioRenderingTaskPriority + kMidiTaskPriority + kUpdateLedsTaskPriority +
+    kUpdateDisplayTaskPriority + kAudioGlitchMonitoringTaskPriority +
+    kInputTaskPriority + kCvTaskPriority <= kSchedulerNumSlots ? 1 : -1];
 
 Scheduler scheduler;
 
+// The order of the first tasks must match TaskIndex.
 /* static */
 template<>
 Task Scheduler::tasks_[] = {
-    { &AudioRenderingTask, 16 },
-    { &MidiTask, 6 },
-    { &UpdateLedsTask, 4 },
-    { &UpdateDisplayTask, 2 },
+    { &AudioRenderingTask, kAudioRenderingTaskPriority },
+    { &MidiTask, kMidiTaskPriority },
+    { &UpdateLedsTask, kUpdateLedsTaskPriority },
+    { &UpdateDisplayTask, kUpdateDisplayTaskPriority },
 #ifdef HAS_GLITCH_MONITORING
-    { &AudioGlitchMonitoringTask, 1 },
+    { &AudioGlitchMonitoringTask, kAudioGlitchMonitoringTaskPriority },
 #endif  // HAS_GLITCH_MONITORING
-    { &InputTask, 2 },
-    { &CvTask, 1 },
+    { &InputTask, kInputTaskPriority },
+    { &CvTask, kCvTaskPriority },
 };
 
+#ifdef HAS_TIMER0_DISPLAY_CLOCK
+TIMER_0_COMPARE_A_TICK {
+  Timer0CompareClock::Advance(kDisplayClockPeriod);
+  display.Tick();
+}
+#endif  // HAS_TIMER0_DISPLAY_CLOCK
+
+SERIAL_0_RX_READY {
+#ifdef HAS_LATENCY_PROBE
+  LatencyProbe::ByteReceived(SerialInput<SerialPort0>::Received());
+#else
+  SerialInput<SerialPort0>::Received();
+#endif  // HAS_LATENCY_PROBE
+}
+
+#ifdef HAS_MIDI_OUTPUT_QUEUE
+SERIAL_0_TX_READY {
+  MidiOut::Requested();
+}
+#endif  // HAS_MIDI_OUTPUT_QUEUE
+
 TIMER_2_TICK {
+#ifndef HAS_TIMER0_DISPLAY_CLOCK
   display.Tick();
+#endif  // HAS_TIMER0_DISPLAY_CLOCK
   audio_out.EmitSample();
+#ifdef HAS_LED_BIT_PLANES
+  if (!--led_refresh_countdown) {
+    led_refresh_countdown = kLedRefreshPeriod;
+    leds.Refresh();
+  }
+#endif  // HAS_LED_BIT_PLANES
+#ifdef HAS_PROFILER_CLOCK
+  ProfilerClock::Tick();
+#endif  // HAS_PROFILER_CLOCK
+#ifdef HAS_TRACE
+  Trace::Tick();
+#endif  // HAS_TRACE
 }
 
 void Init() {
+#ifdef HAS_RAM_MONITORING
+  MemoryMonitor::PaintStack();
+#endif  // HAS_RAM_MONITORING
   scheduler.Init();
+#ifdef HAS_TASK_PROFILING
+  Profiler::Init();
+#endif  // HAS_TASK_PROFILING
+#ifdef HAS_FAST_BOOT
+  // The baud rate message is sent with the interrupts disabled, so it must be
+  // sent before the audio starts. The rest of the setup of the LCD is done by
+  // UpdateDisplayTask.
+  display.Init(false);
+#else
   display.Init();
+#endif  // HAS_FAST_BOOT
   editor.Init();
+#ifndef HAS_DAC_OUTPUT
   audio_out.Init();
+#endif  // HAS_DAC_OUTPUT
 
   // Initialize all the PWM outputs, in 31.25kHz, phase correct mode.
   Timer<1>::set_prescaler(1);
@@ -309,19 +830,72 @@ void Init() {
   vcf_cutoff_out.Init();
   vcf_resonance_out.Init();
   vca_out.Init();
+#ifdef HAS_DAC_OUTPUT
+  // Pin 10 - the SPI slave select of the chip - is now an output, so the SPI
+  // port stays in master mode.
+  audio_out.Init();
+#endif  // HAS_DAC_OUTPUT
+#ifdef HAS_TIMER0_DISPLAY_CLOCK
+  Timer0CompareClock::Start(kDisplayClockPeriod);
+#endif  // HAS_TIMER0_DISPLAY_CLOCK
   
+#ifndef HAS_FAST_BOOT
   display.SetBrightness(29);
   display.SetCustomCharMap(character_table[0], 8);
+#endif  // HAS_FAST_BOOT
   editor.DisplaySplashScreen(STR_RES_MUTABLE____V0_59);
   
   midi_io.Init();
+#ifdef HAS_MIDI_MERGE
+  MidiThru::Init();
+#endif  // HAS_MIDI_MERGE
   pots.Init();
   switches.Init();
   DigitalInput<kPinDigitalInput>::EnablePullUpResistor();
   input_mux.Init();
+  // The pots share the first ADC channel, through the multiplexer. The CV
+  // inputs are only updated when they move by one step of their 8-bit value.
+#ifdef HAS_FAST_CV
+  AdcScanner::Init(kPinCvInput + kNumCvInputs, kPinCvInput + kFastCvInput);
+#else
+  AdcScanner::Init(kPinCvInput + kNumCvInputs);
+#endif  // HAS_FAST_CV
+  for (uint8_t i = 0; i < kNumCvInputs; ++i) {
+    AdcScanner::set_threshold(kPinCvInput + i, 4);
+  }
   leds.Init();  
   
   engine.Init();
+  Patch::IndexEepromSlots();
+#ifdef HAS_EXTERNAL_EEPROM
+  PatchLibrary::Init();
+#endif  // HAS_EXTERNAL_EEPROM
+#ifdef HAS_PATTERN_BANK
+  PatternBank::Init();
+#endif  // HAS_PATTERN_BANK
+#ifdef HAS_RENDER_COST_CALIBRATION
+  RenderCost::Calibrate();
+  // The audio buffer has been starved during the calibration.
+  previous_num_glitches = audio_out.num_glitches();
+#endif  // HAS_RENDER_COST_CALIBRATION
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+  clock_num_glitches = audio_out.num_glitches();
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
+#ifdef HAS_GLITCH_LOG
+  GlitchLog::Init();
+#endif  // HAS_GLITCH_LOG
+#ifdef HAS_TRACE
+  Trace::Init();
+#endif  // HAS_TRACE
+#ifdef HAS_LATENCY_PROBE
+  LatencyProbe::Init();
+#endif  // HAS_LATENCY_PROBE
+#ifdef HAS_LOAD_GOVERNOR
+  LoadGovernor::Init();
+#endif  // HAS_LOAD_GOVERNOR
+#ifdef HAS_ADAPTIVE_BUFFER_DEPTH
+  audio_buffer_num_glitches = audio_out.num_glitches();
+#endif  // HAS_ADAPTIVE_BUFFER_DEPTH
 }
 
 int main(void) {
@@ -23,33 +23,309 @@
 #include "hardware/base/base.h"
 
 #define HAS_GLITCH_MONITORING
+
+// Uncomment to run first the task with the most urgent deadline - audio
+// rendering when the audio buffer runs low, then MIDI input when the input
+// buffer is half full - rather than the fixed, round-robin, schedule of tasks
+// in which audio rendering is always allocated half of the slots. Without it,
+// the other tasks share the remaining 16 slots, which they fill completely -
+// a new task must share the slot of an existing one.
+// #define HAS_DEADLINE_SCHEDULER
+
+// Uncomment to keep track of the number of cycles spent in each task. The
+// statistics are sent as a SysEx message on request.
+// #define HAS_TASK_PROFILING
+
+// Uncomment to log the audio buffer underruns - when they occurred, during
+// which task, on which page of the editor and with which oscillator shapes -
+// along with the lowest level reached by the buffer. The log is sent as a
+// SysEx message on request. Takes about 100 bytes of RAM.
+// #define HAS_GLITCH_LOG
+
+// Uncomment to make a sound within milliseconds of power-up. The bootloader
+// only waits for a STK500 programmer after a reset by the reset pin, and the
+// firmware starts the audio and MIDI without waiting for the LCD to switch to
+// its baud rate; the LCD is set up in the background once it is ready.
+// #define HAS_FAST_BOOT
+
+// Uncomment to build a bootloader which also accepts the firmware pages packed
+// in 7-bit bytes (hex2sysex.py --fast), and which writes each page while the
+// next one is being received. The boot section had 182 bytes left: check that
+// it still fits with "make -f hardware/bootloader/makefile bootloader_size".
+// #define HAS_FAST_SYSEX_UPDATE
+
+// Uncomment to keep a trace of the last 32 MIDI messages, voice triggers,
+// rendered blocks and underruns, each timestamped to the sample. The trace is
+// sent as a SysEx message on request. Takes 128 bytes of RAM.
+// #define HAS_TRACE
+
+// Uncomment to measure the time between the reception of a MIDI note-on and
+// the playback of the first sample of the note. The min/average/max latency
+// is sent as a SysEx message on request.
+// #define HAS_LATENCY_PROBE
+
+// Uncomment to render the next block as soon as the audio buffer falls below
+// a target level, rather than as soon as there is room for a block. The target
+// is lowered, one block at a time, while the renderer keeps up with a margin,
+// and raised after each underrun - so that light patches play with 1 to 2ms
+// of latency instead of 4ms.
+// #define HAS_ADAPTIVE_BUFFER_DEPTH
+
+// Uncomment to draw the audio noise - the noise mixed with the oscillators,
+// the noise oscillator and the phase noise of the vowel oscillator - from a
+// xorshift generator stepped at each sample, instead of the LFSR shared with
+// the LFOs, the arpeggiator and the editor, which is advanced every 4 samples.
+// The noise is brighter and has a flat spectrum, and the control rate users of
+// the LFSR no longer change the audio stream.
+// #define HAS_AUDIO_RATE_NOISE
+
+// Uncomment to measure the cost of each rendered block, and to step down the
+// rendering quality when it takes too much of the CPU or when the audio buffer
+// underruns: first by rendering the sub oscillator at half its rate, then by
+// muting the noise, then by refreshing the LEDs and display half as often. The
+// quality is restored once the cost has been low for about 0.25s.
+// #define HAS_LOAD_GOVERNOR
+
+// Uncomment to replace the quad saw pad by a unison of kNumUnisonVoices saws,
+// detuned symmetrically around the note by the oscillator parameter. The extra
+// voices are rendered at half the sample rate. Each added voice costs 4 bytes
+// of RAM per oscillator, and a 16-bit addition per rendered sample.
+// #define HAS_UNISON_PAD
+
+// Uncomment to ramp the mix balance, sub oscillator and noise levels linearly
+// across each block, rather than applying them in steps, once per block.
+// #define HAS_MIX_INTERPOLATION
+
+// Uncomment to give the envelope stages the curved shape of an analog envelope
+// (RC charge for the attack, exponential decay and release), instead of
+// linear segments.
+// #define HAS_CURVED_ENVELOPES
+
+// Uncomment to make the VCA dip to silence over a few control ticks when a
+// new patch is loaded, during which the oscillator algorithms are swapped,
+// while the other modulation destinations glide to their new values - rather
+// than switching to the new patch at once.
+// #define HAS_PATCH_TRANSITION
+
+// Uncomment to make the samples missed by the audio interrupt on buffer
+// underruns also advance the internal clock, so that it keeps time with the
+// audio timer; and to delay each MIDI clock tick until the point of the
+// rendered stream which will be played one audio buffer after its reception -
+// trading a variable latency of 0 to 4ms for a constant one. Otherwise, the
+// arpeggiator clock only advances by the duration of the rendered blocks, and
+// the MIDI clock ticks are applied to the next rendered block.
+// #define HAS_SAMPLE_LOCKED_CLOCK
+
+// Uncomment to make the steps follow a phase locked loop tracking the MIDI
+// clock, to recompute the LFO increments only when the tempo changes, and to
+// pull the LFOs back in phase with the steps at the start of each of their
+// periods. Otherwise, the steps advance directly on the MIDI clock ticks, the
+// tempo is estimated by counting control ticks every 4 steps, and the LFOs
+// synced to the tempo are reset every few steps.
+// #define HAS_MIDI_CLOCK_PLL
+
+// Uncomment to compile the held notes and the arpeggiator settings into a list
+// of steps whenever they change, so that each arpeggiator step only reads the
+// next entry. In the random mode, the list holds each note of each octave
+// once, and is shuffled at the end of each cycle. Takes 128 bytes of RAM.
+// #define HAS_ARPEGGIO_PROGRAM
+
+// Comment out to write the MIDI output (thru and SysEx) directly to the UART,
+// waiting for the previous byte to be sent. Otherwise, the bytes are queued
+// and sent by the UART interrupt, the realtime messages skip the queue, and
+// the status bytes repeating the running status are dropped.
+#define HAS_MIDI_OUTPUT_QUEUE
+
+// Uncomment to forward the MIDI messages received once they have been decoded,
+// rather than byte by byte, and to merge them with the notes played by the
+// arpeggiator. The types of messages forwarded are set by CC 90. Requires
+// HAS_MIDI_OUTPUT_QUEUE.
+// #define HAS_MIDI_MERGE
+
+// Uncomment to chain several units into a polyphonic instrument, their MIDI
+// outputs connected to the MIDI inputs of the next ones. When the chain is
+// enabled by CC 93, a unit plays the first note it receives, and the notes
+// received while it is busy - and their note-offs - are sent to the next unit
+// instead of the thru, once decoded, so the polyphony is the number of units.
+// Requires HAS_MIDI_MERGE.
+// #define HAS_POLY_CHAIN
+
+// Uncomment to send the parameters edited on the front panel as NRPN messages
+// - NRPN number, then the value as a data entry MSB/LSB pair - so that an
+// editor or another unit stays in sync with 9 bytes per change, instead of a
+// patch dump. The echo is enabled by CC 94. Requires HAS_MIDI_MERGE.
+// #define HAS_PARAMETER_ECHO
+
+// Uncomment to journal the last 32 parameters edited on the front panel - each
+// as its index and previous value - to undo them one by one by holding the
+// modulation group switch, and to redo them by doing so on the load/save page.
+// #define HAS_UNDO_JOURNAL
+
+// Uncomment to record the moves of a front panel parameter into an automation
+// lane of 16 steps, played back by the step sequencer. The recording is
+// started and stopped by CC 91, and the lane is cleared by CC 92.
+// #define HAS_MOTION_SEQUENCER
+
+// Uncomment to keep a library of 512 patches on two external AT24C128 I2C
+// EEPROMs, recalled by a bank select (CC 0) followed by a program change. The
+// I2C buffers take 192 bytes of RAM.
+// #define HAS_EXTERNAL_EEPROM
+
+// Uncomment to keep a bank of 32 step sequencer patterns in the last 8 slots
+// of the external library. Each pattern can be chained to another one after a
+// number of repeats, and the next pattern is read in the background, so that
+// pattern changes take place on the first step without waiting for the I2C
+// bus. Requires HAS_EXTERNAL_EEPROM.
+// #define HAS_PATTERN_BANK
+
+// Uncomment to clock the LCD software serial output from a compare match
+// interrupt of timer 0, at the baud rate, rather than from the audio interrupt
+// at 31.25kHz - in which 12 out of 13 calls only decrement a counter. Timer 0
+// is switched from fast PWM to normal mode, which does not change the rate of
+// the real time clock.
+// #define HAS_TIMER0_DISPLAY_CLOCK
+
+// Uncomment to sample the first CV input at about 4kHz, and update its
+// modulation source at each control tick with the average of the conversions
+// made during the block, rather than every few milliseconds. This allows
+// external LFOs and envelopes to be tracked closely, and to be routed to the
+// oscillator pitch or the cutoff through the modulation matrix. The ADC
+// interrupt takes about 3% of the CPU.
+// #define HAS_FAST_CV
+
+// Uncomment to store the wavetable as 4-bit deltas, in 1056 bytes of flash
+// instead of 2064, and to decode the two cycles played by the oscillator into
+// a RAM cache of 258 bytes. The coding is lossy - the decoded cycles are
+// within 1 to 5 steps (rms) of the source. The resources must be regenerated
+// with "make resources" after changing this.
+// #define HAS_COMPRESSED_WAVETABLE
+
+// Uncomment to send the audio signal to a MCP4921 12-bit DAC on the SPI port,
+// rather than to the 8-bit PWM output of timer 2. The last stage of the mixer
+// (noise) then keeps 12 bits. The VCA output moves from pin 11 - which becomes
+// the SPI data output - to pin 3, left free by the audio PWM, and the chip
+// select of the DAC is pin A4, so this cannot be used with HAS_EXTERNAL_EEPROM.
+// The audio buffer takes 128 more bytes of RAM.
+// #define HAS_DAC_OUTPUT
+
+// Uncomment to run the DAC output through a digital low-pass filter - a state
+// variable filter controlled by the cutoff and resonance of the analog filter,
+// which are still sent to the analog board. This is for the units whose analog
+// filter is missing or out of order. Requires HAS_DAC_OUTPUT.
+// #define HAS_DIGITAL_FILTER
+
+// Uncomment to drive the shift registers of the LEDs and of the input
+// multiplexer from the SPI port, which shifts each byte in 16 cycles, rather
+// than by toggling the clock and data pins for each bit. The clock and data
+// lines move from pins 5 and 4 to pins 13 and 11, shared with the DAC, so this
+// requires HAS_DAC_OUTPUT.
+// #define HAS_SPI_SHIFT_REGISTERS
+
+// Uncomment to refresh the LEDs from the audio interrupt, every 16 samples, by
+// binary code modulation of 4 bit planes - the shift register is written 4
+// times per cycle of 15 refreshes (130Hz), and only when the lit LEDs change.
+// The LED task then only computes the brightness of each LED, and runs less
+// often. Takes 14 more bytes of RAM.
+// #define HAS_LED_BIT_PLANES
+
+// Uncomment to paint the free RAM at boot, and to keep track of the RAM taken
+// by the static variables and of the deepest reach of the stack. The figures
+// are displayed on an extra page of the performance group, and sent as a SysEx
+// message on request.
+// #define HAS_RAM_MONITORING
+
+// Uncomment to measure the cost of each oscillator algorithm at boot time. The
+// results are displayed on an extra page of the performance group.
+// #define HAS_RENDER_COST_CALIBRATION
+
+// The inline assembly versions of the fixed point routines are only available
+// when targeting the AVR.
+#ifdef __AVR__
 #define USE_OPTIMIZED_OP
+#endif  // __AVR__
+
+// The options which depend on other options.
+#if defined(HAS_MIDI_MERGE) && !defined(HAS_MIDI_OUTPUT_QUEUE)
+#error "HAS_MIDI_MERGE requires HAS_MIDI_OUTPUT_QUEUE"
+#endif
+
+#if defined(HAS_POLY_CHAIN) && !defined(HAS_MIDI_MERGE)
+#error "HAS_POLY_CHAIN requires HAS_MIDI_MERGE"
+#endif
+
+#if defined(HAS_PARAMETER_ECHO) && !defined(HAS_MIDI_MERGE)
+#error "HAS_PARAMETER_ECHO requires HAS_MIDI_MERGE"
+#endif
+
+#if defined(HAS_PATTERN_BANK) && !defined(HAS_EXTERNAL_EEPROM)
+#error "HAS_PATTERN_BANK requires HAS_EXTERNAL_EEPROM"
+#endif
+
+// The chip select of the DAC and the I2C data line are both on pin A4.
+#if defined(HAS_DAC_OUTPUT) && defined(HAS_EXTERNAL_EEPROM)
+#error "HAS_DAC_OUTPUT cannot be used with HAS_EXTERNAL_EEPROM"
+#endif
+
+#if defined(HAS_DIGITAL_FILTER) && !defined(HAS_DAC_OUTPUT)
+#error "HAS_DIGITAL_FILTER requires HAS_DAC_OUTPUT"
+#endif
+
+#if defined(HAS_SPI_SHIFT_REGISTERS) && !defined(HAS_DAC_OUTPUT)
+#error "HAS_SPI_SHIFT_REGISTERS requires HAS_DAC_OUTPUT"
+#endif
 
 namespace hardware_shruti {
 
-// Set this flag to 6 to get a nice polysynth (humour).
+// Set this to 2 or more for a paraphonic synth: each voice has its own
+// oscillators, envelopes and pitch, but the VCF and VCA are shared and follow
+// the most recently triggered voice. The extra voices share a single copy of
+// the oscillator code, but each adds its full rendering cost - this does not
+// fit the ATmega328p, and is mostly useful for offline rendering on the host.
 static const uint8_t kNumVoices = 1;
 static const uint8_t kPolyphony = 1;
 
 static const uint8_t kNumEditingPots = 4;
 static const uint8_t kNumGroupSwitches = 5;
 static const uint8_t kNumCvInputs = 3;
+static const uint8_t kFastCvInput = 0;
 
 // Rate of the main timer. For now, 1 sample is generated per tick, but we might
 // want to do something different to achieve other sample rates
 // (20kHz or 16kHz).
 static const uint16_t kMainTimerRate = 31250;
+// The oscillator increments follow it - see pitch_table.h.
 static const uint16_t kSampleRate = 31250;
 
 static const uint16_t kDisplayBaudRate = 2400;
 
+// Timer 0 runs at F_CPU / 64. 104 ticks per bit give 2404 baud.
+static const uint8_t kDisplayClockPeriod = F_CPU / 64 / kDisplayBaudRate;
 
-// One control signal sample is generated for each 32 audio sample.
+// One control signal sample is generated for each kControlRate audio samples,
+// rendered at once as a block. This can be changed to trade latency for CPU
+// headroom, provided that:
+// - it is a multiple of 4 (the oscillator decimation cycle) and a power of 2,
+//   no larger than 64 ;
+// - the LFO and envelope tables are regenerated with "make resources" -
+//   lookup_tables.py reads the value from this file.
 static const uint8_t kControlRate = 32;
 
-// The latency is 1ms, with a buffer storing 4ms of audio.
+// The buffer is a power of 2 smaller than 256, storing 4 blocks - or 2 blocks
+// of 64 samples. With 32 samples, the latency is 1ms, with 4ms of audio
+// buffered.
 static const uint8_t kAudioBlockSize = kControlRate;
-static const uint8_t kAudioBufferSize = kAudioBlockSize * 4;
+static const uint8_t kAudioBufferSize = kAudioBlockSize >= 64 ?
+    128 : kAudioBlockSize * 4;
+
+#ifdef HAS_DAC_OUTPUT
+// 12-bit samples (the DAC code). The codes are never negative, but the type
+// has to match the one used by AudioOutput for ports wider than 8 bits.
+typedef int16_t AudioSample;
+static const AudioSample kAudioSilence = 2048;
+#else
+typedef uint8_t AudioSample;
+static const AudioSample kAudioSilence = 128;
+#endif  // HAS_DAC_OUTPUT
 
 // ---- Wirings ----------------------------------------------------------------
 
@@ -59,15 +335,26 @@ static const uint8_t kPinMidiThruTx = 1;
 static const uint8_t kPinLcdTx = 2;
 
 // Shift registers / muxes.
+#ifdef HAS_SPI_SHIFT_REGISTERS
+// The SPI data output and clock pins.
+static const uint8_t kPinData = 11;
+static const uint8_t kPinClk = 13;
+#else
 static const uint8_t kPinData = 4;
+static const uint8_t kPinClk = 5;
+#endif  // HAS_SPI_SHIFT_REGISTERS
 static const uint8_t kPinDigitalInput = 8;
 static const uint8_t kPinOutputLatch = 6;
 static const uint8_t kPinInputLatch = 7;
-static const uint8_t kPinClk = 5;
 
 // PWM/audio output.
+#ifdef HAS_DAC_OUTPUT
+static const uint8_t kPinDacSlaveSelect = 18;
+static const uint8_t kPinVcaOut = 3;
+#else
 static const uint8_t kPinVcoOut = 3;
 static const uint8_t kPinVcaOut = 11;
+#endif  // HAS_DAC_OUTPUT
 static const uint8_t kPinVcfCutoffOut = 9;
 static const uint8_t kPinVcfResonanceOut = 10;
 
@@ -82,6 +369,7 @@ static const uint8_t kLcdHeight = 2;
 // ---- Scheduler configuration ------------------------------------------------
 
 static const uint8_t kSchedulerNumSlots = 32;
+static const uint8_t kSchedulerMaxNumTasks = 8;
 
 }  // namespace hardware_shruti
 
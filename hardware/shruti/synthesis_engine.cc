@@ -22,8 +22,15 @@
 #include <string.h>
 
 #include "hardware/resources/resources_manager.h"
+#include "hardware/shruti/load_governor.h"
+#include "hardware/shruti/midi_out.h"
 #include "hardware/shruti/oscillator.h"
+#include "hardware/shruti/patch_library.h"
 #include "hardware/shruti/patch_metadata.h"
+#include "hardware/shruti/pattern_bank.h"
+#include "hardware/shruti/pitch_table.h"
+#include "hardware/shruti/trace.h"
+#include "hardware/shruti/undo_journal.h"
 #include "hardware/utils/random.h"
 #include "hardware/utils/op.h"
 
@@ -34,9 +41,208 @@ namespace hardware_shruti {
 /* extern */
 SynthesisEngine engine;
 
-Oscillator<1, FULL> osc_1;
-Oscillator<2, LOW_COMPLEXITY> osc_2;
-Oscillator<3, SUB_OSCILLATOR> sub_osc;
+// The other voices share a single instantiation of the oscillator code, which
+// is bound to the state of a voice before this voice is processed. Adding a
+// voice thus costs the size of its state, rather than a new copy of the code.
+typedef BoundOscillatorStorage<4> BoundOsc1Storage;
+typedef BoundOscillatorStorage<5> BoundOsc2Storage;
+typedef BoundOscillatorStorage<6> BoundSubOscStorage;
+
+template<uint8_t index>
+struct VoiceOscillators {
+  typedef Oscillator<4, FULL, BoundOsc1Storage> Osc1;
+  typedef Oscillator<5, LOW_COMPLEXITY, BoundOsc2Storage> Osc2;
+  typedef Oscillator<6, SUB_OSCILLATOR, BoundSubOscStorage> SubOsc;
+  
+  static inline void Bind() {
+    BoundOsc1Storage::Bind(&state_[0]);
+    BoundOsc2Storage::Bind(&state_[1]);
+    BoundSubOscStorage::Bind(&state_[2]);
+  }
+  
+  static OscillatorState state_[3];
+};
+
+template<uint8_t index> OscillatorState VoiceOscillators<index>::state_[3];
+
+// The oscillators of the first voice keep their state in static variables, and
+// are accessed with direct addressing - this is the fast path, and the only
+// one used by the monophonic build.
+template<>
+struct VoiceOscillators<0> {
+  typedef Oscillator<1, FULL> Osc1;
+  typedef Oscillator<2, LOW_COMPLEXITY> Osc2;
+  typedef Oscillator<3, SUB_OSCILLATOR> SubOsc;
+  
+  static inline void Bind() { }
+};
+
+// A mix level, as applied by the block renderer. With interpolation, the level
+// goes linearly from its value at the previous block to its current value, by
+// adding a constant increment at each sample - the last sample of the block
+// uses exactly the new value. Without, it is the current value all along.
+class MixLevel {
+ public:
+  inline void Init(uint8_t previous, uint8_t current) {
+#ifdef HAS_MIX_INTERPOLATION
+    value_ = static_cast<uint16_t>(previous) << 8;
+    increment_ = (static_cast<int16_t>(current) - previous) * (
+        256 / kAudioBlockSize);
+#else
+    value_ = current;
+#endif  // HAS_MIX_INTERPOLATION
+  }
+  
+  inline uint8_t Next() {
+#ifdef HAS_MIX_INTERPOLATION
+    value_ += increment_;
+    return value_ >> 8;
+#else
+    return value_;
+#endif  // HAS_MIX_INTERPOLATION
+  }
+  
+ private:
+#ifdef HAS_MIX_INTERPOLATION
+  uint16_t value_;
+  int16_t increment_;
+#else
+  uint8_t value_;
+#endif  // HAS_MIX_INTERPOLATION
+};
+
+// Dispatches calls to the voices 0 to num_voices - 1. Each voice is a distinct
+// type, so with a single voice everything collapses into direct calls to
+// Voice<0>. The functions taking a voice index as their first argument are
+// forwarded to this voice only.
+template<uint8_t num_voices>
+struct VoicePool {
+  typedef VoicePool<num_voices - 1> Others;
+  typedef Voice<num_voices - 1> Last;
+
+  static inline void Init() {
+    Others::Init();
+    Last::Init();
+  }
+  static inline void Control() {
+    Others::Control();
+    Last::Control();
+  }
+  static inline void CompileModulationRoutes() {
+    Others::CompileModulationRoutes();
+    Last::CompileModulationRoutes();
+  }
+  static inline void UpdateOscillatorAlgorithms() {
+    Others::UpdateOscillatorAlgorithms();
+    Last::UpdateOscillatorAlgorithms();
+  }
+  static inline uint8_t dead() {
+    return Others::dead() && Last::dead();
+  }
+  // Voices are mixed with equal weights, dead voices contribute silence.
+  static inline void AudioBlock(AudioSample* buffer) {
+    if (num_voices == 1) {
+      Last::AudioBlock(buffer);
+      return;
+    }
+    // 256 / num_voices does not fit in a byte for a single voice, though this
+    // is never reached in that case.
+    const uint8_t weight = num_voices > 1 ? 256 / num_voices : 255;
+    Others::AudioBlock(buffer);
+    if (!Last::dead()) {
+      AudioSample voice_buffer[kAudioBlockSize];
+      Last::AudioBlock(voice_buffer);
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        buffer[i] = MixVoice(buffer[i], voice_buffer[i], weight);
+      }
+    } else {
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        buffer[i] = MixVoice(buffer[i], kAudioSilence, weight);
+      }
+    }
+  }
+  static inline AudioSample MixVoice(
+      AudioSample a,
+      AudioSample b,
+      uint8_t balance) {
+#ifdef HAS_DAC_OUTPUT
+    return (uint32_t(a) * (255 - balance) + uint32_t(b) * balance) >> 8;
+#else
+    return Mix(a, b, balance);
+#endif  // HAS_DAC_OUTPUT
+  }
+  static inline uint8_t is_last(uint8_t voice) {
+    return num_voices == 1 || voice == num_voices - 1;
+  }
+  static inline void Trigger(
+      uint8_t voice,
+      uint8_t note,
+      uint8_t velocity,
+      uint8_t legato) {
+    if (is_last(voice)) {
+      Last::Trigger(note, velocity, legato);
+    } else {
+      Others::Trigger(voice, note, velocity, legato);
+    }
+  }
+  static inline void Release(uint8_t voice) {
+    if (is_last(voice)) {
+      Last::Release();
+    } else {
+      Others::Release(voice);
+    }
+  }
+  static inline void Kill(uint8_t voice) {
+    if (is_last(voice)) {
+      Last::Kill();
+    } else {
+      Others::Kill(voice);
+    }
+  }
+  static inline Envelope* mutable_envelope(uint8_t voice, uint8_t i) {
+    return is_last(voice) ?
+        Last::mutable_envelope(i) :
+        Others::mutable_envelope(voice, i);
+  }
+  static inline uint8_t modulation_source(uint8_t voice, uint8_t i) {
+    return is_last(voice) ?
+        Last::modulation_source(i) :
+        Others::modulation_source(voice, i);
+  }
+  static inline uint8_t modulation_destination(uint8_t voice, uint8_t i) {
+    return is_last(voice) ?
+        Last::modulation_destination(i) :
+        Others::modulation_destination(voice, i);
+  }
+};
+
+template<>
+struct VoicePool<0> {
+  static inline void Init() { }
+  static inline void Control() { }
+  static inline void CompileModulationRoutes() { }
+  static inline void UpdateOscillatorAlgorithms() { }
+  static inline uint8_t dead() { return 1; }
+  static inline void AudioBlock(AudioSample* buffer) { }
+  static inline void Trigger(
+      uint8_t voice,
+      uint8_t note,
+      uint8_t velocity,
+      uint8_t legato) { }
+  static inline void Release(uint8_t voice) { }
+  static inline void Kill(uint8_t voice) { }
+  static inline Envelope* mutable_envelope(uint8_t voice, uint8_t i) {
+    return NULL;
+  }
+  static inline uint8_t modulation_source(uint8_t voice, uint8_t i) {
+    return 0;
+  }
+  static inline uint8_t modulation_destination(uint8_t voice, uint8_t i) {
+    return 0;
+  }
+};
+
+typedef VoicePool<kNumVoices> Voices;
 
 /* <static> */
 uint8_t SynthesisEngine::modulation_sources_[kNumGlobalModulationSources];
@@ -44,7 +250,6 @@ uint8_t SynthesisEngine::modulation_sources_[kNumGlobalModulationSources];
 uint8_t SynthesisEngine::oscillator_decimation_;
 
 Patch SynthesisEngine::patch_;
-Voice SynthesisEngine::voice_[kNumVoices];
 VoiceController SynthesisEngine::controller_;
 Lfo SynthesisEngine::lfo_[kNumLfos];
 uint8_t SynthesisEngine::nrpn_parameter_number_;
@@ -52,24 +257,63 @@ uint8_t SynthesisEngine::data_entry_msb_;
 uint8_t SynthesisEngine::num_lfo_reset_steps_;
 uint8_t SynthesisEngine::lfo_reset_counter_;
 uint8_t SynthesisEngine::lfo_to_reset_;
+#ifdef HAS_MIDI_CLOCK_PLL
+uint8_t SynthesisEngine::lfo_step_[kNumLfos];
+#endif  // HAS_MIDI_CLOCK_PLL
 uint8_t SynthesisEngine::ignore_note_off_messages_;
+#ifdef HAS_POLY_CHAIN
+uint8_t SynthesisEngine::poly_chain_;
+uint8_t SynthesisEngine::chain_note_ = kNoChainNote;
+#endif  // HAS_POLY_CHAIN
+#ifdef HAS_PARAMETER_ECHO
+uint8_t SynthesisEngine::parameter_echo_;
+#endif  // HAS_PARAMETER_ECHO
+#ifdef HAS_EXTERNAL_EEPROM
+uint8_t SynthesisEngine::bank_;
+uint16_t SynthesisEngine::requested_library_slot_ = kNoLibrarySlot;
+uint8_t SynthesisEngine::library_load_in_progress_;
+#endif  // HAS_EXTERNAL_EEPROM
+#ifdef HAS_MOTION_SEQUENCER
+uint8_t SynthesisEngine::automation_lane_[kNumSteps];
+uint8_t SynthesisEngine::automation_parameter_;
+uint8_t SynthesisEngine::automation_recording_;
+uint8_t SynthesisEngine::automation_ramp_;
+uint16_t SynthesisEngine::automation_value_;
+int16_t SynthesisEngine::automation_increment_;
+uint16_t SynthesisEngine::automation_ticks_;
+uint16_t SynthesisEngine::automation_step_duration_;
+#endif  // HAS_MOTION_SEQUENCER
+ParameterChange SynthesisEngine::parameter_change_queue_[
+    kParameterChangeQueueSize];
+uint8_t SynthesisEngine::num_queued_parameter_changes_;
+uint8_t SynthesisEngine::dirty_modulations_;
+#ifdef HAS_LATENCY_PROBE
+uint8_t SynthesisEngine::num_triggers_;
+#endif  // HAS_LATENCY_PROBE
+#ifdef HAS_PATCH_TRANSITION
+uint8_t SynthesisEngine::patch_transition_;
+#endif  // HAS_PATCH_TRANSITION
 
 /* </static> */
 
 /* static */
 void SynthesisEngine::Init() {
-  controller_.Init(voice_, kNumVoices);
+  controller_.Init();
   ResetPatch();
   Reset();
-  for (uint8_t i = 0; i < kNumVoices; ++i) {
-    voice_[i].Init();
-  }
+  Voices::Init();
+#ifdef HAS_COMPRESSED_WAVETABLE
+  WavetableCache::Init();
+#endif  // HAS_COMPRESSED_WAVETABLE
+#ifdef HAS_MOTION_SEQUENCER
+  ClearAutomation();
+#endif  // HAS_MOTION_SEQUENCER
 }
 
-static const prog_char empty_patch[] PROGMEM = {
+static const prog_uint8_t empty_patch[] PROGMEM = {
     99,
     WAVEFORM_SAW, WAVEFORM_SQUARE, 0, 24,
-    0, -12, 0, 12,
+    0, uint8_t(-12), 0, 12,
     16, 0, 0, WAVEFORM_SQUARE,
     90, 0, 20, 0,
     20, 0,
@@ -103,20 +347,61 @@ static const prog_char empty_patch[] PROGMEM = {
 /* static */
 void SynthesisEngine::ResetPatch() {
   ResourcesManager::Load(empty_patch, 0, &patch_);
+#ifdef HAS_UNDO_JOURNAL
+  UndoJournal::Clear();
+#endif  // HAS_UNDO_JOURNAL
+  TouchPatch();
+}
+
+/* static */
+void SynthesisEngine::TransitionPatch() {
+#ifdef HAS_UNDO_JOURNAL
+  UndoJournal::Clear();
+#endif  // HAS_UNDO_JOURNAL
+#ifdef HAS_PATCH_TRANSITION
+  const uint8_t half_way = kPatchTransitionDuration / 2;
+  // If the previous transition is already past the point where the patch is
+  // touched, start again from a point where the VCA gain is the same.
+  if (patch_transition_ < half_way) {
+    patch_transition_ = kPatchTransitionDuration - patch_transition_;
+  } else if (patch_transition_ == half_way) {
+    ++patch_transition_;
+  }
+#else
   TouchPatch();
+#endif  // HAS_PATCH_TRANSITION
 }
 
 /* static */
 void SynthesisEngine::NoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+#ifdef HAS_POLY_CHAIN
+  if (poly_chain_) {
+    if (chain_note_ != kNoChainNote && chain_note_ != note) {
+      // This unit is busy: the next unit of the chain gets the note.
+      MidiThru::Send(0x90 | channel, note, velocity);
+      return;
+    }
+    chain_note_ = note;
+  }
+#endif  // HAS_POLY_CHAIN
+  // The note must be played with the parameters received before it.
+  ApplyQueuedParameterChanges();
+  UpdateDirtyModulations();
   // If the note controller is not active, we are not currently playing a
   // sequence, so we retrigger the LFOs.
   if (patch_.kbd_midi_channel < 34) {
     if (!controller_.active()) {
+#ifdef HAS_MIDI_CLOCK_PLL
+      for (uint8_t i = 0; i < kNumLfos; ++i) {
+        lfo_step_[i] = kLfoRetrigger;
+      }
+#else
       lfo_reset_counter_ = num_lfo_reset_steps_ - 1;
+#endif  // HAS_MIDI_CLOCK_PLL
     }
     controller_.NoteOn(note, velocity);
   } else {
-    voice_[0].Trigger(note, velocity, 0);
+    TriggerVoice(0, note, velocity, 0);
   }
 }
 
@@ -125,10 +410,21 @@ void SynthesisEngine::NoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
   if (ignore_note_off_messages_) {
     return;
   }
+#ifdef HAS_POLY_CHAIN
+  // While the hold pedal is down, all the units of the chain ignore the
+  // note-offs - the pedal change is forwarded by the thru.
+  if (poly_chain_) {
+    if (note != chain_note_) {
+      MidiThru::Send(0x80 | channel, note, velocity);
+      return;
+    }
+    chain_note_ = kNoChainNote;
+  }
+#endif  // HAS_POLY_CHAIN
   if (patch_.kbd_midi_channel < 34) {
     controller_.NoteOff(note);
   } else {
-    voice_[0].Release();
+    ReleaseVoice(0);
   }
 }
 
@@ -146,6 +442,53 @@ void SynthesisEngine::ControlChange(uint8_t channel, uint8_t controller,
   
   if (!recognized) {
     switch (controller) {
+#ifdef HAS_EXTERNAL_EEPROM
+      case hardware_midi::kBankSelectMsb:
+        bank_ = value;
+        break;
+#endif  // HAS_EXTERNAL_EEPROM
+#ifdef HAS_MOTION_SEQUENCER
+      case kAutomationRecord:
+        automation_recording_ = value >= 64;
+        break;
+      case kAutomationClear:
+        ClearAutomation();
+        break;
+#endif  // HAS_MOTION_SEQUENCER
+#ifdef HAS_MIDI_MERGE
+      case kThruFilter:
+        MidiThru::set_filter(value);
+        break;
+#ifdef HAS_POLY_CHAIN
+      case kPolyChain:
+        poly_chain_ = value >= 64;
+        chain_note_ = kNoChainNote;
+        controller_.AllNotesOff();
+        break;
+#endif  // HAS_POLY_CHAIN
+#ifdef HAS_PARAMETER_ECHO
+      case kParameterEcho:
+        parameter_echo_ = value >= 64;
+        break;
+#endif  // HAS_PARAMETER_ECHO
+#endif  // HAS_MIDI_MERGE
+#ifdef HAS_PATTERN_BANK
+      case kPatternSelect:
+        PatternBank::Select(value);
+        break;
+      case kPatternStore:
+        PatternBank::Store(value, patch_);
+        break;
+      case kPatternChainNext:
+        PatternBank::set_next(value < kNumPatterns ? value : kNoPattern);
+        break;
+      case kPatternChainRepeats:
+        PatternBank::set_repeats(value);
+        break;
+      case kPatternSongMode:
+        PatternBank::set_song_mode(value >= 64);
+        break;
+#endif  // HAS_PATTERN_BANK
       case hardware_midi::kModulationWheelMsb:
         modulation_sources_[MOD_SRC_WHEEL] = (value << 1);
         break;
@@ -155,7 +498,7 @@ void SynthesisEngine::ControlChange(uint8_t channel, uint8_t controller,
       case hardware_midi::kDataEntryLsb:
         value = value | data_entry_msb_;
         if (nrpn_parameter_number_ < sizeof(Patch) - 1) {
-          SetParameter(nrpn_parameter_number_, value);
+          QueueParameterChange(nrpn_parameter_number_, value);
         }
         data_entry_msb_ = 0;
         break;
@@ -165,16 +508,19 @@ void SynthesisEngine::ControlChange(uint8_t channel, uint8_t controller,
         } else {
           ignore_note_off_messages_ = 0;
           controller_.AllNotesOff();
+#ifdef HAS_POLY_CHAIN
+          chain_note_ = kNoChainNote;
+#endif  // HAS_POLY_CHAIN
         }
         break;
       case hardware_midi::kPortamentoTimeMsb:
         patch_.kbd_portamento = value >> 1;
         break;
       case hardware_midi::kRelease:
-        SetParameter(PRM_ENV_RELEASE_2, value);
+        QueueParameterChange(PRM_ENV_RELEASE_2, value);
         break;
       case hardware_midi::kAttack:
-        SetParameter(PRM_ENV_ATTACK_2, value);
+        QueueParameterChange(PRM_ENV_ATTACK_2, value);
         break;
       case hardware_midi::kHarmonicIntensity:
         patch_.filter_resonance = value >> 1;
@@ -188,10 +534,39 @@ void SynthesisEngine::ControlChange(uint8_t channel, uint8_t controller,
         break;
     }
   } else {
-    const ParameterDefinition& parameter = PatchMetadata::parameter_definition(
-        controller);
-    SetParameter(parameter.id, PatchMetadata::Scale(parameter, value));
+    QueueParameterChange(
+        PatchMetadata::controlled_parameter(controller),
+        PatchMetadata::ScaleControllerValue(controller, value));
+  }
+}
+
+/* static */
+void SynthesisEngine::QueueParameterChange(uint8_t index, uint8_t value) {
+  for (uint8_t i = 0; i < num_queued_parameter_changes_; ++i) {
+    if (parameter_change_queue_[i].index == index) {
+      parameter_change_queue_[i].value = value;
+      return;
+    }
+  }
+  if (num_queued_parameter_changes_ == kParameterChangeQueueSize) {
+    // Too many different parameters modified within a single block. Apply
+    // this one right away rather than dropping it.
+    SetParameter(index, value);
+  } else {
+    parameter_change_queue_[num_queued_parameter_changes_].index = index;
+    parameter_change_queue_[num_queued_parameter_changes_].value = value;
+    ++num_queued_parameter_changes_;
+  }
+}
+
+/* static */
+void SynthesisEngine::ApplyQueuedParameterChanges() {
+  for (uint8_t i = 0; i < num_queued_parameter_changes_; ++i) {
+    SetParameter(
+        parameter_change_queue_[i].index,
+        parameter_change_queue_[i].value);
   }
+  num_queued_parameter_changes_ = 0;
 }
 
 /* static */
@@ -209,14 +584,61 @@ void SynthesisEngine::PitchBend(uint8_t channel, uint16_t pitch_bend) {
   modulation_sources_[MOD_SRC_PITCH_BEND] = ShiftRight6(pitch_bend);
 }
 
+/* static */
+void SynthesisEngine::ProgramChange(uint8_t channel, uint8_t program) {
+#ifdef HAS_EXTERNAL_EEPROM
+  if (bank_) {
+    uint16_t slot = (static_cast<uint16_t>(bank_ - 1) << 7) + program;
+    // Read by LibraryTick(). If several program changes are received during a
+    // read, only the last one is loaded next.
+    if (slot < kNumLibrarySlots) {
+      requested_library_slot_ = slot;
+    }
+    return;
+  }
+#endif  // HAS_EXTERNAL_EEPROM
+  // The directory of valid slots has been built at boot, so there is nothing
+  // to validate here.
+  if (program < kNumPatchSlots && patch_.EepromRecall(program)) {
+    TransitionPatch();
+  }
+}
+
+#ifdef HAS_EXTERNAL_EEPROM
+/* static */
+void SynthesisEngine::LibraryTick() {
+  if (library_load_in_progress_) {
+    uint8_t status = patch_.LibraryLoadPoll();
+    if (status == LIBRARY_READ_PENDING) {
+      return;
+    }
+    library_load_in_progress_ = 0;
+    if (status == LIBRARY_READ_DONE) {
+      TransitionPatch();
+    }
+  }
+  if (requested_library_slot_ != kNoLibrarySlot &&
+      patch_.LibraryLoad(requested_library_slot_)) {
+    library_load_in_progress_ = 1;
+    requested_library_slot_ = kNoLibrarySlot;
+  }
+}
+#endif  // HAS_EXTERNAL_EEPROM
+
 /* static */
 void SynthesisEngine::AllSoundOff(uint8_t channel) {
   controller_.AllSoundOff();
+#ifdef HAS_POLY_CHAIN
+  chain_note_ = kNoChainNote;
+#endif  // HAS_POLY_CHAIN
 }
 
 /* static */
 void SynthesisEngine::AllNotesOff(uint8_t channel) {
   controller_.AllNotesOff();
+#ifdef HAS_POLY_CHAIN
+  chain_note_ = kNoChainNote;
+#endif  // HAS_POLY_CHAIN
 }
 
 /* static */
@@ -248,6 +670,8 @@ void SynthesisEngine::OmniModeOn(uint8_t channel) {
 
 /* static */
 void SynthesisEngine::SysExStart() {
+  // Do not let pending changes overwrite the incoming patch.
+  ApplyQueuedParameterChanges();
   patch_.SysExReceive(0xf0);
 }
 
@@ -287,15 +711,36 @@ void SynthesisEngine::Stop() {
   controller_.Stop();
 }
 
+// Indexed by the parameter pair (attack, decay, sustain, release, LFO wave,
+// LFO rate).
+static const prog_uint8_t dirty_modulation_flags[] PROGMEM = {
+  DIRTY_ENV_ATTACK,
+  DIRTY_ENV_DECAY,
+  DIRTY_ENV_DECAY,
+  DIRTY_ENV_RELEASE,
+  DIRTY_LFO,
+  DIRTY_LFO
+};
+
 /* static */
 void SynthesisEngine::SetParameter(
     uint8_t parameter_index,
     uint8_t parameter_value) {
-  uint8_t* base = &patch_.keep_me_at_the_top;
+  // keep_me_at_the_top is the first member of the patch.
+  uint8_t* base = reinterpret_cast<uint8_t*>(&patch_);
   base[parameter_index + 1] = parameter_value;
   if (parameter_index >= PRM_ENV_ATTACK_1 &&
       parameter_index <= PRM_LFO_RATE_2) {
-    UpdateModulationIncrements();
+    // Envelope and LFO parameters are interleaved: attack 1, attack 2,
+    // decay 1... so the lowest bit of the offset is the envelope/LFO index.
+    uint8_t offset = parameter_index - PRM_ENV_ATTACK_1;
+    uint8_t flag = ResourcesManager::Lookup<uint8_t, uint8_t>(
+        dirty_modulation_flags, offset >> 1);
+    dirty_modulations_ |= flag << (offset & 1);
+  }
+  if (parameter_index >= PRM_MOD_SOURCE &&
+      parameter_index < PRM_MOD_SOURCE + 3 * kModulationMatrixSize) {
+    CompileModulationRoutes();
   }
   if ((parameter_index <= PRM_OSC_SHAPE_2) ||
       (parameter_index == PRM_MIX_SUB_OSC_SHAPE)) {
@@ -310,56 +755,222 @@ void SynthesisEngine::SetParameter(
   }
 }
 
+/* static */
+void SynthesisEngine::EditParameter(
+    uint8_t parameter_index,
+    uint8_t parameter_value) {
+#ifdef HAS_UNDO_JOURNAL
+  UndoJournal::Record(parameter_index, GetParameter(parameter_index));
+#endif  // HAS_UNDO_JOURNAL
+  SetParameter(parameter_index, parameter_value);
+#ifdef HAS_PARAMETER_ECHO
+  if (parameter_echo_) {
+    // Sent on the receive channel, or on channel 1 in omni mode. The running
+    // status drops the repeated status bytes.
+    uint8_t channel = patch_.kbd_midi_channel;
+    while (channel >= 17) {
+      channel -= 17;
+    }
+    uint8_t status = 0xb0 | (channel ? channel - 1 : 0);
+    MidiThru::Send(status, hardware_midi::kNrpnMsb, 0);
+    MidiThru::Send(status, hardware_midi::kNrpnLsb, parameter_index);
+    MidiThru::Send(status, hardware_midi::kDataEntryMsb,
+                   parameter_value >> 7);
+    MidiThru::Send(status, hardware_midi::kDataEntryLsb,
+                   parameter_value & 0x7f);
+  }
+#endif  // HAS_PARAMETER_ECHO
+}
+
+#ifdef HAS_MOTION_SEQUENCER
+/* static */
+void SynthesisEngine::RecordAutomation(uint8_t parameter_index, uint8_t value) {
+  if (!automation_recording_) {
+    return;
+  }
+  if (automation_parameter_ == kNoAutomation) {
+    automation_parameter_ = parameter_index;
+    memset(automation_lane_, value, kNumSteps);
+    automation_ramp_ = parameter_index == PRM_OSC_PARAMETER_1 ||
+        parameter_index == PRM_OSC_PARAMETER_2 ||
+        (parameter_index >= PRM_MIX_BALANCE &&
+         parameter_index <= PRM_MIX_NOISE) ||
+        parameter_index == PRM_FILTER_CUTOFF ||
+        parameter_index == PRM_FILTER_RESONANCE;
+  }
+  if (parameter_index == automation_parameter_) {
+    automation_lane_[controller_.step()] = value;
+  }
+}
+
+/* static */
+void SynthesisEngine::UpdateAutomation(uint8_t new_step) {
+  if (automation_parameter_ == kNoAutomation || automation_recording_) {
+    return;
+  }
+  uint8_t* parameter = reinterpret_cast<uint8_t*>(&patch_) + 1 +
+      automation_parameter_;
+  if (automation_ticks_ != 0xffff) {
+    ++automation_ticks_;
+  }
+  if (new_step) {
+    automation_step_duration_ = automation_ticks_;
+    automation_ticks_ = 0;
+    uint8_t step = controller_.step();
+    uint8_t value = automation_lane_[step];
+    if (!automation_ramp_) {
+      if (*parameter != value) {
+        SetParameter(automation_parameter_, value);
+      }
+      return;
+    }
+    // Ramp toward the value of the next step, assuming that this step lasts
+    // as long as the previous one.
+    uint8_t next_step = step + 1;
+    if (next_step >= patch_.pattern_size) {
+      next_step = 0;
+    }
+    int16_t delta = automation_lane_[next_step] - value;
+    automation_value_ = static_cast<uint16_t>(value) << 8;
+    automation_increment_ = (static_cast<int32_t>(delta) << 8) /
+        automation_step_duration_;
+    *parameter = value;
+  } else if (automation_ramp_ &&
+             automation_ticks_ < automation_step_duration_) {
+    automation_value_ += automation_increment_;
+    *parameter = automation_value_ >> 8;
+  }
+}
+#endif  // HAS_MOTION_SEQUENCER
+
 /* static */
 void SynthesisEngine::UpdateOscillatorAlgorithms() {
-  osc_1.SetupAlgorithm(patch_.osc_shape[0]);
-  osc_2.SetupAlgorithm(patch_.osc_shape[1]);
-  sub_osc.SetupAlgorithm(patch_.mix_sub_osc_shape);
+  Voices::UpdateOscillatorAlgorithms();
+}
+
+/* static */
+void SynthesisEngine::CompileModulationRoutes() {
+  Voices::CompileModulationRoutes();
 }
 
 /* static */
 void SynthesisEngine::UpdateModulationIncrements() {
-  // Update the LFO increments.
+  dirty_modulations_ = DIRTY_ALL;
+  UpdateDirtyModulations();
+}
+
+/* static */
+void SynthesisEngine::UpdateDirtyModulations() {
+  if (!dirty_modulations_) {
+    return;
+  }
+  // Count the number of steps after which the LFOs synced to the tempo are
+  // reset. This is cheap, and depends on the rate of both LFOs.
   num_lfo_reset_steps_ = 0;
   lfo_to_reset_ = 0;
   for (uint8_t i = 0; i < kNumLfos; ++i) {
-    uint16_t increment;
-    // The LFO rates 0 to 15 are translated into a multiple of the step
-    // sequencer/arpeggiator step size.
     if (patch_.lfo_rate[i] < 16) {
-      increment = 65536 / (controller_.estimated_beat_duration() *
-                           (1 + patch_.lfo_rate[i]) / 4);
       num_lfo_reset_steps_ = UnsignedUnsignedMul(
           num_lfo_reset_steps_ ? num_lfo_reset_steps_ : 1,
           1 + patch_.lfo_rate[i]);
       lfo_to_reset_ |= _BV(i);
-    } else {
-      increment = ResourcesManager::Lookup<uint16_t, uint8_t>(
-          lut_res_lfo_increments, patch_.lfo_rate[i] - 16);
     }
-    lfo_[i].Update(patch_.lfo_wave[i], increment);
+  }
+  for (uint8_t i = 0; i < kNumLfos; ++i) {
+    if (dirty_modulations_ & (DIRTY_LFO << i)) {
+      uint16_t increment;
+      // The LFO rates 0 to 15 are translated into a multiple of the step
+      // sequencer/arpeggiator step size.
+      if (patch_.lfo_rate[i] < 16) {
+        increment = 65536 / (controller_.estimated_beat_duration() *
+                             (1 + patch_.lfo_rate[i]) / 4);
+      } else {
+        increment = ResourcesManager::Lookup<uint16_t, uint8_t>(
+            lut_res_lfo_increments, patch_.lfo_rate[i] - 16);
+      }
+      lfo_[i].Update(patch_.lfo_wave[i], increment);
+    }
 
     for (uint8_t j = 0; j < kNumVoices; ++j) {
-      voice_[j].mutable_envelope(i)->Update(
-          patch_.env_attack[i],
-          patch_.env_decay[i],
-          patch_.env_sustain[i],
-          patch_.env_release[i]);
+      Envelope* envelope = Voices::mutable_envelope(j, i);
+      if (dirty_modulations_ & (DIRTY_ENV_ATTACK << i)) {
+        envelope->UpdateAttack(patch_.env_attack[i]);
+      }
+      if (dirty_modulations_ & (DIRTY_ENV_DECAY << i)) {
+        envelope->UpdateDecay(patch_.env_decay[i], patch_.env_sustain[i]);
+      }
+      if (dirty_modulations_ & (DIRTY_ENV_RELEASE << i)) {
+        envelope->UpdateRelease(patch_.env_release[i]);
+      }
     }
   }
+  dirty_modulations_ = 0;
 }
 
 /* static */
 void SynthesisEngine::Control() {
+  ApplyQueuedParameterChanges();
+#ifdef HAS_PATCH_TRANSITION
+  if (patch_transition_) {
+    --patch_transition_;
+    if (patch_transition_ == kPatchTransitionDuration / 2) {
+      TouchPatch();
+    }
+  }
+#endif  // HAS_PATCH_TRANSITION
+  UpdateDirtyModulations();
   for (uint8_t i = 0; i < kNumLfos; ++i) {
     lfo_[i].Increment();
     modulation_sources_[MOD_SRC_LFO_1 + i] = lfo_[i].Render(patch_);
   }
+#ifdef HAS_AUDIO_RATE_NOISE
+  // The LFSR is no longer advanced by the audio rendering, so it takes here
+  // the steps it used to take during a block.
+  for (uint8_t i = 0; i < kAudioBlockSize / 4; ++i) {
+    Random::Update();
+  }
+#endif  // HAS_AUDIO_RATE_NOISE
   modulation_sources_[MOD_SRC_RANDOM] = Random::state_msb();
   modulation_sources_[MOD_SRC_OFFSET] = 255;
 
   // Update the arpeggiator / step sequencer.
-  if (controller_.Control()) {
+  uint8_t new_step = controller_.Control();
+  if (new_step) {
+#ifdef HAS_PATTERN_BANK
+    if (controller_.step() == 0) {
+      const Pattern* pattern = PatternBank::Downbeat();
+      if (pattern) {
+        memcpy(patch_.sequence, pattern->sequence, sizeof(patch_.sequence));
+        patch_.arp_pattern = pattern->arp_pattern;
+        patch_.pattern_size = pattern->pattern_size;
+        controller_.UpdateArpeggiatorParameters(patch_);
+      }
+    }
+#endif  // HAS_PATTERN_BANK
+#ifdef HAS_MIDI_CLOCK_PLL
+    // The LFOs synced to the tempo only need to be recomputed when the tempo
+    // changes. They are kept in phase with the steps by pulling them toward
+    // the start of their period every 1 + rate steps - or reset when a
+    // sequence starts.
+    if (controller_.tempo_changed()) {
+      dirty_modulations_ |= lfo_to_reset_ * DIRTY_LFO;
+      UpdateDirtyModulations();
+    }
+    for (uint8_t i = 0; i < kNumLfos; ++i) {
+      if (!(lfo_to_reset_ & _BV(i))) {
+        lfo_step_[i] = 0;
+      } else if (lfo_step_[i] == kLfoRetrigger) {
+        lfo_[i].Reset();
+        lfo_step_[i] = 0;
+      } else {
+        ++lfo_step_[i];
+        if (lfo_step_[i] > patch_.lfo_rate[i]) {
+          lfo_[i].Pull();
+          lfo_step_[i] = 0;
+        }
+      }
+    }
+#else
     // We need to do a couple of things when the step sequencer advances to the
     // next step:
     // - periodically (eg whenever we move to step 0), recompute the LFO
@@ -370,7 +981,9 @@ void SynthesisEngine::Control() {
     // "synchronization drift" because of rounding errors.
     ++lfo_reset_counter_;
     if (lfo_reset_counter_ == num_lfo_reset_steps_) {
-      UpdateModulationIncrements();
+      // Only the LFOs synced to the tempo need to be recomputed.
+      dirty_modulations_ |= lfo_to_reset_ * DIRTY_LFO;
+      UpdateDirtyModulations();
       for (uint8_t i = 0; i < kNumLfos; ++i) {
         if (lfo_to_reset_ & _BV(i)) {
           lfo_[i].Reset();
@@ -378,60 +991,214 @@ void SynthesisEngine::Control() {
       }
       lfo_reset_counter_ = 0;
     }
+#endif  // HAS_MIDI_CLOCK_PLL
   }
   
+#ifdef HAS_MOTION_SEQUENCER
+  UpdateAutomation(new_step);
+#endif  // HAS_MOTION_SEQUENCER
+  
   // Read/shift the value of the step sequencer.
   modulation_sources_[MOD_SRC_SEQ] = patch_.sequence_step(controller_.step());
   modulation_sources_[MOD_SRC_STEP] = (
       controller_.has_arpeggiator_note() ? 255 : 0);
   
-  for (uint8_t i = 0; i < kNumVoices; ++i) {
-    voice_[i].Control();
+  Voices::Control();
+}
+
+/* static */
+void SynthesisEngine::AudioBlock(AudioSample* buffer) {
+  Voices::AudioBlock(buffer);
+}
+
+/* static */
+void SynthesisEngine::TriggerVoice(
+    uint8_t voice,
+    uint8_t note,
+    uint8_t velocity,
+    uint8_t legato) {
+  Voices::Trigger(voice, note, velocity, legato);
+#ifdef HAS_TRACE
+  Trace::Write(TRACE_VOICE_TRIGGER, note);
+#endif  // HAS_TRACE
+#ifdef HAS_LATENCY_PROBE
+  ++num_triggers_;
+#endif  // HAS_LATENCY_PROBE
+}
+
+/* static */
+void SynthesisEngine::ReleaseVoice(uint8_t voice) {
+  Voices::Release(voice);
+}
+
+/* static */
+void SynthesisEngine::KillVoice(uint8_t voice) {
+  Voices::Kill(voice);
+}
+
+/* static */
+uint8_t SynthesisEngine::dead() {
+  return Voices::dead();
+}
+
+/* static */
+uint8_t SynthesisEngine::modulation_destination(uint8_t i) {
+  return Voices::modulation_destination(controller_.most_recent_voice(), i);
+}
+
+/* static */
+uint8_t SynthesisEngine::modulation_source(uint8_t i) {
+  if (i < kNumGlobalModulationSources) {
+    return modulation_sources_[i];
+  } else {
+    return Voices::modulation_source(controller_.most_recent_voice(), i);
   }
 }
 
 /* static */
-void SynthesisEngine::Audio() {
-  // Tick the noise generator.
-  oscillator_decimation_ = (oscillator_decimation_ + 1) & 3;
-  if (!oscillator_decimation_) {
-    Random::Update();
+uint16_t SynthesisEngine::PitchToIncrement(int16_t pitch, uint8_t* midi_note) {
+  // The patch parameters keep the pitch above -72 semitones - this is only a
+  // safeguard against corrupted patches.
+  if (pitch < -72 * 128) {
+    pitch = -72 * 128;
   }
-  for (uint8_t i = 0; i < kNumVoices; ++i) {
-    voice_[i].Audio();
+  // Split the pitch into an octave and a pitch within this octave, without
+  // division: for 0 <= x < 384, x * 171 >> 11 is x / 12. The offset of 6
+  // octaves makes x positive.
+  uint16_t x = (pitch >> 7) + 72;
+  int8_t octave = static_cast<int8_t>((x * 171) >> 11) - 6;
+  uint16_t pitch_in_octave = pitch - octave * kOctave;
+  
+  // Transposing the pitch by whole octaves until it lies between kLowestNote
+  // and kHighestNote amounts to clipping the octave.
+  if (octave < 0) {
+    octave = 0;
+  } else if (octave > kHighestOctave) {
+    octave = kHighestOctave;
   }
+  *midi_note = octave * 12 + (pitch_in_octave >> 7);
+  
+  // The table has one entry every 2/128th of semitone. For odd pitches, the
+  // two neighbouring entries are averaged - the entry following the last one
+  // being the first one, an octave higher. The sum of the two entries has one
+  // more bit of precision, hence the extra shift.
+  uint16_t index = pitch_in_octave >> 1;
+  uint16_t increment = ResourcesManager::Lookup<uint16_t, uint16_t>(
+      oscillator_increments, index);
+  uint16_t next = increment;
+  if (pitch_in_octave & 1) {
+    if (index == kOctave / 2 - 1) {
+      next = ResourcesManager::Lookup<uint16_t, uint16_t>(
+          oscillator_increments, 0) << 1;
+    } else {
+      next = ResourcesManager::Lookup<uint16_t, uint16_t>(
+          oscillator_increments, index + 1);
+    }
+  }
+  return (increment + next) >> (kPitchTableOctave + 1 - octave);
 }
 
 /* <static> */
-Envelope Voice::envelope_[kNumEnvelopes];
-uint8_t Voice::dead_;
-int16_t Voice::pitch_increment_;
-int16_t Voice::pitch_target_;
-int16_t Voice::pitch_value_;
-uint8_t Voice::modulation_sources_[kNumVoiceModulationSources];
-int8_t Voice::modulation_destinations_[kNumModulationDestinations];
-uint8_t Voice::signal_;
-uint8_t Voice::osc1_phase_msb_;
+template<uint8_t index> Envelope Voice<index>::envelope_[kNumEnvelopes];
+template<uint8_t index> uint8_t Voice<index>::dead_;
+template<uint8_t index> int16_t Voice<index>::pitch_increment_;
+template<uint8_t index> int16_t Voice<index>::pitch_target_;
+template<uint8_t index> int16_t Voice<index>::pitch_value_;
+template<uint8_t index>
+uint8_t Voice<index>::modulation_sources_[kNumVoiceModulationSources];
+template<uint8_t index>
+int8_t Voice<index>::modulation_destinations_[kNumModulationDestinations];
+template<uint8_t index> uint8_t Voice<index>::signal_;
+#ifdef HAS_MIX_INTERPOLATION
+template<uint8_t index> uint8_t Voice<index>::previous_mix_levels_[3];
+#endif  // HAS_MIX_INTERPOLATION
+#ifdef HAS_DIGITAL_FILTER
+template<uint8_t index> DigitalFilter Voice<index>::filter_;
+#endif  // HAS_DIGITAL_FILTER
+template<uint8_t index>
+ModulationRoute Voice<index>::modulation_routes_[kModulationMatrixSize];
+template<uint8_t index> uint8_t Voice<index>::num_additive_modulation_routes_;
+template<uint8_t index> uint8_t Voice<index>::num_modulation_routes_;
 /* </static> */
 
 /* static */
-void Voice::Init() {
+template<uint8_t index>
+void Voice<index>::Init() {
   pitch_value_ = 0;
   signal_ = 128;
   for (uint8_t i = 0; i < kNumEnvelopes; ++i) {
     envelope_[i].Init();
   }
+#ifdef HAS_DIGITAL_FILTER
+  filter_.Init();
+#endif  // HAS_DIGITAL_FILTER
+}
+
+/* static */
+template<uint8_t index>
+void Voice<index>::UpdateOscillatorAlgorithms() {
+  Oscillators::Bind();
+  Oscillators::Osc1::SetupAlgorithm(engine.patch_.osc_shape[0]);
+  Oscillators::Osc2::SetupAlgorithm(engine.patch_.osc_shape[1]);
+  Oscillators::SubOsc::SetupAlgorithm(engine.patch_.mix_sub_osc_shape);
+}
+
+/* static */
+template<uint8_t index>
+void Voice<index>::CompileModulationRoutes() {
+  uint8_t num_routes = 0;
+  // First pass for the additive destinations, second pass for the VCA.
+  for (uint8_t vca = 0; vca < 2; ++vca) {
+    for (uint8_t i = 0; i < kModulationMatrixSize; ++i) {
+      const Modulation& modulation =
+          engine.patch_.modulation_matrix.modulation[i];
+      if (!modulation.amount ||
+          (modulation.destination == MOD_DST_VCA) != vca) {
+        continue;
+      }
+      uint8_t source = modulation.source;
+      uint8_t flags = 0;
+      ModulationRoute* route = &modulation_routes_[num_routes];
+      if (source < kNumGlobalModulationSources) {
+        // Global sources, read from the engine.
+        route->source = &engine.modulation_sources_[source];
+      } else {
+        // Voice specific sources, read from the voice.
+        route->source = &modulation_sources_[
+            source - kNumGlobalModulationSources];
+      }
+      // For those sources, use relative modulation.
+      if (source <= MOD_SRC_LFO_2 ||
+          source == MOD_SRC_PITCH_BEND ||
+          source == MOD_SRC_NOTE) {
+        flags |= ROUTE_RELATIVE;
+      }
+      // The rate of the last modulation is adjusted by the wheel.
+      if (i == kSavedModulationMatrixSize - 1) {
+        flags |= ROUTE_WHEEL;
+      }
+      route->destination_flags = modulation.destination | flags;
+      route->amount = modulation.amount;
+      ++num_routes;
+    }
+    if (!vca) {
+      num_additive_modulation_routes_ = num_routes;
+    }
+  }
+  num_modulation_routes_ = num_routes;
 }
 
 /* static */
-void Voice::TriggerEnvelope(uint8_t stage) {
+template<uint8_t index>
+void Voice<index>::TriggerEnvelope(uint8_t stage) {
   for (uint8_t i = 0; i < kNumEnvelopes; ++i) {
     envelope_[i].Trigger(stage);
   }
 }
 
 /* static */
-void Voice::Trigger(uint8_t note, uint8_t velocity, uint8_t legato) {
+template<uint8_t index>
+void Voice<index>::Trigger(uint8_t note, uint8_t velocity, uint8_t legato) {
   if (engine.patch_.kbd_raga) {
     int16_t pitch_shift = ResourcesManager::Lookup<int16_t, uint8_t>(
         ResourceId(LUT_RES_SCALE_JUST + engine.patch_.kbd_raga - 1),
@@ -475,7 +1242,9 @@ void Voice::Trigger(uint8_t note, uint8_t velocity, uint8_t legato) {
 }
 
 /* static */
-void Voice::Control() {
+template<uint8_t index>
+void Voice<index>::Control() {
+  Oscillators::Bind();
   // Update the envelopes.
   dead_ = 1;
   for (uint8_t i = 0; i < kNumEnvelopes; ++i) {
@@ -517,52 +1286,40 @@ void Voice::Control() {
   dst[MOD_DST_MIX_SUB_OSC] = engine.patch_.mix_sub_osc << 8;
   dst[MOD_DST_FILTER_RESONANCE] = engine.patch_.filter_resonance << 8;
   
-  // Apply the modulations in the modulation matrix.
-  for (uint8_t i = 0; i < kModulationMatrixSize; ++i) {
-    int8_t amount = engine.patch_.modulation_matrix.modulation[i].amount;
-    if (!amount) {
-      continue;
+  // Apply the modulations in the modulation matrix, compiled into a list of
+  // routes. The additive modulations are applied first.
+  uint8_t wheel = engine.modulation_sources_[MOD_SRC_WHEEL];
+  uint8_t i = 0;
+  for (; i < num_additive_modulation_routes_; ++i) {
+    const ModulationRoute& route = modulation_routes_[i];
+    int8_t amount = route.amount;
+    if (route.destination_flags & ROUTE_WHEEL) {
+      amount = SignedMulScale8(amount, wheel);
     }
-
-    // The rate of the last modulation is adjusted by the wheel.
-    if (i == kSavedModulationMatrixSize - 1) {
-      amount = SignedMulScale8(
-          amount,
-          engine.modulation_sources_[MOD_SRC_WHEEL]);
+    uint8_t destination = route.destination_flags & ROUTE_DESTINATION_MASK;
+    int16_t modulation = dst[destination];
+    modulation += SignedUnsignedMul(amount, *route.source);
+    if (route.destination_flags & ROUTE_RELATIVE) {
+      modulation -= amount << 7;
     }
-    uint8_t source = engine.patch_.modulation_matrix.modulation[i].source;
-    uint8_t destination =
-        engine.patch_.modulation_matrix.modulation[i].destination;
-    uint8_t source_value;
-
-    if (source < kNumGlobalModulationSources) {
-      // Global sources, read from the engine.
-      source_value = engine.modulation_sources_[source];
-    } else {
-      // Voice specific sources, read from the voice.
-      source_value = modulation_sources_[source - kNumGlobalModulationSources];
+    dst[destination] = Clip(modulation, 0, 16383);
+  }
+  for (; i < num_modulation_routes_; ++i) {
+    // The VCA modulation is multiplicative, not additive. Yet another
+    // Special case :(.
+    const ModulationRoute& route = modulation_routes_[i];
+    int8_t amount = route.amount;
+    if (route.destination_flags & ROUTE_WHEEL) {
+      amount = SignedMulScale8(amount, wheel);
     }
-    if (destination != MOD_DST_VCA) {
-      int16_t modulation = dst[destination];
-      modulation += SignedUnsignedMul(amount, source_value);
-      // For those sources, use relative modulation.
-      if (source <= MOD_SRC_LFO_2 ||
-          source == MOD_SRC_PITCH_BEND ||
-          source == MOD_SRC_NOTE) {
-        modulation -= amount << 7;
-      }
-      dst[destination] = Clip(modulation, 0, 16383);
-    } else {
-      // The VCA modulation is multiplicative, not additive. Yet another
-      // Special case :(.
-      if (amount < 0) {
-        amount = -amount;
-        source_value = 255 - source_value;
-      }
-      modulation_destinations_[MOD_DST_VCA] = MulScale8(
-          modulation_destinations_[MOD_DST_VCA],
-          Mix(255, source_value, amount << 2));
+    uint8_t source_value = *route.source;
+    if (amount < 0) {
+      amount = -amount;
+      source_value = 255 - source_value;
     }
+    modulation_destinations_[MOD_DST_VCA] = MulScale8(
+        modulation_destinations_[MOD_DST_VCA],
+        Mix(255, source_value, amount << 2));
   }
   // Hardcoded filter modulations.
   dst[MOD_DST_FILTER_CUTOFF] = Clip(
@@ -579,6 +1336,13 @@ void Voice::Control() {
       0,
       16383);
   
+#ifdef HAS_PATCH_TRANSITION
+  uint8_t previous[kNumModulationDestinations];
+  if (engine.patch_transition_) {
+    memcpy(previous, modulation_destinations_, kNumModulationDestinations);
+  }
+#endif  // HAS_PATCH_TRANSITION
+
   // Store in memory all the updated parameters.
   modulation_destinations_[MOD_DST_FILTER_CUTOFF] = ShiftRight6(
       dst[MOD_DST_FILTER_CUTOFF]);
@@ -593,13 +1357,33 @@ void Voice::Control() {
       dst[MOD_DST_MIX_BALANCE]);
   modulation_destinations_[MOD_DST_MIX_NOISE] = dst[MOD_DST_MIX_NOISE] >> 8;
   modulation_destinations_[MOD_DST_MIX_SUB_OSC] = dst[MOD_DST_MIX_SUB_OSC] >> 7;
+
+#ifdef HAS_PATCH_TRANSITION
+  // During a patch transition, the destinations move half-way towards their
+  // new value at each tick, and the VCA follows the transition envelope.
+  if (engine.patch_transition_) {
+    uint8_t vca = modulation_destinations_[MOD_DST_VCA];
+    for (uint8_t i = 0; i < kNumModulationDestinations; ++i) {
+      modulation_destinations_[i] = (
+          static_cast<uint8_t>(modulation_destinations_[i]) + previous[i]) >> 1;
+    }
+    modulation_destinations_[MOD_DST_VCA] = MulScale8(
+        vca,
+        engine.patch_transition_gain());
+  }
+#endif  // HAS_PATCH_TRANSITION
+
+#ifdef HAS_DIGITAL_FILTER
+  filter_.Update(cutoff(), resonance());
+#endif  // HAS_DIGITAL_FILTER
   
   // Update the oscillator parameters.
   for (uint8_t i = 0; i < kNumOscillators; ++i) {
     int16_t pitch = pitch_value_;
     // -24 / +24 semitones by the range controller.
     if (engine.patch_.osc_shape[i] == WAVEFORM_FM) {
-      osc_1.UpdateSecondaryParameter(engine.patch_.osc_range[i] + 12);
+      Oscillators::Osc1::UpdateSecondaryParameter(
+          engine.patch_.osc_range[i] + 12);
     } else {
       pitch += static_cast<int16_t>(engine.patch_.osc_range[i]) << 7;
     }
@@ -614,39 +1398,21 @@ void Voice::Control() {
     // -4 / +4 semitones by the vibrato and pitch bend.
     pitch += (dst[MOD_DST_VCO_1_2_FINE] - 8192) >> 4;
 
-    // Wrap pitch to a reasonable range.
-    while (pitch < kLowestNote) {
-      pitch += kOctave;
-    }
-    while (pitch >= kHighestNote) {
-      pitch -= kOctave;
-    }
-    // Extract the pitch increment from the pitch table.
-    int16_t ref_pitch = pitch - kPitchTableStart;
-    uint8_t num_shifts = 0;
-    while (ref_pitch < 0) {
-      ref_pitch += kOctave;
-      ++num_shifts;
-    }
-    uint16_t increment = ResourcesManager::Lookup<uint16_t, uint16_t>(
-        lut_res_oscillator_increments, ref_pitch >> 1);
-    // Divide the pitch increment by the number of octaves we had to transpose
-    // to get a value in the lookup table.
-    increment >>= num_shifts;
+    uint8_t midi_note;
+    uint16_t increment = engine.PitchToIncrement(pitch, &midi_note);
     
     // Now the oscillators can recompute all their internal variables!
-    uint8_t midi_note = pitch >>= 7;
     if (i == 0) {
-      osc_1.Update(
+      Oscillators::Osc1::Update(
           modulation_destinations_[MOD_DST_PWM_1],
           midi_note,
           increment);
-      sub_osc.Update(
+      Oscillators::SubOsc::Update(
           0,
           midi_note - 12,
           increment >> 1);
     } else {
-      osc_2.Update(
+      Oscillators::Osc2::Update(
           modulation_destinations_[MOD_DST_PWM_2],
           midi_note,
           increment);
@@ -655,52 +1421,123 @@ void Voice::Control() {
 }
 
 /* static */
-inline void Voice::Audio() {
-  uint8_t osc_2_signal = osc_2.Render();
-  uint8_t mix = osc_1.Render();
-  switch (engine.patch_.osc_option[0]) {
+template<uint8_t index>
+inline void Voice<index>::AudioBlock(AudioSample* buffer) {
+  Oscillators::Bind();
+  MixLevel balance;
+  MixLevel sub_osc_level;
+  MixLevel noise_level;
+#ifdef HAS_MIX_INTERPOLATION
+  balance.Init(
+      previous_mix_levels_[0],
+      modulation_destinations_[MOD_DST_MIX_BALANCE]);
+  noise_level.Init(
+      previous_mix_levels_[1],
+      modulation_destinations_[MOD_DST_MIX_NOISE]);
+  sub_osc_level.Init(
+      previous_mix_levels_[2],
+      modulation_destinations_[MOD_DST_MIX_SUB_OSC]);
+  for (uint8_t i = 0; i < 3; ++i) {
+    previous_mix_levels_[i] = modulation_destinations_[MOD_DST_MIX_BALANCE + i];
+  }
+#else
+  balance.Init(0, modulation_destinations_[MOD_DST_MIX_BALANCE]);
+  noise_level.Init(0, modulation_destinations_[MOD_DST_MIX_NOISE]);
+  sub_osc_level.Init(0, modulation_destinations_[MOD_DST_MIX_SUB_OSC]);
+#endif  // HAS_MIX_INTERPOLATION
+
+  // Each operator has its own loop, so the per-sample code does not test the
+  // operator. With sync, the two oscillators are rendered in the same loop, in
+  // which the first one resets the phase of the second one. With 8-bit
+  // samples, the output buffer is used for the first oscillator.
+#ifdef HAS_DAC_OUTPUT
+  uint8_t osc_1_buffer[kAudioBlockSize];
+#else
+  uint8_t* osc_1_buffer = buffer;
+#endif  // HAS_DAC_OUTPUT
+  uint8_t osc_2_buffer[kAudioBlockSize];
+  uint8_t op = engine.patch_.osc_option[0];
+  if (op == SYNC) {
+    Oscillators::Osc1::template RenderSyncedBlock<typename Oscillators::Osc2>(
+        osc_1_buffer,
+        osc_2_buffer);
+  } else {
+    Oscillators::Osc2::RenderBlock(osc_2_buffer);
+    Oscillators::Osc1::RenderBlock(osc_1_buffer);
+  }
+  
+  switch (op) {
     case SYNC:
-      {
-        uint8_t phase_msb = osc_1.phase() >> 8;
-        if (phase_msb < osc1_phase_msb_) {
-          osc_2.ResetPhase();
-        }
-        // Store the phase of the oscillator to check later whether the phase has
-        // been wrapped. Because the phase increment is likely to be below
-        // 65536 - 256, we can use the most significant byte only to detect
-        // wrapping.
-        osc1_phase_msb_ = phase_msb;
-      }
-      // Fall through!
     case SUM:
-      mix = Mix(
-          mix,
-          osc_2_signal,
-          modulation_destinations_[MOD_DST_MIX_BALANCE]);
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        osc_1_buffer[i] = Mix(osc_1_buffer[i], osc_2_buffer[i], balance.Next());
+      }
       break;
     case RING_MOD:
-      mix = SignedSignedMulScale8(mix + 128, osc_2_signal + 128) + 128;
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        osc_1_buffer[i] = SignedSignedMulScale8(
+            osc_1_buffer[i] + 128,
+            osc_2_buffer[i] + 128) + 128;
+      }
       break;
     case XOR:
-      mix ^= osc_2_signal;
-      mix += modulation_destinations_[MOD_DST_MIX_BALANCE];
+      for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+        osc_1_buffer[i] = (osc_1_buffer[i] ^ osc_2_buffer[i]) + balance.Next();
+      }
       break;
   }
   
-  // Disable sub oscillator and noise when the "vowel" waveform is used - it is
-  // just too costly.
-  if (engine.patch_.osc_shape[0] != WAVEFORM_VOWEL) {
-    mix = Mix(
-        mix,
-        sub_osc.Render(),
-        modulation_destinations_[MOD_DST_MIX_SUB_OSC]);
-    mix = Mix(
-        mix,
-        Random::state_msb(),
-        modulation_destinations_[MOD_DST_MIX_NOISE]);
+  // The buffer of the second oscillator is reused for the sub oscillator. The
+  // noise generator is ticked every 4 samples - or at each sample, when the
+  // noise has its own generator.
+#ifdef HAS_LOAD_GOVERNOR
+  uint8_t governor_level = LoadGovernor::level();
+  if (governor_level >= GOVERNOR_HALF_RATE_SUB_OSC) {
+    Oscillators::SubOsc::RenderHalfRateSubBlock(osc_2_buffer);
+  } else {
+    Oscillators::SubOsc::RenderBlock(osc_2_buffer);
   }
+#else
+  Oscillators::SubOsc::RenderBlock(osc_2_buffer);
+#endif  // HAS_LOAD_GOVERNOR
+  for (uint8_t i = 0; i < kAudioBlockSize; ++i) {
+    uint8_t mix = Mix(osc_1_buffer[i], osc_2_buffer[i], sub_osc_level.Next());
+#ifdef HAS_LOAD_GOVERNOR
+    if (governor_level >= GOVERNOR_NO_NOISE) {
+#ifdef HAS_DAC_OUTPUT
+      buffer[i] = static_cast<uint16_t>(mix) << 4;
+#else
+      buffer[i] = mix;
+#endif  // HAS_DAC_OUTPUT
+      continue;
+    }
+#endif  // HAS_LOAD_GOVERNOR
+#ifdef HAS_AUDIO_RATE_NOISE
+    uint8_t noise = AudioRandom::GetByte();
+#else
+    if ((i & 3) == 3) {
+      Random::Update();
+    }
+    uint8_t noise = Random::state_msb();
+#endif  // HAS_AUDIO_RATE_NOISE
+#ifdef HAS_DAC_OUTPUT
+    // The 16-bit result of the last crossfade is cut down to 12 bits, rather
+    // than to 8.
+    buffer[i] = UnscaledMix(mix, noise, noise_level.Next()) >> 4;
+#else
+    buffer[i] = Mix(mix, noise, noise_level.Next());
+#endif  // HAS_DAC_OUTPUT
+  }
+
+#ifdef HAS_DIGITAL_FILTER
+  filter_.Process(buffer);
+#endif  // HAS_DIGITAL_FILTER
   
-  signal_ = mix;
+#ifdef HAS_DAC_OUTPUT
+  signal_ = buffer[kAudioBlockSize - 1] >> 4;
+#else
+  signal_ = buffer[kAudioBlockSize - 1];
+#endif  // HAS_DAC_OUTPUT
 }
 
 }  // namespace hardware_shruti
@@ -30,9 +30,11 @@
 // to a "class" with only static methods/member variables yielded faster, leaner
 // code in many places and has since been widely adopted in the code.
 //
-// Note that a polyphonic synth would need several voices object - in this case
-// this transformation should not be applied to the Voice class. Since, for now
-// only the monophonic mode is supported, Voice is also "static'ified".
+// The same goes for the voices: Voice is a template parameterized by the index
+// of the voice, and each instantiation is a "static'ified" class. The
+// oscillators of Voice<0> are static too; those of the other voices share the
+// same code and are bound to the state of the voice before it is processed.
+// The monophonic build only instantiates Voice<0>.
 
 #ifndef HARDWARE_SHRUTI_SYNTHESIS_ENGINE_H_
 #define HARDWARE_SHRUTI_SYNTHESIS_ENGINE_H_
@@ -40,6 +42,7 @@
 #include "hardware/shruti/shruti.h"
 
 #include "hardware/midi/midi.h"
+#include "hardware/shruti/digital_filter.h"
 #include "hardware/shruti/envelope.h"
 #include "hardware/shruti/lfo.h"
 #include "hardware/shruti/patch.h"
@@ -48,16 +51,80 @@
 
 namespace hardware_shruti {
 
-// Used for MIDI -> oscillator increment conversion.
+// Used for MIDI -> oscillator increment conversion. The pitch table covers the
+// octave starting at kPitchTableStart, and pitches are transposed by whole
+// octaves to fit between kLowestNote and kHighestNote.
 static const int16_t kLowestNote = 0 * 128;
 static const int16_t kHighestNote = 108 * 128;
 static const int16_t kOctave = 12 * 128;
 static const int16_t kPitchTableStart = 96 * 128;
+static const uint8_t kPitchTableOctave = kPitchTableStart / kOctave;
+static const int8_t kHighestOctave = kHighestNote / kOctave - 1;
 
 static const uint8_t kNumLfos = 2;
 static const uint8_t kNumEnvelopes = 2;
 static const uint8_t kNumOscillators = 2;
 
+// Maximum number of distinct parameters modified by MIDI messages between two
+// calls to Control().
+static const uint8_t kParameterChangeQueueSize = 8;
+
+// Duration, in control ticks, of the transition to a newly loaded patch.
+static const uint8_t kPatchTransitionDuration = 16;
+
+// Value of the LFO step counters causing a reset of the LFO at the next step.
+static const uint8_t kLfoRetrigger = 0xff;
+
+#ifdef HAS_EXTERNAL_EEPROM
+// Value of the requested library slot when no patch is to be read.
+static const uint16_t kNoLibrarySlot = 0xffff;
+#endif  // HAS_EXTERNAL_EEPROM
+
+#ifdef HAS_MOTION_SEQUENCER
+// Value of the automated parameter index when no parameter is automated.
+static const uint8_t kNoAutomation = 0xff;
+
+// Controllers starting/stopping the recording, and clearing the automation
+// lane.
+static const uint8_t kAutomationRecord = 0x5b;
+static const uint8_t kAutomationClear = 0x5c;
+#endif  // HAS_MOTION_SEQUENCER
+
+struct ParameterChange {
+  uint8_t index;
+  uint8_t value;
+};
+
+// Flags marking the LFOs and envelope stages which need to be recomputed.
+// Shifted left by the index of the LFO/envelope.
+enum DirtyModulation {
+  DIRTY_ENV_ATTACK = 0x01,
+  DIRTY_ENV_DECAY = 0x04,
+  DIRTY_ENV_RELEASE = 0x10,
+  DIRTY_LFO = 0x40,
+  DIRTY_ALL = 0xff
+};
+
+// A row of the modulation matrix, compiled into a form which can be applied
+// without testing the source or destination. The 4 lowest bits of
+// destination_flags store the destination, the 4 highest bits are flags.
+enum ModulationRouteFlag {
+  ROUTE_DESTINATION_MASK = 0x0f,
+  // The modulation is centered around the middle value of the source.
+  ROUTE_RELATIVE = 0x10,
+  // The amount is scaled by the modulation wheel.
+  ROUTE_WHEEL = 0x20
+};
+
+struct ModulationRoute {
+  const uint8_t* source;
+  uint8_t destination_flags;
+  int8_t amount;
+};
+
+template<uint8_t index> struct VoiceOscillators;
+
+template<uint8_t index>
 class Voice {
  public:
   Voice() { }
@@ -72,7 +139,7 @@ class Voice {
   // Move this voice to the release stage.
   static void Kill() { TriggerEnvelope(DEAD); }
 
-  static void Audio();
+  static void AudioBlock(AudioSample* buffer);
   static void Control();
 
   // Called whenever a write to the CV analog outputs has to be made.
@@ -95,8 +162,17 @@ class Voice {
   }
   static Envelope* mutable_envelope(uint8_t i) { return &envelope_[i]; }
   static void TriggerEnvelope(uint8_t stage);
+
+  // Rebuilds the list of active routes from the modulation matrix of the
+  // patch. Must be called whenever the modulation matrix is modified.
+  static void CompileModulationRoutes();
+
+  static void UpdateOscillatorAlgorithms();
   
  private:
+  typedef VoiceOscillators<index> Oscillators;
+
+
   // Envelope generators.
   static Envelope envelope_[kNumEnvelopes];
   static uint8_t dead_;
@@ -118,14 +194,31 @@ class Voice {
   static int8_t modulation_destinations_[kNumModulationDestinations];
   
   static uint8_t signal_;
+
+#ifdef HAS_MIX_INTERPOLATION
+  // Mix balance, noise and sub oscillator levels at the end of the previous
+  // block, from which the levels are ramped across the next block.
+  static uint8_t previous_mix_levels_[3];
+#endif  // HAS_MIX_INTERPOLATION
+
+#ifdef HAS_DIGITAL_FILTER
+  static DigitalFilter filter_;
+#endif  // HAS_DIGITAL_FILTER
+
+  // Rows of the modulation matrix with a non-zero amount, in the order of the
+  // matrix. The routes to the additive destinations come first, then the
+  // routes to the VCA, which are multiplicative.
+  static ModulationRoute modulation_routes_[kModulationMatrixSize];
+  static uint8_t num_additive_modulation_routes_;
+  static uint8_t num_modulation_routes_;
   
-  static uint8_t osc1_phase_msb_;
 
   DISALLOW_COPY_AND_ASSIGN(Voice);
 };
 
 class SynthesisEngine : public hardware_midi::MidiDevice {
-  friend class Voice;
+  template<uint8_t index> friend class Voice;
+  friend class RenderCost;
 
  public:
   SynthesisEngine() { }
@@ -138,6 +231,12 @@ class SynthesisEngine : public hardware_midi::MidiDevice {
   // Handled.
   static void ControlChange(uint8_t channel, uint8_t controller, uint8_t value);
   static void PitchBend(uint8_t channel, uint16_t pitch_bend);
+  static void ProgramChange(uint8_t channel, uint8_t program);
+#ifdef HAS_EXTERNAL_EEPROM
+  // Reads the patches of the external library selected by program changes,
+  // in the background. Called from a task.
+  static void LibraryTick();
+#endif  // HAS_EXTERNAL_EEPROM
   static void AllSoundOff(uint8_t channel);
   static void ResetAllControllers(uint8_t channel);
   static void AllNotesOff(uint8_t channel);
@@ -151,12 +250,36 @@ class SynthesisEngine : public hardware_midi::MidiDevice {
   static void SysExByte(uint8_t sysex_byte);
   static void SysExEnd();
   static uint8_t CheckChannel(uint8_t channel);
+#ifdef HAS_POLY_CHAIN
+  // Returns 1 if the message completed by the status byte is a note forwarded
+  // by the poly chain rather than by the thru.
+  static inline uint8_t chained(uint8_t status) {
+    return poly_chain_ && (status & 0xe0) == 0x80 &&
+        CheckChannel(status & 0x0f);
+  }
+#endif  // HAS_POLY_CHAIN
   
-  static void Audio();
   static void Control();
-  
+
+  // Renders kAudioBlockSize samples into buffer. Each oscillator renders its
+  // whole block before the operator and mixer are applied to it.
+  static void AudioBlock(AudioSample* buffer);
+
+  // Called by the voice controller.
+  static void TriggerVoice(
+      uint8_t voice,
+      uint8_t note,
+      uint8_t velocity,
+      uint8_t legato);
+  static void ReleaseVoice(uint8_t voice);
+  static void KillVoice(uint8_t voice);
+
   // Patch manipulation stuff.
   static void SetParameter(uint8_t parameter_index, uint8_t parameter_value);
+  // Same as SetParameter, for the changes made on the front panel, which are
+  // echoed on the MIDI output when the parameter echo is enabled. Changes
+  // received by MIDI are not echoed - the thru already forwards them.
+  static void EditParameter(uint8_t parameter_index, uint8_t parameter_value);
   static inline uint8_t GetParameter(uint8_t parameter_index) {
     const uint8_t* base = &patch_.keep_me_at_the_top;
     return base[parameter_index + 1];
@@ -170,7 +293,23 @@ class SynthesisEngine : public hardware_midi::MidiDevice {
   static void set_cv(uint8_t cv, uint8_t value) {
     modulation_sources_[MOD_SRC_CV_1 + cv] = value;
   }
+#ifdef HAS_MOTION_SEQUENCER
+  // While recording, the first parameter edited on the front panel is
+  // assigned to the automation lane, and its value is recorded at the current
+  // step of the sequencer each time it is edited.
+  static void RecordAutomation(uint8_t parameter_index, uint8_t value);
+  static void set_automation_recording(uint8_t recording) {
+    automation_recording_ = recording;
+  }
+  static void ClearAutomation() {
+    automation_parameter_ = kNoAutomation;
+  }
+#endif  // HAS_MOTION_SEQUENCER
   static uint8_t oscillator_decimation() { return oscillator_decimation_; }
+  // Used by the oscillators when they render a whole block of samples.
+  static void set_oscillator_decimation(uint8_t value) {
+    oscillator_decimation_ = value;
+  }
   static void ResetPatch();
   // Variables dependent on parameters (increments) are recomputed in
   // SetParameter when the related parameter is modified. Sometimes, the patch
@@ -178,10 +317,15 @@ class SynthesisEngine : public hardware_midi::MidiDevice {
   // loading a patch from the EEPROM)... so in this case we need to recompute
   // all the related variables.
   static inline void TouchPatch() {
+    CompileModulationRoutes();
     UpdateModulationIncrements();
     UpdateOscillatorAlgorithms();
     controller_.UpdateArpeggiatorParameters(patch_);
   }
+  // Same as TouchPatch, for a patch loaded while playing: the changes are
+  // applied progressively over the next kPatchTransitionDuration calls to
+  // Control().
+  static void TransitionPatch();
   static inline const Patch& patch() { return patch_; }
   static inline const VoiceController& voice_controller() {
     return controller_;
@@ -191,15 +335,27 @@ class SynthesisEngine : public hardware_midi::MidiDevice {
   }
   static inline Patch* mutable_patch() { return &patch_; }
   
-  // These variables are sent to I/O pins, and are made accessible here.
-  static inline uint8_t modulation_source(uint8_t i, uint8_t j) {
-    if (j < kNumGlobalModulationSources) {
-      return modulation_sources_[j];
-    } else {
-      return voice_[i].modulation_source(j);
-    }
+  // These variables are sent to I/O pins, and are made accessible here. The
+  // VCF and VCA are shared by all voices, and follow the most recently
+  // triggered voice.
+  static uint8_t modulation_source(uint8_t i);
+  static uint8_t modulation_destination(uint8_t i);
+  static inline uint8_t cutoff() {
+    return modulation_destination(MOD_DST_FILTER_CUTOFF);
+  }
+  static inline uint8_t vca() {
+    return modulation_destination(MOD_DST_VCA);
   }
-  static const Voice& voice(uint8_t i) { return voice_[i]; }
+  static inline uint8_t resonance() {
+    return modulation_destination(MOD_DST_FILTER_RESONANCE);
+  }
+  // All the voices are silent.
+  static uint8_t dead();
+#ifdef HAS_LATENCY_PROBE
+  // Incremented each time a voice is triggered.
+  static inline uint8_t num_triggers() { return num_triggers_; }
+#endif  // HAS_LATENCY_PROBE
+
  private:
   // Value of global modulation parameters, scaled to 0-255;
   static uint8_t modulation_sources_[kNumGlobalModulationSources];
@@ -209,19 +365,98 @@ class SynthesisEngine : public hardware_midi::MidiDevice {
   static uint8_t num_lfo_reset_steps_;  // resync the LFO every n-th step.
   static uint8_t lfo_reset_counter_;
   static uint8_t lfo_to_reset_;
-  static Voice voice_[kNumVoices];
+#ifdef HAS_MIDI_CLOCK_PLL
+  // Number of steps since the start of the period of each LFO synced to the
+  // tempo.
+  static uint8_t lfo_step_[kNumLfos];
+#endif  // HAS_MIDI_CLOCK_PLL
   static VoiceController controller_;
   static uint8_t oscillator_decimation_;
   static uint8_t nrpn_parameter_number_;
   static uint8_t data_entry_msb_;
   static uint8_t ignore_note_off_messages_;
+#ifdef HAS_POLY_CHAIN
+  static uint8_t poly_chain_;
+  // Note played by this unit in the chain, or kNoChainNote.
+  static uint8_t chain_note_;
+#endif  // HAS_POLY_CHAIN
+#ifdef HAS_PARAMETER_ECHO
+  static uint8_t parameter_echo_;
+#endif  // HAS_PARAMETER_ECHO
+#ifdef HAS_EXTERNAL_EEPROM
+  // Bank 0 is the internal EEPROM, bank n the n-th group of 128 slots of the
+  // external library.
+  static uint8_t bank_;
+  // Slot to read by LibraryTick(), or kNoLibrarySlot.
+  static uint16_t requested_library_slot_;
+  static uint8_t library_load_in_progress_;
+#endif  // HAS_EXTERNAL_EEPROM
+#ifdef HAS_MOTION_SEQUENCER
+  // Value of the automated parameter at each step. The parameters which are
+  // read from the patch at each control tick, and need no recomputation, are
+  // ramped from one step to the next; the others change on each step.
+  static uint8_t automation_lane_[kNumSteps];
+  static uint8_t automation_parameter_;
+  static uint8_t automation_recording_;
+  static uint8_t automation_ramp_;
+  // Value in 8.8 fixed point, and increment per control tick, of the ramp.
+  static uint16_t automation_value_;
+  static int16_t automation_increment_;
+  // Control ticks since the last step, and duration of the previous step.
+  static uint16_t automation_ticks_;
+  static uint16_t automation_step_duration_;
+
+  static void UpdateAutomation(uint8_t new_step);
+#endif  // HAS_MOTION_SEQUENCER
 
-  // Called whenever a parameter related to LFOs/envelopes is modified (for now
-  // everytime a parameter is modified by the user).
+  // Parameter changes received by MIDI, applied at the next call to Control().
+  // Successive changes of the same parameter are coalesced.
+  static ParameterChange parameter_change_queue_[kParameterChangeQueueSize];
+  static uint8_t num_queued_parameter_changes_;
+
+  static void QueueParameterChange(uint8_t index, uint8_t value);
+  static void ApplyQueuedParameterChanges();
+
+  // Bitmask of DirtyModulation flags. The recomputation of the LFO and
+  // envelope increments is deferred to the next call to Control() - or to the
+  // next note, whichever comes first.
+  static uint8_t dirty_modulations_;
+
+#ifdef HAS_LATENCY_PROBE
+  static uint8_t num_triggers_;
+#endif  // HAS_LATENCY_PROBE
+
+#ifdef HAS_PATCH_TRANSITION
+  // Number of control ticks until the end of the patch transition, 0 if there
+  // is none in progress. The new patch is "touched" half-way, when the VCA is
+  // closed.
+  static uint8_t patch_transition_;
+
+  static inline uint8_t patch_transition_gain() {
+    int8_t distance = patch_transition_ - kPatchTransitionDuration / 2;
+    if (distance < 0) {
+      distance = -distance;
+    }
+    return distance * (512 / kPatchTransitionDuration);
+  }
+#endif  // HAS_PATCH_TRANSITION
+
+  // Recomputes everything related to LFOs/envelopes. Called when the whole
+  // patch is modified.
   static void UpdateModulationIncrements();
+
+  // Recomputes only the LFOs/envelope stages marked as dirty.
+  static void UpdateDirtyModulations();
   
   // Called whenever a parameter related to oscillators is called.
   static void UpdateOscillatorAlgorithms();
+
+  // Called whenever the modulation matrix is modified.
+  static void CompileModulationRoutes();
+  
+  // Converts a pitch, in 1/128th of semitones, into an oscillator phase
+  // increment, and writes in midi_note the corresponding note.
+  static uint16_t PitchToIncrement(int16_t pitch, uint8_t* midi_note);
   
   DISALLOW_COPY_AND_ASSIGN(SynthesisEngine);
 };
@@ -0,0 +1,44 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Trace of timestamped events.
+
+#include "hardware/shruti/trace.h"
+
+#ifdef HAS_TRACE
+
+#include <string.h>
+
+namespace hardware_shruti {
+
+/* <static> */
+TraceRecord Trace::records_[kNumTraceRecords];
+uint8_t Trace::write_ptr_;
+volatile uint16_t Trace::time_;
+uint8_t Trace::frozen_;
+/* </static> */
+
+/* static */
+void Trace::Init() {
+  memset(records_, 0, sizeof(records_));
+  write_ptr_ = 0;
+  frozen_ = 0;
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_TRACE
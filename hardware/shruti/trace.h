@@ -0,0 +1,105 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Trace of timestamped events, written from the hot paths of the firmware and
+// sent as a SysEx message on request.
+//
+// Each record is an event id, an argument and the time in samples - 32us, so
+// that the timestamps wrap every 2.1s - read from a counter advanced by the
+// audio interrupt. Writing a record only takes a few instructions, with the
+// interrupts disabled to keep the records whole, so the trace does not hide
+// the timing issues it is meant to show. Only the last kNumTraceRecords events
+// are kept.
+
+#ifndef HARDWARE_SHRUTI_TRACE_H_
+#define HARDWARE_SHRUTI_TRACE_H_
+
+#include "hardware/shruti/shruti.h"
+
+#ifdef HAS_TRACE
+
+#include <avr/interrupt.h>
+
+namespace hardware_shruti {
+
+// Must be a power of 2.
+static const uint8_t kNumTraceRecords = 32;
+
+enum TraceEvent {
+  // The argument is the status byte of the message.
+  TRACE_MIDI_MESSAGE = 1,
+  // The argument is the note.
+  TRACE_VOICE_TRIGGER,
+  // The argument is the number of samples in the buffer, once the block has
+  // been committed.
+  TRACE_BLOCK_RENDERED,
+  // Recorded for the first sample of a burst of underruns.
+  TRACE_UNDERRUN,
+};
+
+// Dumped as is (little endian) by the trace SysEx message.
+typedef struct {
+  uint8_t event;
+  uint8_t argument;
+  uint16_t time;
+} TraceRecord;
+
+class Trace {
+ public:
+  Trace() { }
+
+  static void Init();
+
+  // Called by the audio interrupt, for each sample.
+  static inline void Tick() { ++time_; }
+
+  static inline void Write(uint8_t event, uint8_t argument) {
+    uint8_t sreg = SREG;
+    cli();
+    if (!frozen_) {
+      TraceRecord* record = &records_[write_ptr_];
+      record->event = event;
+      record->argument = argument;
+      record->time = time_;
+      write_ptr_ = (write_ptr_ + 1) & (kNumTraceRecords - 1);
+    }
+    SREG = sreg;
+  }
+
+  // The records are not written while the trace is being sent.
+  static inline void Freeze() { frozen_ = 1; }
+  static inline void Unfreeze() { frozen_ = 0; }
+
+  static inline const TraceRecord* records() { return records_; }
+  static inline uint8_t size() { return sizeof(records_); }
+  // Index of the oldest record.
+  static inline uint8_t write_ptr() { return write_ptr_; }
+
+ private:
+  static TraceRecord records_[kNumTraceRecords];
+  static uint8_t write_ptr_;
+  static volatile uint16_t time_;
+  static uint8_t frozen_;
+
+  DISALLOW_COPY_AND_ASSIGN(Trace);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_TRACE
+
+#endif  // HARDWARE_SHRUTI_TRACE_H_
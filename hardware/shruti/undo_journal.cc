@@ -0,0 +1,97 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Undo/redo journal of the parameters edited on the front panel.
+
+#include "hardware/shruti/undo_journal.h"
+
+#ifdef HAS_UNDO_JOURNAL
+
+#include "hardware/shruti/synthesis_engine.h"
+
+namespace hardware_shruti {
+
+static const uint8_t kUndoJournalMask = kUndoJournalSize - 1;
+
+/* <static> */
+UndoJournalEntry UndoJournal::entries_[kUndoJournalSize];
+uint8_t UndoJournal::write_ptr_;
+uint8_t UndoJournal::num_undos_;
+uint8_t UndoJournal::num_redos_;
+/* </static> */
+
+/* static */
+void UndoJournal::Clear() {
+  num_undos_ = 0;
+  num_redos_ = 0;
+}
+
+/* static */
+void UndoJournal::Record(uint8_t parameter_index, uint8_t old_value) {
+  // The parameter is still being moved: the oldest value is kept.
+  if (num_undos_ && !num_redos_ && entries_[
+          (write_ptr_ - 1) & kUndoJournalMask].parameter_index ==
+      parameter_index) {
+    return;
+  }
+  entries_[write_ptr_].parameter_index = parameter_index;
+  entries_[write_ptr_].value = old_value;
+  write_ptr_ = (write_ptr_ + 1) & kUndoJournalMask;
+  // Once the journal is full, the oldest edit is overwritten.
+  if (num_undos_ < kUndoJournalSize) {
+    ++num_undos_;
+  }
+  // A new edit makes the undone edits impossible to redo.
+  num_redos_ = 0;
+}
+
+/* static */
+void UndoJournal::Swap(uint8_t index) {
+  UndoJournalEntry* entry = &entries_[index];
+  uint8_t value = engine.GetParameter(entry->parameter_index);
+  engine.SetParameter(entry->parameter_index, entry->value);
+  entry->value = value;
+}
+
+/* static */
+uint8_t UndoJournal::Undo() {
+  if (!num_undos_) {
+    return 0;
+  }
+  write_ptr_ = (write_ptr_ - 1) & kUndoJournalMask;
+  --num_undos_;
+  ++num_redos_;
+  Swap(write_ptr_);
+  return 1;
+}
+
+/* static */
+uint8_t UndoJournal::Redo() {
+  if (!num_redos_) {
+    return 0;
+  }
+  uint8_t index = write_ptr_;
+  write_ptr_ = (write_ptr_ + 1) & kUndoJournalMask;
+  --num_redos_;
+  ++num_undos_;
+  Swap(index);
+  return 1;
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_UNDO_JOURNAL
@@ -0,0 +1,73 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Undo/redo journal of the parameters edited on the front panel.
+//
+// Instead of snapshots of the patch, the journal records, for each edit, the
+// index of the parameter and its previous value. An undo swaps the recorded
+// value with the current one, so that the same entry redoes the edit. The
+// consecutive moves of the same parameter - a knob being turned - are recorded
+// as a single edit. The journal is cleared when a new patch is loaded, since
+// its entries are meaningless for another patch.
+
+#ifndef HARDWARE_SHRUTI_UNDO_JOURNAL_H_
+#define HARDWARE_SHRUTI_UNDO_JOURNAL_H_
+
+#include "hardware/shruti/shruti.h"
+
+#ifdef HAS_UNDO_JOURNAL
+
+namespace hardware_shruti {
+
+// Must be a power of 2. 32 edits take the same RAM as a serialized patch.
+static const uint8_t kUndoJournalSize = 32;
+
+struct UndoJournalEntry {
+  uint8_t parameter_index;
+  uint8_t value;
+};
+
+class UndoJournal {
+ public:
+  UndoJournal() { }
+
+  static void Clear();
+
+  // Called before a parameter edited on the front panel is modified.
+  static void Record(uint8_t parameter_index, uint8_t old_value);
+
+  // Both return 0 if there was nothing to undo/redo.
+  static uint8_t Undo();
+  static uint8_t Redo();
+
+ private:
+  static void Swap(uint8_t index);
+
+  static UndoJournalEntry entries_[kUndoJournalSize];
+  // Position of the next edit to be recorded.
+  static uint8_t write_ptr_;
+  static uint8_t num_undos_;
+  static uint8_t num_redos_;
+
+  DISALLOW_COPY_AND_ASSIGN(UndoJournal);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_UNDO_JOURNAL
+
+#endif  // HARDWARE_SHRUTI_UNDO_JOURNAL_H_
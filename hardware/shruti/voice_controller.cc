@@ -18,6 +18,7 @@
 // Voice manager / arpeggiator.
 
 #include "hardware/shruti/voice_controller.h"
+#include "hardware/shruti/midi_out.h"
 #include "hardware/shruti/patch.h"
 #include "hardware/shruti/resources.h"
 #include "hardware/shruti/synthesis_engine.h"
@@ -36,6 +37,20 @@ static const prog_uint8_t midi_clock_scale[5] PROGMEM = {
 /* <static> */
 int16_t VoiceController::internal_clock_counter_;
 int8_t VoiceController::midi_clock_counter_;
+#ifdef HAS_MIDI_CLOCK_PLL
+uint16_t VoiceController::clock_time_;
+uint16_t VoiceController::last_tick_time_;
+uint16_t VoiceController::tick_period_;
+int16_t VoiceController::pll_counter_;
+int8_t VoiceController::pll_lead_;
+uint8_t VoiceController::pll_state_;
+uint8_t VoiceController::tempo_changed_;
+#endif  // HAS_MIDI_CLOCK_PLL
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+uint8_t VoiceController::sync_delay_;
+uint8_t VoiceController::pending_tick_delay_[kMaxPendingTicks];
+uint8_t VoiceController::num_pending_ticks_;
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
 uint8_t VoiceController::midi_clock_prescaler_;
 int16_t VoiceController::step_duration_[kNumSteps];
 int16_t VoiceController::average_step_duration_;
@@ -49,10 +64,19 @@ int8_t VoiceController::direction_;
 int8_t VoiceController::octave_step_;
 int8_t VoiceController::octaves_;
 uint8_t VoiceController::mode_;
+#ifdef HAS_ARPEGGIO_PROGRAM
+uint8_t VoiceController::arpeggio_program_[kMaxArpeggioProgramSize];
+uint8_t VoiceController::arpeggio_program_size_;
+uint8_t VoiceController::arpeggio_program_step_;
+#endif  // HAS_ARPEGGIO_PROGRAM
 
 NoteStack VoiceController::notes_;
-Voice* VoiceController::voices_;
-uint8_t VoiceController::num_voices_;
+uint8_t VoiceController::voice_note_[kNumVoices];
+uint8_t VoiceController::voice_age_[kNumVoices];
+uint8_t VoiceController::most_recent_voice_;
+#ifdef HAS_MIDI_MERGE
+uint8_t VoiceController::arpeggio_out_note_;
+#endif  // HAS_MIDI_MERGE
   
 uint8_t VoiceController::pattern_size_;
 uint8_t VoiceController::active_;
@@ -64,10 +88,17 @@ uint16_t VoiceController::estimated_beat_duration_;
 /* </static> */
 
 /* static */
-void VoiceController::Init(Voice* voices, uint8_t num_voices) {
-  voices_ = voices;
-  num_voices_ = num_voices;
+void VoiceController::Init() {
   notes_.Clear();
+  InvalidateArpeggioProgram();
+  for (uint8_t i = 0; i < kNumVoices; ++i) {
+    voice_note_[i] = kNoVoiceNote;
+    voice_age_[i] = 0;
+  }
+  most_recent_voice_ = 0;
+#ifdef HAS_MIDI_MERGE
+  arpeggio_out_note_ = kNoVoiceNote;
+#endif  // HAS_MIDI_MERGE
   step_duration_[0] = step_duration_[1] = (kSampleRate * 60L / 4) / 120;
   octaves_ = 0;
   pattern_size_ = 16;
@@ -89,24 +120,38 @@ void VoiceController::Reset() {
   // stopped".
   if (!active_) {
     if (midi_clock_prescaler_ == 0) {
-      estimated_beat_duration_ = step_duration_[0] / (kControlRate / 4);
+      set_estimated_beat_duration(step_duration_[0] / (kControlRate / 4));
     }
     pattern_mask_ = 255;
     internal_clock_counter_ = 0;
     midi_clock_counter_ = 0;
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+    num_pending_ticks_ = 0;
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
+#ifdef HAS_MIDI_CLOCK_PLL
+    pll_state_ = PLL_WAITING_FIRST_TICK;
+#endif  // HAS_MIDI_CLOCK_PLL
     step_duration_estimator_num_ = 0xffff;
     step_duration_estimator_den_ = 0xff;
     pattern_step_ = pattern_size_ - 1;
     direction_ = mode_ == ARPEGGIO_DIRECTION_DOWN ? -1 : 1; 
     ArpeggioStart();
+#ifdef HAS_ARPEGGIO_PROGRAM
+    arpeggio_program_step_ = 0;
+#endif  // HAS_ARPEGGIO_PROGRAM
   }
 }
 
 /* static */
 void VoiceController::AllSoundOff() {
   notes_.Clear();
-  for (uint8_t i = 0; i < num_voices_; ++i) {
-    voices_[i].Kill();
+  InvalidateArpeggioProgram();
+#ifdef HAS_MIDI_MERGE
+  SendArpeggioNote(kNoVoiceNote, 0);
+#endif  // HAS_MIDI_MERGE
+  for (uint8_t i = 0; i < kNumVoices; ++i) {
+    engine.KillVoice(i);
+    voice_note_[i] = kNoVoiceNote;
   }
   active_ = 0;
 }
@@ -114,8 +159,13 @@ void VoiceController::AllSoundOff() {
 /* static */
 void VoiceController::AllNotesOff() {
   notes_.Clear();
-  for (uint8_t i = 0; i < num_voices_; ++i) {
-    voices_[i].Release();
+  InvalidateArpeggioProgram();
+#ifdef HAS_MIDI_MERGE
+  SendArpeggioNote(kNoVoiceNote, 0);
+#endif  // HAS_MIDI_MERGE
+  for (uint8_t i = 0; i < kNumVoices; ++i) {
+    engine.ReleaseVoice(i);
+    voice_note_[i] = kNoVoiceNote;
   }
 }
 
@@ -127,6 +177,7 @@ void VoiceController::UpdateArpeggiatorParameters(const Patch& patch) {
   direction_ = mode_ == ARPEGGIO_DIRECTION_DOWN ? -1 : 1;
   octaves_ = patch.arp_octave;
   pattern_size_ = patch.pattern_size;
+  InvalidateArpeggioProgram();
   if (patch.arp_tempo < 40) {
     midi_clock_prescaler_ = ResourcesManager::Lookup<uint8_t, uint8_t>(
         midi_clock_scale, patch.arp_tempo - 35);
@@ -148,7 +199,7 @@ void VoiceController::UpdateArpeggiatorParameters(const Patch& patch) {
     int16_t swing = swing_direction >> 17;
     step_duration_[i] = average_step_duration_ + swing;
   }
-  estimated_beat_duration_ = average_step_duration_ / (kControlRate / 4);
+  set_estimated_beat_duration(average_step_duration_ / (kControlRate / 4));
 }
 
 /* static */
@@ -157,12 +208,17 @@ void VoiceController::NoteOn(uint8_t note, uint8_t velocity) {
     NoteOff(note);
   } else {
     notes_.NoteOn(note, velocity);
+    InvalidateArpeggioProgram();
     // In case we haven't played something for a while, reset all the
     // sequencer/arpeggiator stuff.
     Start();
     // Trigger the note.
     if (octaves_ == 0) {
-      voices_[0].Trigger(note, velocity, notes_.size() > 1);
+      if (kNumVoices == 1) {
+        TriggerVoice(0, note, velocity, notes_.size() > 1);
+      } else {
+        TriggerVoice(AllocateVoice(note), note, velocity, 0);
+      }
     }
   }
 }
@@ -172,17 +228,33 @@ void VoiceController::NoteOff(uint8_t note) {
   // Get the currently playing note.
   uint8_t top_note = notes_.most_recent_note().note;
   notes_.NoteOff(note);
+  InvalidateArpeggioProgram();
+
+  if (kNumVoices > 1 && octaves_ == 0) {
+    // Release the voice(s) playing this note.
+    for (uint8_t i = 0; i < kNumVoices; ++i) {
+      if (voice_note_[i] == note) {
+        engine.ReleaseVoice(i);
+        voice_note_[i] = kNoVoiceNote;
+      }
+    }
+    return;
+  }
 
   // If no note is remaining, play the release phase of the envelope.
   if (notes_.size() == 0) {
-    voices_[0].Release();
+    engine.ReleaseVoice(0);
+    voice_note_[0] = kNoVoiceNote;
+#ifdef HAS_MIDI_MERGE
+    SendArpeggioNote(kNoVoiceNote, 0);
+#endif  // HAS_MIDI_MERGE
   } else {
     // Otherwise retrigger the previously played note, or let the arpeggiator
     // do it. No need to retrigger if we just removed notes different from
     // the one currently played.
     if (octaves_ == 0) {
       if (top_note == note) {
-        voices_[0].Trigger(notes_.most_recent_note().note, 0, true);
+        TriggerVoice(0, notes_.most_recent_note().note, 0, true);
       }
     }
   }
@@ -192,6 +264,36 @@ void VoiceController::NoteOff(uint8_t note) {
 uint8_t VoiceController::Control() {
   ++step_duration_estimator_num_;
   internal_clock_counter_ -= kControlRate;
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+  // Apply the MIDI clock ticks falling within this block.
+  uint8_t num_pending_ticks = 0;
+  for (uint8_t i = 0; i < num_pending_ticks_; ++i) {
+    uint8_t delay = pending_tick_delay_[i];
+    if (delay < kControlRate) {
+      ReceiveTick(delay);
+    } else {
+      pending_tick_delay_[num_pending_ticks++] = delay - kControlRate;
+    }
+  }
+  num_pending_ticks_ = num_pending_ticks;
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
+#ifdef HAS_MIDI_CLOCK_PLL
+  if (midi_clock_prescaler_ && pll_state_ == PLL_LOCKED) {
+    // Emit the ticks of the loop falling within this block.
+    const int16_t block_duration = kControlRate << kPllFractionalBits;
+    while (pll_counter_ < block_duration && pll_lead_ < kMaxPllLead) {
+      --midi_clock_counter_;
+      ++pll_lead_;
+      pll_counter_ += tick_period_;
+    }
+    pll_counter_ -= block_duration;
+    // Only when the loop is waiting for the MIDI clock.
+    if (pll_counter_ < 0) {
+      pll_counter_ = 0;
+    }
+  }
+  clock_time_ += kControlRate;
+#endif  // HAS_MIDI_CLOCK_PLL
   if ((!midi_clock_prescaler_ && internal_clock_counter_ > 0) ||
       (midi_clock_prescaler_ && midi_clock_counter_ > 0)) {
     return 0;
@@ -220,11 +322,13 @@ uint8_t VoiceController::Control() {
   } else {
     midi_clock_counter_ += midi_clock_prescaler_;
   }
+#ifndef HAS_MIDI_CLOCK_PLL
   if (step_duration_estimator_den_ == 4) {
     estimated_beat_duration_ = step_duration_estimator_num_;
     step_duration_estimator_den_ = 0;
     step_duration_estimator_num_ = 0;
   }
+#endif  // HAS_MIDI_CLOCK_PLL
 
   if (notes_.size() == 0 || octaves_ == 0) {
     return 1;
@@ -237,6 +341,68 @@ uint8_t VoiceController::Control() {
   return 2;
 }
 
+#ifdef HAS_MIDI_CLOCK_PLL
+/* static */
+void VoiceController::ReceiveTick(uint8_t offset) {
+  uint16_t now = clock_time_ + offset;
+  uint16_t interval = now - last_tick_time_;
+  last_tick_time_ = now;
+  int16_t position = static_cast<int16_t>(offset) << kPllFractionalBits;
+  
+  if (pll_state_ == PLL_LOCKED) {
+    --pll_lead_;
+    if (interval <= kMaxTickPeriod && (pll_lead_ == 0 || pll_lead_ == -1)) {
+      // Phase error, positive when the tick of the loop matching this one is
+      // still to come.
+      int16_t error = pll_counter_ - position;
+      if (pll_lead_ == 0) {
+        error -= tick_period_;
+      }
+      pll_counter_ -= error >> 2;
+      tick_period_ -= error >> 5;
+      if (tick_period_ < (kMinTickPeriod << kPllFractionalBits)) {
+        tick_period_ = kMinTickPeriod << kPllFractionalBits;
+      } else if (tick_period_ > (kMaxTickPeriod << kPllFractionalBits)) {
+        tick_period_ = kMaxTickPeriod << kPllFractionalBits;
+      }
+    } else {
+      // The clock has stopped or jumped. Catch up with the ticks the loop has
+      // missed, and restart in phase with this one.
+      if (pll_lead_ < 0) {
+        midi_clock_counter_ += pll_lead_;
+      }
+      pll_lead_ = 0;
+      pll_counter_ = position + tick_period_;
+    }
+  } else {
+    --midi_clock_counter_;
+    if (pll_state_ == PLL_WAITING_FIRST_TICK) {
+      pll_state_ = PLL_WAITING_SECOND_TICK;
+    } else if (interval >= kMinTickPeriod && interval <= kMaxTickPeriod) {
+      tick_period_ = interval << kPllFractionalBits;
+      pll_counter_ = position + tick_period_;
+      pll_lead_ = 0;
+      pll_state_ = PLL_LOCKED;
+    }
+  }
+  
+  // The duration of a beat - 4 steps - in control ticks.
+  if (pll_state_ == PLL_LOCKED && midi_clock_prescaler_) {
+    set_estimated_beat_duration(
+        static_cast<uint32_t>(tick_period_) * midi_clock_prescaler_ /
+        ((kControlRate << kPllFractionalBits) / 4));
+  }
+}
+
+/* static */
+void VoiceController::set_estimated_beat_duration(uint16_t duration) {
+  if (duration != estimated_beat_duration_) {
+    estimated_beat_duration_ = duration;
+    tempo_changed_ = 1;
+  }
+}
+#endif  // HAS_MIDI_CLOCK_PLL
+
 /* static */
 void VoiceController::ArpeggioStart() {
   if (direction_ == 1) {
@@ -276,8 +442,69 @@ void VoiceController::ArpeggioStep() {
   }
 }
 
+#ifdef HAS_ARPEGGIO_PROGRAM
+/* static */
+void VoiceController::CompileArpeggioProgram() {
+  uint8_t size = 0;
+  if (mode_ == ARPEGGIO_DIRECTION_RANDOM) {
+    for (uint8_t octave = 0; octave < octaves_; ++octave) {
+      for (uint8_t i = 0; i < notes_.size(); ++i) {
+        arpeggio_program_[size++] = (i << 4) | octave;
+      }
+    }
+    arpeggio_program_size_ = size;
+    ShuffleArpeggioProgram();
+  } else {
+    // Run the arpeggiator from its initial state until it is back to the
+    // state reached after the first step.
+    direction_ = mode_ == ARPEGGIO_DIRECTION_DOWN ? -1 : 1;
+    ArpeggioStart();
+    int8_t first_direction = 0;
+    while (size < kMaxArpeggioProgramSize) {
+      ArpeggioStep();
+      uint8_t entry = (arpeggio_step_ << 4) | octave_step_;
+      if (size == 0) {
+        first_direction = direction_;
+      } else if (entry == arpeggio_program_[0] &&
+                 direction_ == first_direction) {
+        break;
+      }
+      arpeggio_program_[size++] = entry;
+    }
+    arpeggio_program_size_ = size;
+  }
+}
+
+/* static */
+void VoiceController::ShuffleArpeggioProgram() {
+  for (uint8_t i = arpeggio_program_size_ - 1; i > 0; --i) {
+    uint8_t j = Random::GetByte();
+    while (j > i) {
+      j -= i + 1;
+    }
+    uint8_t swap = arpeggio_program_[i];
+    arpeggio_program_[i] = arpeggio_program_[j];
+    arpeggio_program_[j] = swap;
+  }
+}
+#endif  // HAS_ARPEGGIO_PROGRAM
+
 /* static */
 void VoiceController::Step() {
+#ifdef HAS_ARPEGGIO_PROGRAM
+  if (!arpeggio_program_size_) {
+    CompileArpeggioProgram();
+  }
+  if (arpeggio_program_step_ >= arpeggio_program_size_) {
+    arpeggio_program_step_ = 0;
+    if (mode_ == ARPEGGIO_DIRECTION_RANDOM) {
+      ShuffleArpeggioProgram();
+    }
+  }
+  uint8_t entry = arpeggio_program_[arpeggio_program_step_++];
+  arpeggio_step_ = entry >> 4;
+  octave_step_ = entry & 0x0f;
+#else
   uint8_t num_notes = notes_.size();
   if (mode_ == ARPEGGIO_DIRECTION_RANDOM) {
     uint8_t random_byte = Random::state_msb();
@@ -292,12 +519,80 @@ void VoiceController::Step() {
   } else {
     ArpeggioStep();
   }
+#endif  // HAS_ARPEGGIO_PROGRAM
   uint8_t note = notes_.sorted_note(arpeggio_step_).note;
   note += 12 * octave_step_;
   while (note > 127) {
     note -= 12;
   }
-  voices_[0].Trigger(note, notes_.sorted_note(arpeggio_step_).velocity, false);
-}    
+  uint8_t velocity = notes_.sorted_note(arpeggio_step_).velocity;
+  TriggerVoice(0, note, velocity, false);
+#ifdef HAS_MIDI_MERGE
+  SendArpeggioNote(note, velocity);
+#endif  // HAS_MIDI_MERGE
+}
+
+#ifdef HAS_MIDI_MERGE
+/* static */
+void VoiceController::SendArpeggioNote(uint8_t note, uint8_t velocity) {
+  // The notes are sent on the reception channel - or on channel 1 in omni
+  // mode.
+  uint8_t channel = engine.patch().kbd_midi_channel;
+  while (channel >= 17) {
+    channel -= 17;
+  }
+  if (channel) {
+    --channel;
+  }
+  if (arpeggio_out_note_ != kNoVoiceNote) {
+    MidiThru::Send(0x80 | channel, arpeggio_out_note_, 0);
+  }
+  if (note != kNoVoiceNote) {
+    MidiThru::Send(0x90 | channel, note, velocity);
+  }
+  arpeggio_out_note_ = note;
+}
+#endif  // HAS_MIDI_MERGE
+
+/* static */
+uint8_t VoiceController::AllocateVoice(uint8_t note) {
+  // Reuse the voice already playing this note, if any. Otherwise, pick the
+  // least recently triggered voice, giving priority to released voices.
+  uint8_t best_voice = 0;
+  uint8_t best_score = 0;
+  for (uint8_t i = 0; i < kNumVoices; ++i) {
+    if (voice_note_[i] == note) {
+      return i;
+    }
+    uint8_t score = voice_age_[i];
+    if (voice_note_[i] == kNoVoiceNote) {
+      score |= 0x80;
+    }
+    if (score > best_score) {
+      best_voice = i;
+      best_score = score;
+    }
+  }
+  return best_voice;
+}
+
+/* static */
+void VoiceController::TriggerVoice(
+    uint8_t voice,
+    uint8_t note,
+    uint8_t velocity,
+    uint8_t legato) {
+  if (kNumVoices > 1) {
+    for (uint8_t i = 0; i < kNumVoices; ++i) {
+      if (voice_age_[i] < 127) {
+        ++voice_age_[i];
+      }
+    }
+    voice_age_[voice] = 0;
+    voice_note_[voice] = note;
+    most_recent_voice_ = voice;
+  }
+  engine.TriggerVoice(voice, note, velocity, legato);
+}
 
 }  // namespace hardware_shruti
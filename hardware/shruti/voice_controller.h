@@ -18,9 +18,10 @@
 // Voice manager / arpeggiator.
 //
 // Routes note messages to a pool of voices, and handles arpeggiation.
-// For now, used in monophonic mode only, but it should be fairly easy to use
-// the NoteStack instance contained in this class to handle voice stealing for
-// a polyphonic synth.
+// With a single voice, the most recently played note has priority and notes
+// played legato do not retrigger the envelopes. With several voices, each new
+// note is allocated to a released voice - or steals the least recently
+// triggered one. The arpeggiator always plays on the first voice.
 //
 // Two instances of this guy will be needed for multitimbrality. Since there is
 // no plan to support multitimbrality, this class is implemented as a "static
@@ -45,13 +46,39 @@ enum ArpeggioDirection {
   ARPEGGIO_DIRECTION_RANDOM,
 };
 
+// Stored in voice_note_ for the voices in their release stage.
+static const uint8_t kNoVoiceNote = 0xff;
+
+#ifdef HAS_ARPEGGIO_PROGRAM
+// Long enough for an up/down cycle over 16 notes and 4 octaves.
+static const uint8_t kMaxArpeggioProgramSize = 128;
+#endif  // HAS_ARPEGGIO_PROGRAM
+
+// At 300 BPM, MIDI clock ticks are 8ms apart, so no more than one is pending
+// at once in normal operation.
+static const uint8_t kMaxPendingTicks = 4;
+
+#ifdef HAS_MIDI_CLOCK_PLL
+static const uint8_t kPllFractionalBits = 3;
+// MIDI clock periods, in samples, at 300 and 30 BPM.
+static const uint16_t kMinTickPeriod = kSampleRate * 60L / 24 / 300;
+static const uint16_t kMaxTickPeriod = kSampleRate * 60L / 24 / 30;
+// The loop keeps running for 2 ticks after the MIDI clock has stopped.
+static const int8_t kMaxPllLead = 2;
+
+enum PllState {
+  PLL_WAITING_FIRST_TICK,
+  PLL_WAITING_SECOND_TICK,
+  PLL_LOCKED
+};
+#endif  // HAS_MIDI_CLOCK_PLL
+
 class Patch;
-class Voice;
 
 class VoiceController {
  public:
   VoiceController() { }
-  static void Init(Voice* voices, uint8_t num_voices_);
+  static void Init();
   static void AllNotesOff();
   static void AllSoundOff();
   static void Reset();
@@ -59,7 +86,36 @@ class VoiceController {
   static void NoteOn(uint8_t note, uint8_t velocity);
   static void NoteOff(uint8_t note);
   static void UpdateArpeggiatorParameters(const Patch&);
-  static inline void ExternalSync() { --midi_clock_counter_; }
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+  // Number of samples, from the start of the next rendered block, at which
+  // the MIDI clock ticks received from now on are played.
+  static inline void set_sync_delay(uint8_t delay) { sync_delay_ = delay; }
+  static inline void ExternalSync() {
+    if (num_pending_ticks_ == kMaxPendingTicks) {
+      ReceiveTick(0);
+    } else {
+      pending_tick_delay_[num_pending_ticks_++] = sync_delay_;
+    }
+  }
+  // Advances the internal clock by samples which have not been rendered.
+  static inline void Skip(uint8_t num_samples) {
+    internal_clock_counter_ -= num_samples;
+#ifdef HAS_MIDI_CLOCK_PLL
+    clock_time_ += num_samples;
+    pll_counter_ -= static_cast<int16_t>(num_samples) << kPllFractionalBits;
+#endif  // HAS_MIDI_CLOCK_PLL
+  }
+#else
+  static inline void ExternalSync() { ReceiveTick(0); }
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
+#ifdef HAS_MIDI_CLOCK_PLL
+  // Returns 1, once, after the estimated tempo has changed.
+  static inline uint8_t tempo_changed() {
+    uint8_t changed = tempo_changed_;
+    tempo_changed_ = 0;
+    return changed;
+  }
+#endif  // HAS_MIDI_CLOCK_PLL
   static inline uint8_t step() { return pattern_step_; }
   static inline uint8_t active() { return active_; }
   static inline uint16_t has_arpeggiator_note() {
@@ -70,9 +126,13 @@ class VoiceController {
   static uint16_t estimated_beat_duration() {
     return estimated_beat_duration_;
   }
+  static inline uint8_t most_recent_voice() { return most_recent_voice_; }
   // (for external sync).
   static void Stop() {
     active_ = 0;
+#ifdef HAS_MIDI_MERGE
+    SendArpeggioNote(kNoVoiceNote, 0);
+#endif  // HAS_MIDI_MERGE
   }
   static void Start() {
     Reset();
@@ -82,9 +142,60 @@ class VoiceController {
  private:
   static void ArpeggioStep();
   static void ArpeggioStart();
+#ifdef HAS_ARPEGGIO_PROGRAM
+  static void CompileArpeggioProgram();
+  static void ShuffleArpeggioProgram();
+#endif  // HAS_ARPEGGIO_PROGRAM
+  // Called whenever the held notes or the arpeggiator settings change.
+  static inline void InvalidateArpeggioProgram() {
+#ifdef HAS_ARPEGGIO_PROGRAM
+    arpeggio_program_size_ = 0;
+#endif  // HAS_ARPEGGIO_PROGRAM
+  }
+  static uint8_t AllocateVoice(uint8_t note);
+#ifdef HAS_MIDI_MERGE
+  // Sends the note off of the last arpeggiator note to the MIDI output, and
+  // the note on of a new one - if it is not kNoVoiceNote.
+  static void SendArpeggioNote(uint8_t note, uint8_t velocity);
+#endif  // HAS_MIDI_MERGE
+#ifdef HAS_MIDI_CLOCK_PLL
+  // A MIDI clock tick received offset samples after the start of the block.
+  static void ReceiveTick(uint8_t offset);
+  static void set_estimated_beat_duration(uint16_t duration);
+#else
+  static inline void ReceiveTick(uint8_t offset) { --midi_clock_counter_; }
+  static inline void set_estimated_beat_duration(uint16_t duration) {
+    estimated_beat_duration_ = duration;
+  }
+#endif  // HAS_MIDI_CLOCK_PLL
+  static void TriggerVoice(
+      uint8_t voice,
+      uint8_t note,
+      uint8_t velocity,
+      uint8_t legato);
 
   static int16_t internal_clock_counter_;
   static int8_t midi_clock_counter_;
+#ifdef HAS_MIDI_CLOCK_PLL
+  // With an external clock, the steps are advanced by the ticks of a phase
+  // locked loop following the MIDI clock, rather than by the MIDI clock
+  // itself. The times are in samples, and the period and phase of the loop in
+  // 1/8th of sample.
+  static uint16_t clock_time_;
+  static uint16_t last_tick_time_;
+  static uint16_t tick_period_;
+  // Time of the next tick of the loop, from the start of the current block.
+  static int16_t pll_counter_;
+  // Number of ticks of the loop minus number of ticks received.
+  static int8_t pll_lead_;
+  static uint8_t pll_state_;
+  static uint8_t tempo_changed_;
+#endif  // HAS_MIDI_CLOCK_PLL
+#ifdef HAS_SAMPLE_LOCKED_CLOCK
+  static uint8_t sync_delay_;
+  static uint8_t pending_tick_delay_[kMaxPendingTicks];
+  static uint8_t num_pending_ticks_;
+#endif  // HAS_SAMPLE_LOCKED_CLOCK
   static uint8_t midi_clock_prescaler_;
   static int16_t average_step_duration_;
   static int16_t step_duration_[kNumSteps];
@@ -105,10 +216,26 @@ class VoiceController {
   // Number of octaves
   static int8_t octaves_;
   static uint8_t mode_;
+#ifdef HAS_ARPEGGIO_PROGRAM
+  // Each entry stores the index of the note in the sorted note stack in the
+  // upper nibble, and the octave in the lower nibble. A size of 0 means that
+  // the program has to be compiled again.
+  static uint8_t arpeggio_program_[kMaxArpeggioProgramSize];
+  static uint8_t arpeggio_program_size_;
+  static uint8_t arpeggio_program_step_;
+#endif  // HAS_ARPEGGIO_PROGRAM
 
   static NoteStack notes_;
-  static Voice* voices_;
-  static uint8_t num_voices_;
+
+  // Note played by each voice, and number of notes triggered since each voice
+  // was last triggered (saturates at 127).
+  static uint8_t voice_note_[kNumVoices];
+  static uint8_t voice_age_[kNumVoices];
+  static uint8_t most_recent_voice_;
+#ifdef HAS_MIDI_MERGE
+  // Arpeggiator note last sent to the MIDI output.
+  static uint8_t arpeggio_out_note_;
+#endif  // HAS_MIDI_MERGE
   
   // After 4 beats without event, the sequencer is not active. The LED stops
   // blinking and the sequencer will restart from the first note in the pattern. 
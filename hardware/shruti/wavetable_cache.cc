@@ -0,0 +1,96 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Cache of decoded wavetable cycles.
+
+#include "hardware/shruti/wavetable_cache.h"
+
+#ifdef HAS_COMPRESSED_WAVETABLE
+
+#include "hardware/shruti/resources.h"
+
+namespace hardware_shruti {
+
+// The resources must be regenerated with "make resources" after changing
+// HAS_COMPRESSED_WAVETABLE - waveforms.py reads it from shruti.h. The
+// compressed table holds 16 cycles of 66 bytes.
+#if WAV_RES_WAVETABLE_SIZE != 1056
+#error "The wavetable is not compressed. Run make resources."
+#endif
+
+static const uint8_t kNoCycle = 0xff;
+
+/* <static> */
+uint8_t WavetableCache::samples_[2][kWavetableCycleSize + 1];
+uint8_t WavetableCache::index_[2];
+/* </static> */
+
+/* static */
+void WavetableCache::Init() {
+  index_[0] = kNoCycle;
+  index_[1] = kNoCycle;
+}
+
+/* static */
+void WavetableCache::Load(uint8_t cycle_a, uint8_t cycle_b) {
+  // Each missing cycle replaces the one which is not needed any longer.
+  if (cycle_a != index_[0] && cycle_a != index_[1]) {
+    uint8_t slot = index_[0] == cycle_b ? 1 : 0;
+    index_[slot] = cycle_a;
+    Decode(cycle_a, samples_[slot]);
+  }
+  if (cycle_b != index_[0] && cycle_b != index_[1]) {
+    uint8_t slot = index_[0] == cycle_a ? 1 : 0;
+    index_[slot] = cycle_b;
+    Decode(cycle_b, samples_[slot]);
+  }
+}
+
+/* static */
+void WavetableCache::Decode(uint8_t index, uint8_t* samples) {
+  const prog_uint8_t* data = waveform_table[WAV_RES_WAVETABLE] +
+      index * kCompressedCycleSize;
+  int16_t sample = pgm_read_byte(data);
+  uint8_t shift = pgm_read_byte(data + 1);
+  data += 2;
+  samples[0] = sample;
+  uint8_t deltas = 0;
+  for (uint8_t i = 1; i < kWavetableCycleSize; ++i) {
+    // The high nibble comes first.
+    int8_t delta;
+    if (i & 1) {
+      deltas = pgm_read_byte(data++);
+      delta = deltas >> 4;
+    } else {
+      delta = deltas & 0x0f;
+    }
+    sample += static_cast<int8_t>((delta ^ 8) - 8) << shift;
+    // The encoder clips the same way, so that the decoded signal never drifts
+    // away from the one it was computed from.
+    if (sample < 0) {
+      sample = 0;
+    } else if (sample > 255) {
+      sample = 255;
+    }
+    samples[i] = sample;
+  }
+  samples[kWavetableCycleSize] = samples[0];
+}
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_COMPRESSED_WAVETABLE
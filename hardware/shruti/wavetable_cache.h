@@ -0,0 +1,72 @@
+// Copyright 2009 Emilie Gillet.
+//
+// Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Cache of decoded wavetable cycles.
+//
+// When HAS_COMPRESSED_WAVETABLE is defined, the 16 cycles of the wavetable are
+// stored in flash as 4-bit deltas (66 bytes per cycle instead of 129), and the
+// two cycles crossfaded by the oscillator are decoded into RAM whenever the
+// position in the table changes - so that the render loop still reads one
+// plain byte per sample. A cycle is decoded in about 2000 cycles.
+//
+// The cache is shared by all the oscillators playing the wavetable, so with
+// several voices, they should read the same position of the table.
+
+#ifndef HARDWARE_SHRUTI_WAVETABLE_CACHE_H_
+#define HARDWARE_SHRUTI_WAVETABLE_CACHE_H_
+
+#include "hardware/shruti/shruti.h"
+
+#ifdef HAS_COMPRESSED_WAVETABLE
+
+namespace hardware_shruti {
+
+static const uint8_t kWavetableNumCycles = 16;
+static const uint8_t kWavetableCycleSize = 128;
+// First sample, shift, and 127 deltas packed in 64 bytes.
+static const uint8_t kCompressedCycleSize = 2 + kWavetableCycleSize / 2;
+
+class WavetableCache {
+ public:
+  WavetableCache() { }
+
+  static void Init();
+
+  // Makes sure that the two cycles are decoded - only the cycles not already
+  // in the cache are decoded.
+  static void Load(uint8_t cycle_a, uint8_t cycle_b);
+
+  // Returns the decoded samples of a cycle previously loaded, followed by a
+  // copy of the first sample for interpolation.
+  static inline const uint8_t* cycle(uint8_t index) {
+    return samples_[index == index_[0] ? 0 : 1];
+  }
+
+ private:
+  static void Decode(uint8_t index, uint8_t* samples);
+
+  static uint8_t samples_[2][kWavetableCycleSize + 1];
+  static uint8_t index_[2];
+
+  DISALLOW_COPY_AND_ASSIGN(WavetableCache);
+};
+
+}  // namespace hardware_shruti
+
+#endif  // HAS_COMPRESSED_WAVETABLE
+
+#endif  // HARDWARE_SHRUTI_WAVETABLE_CACHE_H_
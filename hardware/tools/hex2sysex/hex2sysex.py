@@ -25,6 +25,7 @@ usage:
   python hex2sysex.py \
     [--page_size 64] \
     [--delay 200] \
+    [--fast] \
     [--output_file path_to/firmware.mid] \
     path_to/firmware.hex
 """
@@ -49,14 +50,21 @@ def CreateMidifile(
   size = len(data)
   page_size = options.page_size
   delay = options.delay
+  if delay is None:
+    delay = 60 if options.fast else 200
   _, input_file_name = os.path.split(input_file_name)
   comments = [
       'Warning: contains OS data!',
       'Created from %(input_file_name)s' % locals(),
       'Size: %(size)d' % locals(),
       'Page size: %(page_size)d' % locals(),
-      'Delay: %(delay)d ms' % locals()]
-  m = midifile.MidiFile()
+      'Delay: %(delay)d ms' % locals(),
+      'Encoding: %s' % ('7-bit packing' if options.fast else 'nibbles')]
+  num_tracks = 1
+  if options.write_comments:
+    num_tracks += len(comments)
+  f = file(output_file, 'wb')
+  m = midifile.MidiFileWriter(f, num_tracks, format=1)
   if options.write_comments:
     for comment in comments:
       m.AddTrack().AddEvent(0, midifile.TextEvent(comment))
@@ -70,18 +78,23 @@ def CreateMidifile(
     block = ''.join(map(chr, data[i:i+page_size]))
     padding = page_size - len(block)
     block += '\x00' * padding
+    if options.fast:
+      command = options.update_command[0] + '\x01'
+      payload = midifile.Pack7Bits(block)
+    else:
+      command = options.update_command
+      payload = midifile.Nibblize(block)
     t.AddEvent(time, midifile.SysExEvent(
         options.manufacturer_id,
         options.device_id,
-        options.update_command + midifile.Nibblize(block)))
+        command + payload))
     # ms -> s -> beats -> ticks
     time += int(delay / 1000.0 / 0.5 * 96)
   t.AddEvent(time, midifile.SysExEvent(
       options.manufacturer_id,
       options.device_id,
       options.reset_command))
-  f = file(output_file, 'w')
-  m.Write(f, format=1)
+  m.Close()
   f.close()
 
 
@@ -99,8 +112,16 @@ if __name__ == '__main__':
       '--delay',
       dest='delay',
       type='int',
-      default=200,
-      help='Delay between pages in milliseconds')
+      default=None,
+      help='Delay between pages in milliseconds (200, or 60 with --fast)')
+  parser.add_option(
+      '-f',
+      '--fast',
+      dest='fast',
+      action='store_true',
+      default=False,
+      help='Pack the pages in 7-bit bytes rather than in nibbles, for '
+           'bootloaders built with HAS_FAST_SYSEX_UPDATE')
   parser.add_option(
       '-o',
       '--output_file',
@@ -66,8 +66,20 @@ def LoadHexFile(lines):
 def WriteHexFile(data, file_object, chunk_size=32):
   """Writes a Hex file."""
   
-  for address in xrange(0, len(data), chunk_size):
-    chunk = data[address:address+chunk_size]
+  WriteHexRecords(data, file_object, 0, chunk_size)
+  WriteHexFileEnd(file_object)
+
+
+def WriteHexRecords(data, file_object, start_address=0, chunk_size=32):
+  """Writes the data records of a block starting at start_address.
+
+  Allows a large file to be written one block at a time, without holding all
+  its data in memory. The file must be terminated with WriteHexFileEnd.
+  """
+
+  for offset in xrange(0, len(data), chunk_size):
+    chunk = data[offset:offset+chunk_size]
+    address = start_address + offset
     chunk_len = len(chunk)
     address_l = address & 255
     address_h = address >> 8
@@ -75,4 +87,9 @@ def WriteHexFile(data, file_object, chunk_size=32):
     file_object.write(''.join('%02x' % value for value in chunk))
     checksum = (-(chunk_len + address_l + address_h + sum(chunk))) & 255
     file_object.write('%02x\n' % checksum)
+
+
+def WriteHexFileEnd(file_object):
+  """Writes the end of file record of a Hex file."""
+
   file_object.write(':00000001FF\n')
\ No newline at end of file
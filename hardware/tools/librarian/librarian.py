@@ -30,17 +30,39 @@
 # You can edit it, archive it, copy/paste patches from other people etc, post
 # them on twitter, whatever.
 #
-# To create a patch library for the Shruti-1, put 16 lines of patches in a text
-# file, and create a .hex file from it.
+# To create a patch library for the Shruti-1, put up to 16 lines of patches in a
+# text file, and create a .hex file from it.
 #   python hardware/tools/librarian/librarian.py -c \
 #       library.txt > hardware/shruti/data/patch_library.hex
 #
 # And upload the resulting file to the Shruti-1:
 #   make eeprom_restore
+#
+# Large libraries - for example the image of the external EEPROMs, which hold
+# 512 patches - can be built incrementally. The index file keeps a digest and
+# the encoded data of each patch of the previous build, and only the patches
+# which have changed since are encoded again. The text file is read, and the
+# image written, one patch at a time.
+#   python hardware/tools/librarian/librarian.py -c -s 32768 \
+#       -i library.idx library.txt > library.hex
+#
+# To create a bank SysEx file, which replaces the 16 patches of the internal
+# EEPROM, from the patches 16 to 31 of a library:
+#   python hardware/tools/librarian/librarian.py -c -x -b 1 \
+#       -i library.idx library.txt > bank.syx
+#
+# The file contains one message per patch. The Shruti-1 writes each patch to
+# its EEPROM in the background, which takes about 210ms, and cannot receive the
+# next one in the meantime - so the messages must be sent with a pause of at
+# least 250ms between them, for example:
+#   amidi -p hw:1 -i 250 -s bank.syx
+# When the pause is too short, the patches which could not be written are
+# dropped, and '#' is displayed in the status area.
 
 
 """Converts a patch to a copy-and-paste friendly text format."""
 
+import hashlib
 import logging
 import optparse
 import os
@@ -54,9 +76,74 @@ PATCH_SIZE = 64
 EEPROM_SIZE = 1024
 DATA_SIZE = PATCH_SIZE - NAME_LEN
 
+# Must match the SysEx header and commands in hardware/shruti/patch.cc.
+SYSEX_HEADER = [0xf0, 0x00, 0x20, 0x77, 0x00, 0x01]
+SYSEX_COMMAND_BANK_TRANSFER = 0x03
+BANK_SIZE = EEPROM_SIZE / PATCH_SIZE
+
 from hardware.tools.hexfile import hexfile
 
 
+def EncodePatch(line):
+  """Converts a line of the text file into the data of a patch."""
+  name, data = line.strip('\r\n').split('\t')
+  name = name[:NAME_LEN]
+  name = name + ' ' * (NAME_LEN - len(name))
+  assert len(name) == NAME_LEN
+  assert len(data) == DATA_SIZE * 2
+  data = [int(data[x:x+2], 16) for x in xrange(0, DATA_SIZE * 2, 2)]
+  data += map(ord, name)
+  assert len(data) == PATCH_SIZE
+  return data
+
+
+class PatchIndex(object):
+  """Digests and encoded data of the patches of the previous build."""
+
+  def __init__(self, file_name):
+    self._file_name = file_name
+    self._entries = []
+    self.num_encoded = 0
+    if file_name and os.path.exists(file_name):
+      for line in file(file_name):
+        digest, data = line.strip().split('\t')
+        self._entries.append(
+            (digest, [int(data[x:x+2], 16) for x in xrange(0, len(data), 2)]))
+
+  def Lookup(self, slot, line):
+    """Returns the data of a patch, encoding it only if it has changed."""
+    digest = hashlib.md5(line.strip('\r\n')).hexdigest()
+    if slot < len(self._entries) and self._entries[slot][0] == digest:
+      return self._entries[slot][1]
+    data = EncodePatch(line)
+    self.num_encoded += 1
+    entry = (digest, data)
+    if slot < len(self._entries):
+      self._entries[slot] = entry
+    else:
+      self._entries.append(entry)
+    return data
+
+  def Save(self, num_slots):
+    if not self._file_name:
+      return
+    f = file(self._file_name, 'w')
+    for digest, data in self._entries[:num_slots]:
+      f.write(digest + '\t' + ''.join('%02x' % x for x in data) + '\n')
+    f.close()
+
+
+def WriteBankSysEx(patches, file_object):
+  """Writes one bank transfer message per slot, in the nibblized form used by
+  Patch. The argument of each message is the index of the slot."""
+  for slot, data in enumerate(patches):
+    message = SYSEX_HEADER + [SYSEX_COMMAND_BANK_TRANSFER, slot]
+    for value in data + [sum(data) % 256]:
+      message += [value >> 4, value & 0x0f]
+    message.append(0xf7)
+    file_object.write(''.join(map(chr, message)))
+
+
 if __name__ == '__main__':
   parser = optparse.OptionParser()
   parser.add_option(
@@ -71,6 +158,36 @@ if __name__ == '__main__':
       dest='compile',
       action='store_false',
       help='Converts from a dump .hex file to an editable text file')
+  parser.add_option(
+      '-s',
+      '--size',
+      dest='size',
+      type='int',
+      default=EEPROM_SIZE,
+      help='Size of the EEPROM image in bytes (1024, or 32768 for the '
+           'external EEPROMs)')
+  parser.add_option(
+      '-i',
+      '--index',
+      dest='index',
+      default=None,
+      help='Index file used to encode only the patches which have changed '
+           'since the previous build',
+      metavar='FILE')
+  parser.add_option(
+      '-x',
+      '--sysex',
+      dest='sysex',
+      action='store_true',
+      default=False,
+      help='Creates a bank SysEx message rather than a .hex file')
+  parser.add_option(
+      '-b',
+      '--bank',
+      dest='bank',
+      type='int',
+      default=0,
+      help='Bank of 16 patches of the library sent in the SysEx message')
   
   options, args = parser.parse_args()
   if len(args) != 1:
@@ -83,27 +200,40 @@ if __name__ == '__main__':
       logging.fatal('Error while loading .hex file')
       sys.exit(2)
 
-    if len(data) != EEPROM_SIZE:
-      logging.fatal('Eeprom data must be 1024 bytes long')
+    if len(data) % PATCH_SIZE:
+      logging.fatal('Eeprom data must be a multiple of 64 bytes long')
       sys.exit(1)
   
-    for offset in range(0, EEPROM_SIZE, PATCH_SIZE):
+    for offset in range(0, len(data), PATCH_SIZE):
       name = ''.join(
           map(chr, data[offset + PATCH_SIZE - NAME_LEN:offset + PATCH_SIZE]))
       hex_data = ''.join(
           '%02x' % x for x in data[offset:offset + PATCH_SIZE - NAME_LEN])
       print name + '\t' + hex_data
   else:
-    blob = []
+    index = PatchIndex(options.index)
+    num_slots = options.size / PATCH_SIZE
+    first_bank_slot = options.bank * BANK_SIZE
+    bank = []
+    slot = 0
     for line in file(args[0]):
-      name, data = line.strip().split('\t')
-      name = name[:NAME_LEN]
-      name = name + ' ' * (len(name) - NAME_LEN)
-      assert len(name) == NAME_LEN
-      assert len(data) == DATA_SIZE * 2
-      data = [int(data[x:x+2], 16) for x in xrange(0, DATA_SIZE * 2, 2)]
-      data += map(ord, name)
-      assert len(data) == PATCH_SIZE
-      blob += data
-    assert len(blob) == EEPROM_SIZE
-    hexfile.WriteHexFile(blob, sys.stdout)
+      if not line.strip():
+        continue
+      if slot >= num_slots and not options.sysex:
+        logging.fatal('More than %d patches' % num_slots)
+        sys.exit(1)
+      data = index.Lookup(slot, line)
+      if not options.sysex:
+        hexfile.WriteHexRecords(data, sys.stdout, slot * PATCH_SIZE)
+      elif first_bank_slot <= slot < first_bank_slot + BANK_SIZE:
+        bank.append(data)
+      slot += 1
+    if options.sysex:
+      if not bank:
+        logging.fatal('No patches in bank %d' % options.bank)
+        sys.exit(1)
+      WriteBankSysEx(bank, sys.stdout)
+    else:
+      hexfile.WriteHexFileEnd(sys.stdout)
+    index.Save(slot)
+    logging.info('%d patches, %d encoded' % (slot, index.num_encoded))
@@ -0,0 +1,183 @@
+#!/usr/bin/python2.5
+#
+# Copyright 2009 Emilie Gillet.
+#
+# Author: Emilie Gillet (emilie.o.gillet@gmail.com)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# -----------------------------------------------------------------------------
+#
+# MIDI stress test generator.
+
+"""MIDI stress test generator.
+
+Writes a midifile with a dense stream of notes, controller sweeps and MIDI
+clock, to be played into a unit to find how much MIDI data it can handle.
+The events are generated and written one tick at a time, so the duration of
+the file is not limited by the available memory.
+
+usage:
+  python midi_stress.py \
+    [--duration 60] \
+    [--tempo 120] \
+    [--notes 20] \
+    [--note_length 50] \
+    [--controls 100] \
+    [--controller 74] \
+    [--no_clock] \
+    [--channel 1] \
+    [--output_file stress.mid]
+"""
+
+import logging
+import optparse
+import sys
+
+# Allows the code to be run from the project root directory
+sys.path.append('.')
+
+from music.midi import midifile
+
+# 960 ticks per quarter note - a multiple of the 24 clocks per quarter note.
+PPQ = 960
+CLOCK_PERIOD = PPQ / 24
+
+LOWEST_NOTE = 36
+NOTE_RANGE = 48
+
+
+def WriteStressTest(output_file, options):
+  ticks_per_second = options.tempo / 60.0 * PPQ
+  num_ticks = int(options.duration * ticks_per_second)
+  note_length = max(1, int(options.note_length / 1000.0 * ticks_per_second))
+  notes_per_tick = options.notes / ticks_per_second
+  controls_per_tick = options.controls / ticks_per_second
+  channel = options.channel
+
+  f = file(output_file, 'wb')
+  m = midifile.MidiFileWriter(f, ppq=PPQ)
+  t = m.AddTrack()
+  t.AddEvent(0, midifile.TempoEvent(options.tempo))
+  if options.clock:
+    t.AddEvent(0, midifile.StartEvent())
+
+  # The notes are all of the same length, so they are released in the order in
+  # which they have been played.
+  pending_note_offs = []
+  num_notes = 0
+  num_controls = 0
+  note = 0
+  control_value = 0
+  control_direction = 1
+  # The last notes are released, and the clock keeps running, after the end of
+  # the stream of notes and controller changes.
+  end_tick = num_ticks + note_length
+  for tick in xrange(end_tick):
+    if options.clock and tick % CLOCK_PERIOD == 0:
+      t.AddEvent(tick, midifile.ClockEvent())
+    while pending_note_offs and pending_note_offs[0][0] <= tick:
+      _, released_note = pending_note_offs.pop(0)
+      # A note on with a null velocity keeps the running status.
+      t.AddEvent(tick, midifile.NoteOnEvent(channel, released_note, 0))
+    if tick >= num_ticks:
+      continue
+    while num_notes < (tick + 1) * notes_per_tick:
+      # Walks through the range by a fifth, so that consecutive notes differ.
+      note = (note + 7) % NOTE_RANGE
+      t.AddEvent(tick, midifile.NoteOnEvent(
+          channel, LOWEST_NOTE + note, 100))
+      pending_note_offs.append((tick + note_length, LOWEST_NOTE + note))
+      num_notes += 1
+    while num_controls < (tick + 1) * controls_per_tick:
+      # Triangle sweep of the controller, between 0 and 127.
+      t.AddEvent(tick, midifile.ControlChangeEvent(
+          channel, options.controller, control_value))
+      if not 0 <= control_value + control_direction <= 127:
+        control_direction = -control_direction
+      control_value += control_direction
+      num_controls += 1
+
+  if options.clock:
+    t.AddEvent(end_tick, midifile.StopEvent())
+  m.Close()
+  f.close()
+  logging.info('%d notes, %d controller changes' % (num_notes, num_controls))
+
+
+if __name__ == '__main__':
+  parser = optparse.OptionParser()
+  parser.add_option(
+      '-d',
+      '--duration',
+      dest='duration',
+      type='float',
+      default=60.0,
+      help='Duration in seconds')
+  parser.add_option(
+      '-t',
+      '--tempo',
+      dest='tempo',
+      type='float',
+      default=120.0,
+      help='Tempo in BPM, which sets the rate of the MIDI clock')
+  parser.add_option(
+      '-n',
+      '--notes',
+      dest='notes',
+      type='float',
+      default=20.0,
+      help='Notes played per second')
+  parser.add_option(
+      '-l',
+      '--note_length',
+      dest='note_length',
+      type='float',
+      default=50.0,
+      help='Length of the notes in milliseconds')
+  parser.add_option(
+      '-c',
+      '--controls',
+      dest='controls',
+      type='float',
+      default=100.0,
+      help='Controller changes sent per second')
+  parser.add_option(
+      '-k',
+      '--controller',
+      dest='controller',
+      type='int',
+      default=74,
+      help='Number of the swept controller')
+  parser.add_option(
+      '--no_clock',
+      dest='clock',
+      action='store_false',
+      default=True,
+      help='Do not send MIDI clock')
+  parser.add_option(
+      '-m',
+      '--channel',
+      dest='channel',
+      type='int',
+      default=1,
+      help='MIDI channel, from 1 to 16')
+  parser.add_option(
+      '-o',
+      '--output_file',
+      dest='output_file',
+      default='stress.mid',
+      help='Write output file to FILE',
+      metavar='FILE')
+
+  options, args = parser.parse_args()
+  WriteStressTest(options.output_file, options)
@@ -69,6 +69,53 @@ def CheckDups(collection):
   return False
 
 
+def PackStrings(strings):
+  """Packs a list of strings into a stream of 6-bit character codes.
+
+  Code 0 terminates a string, the other codes index an alphabet made of the
+  characters used by the strings. A string which is the tail of a string
+  already packed is not stored again. Returns the alphabet - starting with the
+  terminator - the offset, in characters, of each string, and the packed bytes,
+  followed by a padding byte so that the decoder can always read 2 bytes.
+  """
+  alphabet = ['\0'] + sorted(set(''.join(strings)))
+  if len(alphabet) > 64:
+    raise ValueError('Too many distinct characters to pack: %d' % len(alphabet))
+  codes = dict((c, chr(i)) for i, c in enumerate(alphabet))
+  stream = ''
+  offsets = [0] * len(strings)
+  for i in sorted(range(len(strings)), key=lambda i: -len(strings[i])):
+    encoded = ''.join(codes[c] for c in strings[i]) + codes['\0']
+    offset = stream.find(encoded)
+    if offset == -1:
+      offset = len(stream)
+      stream += encoded
+    offsets[i] = offset
+  bits = ''.join('{0:06b}'.format(ord(code)) for code in stream)
+  bits += '0' * (-len(bits) % 8 + 8)
+  data = [int(bits[i:i + 8], 2) for i in xrange(0, len(bits), 8)]
+  return [ord(c) for c in alphabet], offsets, data
+
+
+def WriteValues(f, data, c_type=''):
+  # Negative values in unsigned tables are written in two's complement, since
+  # narrowing conversions are not allowed in C++11 initializers.
+  mask = None
+  if 'uint8' in c_type:
+    mask = 0xff
+  elif 'uint16' in c_type:
+    mask = 0xffff
+  n_elements = len(data)
+  for i in xrange(0, n_elements, 8):
+    f.write('  ');
+    for j in xrange(i, min(n_elements, i + 8)):
+      value = data[j]
+      if mask is not None:
+        value &= mask
+      f.write('%6d, ' % value);
+    f.write('\n');
+
+
 def GenerateHeader(base_name, res):
   max_num_resources = 0
   for resource in res.resources:
@@ -88,8 +135,15 @@ def GenerateHeader(base_name, res):
   
   f.write('typedef %s ResourceId;\n\n' % res.types[max_num_resources > 255])
   
+  packed_strings = getattr(res, 'packed_strings', False)
   for resource, table_name, prefix, c_type, python_type, ram in res.resources:
-    f.write('extern const %s* %s_table[];\n\n' % (c_type, table_name))
+    if python_type == str and packed_strings:
+      args = (table_name, res.modifier)
+      f.write('extern const prog_uint16_t %s_table[] %s;\n' % args)
+      f.write('extern const prog_uint8_t %s_data[] %s;\n' % args)
+      f.write('extern const prog_uint8_t %s_alphabet[] %s;\n\n' % args)
+    else:
+      f.write('extern const %s* %s_table[];\n\n' % (c_type, table_name))
 
   for resource, table_name, prefix, c_type, python_type, ram in res.resources:
     if python_type != str:
@@ -115,8 +169,14 @@ def GenerateHeader(base_name, res):
   if res.create_specialized_manager:
     f.write('typedef hardware_resources::ResourcesManager<\n')
     f.write('    ResourceId,\n')
-    f.write('    hardware_resources::ResourcesTables<\n')
-    f.write('        %s_table,\n' % res.resources[0][1])
+    if packed_strings:
+      f.write('    hardware_resources::PackedResourcesTables<\n')
+      f.write('        %s_table,\n' % res.resources[0][1])
+      f.write('        %s_data,\n' % res.resources[0][1])
+      f.write('        %s_alphabet,\n' % res.resources[0][1])
+    else:
+      f.write('    hardware_resources::ResourcesTables<\n')
+      f.write('        %s_table,\n' % res.resources[0][1])
     f.write('        %s_table> > ResourcesManager; \n' % res.resources[1][1])
   
   if res.namespace:
@@ -131,8 +191,22 @@ def GenerateCc(base_name, res):
   if res.namespace:
     f.write('\nnamespace %s {\n\n' % res.namespace)
     
+  packed_strings = getattr(res, 'packed_strings', False)
   for resource, table_name, prefix, c_type, python_type, ram in res.resources:
-    if python_type == str:
+    if python_type == str and packed_strings:
+      alphabet, offsets, data = PackStrings([x.strip() for x in resource])
+      args = (table_name, res.modifier)
+      f.write('const prog_uint8_t %s_alphabet[] %s = {\n' % args)
+      WriteValues(f, alphabet)
+      f.write('};\n\n')
+      f.write('const prog_uint8_t %s_data[] %s = {\n' % args)
+      WriteValues(f, data)
+      f.write('};\n\n')
+      f.write('const prog_uint16_t %s_table[] %s = {\n' % args)
+      for string, offset in zip(resource, offsets):
+        f.write('  %4d,  // %s\n' % (offset, Canonicalize(string)))
+      f.write('};\n\n')
+    elif python_type == str:
       for string in resource:
         args = (c_type, '%s_%s' % (prefix.lower(), Canonicalize(string)),
                 res.modifier, string.strip())
@@ -153,12 +227,7 @@ def GenerateCc(base_name, res):
           name = '%s_%s' % (prefix.lower(), Canonicalize(name))
           args = (c_type, name, res.modifier)
           f.write('const %s %s[] %s = {\n' % args)
-          n_elements = len(data)
-          for i in xrange(0, n_elements, 8):
-            f.write('  ');
-            for j in xrange(i, min(n_elements, i + 8)):
-              f.write('%6d, ' % data[j]);
-            f.write('\n');
+          WriteValues(f, data, c_type)
           f.write('};\n')
           canonical[tuple(data)] = name
       if ram:
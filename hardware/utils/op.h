@@ -76,6 +76,24 @@ static inline uint8_t Mix(uint8_t a, uint8_t b, uint8_t balance) {
   return sum.bytes[1];
 }
 
+// Same as Mix, without discarding the 8 least significant bits.
+static inline uint16_t UnscaledMix(uint8_t a, uint8_t b, uint8_t balance) {
+  Word sum;
+  asm(
+    "mul %3, %2"      "\n\t"  // b * balance
+    "movw %A0, r0"    "\n\t"  // to sum
+    "com %2"          "\n\t"  // 255 - balance
+    "mul %1, %2"      "\n\t"  // a * (255 - balance)
+    "com %2"          "\n\t"  // reset balance to its previous value
+    "add %A0, r0"     "\n\t"  // add to sum L
+    "adc %B0, r1"     "\n\t"  // add to sum H
+    "eor r1, r1"      "\n\t"  // reset r1 after multiplication
+    : "&=r" (sum)
+    : "a" (a), "a" (balance), "a" (b)
+    );
+  return sum.value;
+}
+
 
 static inline uint8_t Mix4(uint8_t a, uint8_t b, uint8_t balance) {
   uint16_t sum;
@@ -263,6 +281,9 @@ static inline uint8_t ShiftRight6(int16_t value) {
 
 #else
 
+// Portable versions, used by the desktop build. They return the same results
+// as the assembly versions above.
+
 static inline uint8_t Clip8(int16_t value) {
   return value < 0 ? 0 : (value > 255 ? 255 : value);
 }
@@ -272,14 +293,18 @@ static inline int8_t SignedClip8(int16_t value) {
 }
 
 static inline uint8_t Mix(uint8_t a, uint8_t b, uint8_t balance) {
-  return a * (255 - balance) + b * balance >> 8;
+  return (a * (255 - balance) + b * balance) >> 8;
+}
+
+static inline uint16_t UnscaledMix(uint8_t a, uint8_t b, uint8_t balance) {
+  return a * (255 - balance) + b * balance;
 }
 
 static inline uint8_t Mix4(uint8_t a, uint8_t b, uint8_t balance) {
-  return a * (15 - balance) + b * balance >> 4;
+  return (a * (15 - balance) + b * balance) >> 4;
 }
 
-static inline uint8_t UnscaledMix4(uint8_t a, uint8_t b, uint8_t balance) {
+static inline uint16_t UnscaledMix4(uint8_t a, uint8_t b, uint8_t balance) {
   return a * (15 - balance) + b * balance;
 }
 
@@ -319,7 +344,7 @@ static inline uint16_t Mul16Scale8(uint16_t a, uint16_t b) {
   return static_cast<uint32_t>(a) * b >> 8;
 }
 
-static inline uint8_t ShiftRight6(uint16_t value) {
+static inline uint8_t ShiftRight6(int16_t value) {
   return value >> 6;
 }
   
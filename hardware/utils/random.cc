@@ -24,4 +24,7 @@ namespace hardware_utils {
 /* static */
 uint16_t Random::rng_state_ = 0x21;
 
+/* static */
+uint16_t AudioRandom::rng_state_ = 0x21;
+
 }  // namespace hardware_utils
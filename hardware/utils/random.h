@@ -15,7 +15,7 @@
 //
 // -----------------------------------------------------------------------------
 //
-// Fast 16-bit pseudo random number generator.
+// Fast 16-bit pseudo random number generators.
 
 #ifndef HARDWARE_UTILS_RANDOM_H_
 #define HARDWARE_UTILS_RANDOM_H_
@@ -49,6 +49,38 @@ class Random {
   DISALLOW_COPY_AND_ASSIGN(Random);
 };
 
+// A second generator, for the audio rate noise sources, so that their stream
+// is not disturbed by the control rate users of Random. A step of the LFSR
+// above only shifts in a single new bit, so that consecutive values of its
+// byte output are strongly correlated; each step of this xorshift generator
+// mixes all the bits of the state, for a flat spectrum even when a byte is
+// drawn at each sample.
+class AudioRandom {
+ public:
+  static inline void Update() {
+    // Xorshift with shifts (7, 9, 8). Period: 65535.
+    uint16_t x = rng_state_;
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    rng_state_ = x;
+  }
+
+  static inline uint8_t state_msb() {
+    return static_cast<uint8_t>(rng_state_ >> 8);
+  }
+
+  static inline uint8_t GetByte() {
+    Update();
+    return state_msb();
+  }
+
+ private:
+  static uint16_t rng_state_;
+  
+  DISALLOW_COPY_AND_ASSIGN(AudioRandom);
+};
+
 }  // namespace hardware_utils
 
 #endif  // HARDWARE_UTILS_RANDOM_H_
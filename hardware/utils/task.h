@@ -15,8 +15,9 @@
 //
 // -----------------------------------------------------------------------------
 //
-// Implementation of multitasking by coroutines, and naive deterministic
-// scheduler.
+// Implementation of multitasking by coroutines, naive deterministic scheduler,
+// and deadline-aware scheduler. The schedulers can optionally be instrumented
+// to keep track of the number of cycles spent in each task.
 
 #ifndef HARDWARE_UTILS_TASK_H_
 #define HARDWARE_UTILS_TASK_H_
@@ -57,6 +58,117 @@ typedef struct {
   uint8_t priority;
 } Task;
 
+// Statistics about the number of cycles spent in a task. Dumped as is (little
+// endian) by the profiling SysEx message.
+typedef struct {
+  uint16_t min;
+  uint16_t max;
+  uint32_t total;
+  uint16_t count;
+} TaskStatistics;
+
+// Default, no-op, instrumentation.
+struct NoTaskProfiler {
+  static inline void TaskStarted(uint8_t task) { }
+  static inline void TaskEnded(uint8_t task) { }
+};
+
+// Keeps track of the min/max/total cycle count of each task. Clock is a
+// hardware_hal::CycleCounter. The total and count are halved when the count
+// saturates, so that the average can still be computed.
+template<typename Clock, uint8_t num_tasks>
+class TaskProfiler {
+ public:
+  TaskProfiler() { }
+  static void Init() {
+    for (uint8_t i = 0; i < num_tasks; ++i) {
+      statistics_[i].min = 0xffff;
+      statistics_[i].max = 0;
+      statistics_[i].total = 0;
+      statistics_[i].count = 0;
+    }
+  }
+
+  static inline void TaskStarted(uint8_t task) {
+    Clock::Read(&start_);
+  }
+
+  static inline void TaskEnded(uint8_t task) {
+    uint32_t elapsed = Clock::Elapsed(start_);
+    uint16_t cycles = elapsed > 0xffff ? 0xffff : elapsed;
+    TaskStatistics* s = &statistics_[task];
+    if (cycles < s->min) {
+      s->min = cycles;
+    }
+    if (cycles > s->max) {
+      s->max = cycles;
+    }
+    if (s->count == 0xffff) {
+      s->count >>= 1;
+      s->total >>= 1;
+    }
+    ++s->count;
+    s->total += cycles;
+  }
+
+  static inline const TaskStatistics* statistics() { return statistics_; }
+  static inline uint8_t size() { return sizeof(statistics_); }
+
+ private:
+  static typename Clock::Timestamp start_;
+  static TaskStatistics statistics_[num_tasks];
+
+  DISALLOW_COPY_AND_ASSIGN(TaskProfiler);
+};
+
+template<typename Clock, uint8_t num_tasks>
+typename Clock::Timestamp TaskProfiler<Clock, num_tasks>::start_;
+
+template<typename Clock, uint8_t num_tasks>
+TaskStatistics TaskProfiler<Clock, num_tasks>::statistics_[num_tasks];
+
+// Fills an array of slots in such a way that $task.priority occurrences of a
+// task are present in the array, and are roughly evenly spaced. See below.
+// The sum of the priorities must not exceed the number of slots.
+inline void FillSlots(
+    const Task* tasks,
+    uint8_t num_tasks,
+    uint8_t* slots,
+    uint8_t num_slots) {
+  uint8_t slot = 0;
+  uint8_t num_free_slots = num_slots;
+
+  // For a given task, occupy $priority available slots, spaced apart by
+  // #total slots / $priority.
+  for (uint8_t i = 0; i < num_slots; ++i) {
+    slots[i] = 0;
+  }
+
+  for (uint8_t i = 0; i < num_tasks; ++i) {
+    for (uint8_t j = 0; j < tasks[i].priority; ++j) {
+      // The priorities add up to more than the number of slots. Stop here
+      // rather than searching forever for a free slot - the remaining
+      // occurrences of the task are dropped.
+      if (!num_free_slots) {
+        return;
+      }
+      --num_free_slots;
+      // Search for the next available slot.
+      while (1) {
+        if (slot >= num_slots) {
+          slot = 0;
+        }
+        if (slots[slot] == 0) {
+          break;
+        }
+        ++slot;
+      }
+      slots[slot] = i + 1;
+      slot += num_slots / tasks[i].priority;
+    }
+  }
+}
+
 // This naive deterministic scheduler stores an array of "slots", each element
 // of which stores a 0 (nop) or a task id. During initialization, the array is
 // filled in such a way that $task.priority occurrences of a task are present in
@@ -71,34 +183,13 @@ typedef struct {
 // 1 2 1 3 1 2 1 4 1 2 1 3 2 3 0 0
 //
 // And the scheduler will execute the tasks in this sequence.
-template<uint8_t num_slots>
+//
+// The Profiler is notified of the beginning and end of each task.
+template<uint8_t num_slots, typename Profiler = NoTaskProfiler>
 class NaiveScheduler {
  public:
   void Init()  {
-    uint8_t slot = 0;
-
-    // For a given task, occupy $priority available slots, spaced apart by
-    // #total slots / $priority.
-    for (uint8_t i = 0; i < sizeof(slots_); ++i) {
-      slots_[i] = 0;
-    }
-
-    for (uint8_t i = 0; i < sizeof(tasks_) / sizeof(Task); ++i) {
-      for (uint8_t j = 0; j < tasks_[i].priority; ++j) {
-        // Search for the next available slot.
-        while (1) {
-          if (slot >= sizeof(slots_)) {
-            slot = 0;
-          }
-          if (slots_[slot] == 0) {
-            break;
-          }
-          ++slot;
-        }
-        slots_[slot] = i + 1;
-        slot += sizeof(slots_) / tasks_[i].priority;
-      }
-    }
+    FillSlots(tasks_, sizeof(tasks_) / sizeof(Task), slots_, sizeof(slots_));
   }
 
   void Run() {
@@ -108,8 +199,63 @@ class NaiveScheduler {
         current_slot_ = 0;
       }
       if (slots_[current_slot_]) {
-        tasks_[slots_[current_slot_] - 1].code();
+        uint8_t task = slots_[current_slot_] - 1;
+        Profiler::TaskStarted(task);
+        tasks_[task].code();
+        Profiler::TaskEnded(task);
+      }
+    }
+  }
+
+ private:
+  static Task tasks_[];
+  static uint8_t slots_[num_slots];
+  static uint8_t current_slot_;
+};
+
+template<uint8_t num_slots, typename Profiler>
+uint8_t NaiveScheduler<num_slots, Profiler>::slots_[num_slots];
+
+template<uint8_t num_slots, typename Profiler>
+uint8_t NaiveScheduler<num_slots, Profiler>::current_slot_;
+
+static const uint8_t kNoUrgentTask = 0xff;
+
+// This scheduler first asks the Deadlines policy whether a task must be run
+// right now - for example because an output buffer is about to underrun, or
+// because an input buffer is about to overflow. Deadlines::UrgentTask()
+// returns the index of this task in the task table, or kNoUrgentTask. The
+// policy is asked again before each task, so the most urgent deadline always
+// wins.
+//
+// When there is no urgent task, the slots are used for background tasks and
+// are filled as with the NaiveScheduler. A task of priority 0 never gets a
+// slot - it is only run when the policy says so.
+template<uint8_t num_slots, typename Deadlines,
+         typename Profiler = NoTaskProfiler>
+class DeadlineScheduler {
+ public:
+  void Init() {
+    FillSlots(tasks_, sizeof(tasks_) / sizeof(Task), slots_, sizeof(slots_));
+  }
+
+  void Run() {
+    while (1) {
+      uint8_t task = Deadlines::UrgentTask();
+      if (task == kNoUrgentTask) {
+        ++current_slot_;
+        if (current_slot_ >= num_slots) {
+          current_slot_ = 0;
+        }
+        task = slots_[current_slot_];
+        if (!task) {
+          continue;
+        }
+        --task;
       }
+      Profiler::TaskStarted(task);
+      tasks_[task].code();
+      Profiler::TaskEnded(task);
     }
   }
 
@@ -119,11 +265,11 @@ class NaiveScheduler {
   static uint8_t current_slot_;
 };
 
-template<uint8_t num_slots>
-uint8_t NaiveScheduler<num_slots>::slots_[num_slots];
+template<uint8_t num_slots, typename Deadlines, typename Profiler>
+uint8_t DeadlineScheduler<num_slots, Deadlines, Profiler>::slots_[num_slots];
 
-template<uint8_t num_slots>
-uint8_t NaiveScheduler<num_slots>::current_slot_;
+template<uint8_t num_slots, typename Deadlines, typename Profiler>
+uint8_t DeadlineScheduler<num_slots, Deadlines, Profiler>::current_slot_;
 
 }  // namespace hardware_utils
 
@@ -20,6 +20,11 @@
 # Midifile Writer
 
 """Midifile writer.
+
+MidiFile holds all the events in memory, and sorts them before writing the
+file. MidiFileWriter writes the events as they are added - they must be added
+in chronological order, one track after the other - so that arbitrarily long
+files can be generated. MidiFileReader reads a file one event at a time.
 """
 
 import struct
@@ -30,6 +35,14 @@ def PackInteger(value, size=4):
   return struct.pack('>%s' % {1: 'B', 2: 'H', 4: 'L'}[size], value)
 
 
+def UnpackInteger(data):
+  """Unpacks a n-byte big endian byte sequence into a python integer."""
+  value = 0
+  for char in data:
+    value = (value << 8) | ord(char)
+  return value
+
+
 def PackVariableLengthInteger(value):
   """Packs a python integer into a variable length byte sequence."""
   if value == 0:
@@ -209,11 +222,14 @@ class PitchBendEvent(ChannelEvent):
 
 
 class SystemEvent(Event):
+  """Real-time messages, stored as escaped (0xf7) events, as a status byte
+  above 0xf0 is not allowed in a track. An escaped event cancels the running
+  status."""
   def __init__(self, id):
     self._id = id
     
   def Serialize(self, running_status):
-    return PackInteger(self._id, size=1), running_status
+    return '\xf7\x01' + PackInteger(self._id, size=1), None
 
 
 class ClockEvent(SystemEvent):
@@ -268,6 +284,25 @@ def Nibblize(data, add_checksum=True):
   return ''.join(output)
 
 
+def Pack7Bits(data, add_checksum=True):
+  """Converts a byte string into groups of 7 bytes stripped of their MSB.
+
+  Each group is preceded by a byte holding the MSBs of its bytes - the MSB of
+  the first byte in bit 6. Also adds checksum.
+  """
+  if add_checksum:
+    data += chr(sum(ord(char) for char in data) % 256)
+  output = []
+  for i in xrange(0, len(data), 7):
+    group = map(ord, data[i:i + 7])
+    most_significant_bits = 0
+    for j, char in enumerate(group):
+      most_significant_bits |= (char & 0x80) >> (j + 1)
+    output.append(chr(most_significant_bits))
+    output.extend(chr(char & 0x7f) for char in group)
+  return ''.join(output)
+
+
 class Track(object):
   def __init__(self):
     self._events = []
@@ -305,6 +340,176 @@ class Track(object):
     return self._events
 
     
+class TrackWriter(object):
+  """Writes the events of a track to a file as they are added.
+
+  The size of the track, written in its header, is only known once the track
+  is closed, so the file object must support seek().
+  """
+
+  def __init__(self, file_object):
+    self._file_object = file_object
+    self._start = file_object.tell()
+    self._size = 0
+    self._time = 0
+    self._running_status = None
+    self._last_event = None
+    file_object.write('MTrk')
+    file_object.write(PackInteger(0))
+
+  def AddEvent(self, time, event):
+    assert time >= self._time, 'Events must be added in chronological order'
+    event_data, self._running_status = event.Serialize(self._running_status)
+    data = PackVariableLengthInteger(time - self._time) + event_data
+    self._file_object.write(data)
+    self._size += len(data)
+    self._time = time
+    self._last_event = event
+
+  def Close(self):
+    # Same as Track: the end of track is one tick after the last event.
+    if type(self._last_event) != EndOfTrackEvent:
+      self.AddEvent(self._time + 1, EndOfTrackEvent())
+    end = self._file_object.tell()
+    self._file_object.seek(self._start + 4)
+    self._file_object.write(PackInteger(self._size))
+    self._file_object.seek(end)
+
+
+class MidiFileWriter(object):
+  """Writes a midifile one event at a time."""
+
+  def __init__(self, file_object, num_tracks=1, format=0, ppq=96):
+    assert format != 0 or num_tracks == 1
+    self._file_object = file_object
+    self._num_tracks = num_tracks
+    self._num_tracks_written = 0
+    self._track = None
+    file_object.write('MThd')
+    file_object.write(PackInteger(6))
+    file_object.write(PackInteger(format, size=2))
+    file_object.write(PackInteger(num_tracks, size=2))
+    file_object.write(PackInteger(ppq, size=2))
+
+  def AddTrack(self):
+    """Closes the current track, and starts the next one."""
+    assert self._num_tracks_written < self._num_tracks
+    if self._track:
+      self._track.Close()
+    self._track = TrackWriter(self._file_object)
+    self._num_tracks_written += 1
+    return self._track
+
+  def Close(self):
+    assert self._num_tracks_written == self._num_tracks
+    if self._track:
+      self._track.Close()
+      self._track = None
+
+
+class _ChunkReader(object):
+  """Reads the content of a chunk from a file, a block at a time."""
+
+  def __init__(self, file_object, size, block_size=4096):
+    self._file_object = file_object
+    self._remaining = size
+    self._block_size = block_size
+    self._buffer = ''
+    self._position = 0
+
+  def Read(self, size):
+    while len(self._buffer) - self._position < size:
+      if not self._remaining:
+        raise EOFError
+      block = self._file_object.read(min(self._block_size, self._remaining))
+      if not block:
+        raise EOFError
+      self._remaining -= len(block)
+      self._buffer = self._buffer[self._position:] + block
+      self._position = 0
+    data = self._buffer[self._position:self._position + size]
+    self._position += size
+    return data
+
+  def ReadByte(self):
+    return ord(self.Read(1))
+
+  def ReadVariableLengthInteger(self):
+    value = 0
+    while True:
+      byte = self.ReadByte()
+      value = (value << 7) | (byte & 0x7f)
+      if not byte & 0x80:
+        return value
+
+  def done(self):
+    return not self._remaining and self._position == len(self._buffer)
+
+
+class MidiFileReader(object):
+  """Reads a midifile one event at a time."""
+
+  # Number of data bytes of the channel messages, indexed by the MSBs of the
+  # status byte.
+  _CHANNEL_MESSAGE_SIZE = {
+      0x80: 2, 0x90: 2, 0xa0: 2, 0xb0: 2, 0xc0: 1, 0xd0: 1, 0xe0: 2}
+
+  def __init__(self, file_object):
+    self._file_object = file_object
+    if file_object.read(4) != 'MThd':
+      raise ValueError('Not a midifile')
+    header_size = UnpackInteger(file_object.read(4))
+    header = file_object.read(header_size)
+    self.format = UnpackInteger(header[0:2])
+    self.num_tracks = UnpackInteger(header[2:4])
+    self.ppq = UnpackInteger(header[4:6])
+
+  def Events(self):
+    """Yields (track, time, status, data) for each event of the file.
+
+    The tracks are read one after the other. The time is in ticks, from the
+    start of the track. The running status is expanded: status is the status
+    byte of the event (0xff for meta events, which have their type as the
+    first byte of data).
+    """
+    for track in xrange(self.num_tracks):
+      chunk_type = self._file_object.read(4)
+      chunk_size = UnpackInteger(self._file_object.read(4))
+      reader = _ChunkReader(self._file_object, chunk_size)
+      if chunk_type != 'MTrk':
+        while not reader.done():
+          reader.Read(1)
+        continue
+      time = 0
+      running_status = None
+      while not reader.done():
+        time += reader.ReadVariableLengthInteger()
+        status = reader.ReadByte()
+        if status == 0xff:
+          meta_type = reader.Read(1)
+          data = meta_type + reader.Read(reader.ReadVariableLengthInteger())
+          running_status = None
+        elif status == 0xf0 or status == 0xf7:
+          data = reader.Read(reader.ReadVariableLengthInteger())
+          running_status = None
+        elif status > 0xf0:
+          # Not allowed by the standard, but written by some tools: a bare
+          # real-time message, which does not affect the running status.
+          data = ''
+        else:
+          if status < 0x80:
+            # Running status: this was the first data byte.
+            data = chr(status)
+            status = running_status
+            size = self._CHANNEL_MESSAGE_SIZE[status & 0xf0] - 1
+          else:
+            data = ''
+            size = self._CHANNEL_MESSAGE_SIZE[status & 0xf0]
+            running_status = status
+          data += reader.Read(size)
+        yield track, time, status, data
+
+
 class MidiFile(object):
   def __init__(self, ppq=96):
     self._tracks = []